@@ -159,6 +159,12 @@ typedef struct ALLEGRO_VERTEX_BUFFER ALLEGRO_VERTEX_BUFFER;
  */
 typedef struct ALLEGRO_INDEX_BUFFER ALLEGRO_INDEX_BUFFER;
 
+#if defined(ALLEGRO_UNSTABLE) || defined(ALLEGRO_INTERNAL_UNSTABLE) || defined(ALLEGRO_PRIMITIVES_SRC)
+/* Type: ALLEGRO_PATH_GEOMETRY
+ */
+typedef struct ALLEGRO_PATH_GEOMETRY ALLEGRO_PATH_GEOMETRY;
+#endif
+
 ALLEGRO_PRIM_FUNC(uint32_t, al_get_allegro_primitives_version, (void));
 
 /*
@@ -171,6 +177,12 @@ ALLEGRO_PRIM_FUNC(int, al_draw_indexed_prim, (const void* vtxs, const ALLEGRO_VE
 ALLEGRO_PRIM_FUNC(int, al_draw_vertex_buffer, (ALLEGRO_VERTEX_BUFFER* vertex_buffer, ALLEGRO_BITMAP* texture, int start, int end, int type));
 ALLEGRO_PRIM_FUNC(int, al_draw_indexed_buffer, (ALLEGRO_VERTEX_BUFFER* vertex_buffer, ALLEGRO_BITMAP* texture, ALLEGRO_INDEX_BUFFER* index_buffer, int start, int end, int type));
 
+#if defined(ALLEGRO_UNSTABLE) || defined(ALLEGRO_INTERNAL_UNSTABLE) || defined(ALLEGRO_PRIMITIVES_SRC)
+ALLEGRO_PRIM_FUNC(void, al_hold_primitive_drawing, (bool hold));
+ALLEGRO_PRIM_FUNC(bool, al_is_primitive_drawing_held, (void));
+ALLEGRO_PRIM_FUNC(int, al_get_held_primitive_flush_count, (void));
+#endif
+
 ALLEGRO_PRIM_FUNC(ALLEGRO_VERTEX_DECL*, al_create_vertex_decl, (const ALLEGRO_VERTEX_ELEMENT* elements, int stride));
 ALLEGRO_PRIM_FUNC(void, al_destroy_vertex_decl, (ALLEGRO_VERTEX_DECL* decl));
 
@@ -245,6 +257,21 @@ ALLEGRO_PRIM_FUNC(void, al_draw_polygon, (const float* vertices, int vertex_coun
 ALLEGRO_PRIM_FUNC(void, al_draw_filled_polygon, (const float* vertices, int vertex_count, ALLEGRO_COLOR color));
 ALLEGRO_PRIM_FUNC(void, al_draw_filled_polygon_with_holes, (const float* vertices, const int* vertex_counts, ALLEGRO_COLOR color));
 
+/*
+* Retained path geometry
+*/
+#if defined(ALLEGRO_UNSTABLE) || defined(ALLEGRO_INTERNAL_UNSTABLE) || defined(ALLEGRO_PRIMITIVES_SRC)
+ALLEGRO_PRIM_FUNC(ALLEGRO_PATH_GEOMETRY*, al_create_path_geometry, (int flags));
+ALLEGRO_PRIM_FUNC(void, al_destroy_path_geometry, (ALLEGRO_PATH_GEOMETRY* geometry));
+ALLEGRO_PRIM_FUNC(void, al_set_path_geometry_polyline, (ALLEGRO_PATH_GEOMETRY* geometry, const float* vertices, int vertex_stride, int vertex_count, int join_style, int cap_style, float thickness, float miter_limit));
+ALLEGRO_PRIM_FUNC(void, al_set_path_geometry_filled_polygon, (ALLEGRO_PATH_GEOMETRY* geometry, const float* vertices, int vertex_count));
+ALLEGRO_PRIM_FUNC(void, al_set_path_geometry_filled_polygon_with_holes, (ALLEGRO_PATH_GEOMETRY* geometry, const float* vertices, const int* vertex_counts));
+ALLEGRO_PRIM_FUNC(void, al_set_path_geometry_ribbon, (ALLEGRO_PATH_GEOMETRY* geometry, const float* points, int points_stride, float thickness, int num_segments));
+ALLEGRO_PRIM_FUNC(void, al_set_path_geometry_spline, (ALLEGRO_PATH_GEOMETRY* geometry, float points[8], float thickness, int num_segments));
+ALLEGRO_PRIM_FUNC(void, al_set_path_geometry_arc, (ALLEGRO_PATH_GEOMETRY* geometry, float cx, float cy, float rx, float ry, float start_theta, float delta_theta, float thickness, int num_segments));
+ALLEGRO_PRIM_FUNC(void, al_draw_path_geometry, (ALLEGRO_PATH_GEOMETRY* geometry, ALLEGRO_COLOR color));
+#endif
+
 
 #ifdef __cplusplus
 }
@@ -1,6 +1,8 @@
 #ifndef __al_included_allegro5_aintern_prim_h
 #define __al_included_allegro5_aintern_prim_h
 
+#include "allegro5/internal/aintern_vector.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -25,6 +27,10 @@ typedef struct ALLEGRO_PRIM_VERTEX_CACHE {
    ALLEGRO_COLOR   color;
    int             prim_type;
    void*           user_data;
+   /* If not NULL, flushed vertices are appended to this vector of
+    * ALLEGRO_VERTEX instead of being drawn.
+    */
+   _AL_VECTOR*     record;
 } ALLEGRO_PRIM_VERTEX_CACHE;
 
 typedef struct ALLEGRO_BUFFER_COMMON {
@@ -61,6 +67,15 @@ void _al_prim_cache_push_point(ALLEGRO_PRIM_VERTEX_CACHE* cache, const float* v)
 void _al_prim_cache_push_triangle(ALLEGRO_PRIM_VERTEX_CACHE* cache, const float* v0, const float* v1, const float* v2);
 
 
+/* Fast triangulation, see triangulator_grid.c. */
+bool _al_triangulate_polygon_grid(const float* vertices, size_t vertex_stride, const int* vertex_counts, void (*emit_triangle)(int, int, int, void*), void* userdata);
+
+/* The [primitives] triangulator setting, see triangulator.c. */
+void _al_init_triangulator(void);
+
+/* Tessellation for path geometry, see path_geometry.c. */
+int _al_tessellate_polyline(_AL_VECTOR* dest, const float* vertices, int vertex_stride, int vertex_count, int join_style, int cap_style, float thickness, float miter_limit);
+
 /* Internal functions. */
 float     _al_prim_get_scale(void);
 float     _al_prim_normalize(float* vector);
@@ -69,6 +84,20 @@ bool      _al_prim_is_point_in_triangle(const float* point, const float* v0, con
 bool      _al_prim_intersect_segment(const float* v0, const float* v1, const float* p0, const float* p1, float* point, float* t0, float* t1);
 bool      _al_prim_are_points_equal(const float* point_a, const float* point_b);
 
+/* Held primitive drawing, see prim_batch.c. */
+void _al_init_prim_batch(void);
+void _al_shutdown_prim_batch(void);
+bool _al_prim_batch_held(void);
+int  _al_batch_prim(const ALLEGRO_VERTEX* vtxs, const int* indices, int start, int end, int type);
+void _al_flush_prim_batch(void);
+
+/* Unit arc tables, see high_primitives.c. */
+void _al_init_arc_tables(void);
+void _al_shutdown_arc_tables(void);
+
+int _al_draw_prim_direct(const void* vtxs, const ALLEGRO_VERTEX_DECL* decl, ALLEGRO_BITMAP* texture, int start, int end, int type);
+int _al_draw_prim_indexed_direct(const void* vtxs, const ALLEGRO_VERTEX_DECL* decl, ALLEGRO_BITMAP* texture, const int* indices, int num_vtx, int type);
+
 int _al_bitmap_region_is_locked(ALLEGRO_BITMAP* bmp, int x1, int y1, int x2, int y2);
 int _al_draw_buffer_common_soft(ALLEGRO_VERTEX_BUFFER* vertex_buffer, ALLEGRO_BITMAP* texture, ALLEGRO_INDEX_BUFFER* index_buffer, int start, int end, int type);
 
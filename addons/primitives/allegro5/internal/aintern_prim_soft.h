@@ -12,7 +12,7 @@ int _al_draw_prim_soft(ALLEGRO_BITMAP* texture, const void* vtxs, const ALLEGRO_
 int _al_draw_prim_indexed_soft(ALLEGRO_BITMAP* texture, const void* vtxs, const ALLEGRO_VERTEX_DECL* decl, const int* indices, int num_vtx, int type);
 
 void _al_line_2d(ALLEGRO_BITMAP* texture, ALLEGRO_VERTEX* v1, ALLEGRO_VERTEX* v2);
-void _al_point_2d(ALLEGRO_BITMAP* texture, ALLEGRO_VERTEX* v);
+void _al_points_2d(ALLEGRO_BITMAP* texture, ALLEGRO_VERTEX* vtx, int n);
 
 #ifdef __cplusplus
 }
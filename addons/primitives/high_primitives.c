@@ -42,7 +42,18 @@
 #include "allegro5/allegro_opengl.h"
 #endif
 #include "allegro5/internal/aintern_bitmap.h"
+#include "allegro5/internal/aintern_cpu.h"
+#include "allegro5/internal/aintern_prim.h"
+#include "allegro5/internal/aintern_thread.h"
 #include <math.h>
+#include <stdlib.h>
+
+#ifdef _AL_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 #ifdef ALLEGRO_MSVC
    #define hypotf(x, y) _hypotf((x), (y))
@@ -50,6 +61,28 @@
 
 #define LOCAL_VERTEX_CACHE  ALLEGRO_VERTEX vertex_cache[ALLEGRO_VERTEX_CACHE_SIZE]
 
+/* Unit arcs of up to this many points are kept once computed. */
+#define MAX_ARC_TABLE_POINTS  1024
+
+/* The fewest segments a whole turn gets when arc_max_error is set. */
+#define MIN_SEGMENTS_PER_TURN  8
+
+/* The unit arcs kept: whole turns, which ellipses and circles are made of,
+ * and quarter turns, which the corners of rounded rectangles are made of.
+ */
+enum {
+   ARC_TABLE_TURN,
+   ARC_TABLE_QUARTER,
+   NUM_ARC_TABLES
+};
+
+static _AL_MUTEX arc_table_mutex = _AL_MUTEX_UNINITED;
+static float *arc_tables[NUM_ARC_TABLES][MAX_ARC_TABLE_POINTS + 1];
+static bool arc_tables_ready = false;
+
+/* The [primitives] arc_max_error setting, or 0 if it is not set. */
+static float arc_max_error = 0;
+
 /*
  * Make an estimate of the scale of the current transformation. 
  * We do this by computing the determinants of the 2D section of the transformation matrix.
@@ -72,6 +105,184 @@ static float get_scale(void)
 #undef DET2D
 }
 
+/* The number of segments a whole turn of an arc of radius r is drawn with
+ * at the given scale. By default it grows with the square root of the
+ * radius. With arc_max_error set it is the fewest that keep the chords
+ * within that many pixels of the arc.
+ */
+static float segments_per_turn(float scale, float r)
+{
+   double pixels;
+   float n;
+
+   if (arc_max_error <= 0)
+      return ALLEGRO_PRIM_QUALITY * scale * sqrtf(r);
+
+   pixels = (double)scale * r;
+   if (pixels <= 0)
+      return 0;
+   if (arc_max_error >= pixels)
+      return MIN_SEGMENTS_PER_TURN;
+
+   n = ALLEGRO_PI / acos(1.0 - arc_max_error / pixels);
+   return n < MIN_SEGMENTS_PER_TURN ? MIN_SEGMENTS_PER_TURN : n;
+}
+
+/* Internal function: _al_init_arc_tables
+ */
+void _al_init_arc_tables(void)
+{
+   ALLEGRO_CONFIG *config = al_get_system_config();
+   const char *value = config ?
+      al_get_config_value(config, "primitives", "arc_max_error") : NULL;
+
+   _al_mutex_init(&arc_table_mutex);
+   arc_max_error = value ? strtod(value, NULL) : 0;
+   arc_tables_ready = true;
+}
+
+/* Internal function: _al_shutdown_arc_tables
+ */
+void _al_shutdown_arc_tables(void)
+{
+   int kind, n;
+
+   arc_tables_ready = false;
+   for (kind = 0; kind < NUM_ARC_TABLES; kind++) {
+      for (n = 0; n <= MAX_ARC_TABLE_POINTS; n++) {
+         al_free(arc_tables[kind][n]);
+         arc_tables[kind][n] = NULL;
+      }
+   }
+   _al_mutex_destroy(&arc_table_mutex);
+}
+
+/* Reads a slot of arc_tables without taking arc_table_mutex. A table is
+ * filled in before it is published, so it can be used as soon as it is
+ * seen. Returns NULL if the slot must be read again under the lock.
+ */
+static float *load_arc_table(int kind, int num_points)
+{
+#if defined(__ATOMIC_ACQUIRE)
+   return __atomic_load_n(&arc_tables[kind][num_points], __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER)
+   return _InterlockedCompareExchangePointer(
+      (void * volatile *)&arc_tables[kind][num_points], NULL, NULL);
+#else
+   (void)kind;
+   (void)num_points;
+   return NULL;
+#endif
+}
+
+/* Publishes a filled in table. Must be called with arc_table_mutex held. */
+static void store_arc_table(int kind, int num_points, float *xy)
+{
+#if defined(__ATOMIC_RELEASE)
+   __atomic_store_n(&arc_tables[kind][num_points], xy, __ATOMIC_RELEASE);
+#elif defined(_MSC_VER)
+   _InterlockedExchangePointer(
+      (void * volatile *)&arc_tables[kind][num_points], xy);
+#else
+   arc_tables[kind][num_points] = xy;
+#endif
+}
+
+/* Returns the cos and sin of num_points angles going from 0 to delta_theta
+ * in equal steps, or NULL if they are not kept. The tables are shared by
+ * all threads and never change once made, so only making one takes the
+ * lock.
+ */
+static const float *get_unit_arc(float delta_theta, int num_points)
+{
+   float *xy;
+   int kind, ii;
+
+   if (!arc_tables_ready || num_points > MAX_ARC_TABLE_POINTS)
+      return NULL;
+
+   if (delta_theta == (float)(ALLEGRO_PI * 2))
+      kind = ARC_TABLE_TURN;
+   else if (delta_theta == (float)(ALLEGRO_PI / 2))
+      kind = ARC_TABLE_QUARTER;
+   else
+      return NULL;
+
+   xy = load_arc_table(kind, num_points);
+   if (xy)
+      return xy;
+
+   _al_mutex_lock(&arc_table_mutex);
+   /* Another thread may have made it in the meantime. */
+   xy = arc_tables[kind][num_points];
+   if (!xy) {
+      xy = al_malloc(2 * num_points * sizeof(float));
+      if (xy) {
+         for (ii = 0; ii < num_points; ii++) {
+            double theta = (double)delta_theta * ii / (num_points - 1);
+            xy[2 * ii] = cos(theta);
+            xy[2 * ii + 1] = sin(theta);
+         }
+         store_arc_table(kind, num_points, xy);
+      }
+   }
+   _al_mutex_unlock(&arc_table_mutex);
+
+   return xy;
+}
+
+#ifdef _AL_HAVE_SSE2
+
+/* Places pairs of points at a time, see place_arc. Returns how many were
+ * done.
+ */
+static int place_arc_sse2(float* dest, int stride, const float* xy,
+   int num_points, const float m[6])
+{
+   const __m128 a = _mm_setr_ps(m[0], m[3], m[0], m[3]);
+   const __m128 b = _mm_setr_ps(m[1], m[2], m[1], m[2]);
+   const __m128 c = _mm_setr_ps(m[4], m[5], m[4], m[5]);
+   int ii;
+
+   for (ii = 0; ii + 2 <= num_points; ii += 2) {
+      const __m128 p = _mm_loadu_ps(xy + 2 * ii);
+      const __m128 q = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 3, 0, 1));
+      const __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(p, a),
+         _mm_mul_ps(q, b)), c);
+      _mm_storel_pi((__m64 *)dest, r);
+      dest = (float*)(((char*)dest) + stride);
+      _mm_storeh_pi((__m64 *)dest, r);
+      dest = (float*)(((char*)dest) + stride);
+   }
+
+   return ii;
+}
+
+#endif
+
+/* Writes the unit arc points in xy, rotated by the angle with cosine c and
+ * sine s, scaled by sx and sy and moved to (cx, cy), to dest.
+ */
+static void place_arc(float* dest, int stride, const float* xy,
+   int num_points, float c, float s, float sx, float sy, float cx, float cy)
+{
+   const float m[6] = {sx * c, -sx * s, sy * s, sy * c, cx, cy};
+   int ii = 0;
+
+#ifdef _AL_HAVE_SSE2
+   ii = place_arc_sse2(dest, stride, xy, num_points, m);
+   dest = (float*)(((char*)dest) + ii * stride);
+#endif
+
+   for (; ii < num_points; ii++) {
+      const float x = xy[2 * ii];
+      const float y = xy[2 * ii + 1];
+      *dest =       x * m[0] + y * m[1] + m[4];
+      *(dest + 1) = x * m[2] + y * m[3] + m[5];
+      dest = (float*)(((char*)dest) + stride);
+   }
+}
+
 /* Function: al_draw_line
  */
 void al_draw_line(float x1, float y1, float x2, float y2,
@@ -418,51 +629,30 @@ void al_draw_filled_rectangle(float x1, float y1, float x2, float y2,
    al_draw_prim(vtx, 0, 0, 0, 4, ALLEGRO_PRIM_TRIANGLE_FAN);
 }
 
-/* Function: al_calculate_arc
+/* Writes num_points points of an arc to dest, see al_calculate_arc, from
+ * the unit arc points in xy rotated by the angle with cosine c and sine s.
  */
-void al_calculate_arc(float* dest, int stride, float cx, float cy,
-   float rx, float ry, float start_theta, float delta_theta, float thickness,
-   int num_points)
-{   
-   float theta;
-   float c;
-   float s;
-   float x, y, t;
+static void place_arc_points(float* dest, int stride, const float* xy,
+   int num_points, float c, float s, float cx, float cy, float rx, float ry,
+   float thickness)
+{
    int ii;
- 
-   ASSERT(dest);
-   ASSERT(num_points > 1);
-   ASSERT(rx >= 0);
-   ASSERT(ry >= 0);
 
    if (thickness > 0.0f) {
-      theta = delta_theta / ((float)(num_points) - 1);
-      c = cosf(theta);
-      s = sinf(theta);
-      x = cosf(start_theta);
-      y = sinf(start_theta);
- 
       if (rx == ry) {
          /*
          The circle case is particularly simple
          */
          float r1 = rx - thickness / 2.0f;
          float r2 = rx + thickness / 2.0f;
-         for (ii = 0; ii < num_points; ii ++) {
-            *dest =       r2 * x + cx;
-            *(dest + 1) = r2 * y + cy;
-            dest = (float*)(((char*)dest) + stride);
-            *dest =        r1 * x + cx;
-            *(dest + 1) =  r1 * y + cy;
-            dest = (float*)(((char*)dest) + stride);
-            
-            t = x;
-            x = c * x - s * y;
-            y = s * t + c * y;
-         }
+         place_arc(dest, 2 * stride, xy, num_points, c, s, r2, r2, cx, cy);
+         place_arc((float*)(((char*)dest) + stride), 2 * stride, xy,
+            num_points, c, s, r1, r1, cx, cy);
       } else {
          if (rx != 0 && !ry == 0) {
             for (ii = 0; ii < num_points; ii++) {
+               float x = c * xy[2 * ii] - s * xy[2 * ii + 1];
+               float y = s * xy[2 * ii] + c * xy[2 * ii + 1];
                float denom = hypotf(ry * x, rx * y);
                float nx = thickness / 2 * ry * x / denom;
                float ny = thickness / 2 * rx * y / denom;
@@ -473,29 +663,69 @@ void al_calculate_arc(float* dest, int stride, float cx, float cy,
                *dest =       rx * x + cx - nx;
                *(dest + 1) = ry * y + cy - ny;
                dest = (float*)(((char*)dest) + stride);
-
-               t = x;
-               x = c * x - s * y;
-               y = s * t + c * y;
             }
          }
       }
    } else {
-      theta = delta_theta / ((float)num_points - 1);
-      c = cosf(theta);
-      s = sinf(theta);
-      x = cosf(start_theta);
-      y = sinf(start_theta);
-      
-      for (ii = 0; ii < num_points; ii++) {
-         *dest =       rx * x + cx;
-         *(dest + 1) = ry * y + cy;
-         dest = (float*)(((char*)dest) + stride);
+      place_arc(dest, stride, xy, num_points, c, s, rx, ry, cx, cy);
+   }
+}
+
+/* Function: al_calculate_arc
+ */
+void al_calculate_arc(float* dest, int stride, float cx, float cy,
+   float rx, float ry, float start_theta, float delta_theta, float thickness,
+   int num_points)
+{   
+   float unit[2 * ALLEGRO_VERTEX_CACHE_SIZE];
+   const float* xy;
+   float theta, dc, ds, x, y, t;
+   int done, n, ii;
+ 
+   ASSERT(dest);
+   ASSERT(num_points > 1);
+   ASSERT(rx >= 0);
+   ASSERT(ry >= 0);
+
+   xy = get_unit_arc(delta_theta, num_points);
+   if (xy) {
+      float c = 1;
+      float s = 0;
+      if (start_theta != 0) {
+         c = cosf(start_theta);
+         s = sinf(start_theta);
+      }
+      place_arc_points(dest, stride, xy, num_points, c, s, cx, cy, rx, ry,
+         thickness);
+      return;
+   }
+
+   /* Other arcs step around by rotating the previous point, a chunk of
+    * points at a time.
+    */
+   theta = delta_theta / ((float)(num_points) - 1);
+   dc = cosf(theta);
+   ds = sinf(theta);
+   x = cosf(start_theta);
+   y = sinf(start_theta);
+
+   for (done = 0; done < num_points; done += n) {
+      n = num_points - done;
+      if (n > ALLEGRO_VERTEX_CACHE_SIZE)
+         n = ALLEGRO_VERTEX_CACHE_SIZE;
+
+      for (ii = 0; ii < n; ii++) {
+         unit[2 * ii] = x;
+         unit[2 * ii + 1] = y;
 
          t = x;
-         x = c * x - s * y;
-         y = s * t + c * y;
+         x = dc * x - ds * y;
+         y = ds * t + dc * y;
       }
+
+      place_arc_points(dest, stride, unit, n, 1, 0, cx, cy, rx, ry,
+         thickness);
+      dest = (float*)(((char*)dest) + n * stride * (thickness > 0.0f ? 2 : 1));
    }
 }
 
@@ -517,7 +747,7 @@ void al_draw_pieslice(float cx, float cy, float r, float start_theta,
    }
    
    if (thickness <= 0) {
-      num_segments = fabs(delta_theta / (2 * ALLEGRO_PI) * ALLEGRO_PRIM_QUALITY * scale * sqrtf(r));
+      num_segments = fabs(delta_theta / (2 * ALLEGRO_PI) * segments_per_turn(scale, r));
 
       if (num_segments < 2)
          num_segments = 2;
@@ -563,7 +793,7 @@ void al_draw_pieslice(float cx, float cy, float r, float start_theta,
          vertex_cache[0].x = cx + (r - thickness / 2) * cosf(central_start_angle);
          vertex_cache[0].y = cy + (r - thickness / 2) * sinf(central_start_angle);
          
-         num_segments = (inner_side_angle + outer_side_angle) / (2 * ALLEGRO_PI) * ALLEGRO_PRIM_QUALITY * scale * sqrtf(r + ht);
+         num_segments = (inner_side_angle + outer_side_angle) / (2 * ALLEGRO_PI) * segments_per_turn(scale, r + ht);
          
          if (num_segments < 2)
             num_segments = 2;
@@ -617,7 +847,7 @@ void al_draw_pieslice(float cx, float cy, float r, float start_theta,
          /* Apex: 2 vertices if the apex is blunt) */
          int extra_vtx = blunt_tip ? 2 : 1;
          
-         num_segments = (2 * outer_side_angle) / (2 * ALLEGRO_PI) * ALLEGRO_PRIM_QUALITY * scale * sqrtf(r + ht);
+         num_segments = (2 * outer_side_angle) / (2 * ALLEGRO_PI) * segments_per_turn(scale, r + ht);
          
          if (num_segments < 2)
             num_segments = 2;
@@ -666,7 +896,7 @@ void al_draw_filled_pieslice(float cx, float cy, float r, float start_theta,
    
    ASSERT(r >= 0);
    
-   num_segments = fabs(delta_theta / (2 * ALLEGRO_PI) * ALLEGRO_PRIM_QUALITY * scale * sqrtf(r));
+   num_segments = fabs(delta_theta / (2 * ALLEGRO_PI) * segments_per_turn(scale, r));
 
    if (num_segments < 2)
       num_segments = 2;
@@ -698,7 +928,7 @@ void al_draw_ellipse(float cx, float cy, float rx, float ry,
    ASSERT(ry >= 0);
 
    if (thickness > 0) {
-      int num_segments = ALLEGRO_PRIM_QUALITY * scale * sqrtf((rx + ry) / 2.0f);
+      int num_segments = segments_per_turn(scale, (rx + ry) / 2.0f);
       int ii;
 
       /* In case rx and ry are both 0. */
@@ -717,7 +947,7 @@ void al_draw_ellipse(float cx, float cy, float rx, float ry,
          
       al_draw_prim(vertex_cache, 0, 0, 0, 2 * num_segments, ALLEGRO_PRIM_TRIANGLE_STRIP);
    } else {
-      int num_segments = ALLEGRO_PRIM_QUALITY * scale * sqrtf((rx + ry) / 2.0f);
+      int num_segments = segments_per_turn(scale, (rx + ry) / 2.0f);
       int ii;
       
       /* In case rx and ry are both 0. */
@@ -750,7 +980,7 @@ void al_draw_filled_ellipse(float cx, float cy, float rx, float ry,
    ASSERT(rx >= 0);
    ASSERT(ry >= 0);
    
-   num_segments = ALLEGRO_PRIM_QUALITY * scale * sqrtf((rx + ry) / 2.0f);
+   num_segments = segments_per_turn(scale, (rx + ry) / 2.0f);
 
    /* In case rx and ry are both close to 0. If al_calculate_arc is passed
     * 0 or 1 it will assert.
@@ -798,7 +1028,7 @@ void al_draw_elliptical_arc(float cx, float cy, float rx, float ry, float start_
 
    ASSERT(rx >= 0 && ry >= 0);
    if (thickness > 0) {
-      int num_segments = fabs(delta_theta / (2 * ALLEGRO_PI) * ALLEGRO_PRIM_QUALITY * scale * sqrtf((rx + ry) / 2.0f));
+      int num_segments = fabs(delta_theta / (2 * ALLEGRO_PI) * segments_per_turn(scale, (rx + ry) / 2.0f));
       int ii;
 
       if (num_segments < 2)
@@ -817,7 +1047,7 @@ void al_draw_elliptical_arc(float cx, float cy, float rx, float ry, float start_
       
       al_draw_prim(vertex_cache, 0, 0, 0, 2 * num_segments, ALLEGRO_PRIM_TRIANGLE_STRIP);
    } else {
-      int num_segments = fabs(delta_theta / (2 * ALLEGRO_PI) * ALLEGRO_PRIM_QUALITY * scale * sqrtf((rx + ry) / 2.0f));
+      int num_segments = fabs(delta_theta / (2 * ALLEGRO_PI) * segments_per_turn(scale, (rx + ry) / 2.0f));
       int ii;
 
       if (num_segments < 2)
@@ -858,7 +1088,7 @@ void al_draw_rounded_rectangle(float x1, float y1, float x2, float y2,
    ASSERT(ry >= 0);
 
    if (thickness > 0) {
-      int num_segments = ALLEGRO_PRIM_QUALITY * scale * sqrtf((rx + ry) / 2.0f) / 4;
+      int num_segments = segments_per_turn(scale, (rx + ry) / 2.0f) / 4;
       int ii;
 
       /* In case rx and ry are both 0. */
@@ -905,7 +1135,7 @@ void al_draw_rounded_rectangle(float x1, float y1, float x2, float y2,
          
       al_draw_prim(vertex_cache, 0, 0, 0, 8 * num_segments + 2, ALLEGRO_PRIM_TRIANGLE_STRIP);
    } else {
-      int num_segments = ALLEGRO_PRIM_QUALITY * scale * sqrtf((rx + ry) / 2.0f) / 4;
+      int num_segments = segments_per_turn(scale, (rx + ry) / 2.0f) / 4;
       int ii;
       
       /* In case rx and ry are both 0. */
@@ -952,7 +1182,7 @@ void al_draw_filled_rounded_rectangle(float x1, float y1, float x2, float y2,
    LOCAL_VERTEX_CACHE;
    int ii;
    float scale = get_scale();
-   int num_segments = ALLEGRO_PRIM_QUALITY * scale * sqrtf((rx + ry) / 2.0f) / 4;
+   int num_segments = segments_per_turn(scale, (rx + ry) / 2.0f) / 4;
 
    ASSERT(rx >= 0);
    ASSERT(ry >= 0);
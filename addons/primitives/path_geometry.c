@@ -0,0 +1,465 @@
+/*         ______   ___    ___
+ *        /\  _  \ /\_ \  /\_ \
+ *        \ \ \L\ \\//\ \ \//\ \      __     __   _ __   ___
+ *         \ \  __ \ \ \ \  \ \ \   /'__`\ /'_ `\/\`'__\/ __`\
+ *          \ \ \/\ \ \_\ \_ \_\ \_/\  __//\ \L\ \ \ \//\ \L\ \
+ *           \ \_\ \_\/\____\/\____\ \____\ \____ \ \_\\ \____/
+ *            \/_/\/_/\/____/\/____/\/____/\/___L\ \/_/ \/___/
+ *                                           /\____/
+ *                                           \_/__/
+ *
+ *      Retained path geometry.
+ *
+ *      A path geometry keeps the vertices (and indices) of a polyline,
+ *      polygon, ribbon, spline or arc, so that drawing it again does not
+ *      tessellate it again. The shape is only tessellated when it is
+ *      drawn after its parameters changed.
+ *
+ *      See readme.txt for copyright information.
+ */
+
+#include "allegro5/allegro.h"
+#include "allegro5/allegro_primitives.h"
+#include "allegro5/internal/aintern.h"
+#include "allegro5/internal/aintern_prim.h"
+#include <string.h>
+
+ALLEGRO_DEBUG_CHANNEL("primitives")
+
+enum {
+   PATH_NONE,
+   PATH_POLYLINE,
+   PATH_FILLED_POLYGON,
+   PATH_RIBBON,
+   PATH_SPLINE,
+   PATH_ARC
+};
+
+#define NUM_PARAMS  8
+
+struct ALLEGRO_PATH_GEOMETRY {
+   /* ALLEGRO_PRIM_BUFFER_FLAGS of the vertex buffer, or 0 for none. */
+   int flags;
+
+   /* The shape, kept to tell whether a setter changes it. */
+   int shape;
+   _AL_VECTOR points;   /* pairs of floats */
+   _AL_VECTOR counts;   /* ints, with the terminating 0 */
+   float params[NUM_PARAMS];
+   bool dirty;
+
+   /* The tessellated shape. */
+   int type;
+   _AL_VECTOR vtxs;     /* ALLEGRO_VERTEX */
+   _AL_VECTOR indices;  /* ints */
+   ALLEGRO_COLOR color;
+   ALLEGRO_VERTEX_BUFFER *vertex_buffer;
+   ALLEGRO_INDEX_BUFFER *index_buffer;
+};
+
+
+static const float *point(const float *points, int stride, int i)
+{
+   return (const float *)((const char *)points + stride * i);
+}
+
+
+static void destroy_buffers(ALLEGRO_PATH_GEOMETRY *geometry)
+{
+   if (geometry->vertex_buffer) {
+      al_destroy_vertex_buffer(geometry->vertex_buffer);
+      geometry->vertex_buffer = NULL;
+   }
+   if (geometry->index_buffer) {
+      al_destroy_index_buffer(geometry->index_buffer);
+      geometry->index_buffer = NULL;
+   }
+}
+
+
+/* Remembers the shape, and marks the geometry to be tessellated again if it
+ * differs from the one it has.
+ */
+static void set_shape(ALLEGRO_PATH_GEOMETRY *geometry, int shape,
+   const float *points, int stride, int num_points, const int *counts,
+   const float params[NUM_PARAMS])
+{
+   int num_counts = 0;
+   int i;
+
+   if (counts) {
+      while (counts[num_counts])
+         num_counts++;
+      num_counts++;
+   }
+
+   if (shape == geometry->shape &&
+         num_points == (int)_al_vector_size(&geometry->points) &&
+         num_counts == (int)_al_vector_size(&geometry->counts) &&
+         memcmp(params, geometry->params, sizeof(geometry->params)) == 0 &&
+         (num_counts == 0 || memcmp(counts, _al_vector_ref_front(&geometry->counts),
+            num_counts * sizeof(int)) == 0)) {
+      for (i = 0; i < num_points; i++) {
+         const float *p = point(points, stride, i);
+         const float *q = _al_vector_ref(&geometry->points, i);
+         if (p[0] != q[0] || p[1] != q[1])
+            break;
+      }
+      if (i == num_points)
+         return;
+   }
+
+   geometry->shape = shape;
+   _al_vector_free(&geometry->points);
+   for (i = 0; i < num_points; i++)
+      _al_vector_append_array(&geometry->points, 1, point(points, stride, i));
+   _al_vector_free(&geometry->counts);
+   if (num_counts > 0)
+      _al_vector_append_array(&geometry->counts, num_counts, counts);
+   memcpy(geometry->params, params, sizeof(geometry->params));
+   geometry->dirty = true;
+}
+
+
+static void push_triangle(int i0, int i1, int i2, void *user_data)
+{
+   ALLEGRO_PATH_GEOMETRY *geometry = user_data;
+   int *idx = _al_vector_alloc_back(&geometry->indices);
+   if (idx) idx[0] = i0;
+   idx = _al_vector_alloc_back(&geometry->indices);
+   if (idx) idx[0] = i1;
+   idx = _al_vector_alloc_back(&geometry->indices);
+   if (idx) idx[0] = i2;
+}
+
+
+/* Makes room for n vertices computed by one of the al_calculate_*
+ * functions.
+ */
+static ALLEGRO_VERTEX *alloc_vertices(ALLEGRO_PATH_GEOMETRY *geometry, int n)
+{
+   int i;
+
+   for (i = 0; i < n; i++) {
+      ALLEGRO_VERTEX *v = _al_vector_alloc_back(&geometry->vtxs);
+      if (!v) {
+         _al_vector_free(&geometry->vtxs);
+         return NULL;
+      }
+      memset(v, 0, sizeof(*v));
+   }
+   return _al_vector_ref_front(&geometry->vtxs);
+}
+
+
+static void tessellate(ALLEGRO_PATH_GEOMETRY *geometry)
+{
+   const float *points = _al_vector_size(&geometry->points) ?
+      _al_vector_ref_front(&geometry->points) : NULL;
+   const int num_points = _al_vector_size(&geometry->points);
+   const float *params = geometry->params;
+   ALLEGRO_VERTEX *v;
+   int n, i;
+
+   destroy_buffers(geometry);
+   _al_vector_free(&geometry->vtxs);
+   _al_vector_free(&geometry->indices);
+   geometry->dirty = false;
+
+   switch (geometry->shape) {
+      case PATH_POLYLINE:
+         geometry->type = _al_tessellate_polyline(&geometry->vtxs, points,
+            2 * sizeof(float), num_points, (int)params[0], (int)params[1],
+            params[2], params[3]);
+         break;
+
+      case PATH_FILLED_POLYGON:
+         geometry->type = ALLEGRO_PRIM_TRIANGLE_LIST;
+         v = alloc_vertices(geometry, num_points);
+         if (!v)
+            break;
+         for (i = 0; i < num_points; i++) {
+            v[i].x = points[2 * i];
+            v[i].y = points[2 * i + 1];
+         }
+         al_triangulate_polygon(points, 2 * sizeof(float),
+            _al_vector_ref_front(&geometry->counts), push_triangle, geometry);
+         break;
+
+      case PATH_RIBBON:
+         n = params[0] > 0 ? 2 * num_points : num_points;
+         geometry->type = params[0] > 0 ? ALLEGRO_PRIM_TRIANGLE_STRIP :
+            ALLEGRO_PRIM_LINE_STRIP;
+         v = alloc_vertices(geometry, n);
+         if (v) {
+            al_calculate_ribbon(&v[0].x, sizeof(ALLEGRO_VERTEX), points,
+               2 * sizeof(float), params[0], num_points);
+         }
+         break;
+
+      case PATH_SPLINE:
+         n = (int)params[1];
+         geometry->type = params[0] > 0 ? ALLEGRO_PRIM_TRIANGLE_STRIP :
+            ALLEGRO_PRIM_LINE_STRIP;
+         v = alloc_vertices(geometry, params[0] > 0 ? 2 * n : n);
+         if (v) {
+            float control[8];
+            memcpy(control, points, sizeof(control));
+            al_calculate_spline(&v[0].x, sizeof(ALLEGRO_VERTEX), control,
+               params[0], n);
+         }
+         break;
+
+      case PATH_ARC:
+         n = (int)params[7];
+         geometry->type = params[6] > 0 ? ALLEGRO_PRIM_TRIANGLE_STRIP :
+            ALLEGRO_PRIM_LINE_STRIP;
+         v = alloc_vertices(geometry, params[6] > 0 ? 2 * n : n);
+         if (v) {
+            al_calculate_arc(&v[0].x, sizeof(ALLEGRO_VERTEX), params[0],
+               params[1], params[2], params[3], params[4], params[5],
+               params[6], n);
+         }
+         break;
+   }
+
+   n = _al_vector_size(&geometry->vtxs);
+   for (i = 0; i < n; i++) {
+      v = _al_vector_ref(&geometry->vtxs, i);
+      v->z = 0;
+      v->color = geometry->color;
+   }
+
+   if (geometry->flags && n > 0 && al_get_current_display()) {
+      const int num_indices = _al_vector_size(&geometry->indices);
+      geometry->vertex_buffer = al_create_vertex_buffer(NULL,
+         _al_vector_ref_front(&geometry->vtxs), n, geometry->flags);
+      if (geometry->vertex_buffer && num_indices > 0) {
+         geometry->index_buffer = al_create_index_buffer(sizeof(int),
+            _al_vector_ref_front(&geometry->indices), num_indices,
+            geometry->flags);
+         if (!geometry->index_buffer)
+            destroy_buffers(geometry);
+      }
+      if (!geometry->vertex_buffer)
+         ALLEGRO_WARN("Drawing the path geometry without a vertex buffer.\n");
+   }
+}
+
+
+static void set_color(ALLEGRO_PATH_GEOMETRY *geometry, ALLEGRO_COLOR color)
+{
+   const int n = _al_vector_size(&geometry->vtxs);
+   int i;
+
+   geometry->color = color;
+   for (i = 0; i < n; i++) {
+      ALLEGRO_VERTEX *v = _al_vector_ref(&geometry->vtxs, i);
+      v->color = color;
+   }
+
+   if (geometry->vertex_buffer) {
+      ALLEGRO_VERTEX *dest = al_lock_vertex_buffer(geometry->vertex_buffer,
+         0, n, ALLEGRO_LOCK_WRITEONLY);
+      if (dest) {
+         memcpy(dest, _al_vector_ref_front(&geometry->vtxs),
+            n * sizeof(ALLEGRO_VERTEX));
+         al_unlock_vertex_buffer(geometry->vertex_buffer);
+      }
+      else {
+         destroy_buffers(geometry);
+      }
+   }
+}
+
+
+/* Function: al_create_path_geometry
+ */
+ALLEGRO_PATH_GEOMETRY *al_create_path_geometry(int flags)
+{
+   ALLEGRO_PATH_GEOMETRY *geometry = al_calloc(1, sizeof(*geometry));
+   if (!geometry)
+      return NULL;
+
+   geometry->flags = flags;
+   geometry->shape = PATH_NONE;
+   _al_vector_init(&geometry->points, 2 * sizeof(float));
+   _al_vector_init(&geometry->counts, sizeof(int));
+   _al_vector_init(&geometry->vtxs, sizeof(ALLEGRO_VERTEX));
+   _al_vector_init(&geometry->indices, sizeof(int));
+   geometry->color = al_map_rgb_f(1, 1, 1);
+   return geometry;
+}
+
+
+/* Function: al_destroy_path_geometry
+ */
+void al_destroy_path_geometry(ALLEGRO_PATH_GEOMETRY *geometry)
+{
+   if (!geometry)
+      return;
+
+   destroy_buffers(geometry);
+   _al_vector_free(&geometry->points);
+   _al_vector_free(&geometry->counts);
+   _al_vector_free(&geometry->vtxs);
+   _al_vector_free(&geometry->indices);
+   al_free(geometry);
+}
+
+
+/* Function: al_set_path_geometry_polyline
+ */
+void al_set_path_geometry_polyline(ALLEGRO_PATH_GEOMETRY *geometry,
+   const float *vertices, int vertex_stride, int vertex_count,
+   int join_style, int cap_style, float thickness, float miter_limit)
+{
+   float params[NUM_PARAMS] = {0};
+   ASSERT(geometry);
+   ASSERT(vertices || vertex_count == 0);
+
+   params[0] = join_style;
+   params[1] = cap_style;
+   params[2] = thickness;
+   params[3] = miter_limit;
+   set_shape(geometry, PATH_POLYLINE, vertices, vertex_stride, vertex_count,
+      NULL, params);
+}
+
+
+/* Function: al_set_path_geometry_filled_polygon
+ */
+void al_set_path_geometry_filled_polygon(ALLEGRO_PATH_GEOMETRY *geometry,
+   const float *vertices, int vertex_count)
+{
+   int vertex_counts[2];
+
+   vertex_counts[0] = vertex_count;
+   vertex_counts[1] = 0; /* terminator */
+   al_set_path_geometry_filled_polygon_with_holes(geometry, vertices,
+      vertex_counts);
+}
+
+
+/* Function: al_set_path_geometry_filled_polygon_with_holes
+ */
+void al_set_path_geometry_filled_polygon_with_holes(
+   ALLEGRO_PATH_GEOMETRY *geometry, const float *vertices,
+   const int *vertex_counts)
+{
+   float params[NUM_PARAMS] = {0};
+   int num_points = 0;
+   int i;
+   ASSERT(geometry);
+   ASSERT(vertex_counts);
+
+   for (i = 0; vertex_counts[i]; i++)
+      num_points += vertex_counts[i];
+
+   set_shape(geometry, PATH_FILLED_POLYGON, vertices, 2 * sizeof(float),
+      num_points, vertex_counts, params);
+}
+
+
+/* Function: al_set_path_geometry_ribbon
+ */
+void al_set_path_geometry_ribbon(ALLEGRO_PATH_GEOMETRY *geometry,
+   const float *points, int points_stride, float thickness, int num_segments)
+{
+   float params[NUM_PARAMS] = {0};
+   ASSERT(geometry);
+   ASSERT(num_segments >= 2);
+
+   params[0] = thickness;
+   set_shape(geometry, PATH_RIBBON, points, points_stride, num_segments,
+      NULL, params);
+}
+
+
+/* Function: al_set_path_geometry_spline
+ */
+void al_set_path_geometry_spline(ALLEGRO_PATH_GEOMETRY *geometry,
+   float points[8], float thickness, int num_segments)
+{
+   float params[NUM_PARAMS] = {0};
+   ASSERT(geometry);
+   ASSERT(num_segments >= 2);
+
+   params[0] = thickness;
+   params[1] = num_segments;
+   set_shape(geometry, PATH_SPLINE, points, 2 * sizeof(float), 4, NULL,
+      params);
+}
+
+
+/* Function: al_set_path_geometry_arc
+ */
+void al_set_path_geometry_arc(ALLEGRO_PATH_GEOMETRY *geometry,
+   float cx, float cy, float rx, float ry, float start_theta,
+   float delta_theta, float thickness, int num_segments)
+{
+   float params[NUM_PARAMS];
+   ASSERT(geometry);
+   ASSERT(num_segments >= 2);
+
+   params[0] = cx;
+   params[1] = cy;
+   params[2] = rx;
+   params[3] = ry;
+   params[4] = start_theta;
+   params[5] = delta_theta;
+   params[6] = thickness;
+   params[7] = num_segments;
+   set_shape(geometry, PATH_ARC, NULL, 0, 0, NULL, params);
+}
+
+
+/* Function: al_draw_path_geometry
+ */
+void al_draw_path_geometry(ALLEGRO_PATH_GEOMETRY *geometry,
+   ALLEGRO_COLOR color)
+{
+   ALLEGRO_BITMAP *target = al_get_target_bitmap();
+   int num_vtxs, num_indices;
+   ASSERT(geometry);
+
+   if (geometry->dirty) {
+      geometry->color = color;
+      tessellate(geometry);
+   }
+   else if (memcmp(&color, &geometry->color, sizeof(color)) != 0) {
+      set_color(geometry, color);
+   }
+
+   num_vtxs = _al_vector_size(&geometry->vtxs);
+   num_indices = _al_vector_size(&geometry->indices);
+   if (num_vtxs == 0 || !target)
+      return;
+
+   /* Memory bitmaps are drawn from the vertices in memory, which saves
+    * reading the buffer back.
+    */
+   if (geometry->vertex_buffer &&
+         !(al_get_bitmap_flags(target) & ALLEGRO_MEMORY_BITMAP)) {
+      if (geometry->index_buffer) {
+         al_draw_indexed_buffer(geometry->vertex_buffer, NULL,
+            geometry->index_buffer, 0, num_indices, geometry->type);
+      }
+      else {
+         al_draw_vertex_buffer(geometry->vertex_buffer, NULL, 0, num_vtxs,
+            geometry->type);
+      }
+   }
+   else if (num_indices > 0) {
+      al_draw_indexed_prim(_al_vector_ref_front(&geometry->vtxs), NULL, NULL,
+         _al_vector_ref_front(&geometry->indices), num_indices,
+         geometry->type);
+   }
+   else if (geometry->shape != PATH_FILLED_POLYGON) {
+      al_draw_prim(_al_vector_ref_front(&geometry->vtxs), NULL, NULL, 0,
+         num_vtxs, geometry->type);
+   }
+}
+
+
+/* vim: set sts=3 sw=3 et: */
@@ -21,11 +21,16 @@
 
 #include "allegro5/allegro.h"
 #include "allegro5/allegro_primitives.h"
+#include "allegro5/internal/aintern.h"
+#include "allegro5/internal/aintern_bitmap.h"
 #include "allegro5/internal/aintern_blend.h"
 #include "allegro5/internal/aintern_prim.h"
 #include "allegro5/internal/aintern_prim_soft.h"
 #include <math.h>
 
+/* How many texels are looked up before their points are drawn. */
+#define POINT_CHUNK  64
+
 static int fix_var(float var, int max_var)
 {
    const int ivar = (int)floorf(var);
@@ -36,52 +41,44 @@ static int fix_var(float var, int max_var)
       return ret + max_var;
 }
 
-void _al_point_2d(ALLEGRO_BITMAP* texture, ALLEGRO_VERTEX* v)
+/* Draws the points in the already transformed vertices to the target. */
+void _al_points_2d(ALLEGRO_BITMAP* texture, ALLEGRO_VERTEX* vtx, int n)
 {
+   ALLEGRO_BITMAP *target = al_get_target_bitmap();
    int shade = 1;
-   int op, src_mode, dst_mode, op_alpha, src_alpha, dst_alpha;
-   ALLEGRO_COLOR vc;
-   int clip_min_x, clip_min_y, clip_max_x, clip_max_y;
-   int x = (int)floorf(v->x);
-   int y = (int)floorf(v->x);
-   
-   al_get_clipping_rectangle(&clip_min_x, &clip_min_y, &clip_max_x, &clip_max_y);
-   clip_max_x += clip_min_x;
-   clip_max_y += clip_min_y;
-   
-   if(x < clip_min_x || x >= clip_max_x || y < clip_min_y || y >= clip_max_y)
-      return;
-
-   vc = v->color;
+   int ii, jj;
 
-   al_get_separate_blender(&op, &src_mode, &dst_mode, &op_alpha, &src_alpha, &dst_alpha);
-   if (_AL_DEST_IS_ZERO && _AL_SRC_NOT_MODIFIED) {
+   if (_al_get_compiled_blender()->flags & _AL_BLEND_COPY) {
       shade = 0;
    }
-   
-   if (texture) {
-      float U = fix_var(v->u, al_get_bitmap_width(texture));
-      float V = fix_var(v->v, al_get_bitmap_height(texture));
-      ALLEGRO_COLOR color = al_get_pixel(texture, U, V);
 
-      if(vc.r != 1 || vc.g != 1 || vc.b != 1 || vc.a != 1) {
-         color.r *= vc.r;
-         color.g *= vc.g;
-         color.b *= vc.b;
-         color.a *= vc.a;
-      }
+   if (!texture) {
+      _al_put_pixels(target, &vtx->x, sizeof(*vtx), &vtx->color, sizeof(*vtx),
+         n, shade);
+      return;
+   }
 
-      if (shade) {
-         al_put_blended_pixel(v->x, v->y, color);
-      } else {
-         al_put_pixel(v->x, v->y, color);
-      }
-   } else {
-      ALLEGRO_COLOR color = al_map_rgba_f(vc.r, vc.g, vc.b, vc.a);
-      if (shade) {
-         al_put_blended_pixel(v->x, v->y, color);
-      } else {
-         al_put_pixel(v->x, v->y, color);
+   for (ii = 0; ii < n; ii += POINT_CHUNK) {
+      ALLEGRO_COLOR colors[POINT_CHUNK];
+      const int m = _ALLEGRO_MIN(n - ii, POINT_CHUNK);
+
+      for (jj = 0; jj < m; jj++) {
+         ALLEGRO_VERTEX *v = &vtx[ii + jj];
+         ALLEGRO_COLOR vc = v->color;
+         float U = fix_var(v->u, al_get_bitmap_width(texture));
+         float V = fix_var(v->v, al_get_bitmap_height(texture));
+         ALLEGRO_COLOR color = al_get_pixel(texture, U, V);
+
+         if(vc.r != 1 || vc.g != 1 || vc.b != 1 || vc.a != 1) {
+            color.r *= vc.r;
+            color.g *= vc.g;
+            color.b *= vc.b;
+            color.a *= vc.a;
+         }
+         colors[jj] = color;
       }
+
+      _al_put_pixels(target, &vtx[ii].x, sizeof(*vtx), colors, sizeof(*colors),
+         m, shade);
    }
 }
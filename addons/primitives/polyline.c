@@ -496,11 +496,12 @@ static void emit_polyline(ALLEGRO_PRIM_VERTEX_CACHE* cache, const float* vertice
 # undef VERTEX
 }
 
-static void do_draw_polyline(ALLEGRO_PRIM_VERTEX_CACHE* cache, const float* vertices, int vertex_stride, int vertex_count, int join_style, int cap_style, ALLEGRO_COLOR color, float thickness, float miter_limit)
+static void do_draw_polyline(ALLEGRO_PRIM_VERTEX_CACHE* cache, _AL_VECTOR* record, const float* vertices, int vertex_stride, int vertex_count, int join_style, int cap_style, ALLEGRO_COLOR color, float thickness, float miter_limit)
 {
    if (thickness > 0.0f)
    {
       _al_prim_cache_init(cache, ALLEGRO_PRIM_VERTEX_CACHE_TRIANGLE, color);
+      cache->record = record;
       emit_polyline(cache, vertices, vertex_stride, vertex_count, join_style, cap_style, thickness, miter_limit);
       _al_prim_cache_term(cache);
    }
@@ -511,6 +512,7 @@ static void do_draw_polyline(ALLEGRO_PRIM_VERTEX_CACHE* cache, const float* vert
       int i;
 
       _al_prim_cache_init(cache, ALLEGRO_PRIM_VERTEX_CACHE_LINE_STRIP, color);
+      cache->record = record;
 
       for (i = 0; i < vertex_count; ++i) {
          if (cache->size >= (ALLEGRO_VERTEX_CACHE_SIZE - 2))
@@ -539,7 +541,18 @@ void al_draw_polyline(const float* vertices, int vertex_stride,
    ALLEGRO_COLOR color, float thickness, float miter_limit)
 {
    ALLEGRO_PRIM_VERTEX_CACHE cache;
-   do_draw_polyline(&cache, vertices, vertex_stride, vertex_count, join_style, cap_style, color, thickness, miter_limit);
+   do_draw_polyline(&cache, NULL, vertices, vertex_stride, vertex_count, join_style, cap_style, color, thickness, miter_limit);
+}
+
+/* Internal function: _al_tessellate_polyline
+ *  Appends the white vertices al_draw_polyline would draw to dest, which
+ *  holds ALLEGRO_VERTEX. Returns the primitive type to draw them with.
+ */
+int _al_tessellate_polyline(_AL_VECTOR* dest, const float* vertices, int vertex_stride, int vertex_count, int join_style, int cap_style, float thickness, float miter_limit)
+{
+   ALLEGRO_PRIM_VERTEX_CACHE cache;
+   do_draw_polyline(&cache, dest, vertices, vertex_stride, vertex_count, join_style, cap_style, al_map_rgb_f(1, 1, 1), thickness, miter_limit);
+   return thickness > 0.0f ? ALLEGRO_PRIM_TRIANGLE_LIST : ALLEGRO_PRIM_LINE_STRIP;
 }
 
 /* vim: set sts=3 sw=3 et: */
@@ -0,0 +1,411 @@
+/*         ______   ___    ___
+ *        /\  _  \ /\_ \  /\_ \
+ *        \ \ \L\ \\//\ \ \//\ \      __     __   _ __   ___
+ *         \ \  __ \ \ \ \  \ \ \   /'__`\ /'_ `\/\`'__\/ __`\
+ *          \ \ \/\ \ \_\ \_ \_\ \_/\  __//\ \L\ \ \ \//\ \L\ \
+ *           \ \_\ \_\/\____\/\____\ \____\ \____ \ \_\\ \____/
+ *            \/_/\/_/\/____/\/____/\/____/\/___L\ \/_/ \/___/
+ *                                           /\____/
+ *                                           \_/__/
+ *
+ *      Held primitive drawing.
+ *
+ *      While primitive drawing is held, untextured primitives drawn with
+ *      the default vertex declaration are appended to one growing list of
+ *      points, lines or triangles. The list is drawn in one call when the
+ *      kind of primitive or the drawing state changes, when it gets full
+ *      and when the hold is released. Each thread holds its own, kept in
+ *      the thread local state of the core while it holds any.
+ *
+ *      See readme.txt for copyright information.
+ */
+
+#include "allegro5/allegro.h"
+#include "allegro5/allegro_primitives.h"
+#include "allegro5/internal/aintern.h"
+#include "allegro5/internal/aintern_bitmap.h"
+#include "allegro5/internal/aintern_prim.h"
+#include "allegro5/internal/aintern_tls.h"
+#include <string.h>
+
+ALLEGRO_DEBUG_CHANNEL("primitives")
+
+/* The most vertices held at once. */
+#define MAX_HELD_VERTICES  65536
+
+/* The state the held vertices are drawn with. */
+typedef struct BATCH_STATE {
+   ALLEGRO_BITMAP *target;
+   ALLEGRO_TRANSFORM transform;
+   ALLEGRO_TRANSFORM projection;
+   int clip[4];
+   int blender[6];
+   ALLEGRO_COLOR blend_color;
+} BATCH_STATE;
+
+typedef struct PRIM_BATCH {
+   /* ALLEGRO_PRIM_POINT_LIST, ALLEGRO_PRIM_LINE_LIST or
+    * ALLEGRO_PRIM_TRIANGLE_LIST.
+    */
+   int type;
+   ALLEGRO_VERTEX *vtxs;
+   int num_vtxs;
+   int max_vtxs;
+   BATCH_STATE state;
+   int flushes;
+} PRIM_BATCH;
+
+
+/* The primitives held by the calling thread, or NULL if it holds none. */
+static PRIM_BATCH *get_batch(void)
+{
+   return *_al_tls_get_held_primitives();
+}
+
+
+static void get_state(BATCH_STATE *state)
+{
+   ALLEGRO_BITMAP *target = al_get_target_bitmap();
+
+   /* The states are compared with memcmp. */
+   memset(state, 0, sizeof(*state));
+
+   state->target = target;
+   if (target) {
+      state->transform = *al_get_current_transform();
+      state->projection = *al_get_current_projection_transform();
+      al_get_clipping_rectangle(&state->clip[0], &state->clip[1],
+         &state->clip[2], &state->clip[3]);
+   }
+   al_get_separate_blender(&state->blender[0], &state->blender[1],
+      &state->blender[2], &state->blender[3], &state->blender[4],
+      &state->blender[5]);
+   state->blend_color = al_get_blend_color();
+}
+
+
+static void set_state(const BATCH_STATE *state)
+{
+   al_set_target_bitmap(state->target);
+   al_use_transform(&state->transform);
+   al_use_projection_transform(&state->projection);
+   al_set_clipping_rectangle(state->clip[0], state->clip[1],
+      state->clip[2], state->clip[3]);
+   al_set_separate_blender(state->blender[0], state->blender[1],
+      state->blender[2], state->blender[3], state->blender[4],
+      state->blender[5]);
+   al_set_blend_color(state->blend_color);
+}
+
+
+/* Draws the held vertices with the state they were added with, which may
+ * no longer be the current one.
+ */
+static void draw_batch(PRIM_BATCH *batch)
+{
+   BATCH_STATE current;
+   ALLEGRO_STATE stored;
+   BATCH_STATE target_state;
+   bool switch_state;
+   const int num_vtxs = batch->num_vtxs;
+
+   if (num_vtxs == 0)
+      return;
+
+   /* Setting the target below must not draw them again. */
+   batch->num_vtxs = 0;
+
+   get_state(&current);
+   switch_state = memcmp(&current, &batch->state, sizeof(current)) != 0;
+
+   if (switch_state) {
+      al_store_state(&stored, ALLEGRO_STATE_TARGET_BITMAP |
+         ALLEGRO_STATE_BLENDER | ALLEGRO_STATE_TRANSFORM |
+         ALLEGRO_STATE_PROJECTION_TRANSFORM);
+      /* Whatever was set on the held target since is put back below. */
+      al_set_target_bitmap(batch->state.target);
+      get_state(&target_state);
+      set_state(&batch->state);
+   }
+
+   _al_draw_prim_direct(batch->vtxs, NULL, NULL, 0, num_vtxs, batch->type);
+   batch->flushes++;
+
+   if (switch_state) {
+      set_state(&target_state);
+      al_restore_state(&stored);
+   }
+}
+
+
+static int list_type(int type)
+{
+   switch (type) {
+      case ALLEGRO_PRIM_LINE_LIST:
+      case ALLEGRO_PRIM_LINE_STRIP:
+      case ALLEGRO_PRIM_LINE_LOOP:
+         return ALLEGRO_PRIM_LINE_LIST;
+      case ALLEGRO_PRIM_TRIANGLE_LIST:
+      case ALLEGRO_PRIM_TRIANGLE_STRIP:
+      case ALLEGRO_PRIM_TRIANGLE_FAN:
+         return ALLEGRO_PRIM_TRIANGLE_LIST;
+      default:
+         return ALLEGRO_PRIM_POINT_LIST;
+   }
+}
+
+
+/* The number of vertices the list form of a primitive has. */
+static int list_size(int type, int n)
+{
+   switch (type) {
+      case ALLEGRO_PRIM_LINE_LIST:
+         return n - n % 2;
+      case ALLEGRO_PRIM_LINE_STRIP:
+         return n >= 2 ? 2 * (n - 1) : 0;
+      case ALLEGRO_PRIM_LINE_LOOP:
+         return n >= 2 ? 2 * n : 0;
+      case ALLEGRO_PRIM_TRIANGLE_LIST:
+         return n - n % 3;
+      case ALLEGRO_PRIM_TRIANGLE_STRIP:
+      case ALLEGRO_PRIM_TRIANGLE_FAN:
+         return n >= 3 ? 3 * (n - 2) : 0;
+      default:
+         return n;
+   }
+}
+
+
+/* Appends the list form of a primitive, with the vertices of each line and
+ * triangle in the order the software rasterizer takes them.
+ */
+static void append(PRIM_BATCH *batch, const ALLEGRO_VERTEX *vtxs,
+   const int *indices, int start, int end, int type)
+{
+   ALLEGRO_VERTEX *out = batch->vtxs + batch->num_vtxs;
+   int ii;
+
+#define VTX(i)  (vtxs[indices ? indices[i] : (i)])
+
+   switch (type) {
+      case ALLEGRO_PRIM_LINE_STRIP:
+         for (ii = start + 1; ii < end; ii++) {
+            *out++ = VTX(ii - 1);
+            *out++ = VTX(ii);
+         }
+         break;
+      case ALLEGRO_PRIM_LINE_LOOP:
+         for (ii = start + 1; ii < end; ii++) {
+            *out++ = VTX(ii - 1);
+            *out++ = VTX(ii);
+         }
+         *out++ = VTX(end - 1);
+         *out++ = VTX(start);
+         break;
+      case ALLEGRO_PRIM_TRIANGLE_STRIP:
+         for (ii = start + 2; ii < end; ii++) {
+            *out++ = VTX(ii - 2);
+            *out++ = VTX(ii - 1);
+            *out++ = VTX(ii);
+         }
+         break;
+      case ALLEGRO_PRIM_TRIANGLE_FAN:
+         for (ii = start + 2; ii < end; ii++) {
+            *out++ = VTX(start);
+            *out++ = VTX(ii);
+            *out++ = VTX(ii - 1);
+         }
+         break;
+      default:
+         if (indices) {
+            for (ii = start; ii < start + list_size(type, end - start); ii++)
+               *out++ = VTX(ii);
+         }
+         else {
+            const int n = list_size(type, end - start);
+            memcpy(out, vtxs + start, n * sizeof(ALLEGRO_VERTEX));
+            out += n;
+         }
+         break;
+   }
+
+#undef VTX
+
+   batch->num_vtxs = out - batch->vtxs;
+}
+
+
+static int num_primitives(int type, int n)
+{
+   switch (list_type(type)) {
+      case ALLEGRO_PRIM_LINE_LIST:
+         return n / 2;
+      case ALLEGRO_PRIM_TRIANGLE_LIST:
+         return n / 3;
+      default:
+         return n;
+   }
+}
+
+
+static int draw_direct(const ALLEGRO_VERTEX *vtxs, const int *indices,
+   int start, int end, int type)
+{
+   if (indices)
+      return _al_draw_prim_indexed_direct(vtxs, NULL, NULL, indices + start,
+         end - start, type);
+   return _al_draw_prim_direct(vtxs, NULL, NULL, start, end, type);
+}
+
+
+/* Draws what the calling thread holds, before its target changes. */
+static void flush_held_primitives(void)
+{
+   PRIM_BATCH *batch = get_batch();
+
+   if (batch)
+      draw_batch(batch);
+}
+
+
+/* Internal function: _al_init_prim_batch
+ */
+void _al_init_prim_batch(void)
+{
+   _al_set_held_primitives_flush(flush_held_primitives);
+}
+
+
+/* Internal function: _al_shutdown_prim_batch
+ *  Drops whatever the calling thread holds, as the target may be gone by
+ *  now.
+ */
+void _al_shutdown_prim_batch(void)
+{
+   PRIM_BATCH **slot = (PRIM_BATCH **)_al_tls_get_held_primitives();
+
+   _al_set_held_primitives_flush(NULL);
+   if (*slot) {
+      al_free((*slot)->vtxs);
+      al_free(*slot);
+      *slot = NULL;
+   }
+}
+
+
+/* Internal function: _al_prim_batch_held
+ */
+bool _al_prim_batch_held(void)
+{
+   return get_batch() != NULL;
+}
+
+
+/* Internal function: _al_batch_prim
+ *  Adds vertices start to end (indices[start] to indices[end] if indices
+ *  is not NULL) of an untextured primitive to the held ones. Returns the
+ *  number of primitives added, like al_draw_prim.
+ */
+int _al_batch_prim(const ALLEGRO_VERTEX *vtxs, const int *indices,
+   int start, int end, int type)
+{
+   PRIM_BATCH *batch = get_batch();
+   BATCH_STATE state;
+   const int n = list_size(type, end - start);
+   const int ltype = list_type(type);
+
+   ASSERT(batch);
+
+   if (n == 0)
+      return 0;
+
+   /* Too large to hold, it may as well be drawn right away. */
+   if (n > MAX_HELD_VERTICES) {
+      draw_batch(batch);
+      return draw_direct(vtxs, indices, start, end, type);
+   }
+
+   get_state(&state);
+
+   if (batch->num_vtxs > 0 && (ltype != batch->type ||
+         batch->num_vtxs + n > MAX_HELD_VERTICES ||
+         memcmp(&state, &batch->state, sizeof(state)) != 0)) {
+      draw_batch(batch);
+   }
+
+   if (batch->num_vtxs + n > batch->max_vtxs) {
+      int max_vtxs = batch->max_vtxs ? batch->max_vtxs : 1024;
+      ALLEGRO_VERTEX *grown;
+      while (max_vtxs < batch->num_vtxs + n)
+         max_vtxs *= 2;
+      grown = al_realloc(batch->vtxs, max_vtxs * sizeof(ALLEGRO_VERTEX));
+      if (!grown) {
+         ALLEGRO_ERROR("Failed to grow the held vertices.\n");
+         draw_batch(batch);
+         return draw_direct(vtxs, indices, start, end, type);
+      }
+      batch->vtxs = grown;
+      batch->max_vtxs = max_vtxs;
+   }
+
+   batch->type = ltype;
+   batch->state = state;
+   append(batch, vtxs, indices, start, end, type);
+
+   return num_primitives(type, n);
+}
+
+
+/* Internal function: _al_flush_prim_batch
+ */
+void _al_flush_prim_batch(void)
+{
+   flush_held_primitives();
+}
+
+
+/* Function: al_hold_primitive_drawing
+ */
+void al_hold_primitive_drawing(bool hold)
+{
+   PRIM_BATCH **slot = (PRIM_BATCH **)_al_tls_get_held_primitives();
+   PRIM_BATCH *batch = *slot;
+
+   if (hold) {
+      if (!batch) {
+         batch = al_calloc(1, sizeof(*batch));
+         if (!batch) {
+            ALLEGRO_ERROR("Failed to allocate the held primitives.\n");
+            return;
+         }
+         *slot = batch;
+      }
+   }
+   else if (batch) {
+      draw_batch(batch);
+      *slot = NULL;
+      al_free(batch->vtxs);
+      al_free(batch);
+   }
+}
+
+
+/* Function: al_is_primitive_drawing_held
+ */
+bool al_is_primitive_drawing_held(void)
+{
+   return get_batch() != NULL;
+}
+
+
+/* Function: al_get_held_primitive_flush_count
+ */
+int al_get_held_primitive_flush_count(void)
+{
+   PRIM_BATCH *batch = get_batch();
+
+   return batch ? batch->flushes : 0;
+}
+
+
+/* vim: set sts=3 sw=3 et: */
@@ -17,6 +17,8 @@
  */
 
 
+#define ALLEGRO_INTERNAL_UNSTABLE
+
 #include "allegro5/allegro.h"
 #include "allegro5/internal/aintern_bitmap.h"
 
@@ -24,7 +26,9 @@
 #include "allegro5/internal/aintern.h"
 #include "allegro5/internal/aintern_prim_soft.h"
 #include "allegro5/internal/aintern_prim.h"
+#include "allegro5/internal/aintern_transform.h"
 #include "allegro5/internal/aintern_tri_soft.h"
+#include <string.h>
 
 /*
 The vertex cache allows for bulk transformation of vertices, for faster run speeds
@@ -42,11 +46,19 @@ static void convert_vtx(ALLEGRO_BITMAP* texture, const char* src, ALLEGRO_VERTEX
    if(e->attribute) {
       switch(e->storage) {
          case ALLEGRO_PRIM_FLOAT_2:
+         {
+            float *ptr = (float*)(src + e->offset);
+            dest->x = *(ptr);
+            dest->y = *(ptr + 1);
+            dest->z = 0;
+            break;
+         }
          case ALLEGRO_PRIM_FLOAT_3:
          {
             float *ptr = (float*)(src + e->offset);
             dest->x = *(ptr);
             dest->y = *(ptr + 1);
+            dest->z = *(ptr + 2);
             break;
          }
          case ALLEGRO_PRIM_SHORT_2:
@@ -54,12 +66,14 @@ static void convert_vtx(ALLEGRO_BITMAP* texture, const char* src, ALLEGRO_VERTEX
             short *ptr = (short*)(src + e->offset);
             dest->x = (float)*(ptr);
             dest->y = (float)*(ptr + 1);
+            dest->z = 0;
             break;
          }
       }
    } else {
       dest->x = 0;
       dest->y = 0;
+      dest->z = 0;
    }
 
    e = &decl->elements[ALLEGRO_PRIM_TEX_COORD];
@@ -100,6 +114,239 @@ static void convert_vtx(ALLEGRO_BITMAP* texture, const char* src, ALLEGRO_VERTEX
    }
 }
 
+/*
+Converts n vertices into the cache, then transforms them all in one go
+*/
+static void fill_vertex_cache(ALLEGRO_BITMAP* texture, const char* vtxptr, int stride,
+   const ALLEGRO_VERTEX_DECL* decl, const ALLEGRO_TRANSFORM* trans, ALLEGRO_VERTEX* cache, int n)
+{
+   int ii;
+   for (ii = 0; ii < n; ii++) {
+      convert_vtx(texture, vtxptr, &cache[ii], decl);
+      vtxptr += stride;
+   }
+   al_transform_coordinates_array(trans, &cache[0].x, &cache[0].y, sizeof(ALLEGRO_VERTEX), n);
+}
+
+/*
+Where _al_draw_prim_indexed_soft finds its transformed vertices: vertex ii of
+the draw is at vtxs[map[ii] - offset]. The vertices and any scratch space are
+either the local storage or memory, which must be freed.
+*/
+typedef struct INDEXED_CACHE {
+   ALLEGRO_VERTEX* vtxs;
+   const int* map;
+   int offset;
+   void* memory;
+} INDEXED_CACHE;
+
+/*
+Converts and transforms every vertex the indices refer to once, however many
+times it is referred to. When the indices cover their range densely the whole
+range is done in one go, otherwise the vertices referred to are gathered into
+consecutive slots first. Local storage for up to ALLEGRO_VERTEX_CACHE_SIZE
+vertices and 4 * ALLEGRO_VERTEX_CACHE_SIZE ints is used when it is enough.
+Returns false if there is no memory for the cache.
+*/
+static bool fill_indexed_cache(INDEXED_CACHE* cache, ALLEGRO_BITMAP* texture,
+   const char* vtxs, int stride, const ALLEGRO_VERTEX_DECL* decl,
+   const int* indices, int num_vtx, int min_idx, int max_idx,
+   ALLEGRO_VERTEX* local_vtxs, int* local_ints)
+{
+   const ALLEGRO_TRANSFORM* trans = al_get_current_transform();
+   const int range = max_idx - min_idx + 1;
+   int* slots;
+   int* unique;
+   int* table;
+   int mask, num_unique, ii;
+
+   cache->memory = NULL;
+
+   if (range <= 2 * num_vtx) {
+      if (range <= ALLEGRO_VERTEX_CACHE_SIZE) {
+         cache->vtxs = local_vtxs;
+      } else {
+         cache->vtxs = cache->memory = al_malloc(range * sizeof(ALLEGRO_VERTEX));
+         if (!cache->vtxs)
+            return false;
+      }
+      fill_vertex_cache(texture, vtxs + min_idx * stride, stride, decl, trans,
+         cache->vtxs, range);
+      cache->map = indices;
+      cache->offset = min_idx;
+      return true;
+   }
+
+   /* An open addressing table of the slots, at most half full. */
+   for (mask = 1; mask < 2 * num_vtx; mask *= 2)
+      ;
+   if (num_vtx <= ALLEGRO_VERTEX_CACHE_SIZE) {
+      cache->vtxs = local_vtxs;
+      slots = local_ints;
+   } else {
+      cache->memory = al_malloc(num_vtx * sizeof(ALLEGRO_VERTEX) +
+         (2 * num_vtx + mask) * sizeof(int));
+      if (!cache->memory)
+         return false;
+      cache->vtxs = cache->memory;
+      slots = (int*)(cache->vtxs + num_vtx);
+   }
+   unique = slots + num_vtx;
+   table = unique + num_vtx;
+   memset(table, -1, mask * sizeof(int));
+   mask--;
+
+   num_unique = 0;
+   for (ii = 0; ii < num_vtx; ii++) {
+      const int idx = indices[ii];
+      int h = ((unsigned)idx * 2654435761u) & mask;
+      while (table[h] >= 0 && unique[table[h]] != idx)
+         h = (h + 1) & mask;
+      if (table[h] < 0) {
+         table[h] = num_unique;
+         unique[num_unique] = idx;
+         convert_vtx(texture, vtxs + idx * stride, &cache->vtxs[num_unique], decl);
+         num_unique++;
+      }
+      slots[ii] = table[h];
+   }
+   al_transform_coordinates_array(trans, &cache->vtxs[0].x, &cache->vtxs[0].y,
+      sizeof(ALLEGRO_VERTEX), num_unique);
+
+   cache->map = slots;
+   cache->offset = 0;
+   return true;
+}
+
+static void line_3d(ALLEGRO_BITMAP* texture, const _AL_CLIP_VERTEX* v1, const _AL_CLIP_VERTEX* v2)
+{
+   ALLEGRO_VERTEX p1, p2;
+   if (_al_project_line_3d(v1, v2, &p1, &p2))
+      _al_line_2d(texture, &p1, &p2);
+}
+
+/*
+Draws primitives to a target they have to be projected for, see _al_use_soft_3d.
+The vertices are numbered from start to end, or are given by indices from start
+to end if those are passed. Only triangles are tested against the depth buffer,
+lines and points are projected and then drawn as usual.
+*/
+static int draw_prim_soft_3d(ALLEGRO_BITMAP* texture, const void* vtxs, const ALLEGRO_VERTEX_DECL* decl,
+   const int* indices, int start, int end, int type)
+{
+   const int stride = decl ? decl->stride : (int)sizeof(ALLEGRO_VERTEX);
+   const int num_vtx = end - start;
+   ALLEGRO_TRANSFORM trans;
+   _AL_CLIP_VERTEX* clip;
+   int min_idx = start, max_idx = end - 1;
+   int num_primitives = 0;
+   bool by_position;
+   int ii;
+
+   if (num_vtx <= 0)
+      return 0;
+
+   if (indices) {
+      min_idx = max_idx = indices[start];
+      for (ii = start + 1; ii < end; ii++) {
+         min_idx = _ALLEGRO_MIN(min_idx, indices[ii]);
+         max_idx = _ALLEGRO_MAX(max_idx, indices[ii]);
+      }
+   }
+
+   /*
+   Each vertex is transformed once, unless the indices are so sparse that it is
+   cheaper to transform the vertex at each position instead
+   */
+   by_position = indices && max_idx - min_idx >= 2 * num_vtx;
+   clip = al_malloc(sizeof(*clip) * (by_position ? num_vtx : max_idx - min_idx + 1));
+   if (!clip)
+      return 0;
+
+   _al_get_clip_transform(al_get_target_bitmap(), &trans);
+   if (by_position) {
+      for (ii = start; ii < end; ii++) {
+         ALLEGRO_VERTEX v;
+         convert_vtx(texture, (const char*)vtxs + indices[ii] * stride, &v, decl);
+         _al_clip_vertex(&trans, &v, &clip[ii - start]);
+      }
+   } else {
+      for (ii = min_idx; ii <= max_idx; ii++) {
+         ALLEGRO_VERTEX v;
+         convert_vtx(texture, (const char*)vtxs + ii * stride, &v, decl);
+         _al_clip_vertex(&trans, &v, &clip[ii - min_idx]);
+      }
+   }
+
+#define VTX(ii) (by_position ? &clip[(ii) - start] : \
+   &clip[(indices ? indices[ii] : (ii)) - min_idx])
+
+   if (texture)
+      al_lock_bitmap(texture, ALLEGRO_PIXEL_FORMAT_ANY, ALLEGRO_LOCK_READONLY);
+
+   switch (type) {
+      case ALLEGRO_PRIM_LINE_LIST: {
+         for (ii = start; ii < end - 1; ii += 2) {
+            line_3d(texture, VTX(ii), VTX(ii + 1));
+         }
+         num_primitives = num_vtx / 2;
+         break;
+      };
+      case ALLEGRO_PRIM_LINE_STRIP: {
+         for (ii = start + 1; ii < end; ii++) {
+            line_3d(texture, VTX(ii - 1), VTX(ii));
+         }
+         num_primitives = num_vtx - 1;
+         break;
+      };
+      case ALLEGRO_PRIM_LINE_LOOP: {
+         for (ii = start + 1; ii < end; ii++) {
+            line_3d(texture, VTX(ii - 1), VTX(ii));
+         }
+         line_3d(texture, VTX(end - 1), VTX(start));
+         num_primitives = num_vtx;
+         break;
+      };
+      case ALLEGRO_PRIM_TRIANGLE_LIST: {
+         for (ii = start; ii < end - 2; ii += 3) {
+            _al_triangle_3d(texture, VTX(ii), VTX(ii + 1), VTX(ii + 2));
+         }
+         num_primitives = num_vtx / 3;
+         break;
+      };
+      case ALLEGRO_PRIM_TRIANGLE_STRIP: {
+         for (ii = start + 2; ii < end; ii++) {
+            _al_triangle_3d(texture, VTX(ii - 2), VTX(ii - 1), VTX(ii));
+         }
+         num_primitives = num_vtx - 2;
+         break;
+      };
+      case ALLEGRO_PRIM_TRIANGLE_FAN: {
+         for (ii = start + 2; ii < end; ii++) {
+            _al_triangle_3d(texture, VTX(start), VTX(ii - 1), VTX(ii));
+         }
+         num_primitives = num_vtx - 2;
+         break;
+      };
+      case ALLEGRO_PRIM_POINT_LIST: {
+         for (ii = start; ii < end; ii++) {
+            ALLEGRO_VERTEX p;
+            if (_al_project_point_3d(VTX(ii), &p))
+               _al_points_2d(texture, &p, 1);
+         }
+         num_primitives = num_vtx;
+         break;
+      };
+   }
+
+   if (texture)
+      al_unlock_bitmap(texture);
+
+   al_free(clip);
+   return num_primitives;
+#undef VTX
+}
+
 int _al_draw_prim_soft(ALLEGRO_BITMAP* texture, const void* vtxs, const ALLEGRO_VERTEX_DECL* decl, int start, int end, int type)
 {
    LOCAL_VERTEX_CACHE;
@@ -108,7 +355,11 @@ int _al_draw_prim_soft(ALLEGRO_BITMAP* texture, const void* vtxs, const ALLEGRO_
    int use_cache;
    int stride = decl ? decl->stride : (int)sizeof(ALLEGRO_VERTEX);
    const ALLEGRO_TRANSFORM* global_trans = al_get_current_transform();
+   const int trans_class = _al_get_current_transform_class();
    
+   if (_al_use_soft_3d(al_get_target_bitmap()))
+      return draw_prim_soft_3d(texture, vtxs, decl, NULL, start, end, type);
+
    num_primitives = 0;
    num_vtx = end - start;
    use_cache = num_vtx < ALLEGRO_VERTEX_CACHE_SIZE;
@@ -117,20 +368,13 @@ int _al_draw_prim_soft(ALLEGRO_BITMAP* texture, const void* vtxs, const ALLEGRO_
       al_lock_bitmap(texture, ALLEGRO_PIXEL_FORMAT_ANY, ALLEGRO_LOCK_READONLY);
       
    if (use_cache) {
-      int ii;
-      int n = 0;
-      const char* vtxptr = (const char*)vtxs + start * stride;
-      for (ii = 0; ii < num_vtx; ii++) {
-         convert_vtx(texture, vtxptr, &vertex_cache[ii], decl);
-         al_transform_coordinates(global_trans, &vertex_cache[ii].x, &vertex_cache[ii].y);
-         n++;
-         vtxptr += stride;
-      }
+      fill_vertex_cache(texture, (const char*)vtxs + start * stride, stride, decl,
+         global_trans, vertex_cache, num_vtx);
    }
    
 #define SET_VERTEX(v, idx)                                             \
    convert_vtx(texture, (const char*)vtxs + stride * (idx), &v, decl); \
-   al_transform_coordinates(global_trans, &v.x, &v.y);            \
+   _al_transform_coordinates_class(global_trans, trans_class, &v.x, &v.y); \
     
    switch (type) {
       case ALLEGRO_PRIM_LINE_LIST: {
@@ -140,13 +384,16 @@ int _al_draw_prim_soft(ALLEGRO_BITMAP* texture, const void* vtxs, const ALLEGRO_
                _al_line_2d(texture, &vertex_cache[ii], &vertex_cache[ii + 1]);
             }
          } else {
-            int ii;
-            for (ii = start; ii < end - 1; ii += 2) {
-               ALLEGRO_VERTEX v1, v2;
-               SET_VERTEX(v1, ii);
-               SET_VERTEX(v2, ii + 1);
-               
-               _al_line_2d(texture, &v1, &v2);
+            /* Whole lines are passed through the cache, a batch at a time */
+            const int batch = ALLEGRO_VERTEX_CACHE_SIZE - ALLEGRO_VERTEX_CACHE_SIZE % 2;
+            int ii, jj;
+            for (ii = start; ii < end - 1; ii += batch) {
+               const int n = _ALLEGRO_MIN(end - ii, batch);
+               fill_vertex_cache(texture, (const char*)vtxs + ii * stride, stride, decl,
+                  global_trans, vertex_cache, n);
+               for (jj = 0; jj < n - 1; jj += 2) {
+                  _al_line_2d(texture, &vertex_cache[jj], &vertex_cache[jj + 1]);
+               }
             }
          }
          num_primitives = num_vtx / 2;
@@ -202,14 +449,15 @@ int _al_draw_prim_soft(ALLEGRO_BITMAP* texture, const void* vtxs, const ALLEGRO_
                _al_triangle_2d(texture, &vertex_cache[ii], &vertex_cache[ii + 1], &vertex_cache[ii + 2]);
             }
          } else {
-            int ii;
-            for (ii = start; ii < end - 2; ii += 3) {
-               ALLEGRO_VERTEX v1, v2, v3;
-               SET_VERTEX(v1, ii);
-               SET_VERTEX(v2, ii + 1);
-               SET_VERTEX(v3, ii + 2);
-               
-               _al_triangle_2d(texture, &v1, &v2, &v3);
+            const int batch = ALLEGRO_VERTEX_CACHE_SIZE - ALLEGRO_VERTEX_CACHE_SIZE % 3;
+            int ii, jj;
+            for (ii = start; ii < end - 2; ii += batch) {
+               const int n = _ALLEGRO_MIN(end - ii, batch);
+               fill_vertex_cache(texture, (const char*)vtxs + ii * stride, stride, decl,
+                  global_trans, vertex_cache, n);
+               for (jj = 0; jj < n - 2; jj += 3) {
+                  _al_triangle_2d(texture, &vertex_cache[jj], &vertex_cache[jj + 1], &vertex_cache[jj + 2]);
+               }
             }
          }
          num_primitives = num_vtx / 3;
@@ -261,17 +509,14 @@ int _al_draw_prim_soft(ALLEGRO_BITMAP* texture, const void* vtxs, const ALLEGRO_
       };
       case ALLEGRO_PRIM_POINT_LIST: {
          if (use_cache) {
-            int ii;
-            for (ii = 0; ii < num_vtx; ii++) {
-               _al_point_2d(texture, &vertex_cache[ii]);
-            }
+            _al_points_2d(texture, vertex_cache, num_vtx);
          } else {
             int ii;
-            for (ii = start; ii < end; ii++) {
-               ALLEGRO_VERTEX v;
-               SET_VERTEX(v, ii);
-
-               _al_point_2d(texture, &v);
+            for (ii = start; ii < end; ii += ALLEGRO_VERTEX_CACHE_SIZE) {
+               const int n = _ALLEGRO_MIN(end - ii, ALLEGRO_VERTEX_CACHE_SIZE);
+               fill_vertex_cache(texture, (const char*)vtxs + ii * stride, stride, decl,
+                  global_trans, vertex_cache, n);
+               _al_points_2d(texture, vertex_cache, n);
             }
          }
          num_primitives = num_vtx;
@@ -290,15 +535,23 @@ int _al_draw_prim_indexed_soft(ALLEGRO_BITMAP* texture, const void* vtxs, const
    const int* indices, int num_vtx, int type)
 {
    LOCAL_VERTEX_CACHE;
+   int local_ints[4 * ALLEGRO_VERTEX_CACHE_SIZE];
+   INDEXED_CACHE cache;
    int num_primitives;
    int use_cache;
    int min_idx, max_idx;
    int ii;
    int stride = decl ? decl->stride : (int)sizeof(ALLEGRO_VERTEX);
    const ALLEGRO_TRANSFORM* global_trans = al_get_current_transform();
+   const int trans_class = _al_get_current_transform_class();
+
+   if (_al_use_soft_3d(al_get_target_bitmap()))
+      return draw_prim_soft_3d(texture, vtxs, decl, indices, 0, num_vtx, type);
 
    num_primitives = 0;   
-   use_cache = 1;
+   if (num_vtx <= 0)
+      return 0;
+
    min_idx = indices[0];
    max_idx = indices[0];
 
@@ -312,25 +565,25 @@ int _al_draw_prim_indexed_soft(ALLEGRO_BITMAP* texture, const void* vtxs, const
       else if (min_idx > indices[ii])
          min_idx = idx;
    }
-   if (max_idx - min_idx >= ALLEGRO_VERTEX_CACHE_SIZE) {
-      use_cache = 0;
-   }
 
    if (texture)
       al_lock_bitmap(texture, ALLEGRO_PIXEL_FORMAT_ANY, ALLEGRO_LOCK_READONLY);
-      
+
+   /*
+   Points are drawn in order, each vertex is transformed as it comes up
+   */
+   use_cache = type != ALLEGRO_PRIM_POINT_LIST &&
+      fill_indexed_cache(&cache, texture, vtxs, stride, decl, indices, num_vtx,
+         min_idx, max_idx, vertex_cache, local_ints);
    if (use_cache) {
-      int ii;
-      for (ii = 0; ii < num_vtx; ii++) {
-         int idx = indices[ii];
-         convert_vtx(texture, (const char*)vtxs + idx * stride, &vertex_cache[idx - min_idx], decl);
-         al_transform_coordinates(global_trans, &vertex_cache[idx - min_idx].x, &vertex_cache[idx - min_idx].y);
-      }
+      /* From here on, the indices are those of the cached vertices. */
+      indices = cache.map;
+      min_idx = cache.offset;
    }
    
 #define SET_VERTEX(v, idx)                                             \
    convert_vtx(texture, (const char*)vtxs + stride * (idx), &v, decl); \
-   al_transform_coordinates(global_trans, &v.x, &v.y);            \
+   _al_transform_coordinates_class(global_trans, trans_class, &v.x, &v.y); \
     
    switch (type) {
       case ALLEGRO_PRIM_LINE_LIST: {
@@ -340,7 +593,7 @@ int _al_draw_prim_indexed_soft(ALLEGRO_BITMAP* texture, const void* vtxs, const
                int idx1 = indices[ii] - min_idx;
                int idx2 = indices[ii + 1] - min_idx;
                
-               _al_line_2d(texture, &vertex_cache[idx1], &vertex_cache[idx2]);
+               _al_line_2d(texture, &cache.vtxs[idx1], &cache.vtxs[idx2]);
             }
          } else {
             int ii;
@@ -365,7 +618,7 @@ int _al_draw_prim_indexed_soft(ALLEGRO_BITMAP* texture, const void* vtxs, const
                int idx1 = indices[ii - 1] - min_idx;
                int idx2 = indices[ii] - min_idx;
                
-               _al_line_2d(texture, &vertex_cache[idx1], &vertex_cache[idx2]);
+               _al_line_2d(texture, &cache.vtxs[idx1], &cache.vtxs[idx2]);
             }
          } else {
             int ii;
@@ -390,12 +643,12 @@ int _al_draw_prim_indexed_soft(ALLEGRO_BITMAP* texture, const void* vtxs, const
                int idx1 = indices[ii - 1] - min_idx;
                int idx2 = indices[ii] - min_idx;
                
-               _al_line_2d(texture, &vertex_cache[idx1], &vertex_cache[idx2]);
+               _al_line_2d(texture, &cache.vtxs[idx1], &cache.vtxs[idx2]);
             }
             idx1 = indices[0] - min_idx;
             idx2 = indices[num_vtx - 1] - min_idx;
             
-            _al_line_2d(texture, &vertex_cache[idx2], &vertex_cache[idx1]);
+            _al_line_2d(texture, &cache.vtxs[idx2], &cache.vtxs[idx1]);
          } else {
             int ii;
             int idx = 1;
@@ -419,7 +672,7 @@ int _al_draw_prim_indexed_soft(ALLEGRO_BITMAP* texture, const void* vtxs, const
                int idx1 = indices[ii] - min_idx;
                int idx2 = indices[ii + 1] - min_idx;
                int idx3 = indices[ii + 2] - min_idx;
-               _al_triangle_2d(texture, &vertex_cache[idx1], &vertex_cache[idx2], &vertex_cache[idx3]);
+               _al_triangle_2d(texture, &cache.vtxs[idx1], &cache.vtxs[idx2], &cache.vtxs[idx3]);
             }
          } else {
             int ii;
@@ -446,7 +699,7 @@ int _al_draw_prim_indexed_soft(ALLEGRO_BITMAP* texture, const void* vtxs, const
                int idx1 = indices[ii - 2] - min_idx;
                int idx2 = indices[ii - 1] - min_idx;
                int idx3 = indices[ii] - min_idx;
-               _al_triangle_2d(texture, &vertex_cache[idx1], &vertex_cache[idx2], &vertex_cache[idx3]);
+               _al_triangle_2d(texture, &cache.vtxs[idx1], &cache.vtxs[idx2], &cache.vtxs[idx3]);
             }
          } else {
             int ii;
@@ -471,7 +724,7 @@ int _al_draw_prim_indexed_soft(ALLEGRO_BITMAP* texture, const void* vtxs, const
             for (ii = 1; ii < num_vtx; ii++) {
                int idx1 = indices[ii] - min_idx;
                int idx2 = indices[ii - 1] - min_idx;
-               _al_triangle_2d(texture, &vertex_cache[idx0], &vertex_cache[idx1], &vertex_cache[idx2]);
+               _al_triangle_2d(texture, &cache.vtxs[idx0], &cache.vtxs[idx1], &cache.vtxs[idx2]);
             }
          } else {
             int ii;
@@ -490,20 +743,14 @@ int _al_draw_prim_indexed_soft(ALLEGRO_BITMAP* texture, const void* vtxs, const
          break;
       };
       case ALLEGRO_PRIM_POINT_LIST: {
-         if (use_cache) {
-            int ii;
-            for (ii = 0; ii < num_vtx; ii++) {
-               int idx = indices[ii] - min_idx;
-               _al_point_2d(texture, &vertex_cache[idx]);
-            }
-         } else {
-            int ii;
-            for (ii = 0; ii < num_vtx; ii++) {
-               ALLEGRO_VERTEX v;
-               SET_VERTEX(v, indices[ii]);
-
-               _al_point_2d(texture, &v);
+         /* The cache is not used, the points are gathered in it in order. */
+         int ii, jj;
+         for (ii = 0; ii < num_vtx; ii += ALLEGRO_VERTEX_CACHE_SIZE) {
+            const int n = _ALLEGRO_MIN(num_vtx - ii, ALLEGRO_VERTEX_CACHE_SIZE);
+            for (jj = 0; jj < n; jj++) {
+               SET_VERTEX(vertex_cache[jj], indices[ii + jj]);
             }
+            _al_points_2d(texture, vertex_cache, n);
          }
          num_primitives = num_vtx;
          break;
@@ -512,6 +759,9 @@ int _al_draw_prim_indexed_soft(ALLEGRO_BITMAP* texture, const void* vtxs, const
 
    if(texture)
        al_unlock_bitmap(texture);
+
+   if (use_cache)
+      al_free(cache.memory);
    
    return num_primitives;
 #undef SET_VERTEX
@@ -175,6 +175,7 @@ void _al_prim_cache_init_ex(ALLEGRO_PRIM_VERTEX_CACHE* cache, int prim_type, ALL
    cache->color     = color;
    cache->prim_type = prim_type;
    cache->user_data = user_data;
+   cache->record    = NULL;
 }
 
 void _al_prim_cache_term(ALLEGRO_PRIM_VERTEX_CACHE* cache)
@@ -187,7 +188,13 @@ void _al_prim_cache_flush(ALLEGRO_PRIM_VERTEX_CACHE* cache)
    if (cache->size == 0)
       return;
 
-   if (cache->prim_type == ALLEGRO_PRIM_VERTEX_CACHE_TRIANGLE)
+   if (cache->record) {
+      /* A line strip continues from the last vertex recorded. */
+      size_t first = (cache->prim_type == ALLEGRO_PRIM_VERTEX_CACHE_LINE_STRIP &&
+         !_al_vector_is_empty(cache->record)) ? 1 : 0;
+      _al_vector_append_array(cache->record, cache->size - first, cache->buffer + first);
+   }
+   else if (cache->prim_type == ALLEGRO_PRIM_VERTEX_CACHE_TRIANGLE)
       al_draw_prim(cache->buffer, NULL, NULL, 0, cache->size, ALLEGRO_PRIM_TRIANGLE_LIST);
    else if (cache->prim_type == ALLEGRO_PRIM_VERTEX_CACHE_LINE_STRIP)
       al_draw_prim(cache->buffer, NULL, NULL, 0, cache->size, ALLEGRO_PRIM_LINE_STRIP);
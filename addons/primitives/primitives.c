@@ -47,6 +47,9 @@ bool al_init_primitives_addon(void)
 {
    bool ret = true;
    ret &= _al_init_d3d_driver();
+   _al_init_prim_batch();
+   _al_init_arc_tables();
+   _al_init_triangulator();
    
    addon_initialized = ret;
    
@@ -59,6 +62,8 @@ bool al_init_primitives_addon(void)
  */
 void al_shutdown_primitives_addon(void)
 {
+   _al_shutdown_prim_batch();
+   _al_shutdown_arc_tables();
    _al_shutdown_d3d_driver();
    addon_initialized = false;
 }
@@ -68,15 +73,28 @@ void al_shutdown_primitives_addon(void)
 int al_draw_prim(const void* vtxs, const ALLEGRO_VERTEX_DECL* decl,
    ALLEGRO_BITMAP* texture, int start, int end, int type)
 {  
-   ALLEGRO_BITMAP *target;
-   int ret = 0;
- 
    ASSERT(addon_initialized);
    ASSERT(vtxs);
    ASSERT(end >= start);
    ASSERT(start >= 0);
    ASSERT(type >= 0 && type < ALLEGRO_PRIM_NUM_TYPES);
 
+   if (_al_prim_batch_held()) {
+      if (!decl && !texture)
+         return _al_batch_prim(vtxs, NULL, start, end, type);
+      _al_flush_prim_batch();
+   }
+
+   return _al_draw_prim_direct(vtxs, decl, texture, start, end, type);
+}
+
+/* Draws right away, whether primitive drawing is held or not. */
+int _al_draw_prim_direct(const void* vtxs, const ALLEGRO_VERTEX_DECL* decl,
+   ALLEGRO_BITMAP* texture, int start, int end, int type)
+{
+   ALLEGRO_BITMAP *target;
+   int ret = 0;
+
    target = al_get_target_bitmap();
 
    /* In theory, if we ever get a camera concept for this addon, the transformation into
@@ -104,15 +122,30 @@ int al_draw_prim(const void* vtxs, const ALLEGRO_VERTEX_DECL* decl,
 int al_draw_indexed_prim(const void* vtxs, const ALLEGRO_VERTEX_DECL* decl,
    ALLEGRO_BITMAP* texture, const int* indices, int num_vtx, int type)
 {
-   ALLEGRO_BITMAP *target;
-   int ret = 0;
- 
    ASSERT(addon_initialized);
    ASSERT(vtxs);
    ASSERT(indices);
    ASSERT(num_vtx > 0);
    ASSERT(type >= 0 && type < ALLEGRO_PRIM_NUM_TYPES);
 
+   if (_al_prim_batch_held()) {
+      if (!decl && !texture)
+         return _al_batch_prim(vtxs, indices, 0, num_vtx, type);
+      _al_flush_prim_batch();
+   }
+
+   return _al_draw_prim_indexed_direct(vtxs, decl, texture, indices, num_vtx,
+      type);
+}
+
+/* Draws right away, whether primitive drawing is held or not. */
+int _al_draw_prim_indexed_direct(const void* vtxs,
+   const ALLEGRO_VERTEX_DECL* decl, ALLEGRO_BITMAP* texture,
+   const int* indices, int num_vtx, int type)
+{
+   ALLEGRO_BITMAP *target;
+   int ret = 0;
+
    target = al_get_target_bitmap();
    
    /* In theory, if we ever get a camera concept for this addon, the transformation into
@@ -458,41 +491,65 @@ int _al_draw_buffer_common_soft(ALLEGRO_VERTEX_BUFFER* vertex_buffer, ALLEGRO_BI
    void* vtx;
    int num_primitives = 0;
    int num_vtx = end - start;
-   int vtx_lock_start = index_buffer ? 0 : start;
-   int vtx_lock_len = index_buffer ? al_get_vertex_buffer_size(vertex_buffer) : num_vtx;
    if (vertex_buffer->common.write_only || (index_buffer && index_buffer->common.write_only)) {
       return 0;
    }
-
-   vtx = al_lock_vertex_buffer(vertex_buffer, vtx_lock_start, vtx_lock_len, ALLEGRO_LOCK_READONLY);
-   ASSERT(vtx);
+   if (num_vtx <= 0)
+      return 0;
 
    if (index_buffer) {
       void* idx;
       int* int_idx = NULL;
+      int min_idx, max_idx;
       int ii;
 
       idx = al_lock_index_buffer(index_buffer, start, num_vtx, ALLEGRO_LOCK_READONLY);
       ASSERT(idx);
 
-      if (index_buffer->index_size != 4) {
+#define INDEX(ii) (index_buffer->index_size == 4 ? ((int*)idx)[ii] : \
+   ((unsigned short*)idx)[ii])
+
+      min_idx = max_idx = INDEX(0);
+      for (ii = 1; ii < num_vtx; ii++) {
+         min_idx = _ALLEGRO_MIN(min_idx, INDEX(ii));
+         max_idx = _ALLEGRO_MAX(max_idx, INDEX(ii));
+      }
+
+      /*
+      Only the vertices the indices refer to are locked, so the indices are
+      made relative to the first of them
+      */
+      if (index_buffer->index_size != 4 || min_idx > 0) {
          int_idx = al_malloc(num_vtx * sizeof(int));
+         if (!int_idx) {
+            al_unlock_index_buffer(index_buffer);
+            return 0;
+         }
          for (ii = 0; ii < num_vtx; ii++) {
-            int_idx[ii] = ((unsigned short*)idx)[ii];
+            int_idx[ii] = INDEX(ii) - min_idx;
          }
-         idx = int_idx;
       }
 
-      num_primitives = _al_draw_prim_indexed_soft(texture, vtx, vertex_buffer->decl, idx, num_vtx, type);
+#undef INDEX
+
+      vtx = al_lock_vertex_buffer(vertex_buffer, min_idx, max_idx - min_idx + 1, ALLEGRO_LOCK_READONLY);
+      ASSERT(vtx);
+
+      num_primitives = _al_draw_prim_indexed_soft(texture, vtx, vertex_buffer->decl, int_idx ? int_idx : idx, num_vtx, type);
 
+      al_unlock_vertex_buffer(vertex_buffer);
       al_unlock_index_buffer(index_buffer);
       al_free(int_idx);
    }
    else {
+      vtx = al_lock_vertex_buffer(vertex_buffer, start, num_vtx, ALLEGRO_LOCK_READONLY);
+      ASSERT(vtx);
+
       num_primitives = _al_draw_prim_soft(texture, vtx, vertex_buffer->decl, 0, num_vtx, type);
+
+      al_unlock_vertex_buffer(vertex_buffer);
    }
 
-   al_unlock_vertex_buffer(vertex_buffer);
    return num_primitives;
 }
 
@@ -512,6 +569,9 @@ int al_draw_vertex_buffer(ALLEGRO_VERTEX_BUFFER* vertex_buffer,
    ASSERT(vertex_buffer);
    ASSERT(!vertex_buffer->common.is_locked);
 
+   if (_al_prim_batch_held())
+      _al_flush_prim_batch();
+
    target = al_get_target_bitmap();
 
    if (al_get_bitmap_flags(target) & ALLEGRO_MEMORY_BITMAP ||
@@ -550,6 +610,9 @@ int al_draw_indexed_buffer(ALLEGRO_VERTEX_BUFFER* vertex_buffer,
    ASSERT(index_buffer);
    ASSERT(!index_buffer->common.is_locked);
 
+   if (_al_prim_batch_held())
+      _al_flush_prim_batch();
+
    target = al_get_target_bitmap();
 
    if (al_get_bitmap_flags(target) & ALLEGRO_MEMORY_BITMAP ||
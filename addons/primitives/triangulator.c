@@ -23,11 +23,18 @@
 # include "allegro5/internal/aintern_list.h"
 # include <float.h>
 # include <math.h>
+# include <string.h>
 
 
 # define POLY_DEBUG 0
 
 
+/* Whether [primitives] triangulator asks for the linked list ear clipper
+ * only, see _al_init_triangulator.
+ */
+static bool always_use_lists = false;
+
+
 /* */
 # define POLY_VERTEX_ATTR_REFLEX      0x0001
 # define POLY_VERTEX_ATTR_EAR_CLIP    0x0002
@@ -808,10 +815,12 @@ static void poly_do_triangulate(POLY* polygon)
 }
 
 
-/* Function: al_triangulate_polygon
- *  General triangulation function.
+/*
+ *  Triangulate with the linked lists above. This is quadratic in the
+ *  number of vertices, so it is only used when the grid triangulator
+ *  is turned off or fails.
  */
-bool al_triangulate_polygon(
+static bool poly_triangulate_with_lists(
    const float* vertices, size_t vertex_stride, const int* vertex_counts,
    void (*emit_triangle)(int, int, int, void*), void* userdata)
 {
@@ -867,4 +876,34 @@ bool al_triangulate_polygon(
    return ret;
 }
 
+
+/* Internal function: _al_init_triangulator
+ *  Reads the [primitives] triangulator setting.
+ */
+void _al_init_triangulator(void)
+{
+   ALLEGRO_CONFIG* config = al_get_system_config();
+   const char* value = config ?
+      al_get_config_value(config, "primitives", "triangulator") : NULL;
+
+   always_use_lists = value && 0 == strcmp(value, "lists");
+}
+
+
+/* Function: al_triangulate_polygon
+ *  General triangulation function.
+ */
+bool al_triangulate_polygon(
+   const float* vertices, size_t vertex_stride, const int* vertex_counts,
+   void (*emit_triangle)(int, int, int, void*), void* userdata)
+{
+   if (!always_use_lists &&
+      _al_triangulate_polygon_grid(vertices, vertex_stride, vertex_counts,
+         emit_triangle, userdata))
+      return true;
+
+   return poly_triangulate_with_lists(vertices, vertex_stride, vertex_counts,
+      emit_triangle, userdata);
+}
+
 /* vim: set sts=3 sw=3 et: */
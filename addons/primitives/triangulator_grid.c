@@ -0,0 +1,747 @@
+/*         ______   ___    ___
+ *        /\  _  \ /\_ \  /\_ \
+ *        \ \ \L\ \\//\ \ \//\ \      __     __   _ __   ___
+ *         \ \  __ \ \ \ \  \ \ \   /'__`\ /'_ `\/\`'__\/ __`\
+ *          \ \ \/\ \ \_\ \_ \_\ \_/\  __//\ \L\ \ \ \//\ \L\ \
+ *           \ \_\ \_\/\____\/\____\ \____\ \____ \ \_\\ \____/
+ *            \/_/\/_/\/____/\/____/\/____/\/___L\ \/_/ \/___/
+ *                                           /\____/
+ *                                           \_/__/
+ *
+ *      Polygon triangulation by ear clipping on flat arrays.
+ *
+ *      The vertices are kept in one array of nodes, linked into a ring by
+ *      their indices. Holes are joined to the outline by a bridge to a
+ *      vertex visible from them. A vertex is an ear when no reflex vertex
+ *      lies in its triangle; for large polygons the reflex vertices are
+ *      sorted into a grid, so only those in the cells under the triangle
+ *      are searched. Only convex vertices are tested as ears. Together
+ *      this keeps the clipping close to linear instead of O(n^2). The hole
+ *      bridging follows the approach of Mapbox's earcut.
+ *
+ *      See readme.txt for copyright information.
+ */
+
+
+#include "allegro5/allegro.h"
+#include "allegro5/allegro_primitives.h"
+#include "allegro5/internal/aintern.h"
+#include "allegro5/internal/aintern_prim.h"
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Polygons with at most this many vertices search all of them for
+ * vertices inside an ear, which is faster than building the grid.
+ */
+#define MAX_UNINDEXED_VERTICES  80
+
+typedef struct NODE {
+   /* Index of the vertex. */
+   int index;
+   float x, y;
+   /* Neighbours in the ring. */
+   int prev, next;
+   bool removed;
+   /* Neighbours in the ring of convex nodes, if convex. */
+   bool convex;
+   int prev_c, next_c;
+} NODE;
+
+typedef struct TRIANGULATION {
+   NODE *nodes;
+   int num_nodes;
+   int *triangles;
+   int num_triangles;
+   /* Grid of the reflex nodes. The nodes in cell i are cell_nodes[j] for
+    * cell_start[i] <= j < cell_start[i + 1].
+    */
+   bool indexed;
+   float min_x, min_y, inv_cell_w, inv_cell_h;
+   int grid_w, grid_h;
+   int *cell_start;
+   int *cell_nodes;
+} TRIANGULATION;
+
+typedef struct HOLE {
+   float x, y;
+   int node;
+} HOLE;
+
+
+/* Twice the signed area of the triangle p, q, r. Positive if it turns the
+ * same way as the outline after linked_list, i.e. if q is convex.
+ */
+static float area(const NODE *p, const NODE *q, const NODE *r)
+{
+   return (q->x - p->x) * (r->y - p->y) - (q->y - p->y) * (r->x - p->x);
+}
+
+
+static bool equals(const NODE *p, const NODE *q)
+{
+   return p->x == q->x && p->y == q->y;
+}
+
+
+/* Whether p lies in or on the triangle a, b, c, which has positive area. */
+static bool point_in_triangle(float ax, float ay, float bx, float by,
+   float cx, float cy, float px, float py)
+{
+   return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+      (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+      (bx - px) * (cy - py) >= (cx - px) * (by - py);
+}
+
+
+static void remove_node(TRIANGULATION *t, int i)
+{
+   NODE *n = t->nodes;
+   NODE *p = &n[i];
+
+   p->removed = true;
+   n[p->next].prev = p->prev;
+   n[p->prev].next = p->next;
+}
+
+
+static int insert_node(TRIANGULATION *t, int index, float x, float y,
+   int last)
+{
+   NODE *n = t->nodes;
+   const int i = t->num_nodes++;
+
+   n[i].index = index;
+   n[i].x = x;
+   n[i].y = y;
+   n[i].removed = false;
+   if (last < 0) {
+      n[i].prev = i;
+      n[i].next = i;
+   }
+   else {
+      n[i].next = n[last].next;
+      n[i].prev = last;
+      n[n[last].next].prev = i;
+      n[last].next = i;
+   }
+   return i;
+}
+
+
+/* Links vertices start to end into a ring, turning the way positive asks
+ * for. Returns the last node, or -1 if there are none. Sets *reversed if
+ * the vertices were linked in the opposite order.
+ */
+static int linked_list(TRIANGULATION *t, const float *vertices,
+   size_t stride, int start, int end, bool positive, bool *reversed)
+{
+#define VTX(i)  ((const float *)((const char *)vertices + (i) * stride))
+   float sum = 0;
+   int last = -1;
+   int i, j;
+
+   for (i = start, j = end - 1; i < end; j = i++)
+      sum += VTX(j)[0] * VTX(i)[1] - VTX(i)[0] * VTX(j)[1];
+
+   *reversed = (sum > 0) != positive;
+   if (!*reversed) {
+      for (i = start; i < end; i++)
+         last = insert_node(t, i, VTX(i)[0], VTX(i)[1], last);
+   }
+   else {
+      for (i = end - 1; i >= start; i--)
+         last = insert_node(t, i, VTX(i)[0], VTX(i)[1], last);
+   }
+
+   if (last >= 0 && equals(&t->nodes[last], &t->nodes[t->nodes[last].next])) {
+      remove_node(t, last);
+      last = t->nodes[last].next;
+   }
+
+   return last;
+#undef VTX
+}
+
+
+/* Removes duplicate and collinear vertices from start on. Returns a node
+ * that was not removed.
+ */
+static int filter_points(TRIANGULATION *t, int start, int end)
+{
+   NODE *n = t->nodes;
+   int p = start;
+   bool again;
+
+   do {
+      again = false;
+      if (equals(&n[p], &n[n[p].next]) ||
+            area(&n[n[p].prev], &n[p], &n[n[p].next]) == 0) {
+         remove_node(t, p);
+         p = end = n[p].prev;
+         if (p == n[p].next)
+            break;
+         again = true;
+      }
+      else {
+         p = n[p].next;
+      }
+   } while (again || p != end);
+
+   return end;
+}
+
+
+/* Whether the diagonal from a towards b starts inside the polygon. */
+static bool locally_inside(const NODE *n, int a, int b)
+{
+   const NODE *pa = &n[a];
+
+   if (area(&n[pa->prev], pa, &n[pa->next]) > 0) {
+      return area(pa, &n[b], &n[pa->next]) <= 0 &&
+         area(pa, &n[pa->prev], &n[b]) <= 0;
+   }
+   return area(pa, &n[b], &n[pa->prev]) > 0 ||
+      area(pa, &n[pa->next], &n[b]) > 0;
+}
+
+
+/* Whether the sector of p lies in the sector of m, for two nodes at the
+ * same place.
+ */
+static bool sector_contains_sector(const NODE *n, int m, int p)
+{
+   return area(&n[n[m].prev], &n[m], &n[n[p].prev]) > 0 &&
+      area(&n[n[p].next], &n[m], &n[n[m].next]) > 0;
+}
+
+
+/* Finds a vertex of the outline that the leftmost vertex of a hole can be
+ * joined to: the nearest edge to the left of it, or the reflex vertex in
+ * front of that edge at the smallest angle. Returns -1 if there is none.
+ */
+static int find_hole_bridge(TRIANGULATION *t, int hole, int outer)
+{
+   NODE *n = t->nodes;
+   const float hx = n[hole].x;
+   const float hy = n[hole].y;
+   float qx = -FLT_MAX;
+   float mx, my;
+   float tan_min = FLT_MAX;
+   int p = outer;
+   int m = -1;
+   int stop;
+
+   if (equals(&n[hole], &n[p]))
+      return p;
+
+   do {
+      const NODE *a = &n[p];
+      const NODE *b = &n[a->next];
+      if (equals(&n[hole], b))
+         return a->next;
+      if (hy <= a->y && hy >= b->y && b->y != a->y) {
+         const float x = a->x + (hy - a->y) * (b->x - a->x) / (b->y - a->y);
+         if (x <= hx && x > qx) {
+            qx = x;
+            m = a->x < b->x ? p : a->next;
+            if (x == hx)
+               return m;
+         }
+      }
+      p = a->next;
+   } while (p != outer);
+
+   if (m < 0)
+      return -1;
+
+   stop = m;
+   mx = n[m].x;
+   my = n[m].y;
+   p = m;
+   do {
+      const NODE *a = &n[p];
+      if (hx >= a->x && a->x >= mx && hx != a->x &&
+            point_in_triangle(hy < my ? hx : qx, hy, mx, my,
+               hy < my ? qx : hx, hy, a->x, a->y)) {
+         const float tan = fabsf(hy - a->y) / (hx - a->x);
+         if (locally_inside(n, p, hole) && (tan < tan_min ||
+               (tan == tan_min && (a->x > n[m].x ||
+                  (a->x == n[m].x && sector_contains_sector(n, m, p)))))) {
+            m = p;
+            tan_min = tan;
+         }
+      }
+      p = a->next;
+   } while (p != stop);
+
+   return m;
+}
+
+
+/* Joins the rings of a and b with a pair of edges between them, splitting
+ * a and b in two nodes each. Returns the copy of b.
+ */
+static int split_polygon(TRIANGULATION *t, int a, int b)
+{
+   NODE *n = t->nodes;
+   const int a2 = insert_node(t, n[a].index, n[a].x, n[a].y, -1);
+   const int b2 = insert_node(t, n[b].index, n[b].x, n[b].y, -1);
+   const int an = n[a].next;
+   const int bp = n[b].prev;
+
+   n[a].next = b;
+   n[b].prev = a;
+   n[a2].next = an;
+   n[an].prev = a2;
+   n[b2].next = a2;
+   n[a2].prev = b2;
+   n[bp].next = b2;
+   n[b2].prev = bp;
+
+   return b2;
+}
+
+
+static int compare_x(const void *pa, const void *pb)
+{
+   const HOLE *a = pa;
+   const HOLE *b = pb;
+
+   if (a->x != b->x)
+      return a->x < b->x ? -1 : 1;
+   if (a->y != b->y)
+      return a->y < b->y ? -1 : 1;
+   return 0;
+}
+
+
+/* Links the holes into the outline, from the leftmost one on so that each
+ * hole can be bridged to an outline which already includes those left of
+ * it. Returns a node of the outline, or -1 if a hole could not be linked.
+ */
+static int eliminate_holes(TRIANGULATION *t, const float *vertices,
+   size_t stride, const int *vertex_counts, int outer)
+{
+   NODE *n = t->nodes;
+   HOLE *queue;
+   int num_holes = 0;
+   int start = vertex_counts[0];
+   int i;
+
+   for (i = 1; vertex_counts[i] > 0; i++)
+      num_holes++;
+
+   queue = al_malloc(num_holes * sizeof(HOLE));
+   if (!queue)
+      return -1;
+
+   for (i = 0; i < num_holes; i++) {
+      bool reversed;
+      int list = linked_list(t, vertices, stride, start,
+         start + vertex_counts[i + 1], false, &reversed);
+      int leftmost = list;
+      int p = list;
+
+      start += vertex_counts[i + 1];
+      if (list < 0 || n[list].next == n[list].prev) {
+         al_free(queue);
+         return -1;
+      }
+      do {
+         if (n[p].x < n[leftmost].x ||
+               (n[p].x == n[leftmost].x && n[p].y < n[leftmost].y))
+            leftmost = p;
+         p = n[p].next;
+      } while (p != list);
+
+      queue[i].x = n[leftmost].x;
+      queue[i].y = n[leftmost].y;
+      queue[i].node = leftmost;
+   }
+
+   qsort(queue, num_holes, sizeof(HOLE), compare_x);
+
+   for (i = 0; i < num_holes; i++) {
+      int bridge = find_hole_bridge(t, queue[i].node, outer);
+      int bridge_reverse;
+
+      if (bridge < 0) {
+         outer = -1;
+         break;
+      }
+      bridge_reverse = split_polygon(t, bridge, queue[i].node);
+      filter_points(t, bridge_reverse, n[bridge_reverse].next);
+      outer = filter_points(t, bridge, n[bridge].next);
+   }
+
+   al_free(queue);
+   return outer;
+}
+
+
+static int cell_x(const TRIANGULATION *t, float x)
+{
+   int i = (int)((x - t->min_x) * t->inv_cell_w);
+   return _ALLEGRO_CLAMP(0, i, t->grid_w - 1);
+}
+
+
+static int cell_y(const TRIANGULATION *t, float y)
+{
+   int i = (int)((y - t->min_y) * t->inv_cell_h);
+   return _ALLEGRO_CLAMP(0, i, t->grid_h - 1);
+}
+
+
+/* Sorts the reflex nodes of the ring into a grid of about as many cells
+ * covering the ring. Clipping ears never makes a node reflex, so the grid
+ * never misses one; nodes that stop being reflex are skipped when found.
+ * A ring without area gets no grid. Returns false if the grid could not be
+ * allocated.
+ */
+static bool build_grid(TRIANGULATION *t, int start)
+{
+   NODE *n = t->nodes;
+   float max_x = -FLT_MAX;
+   float max_y = -FLT_MAX;
+   float w, h, cell;
+   int num_reflex = 0;
+   int num_cells;
+   int p = start;
+   int i;
+
+   al_free(t->cell_start);
+   al_free(t->cell_nodes);
+   t->cell_start = NULL;
+   t->cell_nodes = NULL;
+   t->indexed = false;
+
+   t->min_x = FLT_MAX;
+   t->min_y = FLT_MAX;
+   do {
+      t->min_x = _ALLEGRO_MIN(t->min_x, n[p].x);
+      t->min_y = _ALLEGRO_MIN(t->min_y, n[p].y);
+      max_x = _ALLEGRO_MAX(max_x, n[p].x);
+      max_y = _ALLEGRO_MAX(max_y, n[p].y);
+      if (area(&n[n[p].prev], &n[p], &n[n[p].next]) <= 0)
+         num_reflex++;
+      p = n[p].next;
+   } while (p != start);
+
+   w = max_x - t->min_x;
+   h = max_y - t->min_y;
+   if (!(w > 0 && h > 0))
+      return true;
+
+   cell = sqrtf(w * h / _ALLEGRO_MAX(num_reflex, 1));
+   t->grid_w = _ALLEGRO_CLAMP(1, (int)(w / cell) + 1, num_reflex + 1);
+   t->grid_h = _ALLEGRO_CLAMP(1, (int)(h / cell) + 1, num_reflex + 1);
+   t->inv_cell_w = t->grid_w / w;
+   t->inv_cell_h = t->grid_h / h;
+   num_cells = t->grid_w * t->grid_h;
+
+   t->cell_start = al_calloc(num_cells + 1, sizeof(int));
+   t->cell_nodes = al_malloc(_ALLEGRO_MAX(num_reflex, 1) * sizeof(int));
+   if (!t->cell_start || !t->cell_nodes)
+      return false;
+
+   /* Count the nodes in each cell, then turn the counts into the ends of
+    * the cells and fill them back to front.
+    */
+   p = start;
+   do {
+      if (area(&n[n[p].prev], &n[p], &n[n[p].next]) <= 0)
+         t->cell_start[cell_y(t, n[p].y) * t->grid_w + cell_x(t, n[p].x)]++;
+      p = n[p].next;
+   } while (p != start);
+   for (i = 1; i <= num_cells; i++)
+      t->cell_start[i] += t->cell_start[i - 1];
+   p = start;
+   do {
+      if (area(&n[n[p].prev], &n[p], &n[n[p].next]) <= 0) {
+         int c = cell_y(t, n[p].y) * t->grid_w + cell_x(t, n[p].x);
+         t->cell_nodes[--t->cell_start[c]] = p;
+      }
+      p = n[p].next;
+   } while (p != start);
+
+   t->indexed = true;
+   return true;
+}
+
+
+/* Whether p is in the way of the ear a, b, c: a reflex node in or on its
+ * triangle other than its corners. A node at the same place as a is not,
+ * as that is where holes are bridged.
+ */
+static bool blocks_ear(const NODE *n, const NODE *a, const NODE *b,
+   const NODE *c, int p)
+{
+   const NODE *q = &n[p];
+
+   return q != a && q != c && !equals(q, a) &&
+      point_in_triangle(a->x, a->y, b->x, b->y, c->x, c->y, q->x, q->y) &&
+      area(&n[q->prev], q, &n[q->next]) <= 0;
+}
+
+
+static bool is_ear(const TRIANGULATION *t, int ear)
+{
+   const NODE *n = t->nodes;
+   const NODE *a = &n[n[ear].prev];
+   const NODE *b = &n[ear];
+   const NODE *c = &n[n[ear].next];
+   int p;
+
+   if (area(a, b, c) <= 0)
+      return false;
+
+   if (!t->indexed) {
+      for (p = c->next; p != b->prev; p = n[p].next) {
+         if (blocks_ear(n, a, b, c, p))
+            return false;
+      }
+      return true;
+   }
+   else {
+      const float x0 = _ALLEGRO_MIN(a->x, _ALLEGRO_MIN(b->x, c->x));
+      const float y0 = _ALLEGRO_MIN(a->y, _ALLEGRO_MIN(b->y, c->y));
+      const float x1 = _ALLEGRO_MAX(a->x, _ALLEGRO_MAX(b->x, c->x));
+      const float y1 = _ALLEGRO_MAX(a->y, _ALLEGRO_MAX(b->y, c->y));
+      const int cx0 = cell_x(t, x0);
+      const int cx1 = cell_x(t, x1);
+      const int cy1 = cell_y(t, y1);
+      int cx, cy;
+
+      for (cy = cell_y(t, y0); cy <= cy1; cy++) {
+         const int *start = t->cell_start + cy * t->grid_w;
+         for (cx = cx0; cx <= cx1; cx++) {
+            int j;
+            for (j = start[cx]; j < start[cx + 1]; j++) {
+               p = t->cell_nodes[j];
+               if (!n[p].removed && blocks_ear(n, a, b, c, p))
+                  return false;
+            }
+         }
+      }
+      return true;
+   }
+}
+
+
+static int ring_size(const NODE *n, int start)
+{
+   int size = 0;
+   int p = start;
+
+   do {
+      size++;
+      p = n[p].next;
+   } while (p != start);
+
+   return size;
+}
+
+
+/* Inserts p into the ring of convex nodes after the node after, or makes
+ * it the only one if after is -1.
+ */
+static void insert_convex(NODE *n, int p, int after)
+{
+   n[p].convex = true;
+   if (after < 0) {
+      n[p].prev_c = p;
+      n[p].next_c = p;
+   }
+   else {
+      n[p].prev_c = after;
+      n[p].next_c = n[after].next_c;
+      n[n[after].next_c].prev_c = p;
+      n[after].next_c = p;
+   }
+}
+
+
+/* Links the convex nodes of the ring into a ring of their own, in the same
+ * order. Returns one of them, or -1 if there are none.
+ */
+static int link_convex(NODE *n, int start)
+{
+   int last = -1;
+   int p = start;
+
+   do {
+      n[p].convex = false;
+      if (area(&n[n[p].prev], &n[p], &n[n[p].next]) > 0) {
+         insert_convex(n, p, last);
+         last = p;
+      }
+      p = n[p].next;
+   } while (p != start);
+
+   return last;
+}
+
+
+/* Clips ears off the ring until a triangle is left. Only convex nodes can
+ * be ears, and clipping an ear only makes the angles of its neighbours
+ * smaller, so the walk goes around a second ring of just the convex nodes
+ * and adds the neighbours of a clipped ear to it once they turn convex.
+ * Returns false if a full turn finds no ear even after removing duplicate
+ * and collinear vertices, which happens with self-intersecting outlines or
+ * rounding errors.
+ */
+static bool clip_ears(TRIANGULATION *t, int start)
+{
+   NODE *n = t->nodes;
+   bool filtered = false;
+   int size = ring_size(n, start);
+   int grid_size = size;
+   int ear = link_convex(n, start);
+   int stop = ear;
+
+   while (size > 2) {
+      /* As the ring shrinks, more of the grid is nodes that are gone or no
+       * longer reflex, and its cells get small for the ears, so it is
+       * rebuilt whenever the ring halves. That costs O(n) in total.
+       */
+      if (t->indexed && size < grid_size / 2) {
+         if (!build_grid(t, start))
+            return false;
+         grid_size = size;
+      }
+
+      if (ear >= 0 && is_ear(t, ear)) {
+         const int prev = n[ear].prev;
+         const int next = n[ear].next;
+         int before = n[ear].prev_c;
+         int *tri = t->triangles + 3 * t->num_triangles++;
+
+         tri[0] = n[prev].index;
+         tri[1] = n[ear].index;
+         tri[2] = n[next].index;
+         remove_node(t, ear);
+         size--;
+
+         if (before == ear) {
+            before = -1;
+         }
+         else {
+            n[before].next_c = n[ear].next_c;
+            n[n[ear].next_c].prev_c = before;
+         }
+         if (!n[prev].convex &&
+               area(&n[n[prev].prev], &n[prev], &n[next]) > 0) {
+            insert_convex(n, prev, before);
+         }
+         if (n[prev].convex)
+            before = prev;
+         if (!n[next].convex &&
+               area(&n[prev], &n[next], &n[n[next].next]) > 0) {
+            insert_convex(n, next, before);
+         }
+         start = next;
+
+         /* Going on after the next node makes fewer thin triangles. */
+         if (n[next].convex)
+            ear = n[next].next_c;
+         else
+            ear = before >= 0 ? n[before].next_c : -1;
+         stop = ear;
+         continue;
+      }
+
+      if (ear >= 0)
+         ear = n[ear].next_c;
+      if (ear < 0 || ear == stop) {
+         if (filtered)
+            return false;
+         start = filter_points(t, start, start);
+         size = ring_size(n, start);
+         ear = stop = link_convex(n, start);
+         filtered = true;
+      }
+   }
+
+   return true;
+}
+
+
+/* Internal function: _al_triangulate_polygon_grid
+ *  Triangulates like al_triangulate_polygon. Returns false without
+ *  emitting any triangles if it fails, so another triangulator can be
+ *  tried.
+ */
+bool _al_triangulate_polygon_grid(
+   const float* vertices, size_t vertex_stride, const int* vertex_counts,
+   void (*emit_triangle)(int, int, int, void*), void* userdata)
+{
+   TRIANGULATION t;
+   int num_vertices = 0;
+   int num_holes = -1;
+   int max_nodes;
+   int outer;
+   bool reversed;
+   bool ret = false;
+   int i;
+
+   for (i = 0; vertex_counts[i] > 0; i++) {
+      num_vertices += vertex_counts[i];
+      num_holes++;
+   }
+   ASSERT(i > 0);
+   if (vertex_counts[0] < 3)
+      return false;
+
+   /* Every hole adds two nodes for its bridge. */
+   max_nodes = num_vertices + 2 * num_holes;
+
+   memset(&t, 0, sizeof(t));
+   t.nodes = al_malloc(max_nodes * sizeof(NODE));
+   t.triangles = al_malloc(3 * max_nodes * sizeof(int));
+   if (!t.nodes || !t.triangles)
+      goto done;
+
+   outer = linked_list(&t, vertices, vertex_stride, 0, vertex_counts[0],
+      true, &reversed);
+   if (t.nodes[outer].next == t.nodes[outer].prev)
+      goto done;
+
+   if (num_holes > 0) {
+      outer = eliminate_holes(&t, vertices, vertex_stride, vertex_counts,
+         outer);
+      if (outer < 0)
+         goto done;
+   }
+
+   /* Without a grid, every node is searched, which is fine for small
+    * polygons and the best that can be done for flat ones.
+    */
+   if (num_vertices > MAX_UNINDEXED_VERTICES && !build_grid(&t, outer))
+      goto done;
+
+   if (!clip_ears(&t, outer))
+      goto done;
+
+   /* Keep the winding of the outline as given. */
+   for (i = 0; i < t.num_triangles; i++) {
+      const int *tri = t.triangles + 3 * i;
+      if (reversed)
+         emit_triangle(tri[2], tri[1], tri[0], userdata);
+      else
+         emit_triangle(tri[0], tri[1], tri[2], userdata);
+   }
+   ret = true;
+
+done:
+   al_free(t.nodes);
+   al_free(t.triangles);
+   al_free(t.cell_start);
+   al_free(t.cell_nodes);
+   return ret;
+}
+
+
+/* vim: set sts=3 sw=3 et: */
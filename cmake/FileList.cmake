@@ -1,10 +1,14 @@
 set(ALLEGRO_SRC_FILES
     src/allegro.c
     src/bitmap.c
+    src/bitmap_depth.c
+    src/bitmap_dirty.c
     src/bitmap_draw.c
     src/bitmap_io.c
     src/bitmap_lock.c
+    src/bitmap_memory.c
     src/bitmap_pixel.c
+    src/bitmap_rle.c
     src/bitmap_type.c
     src/blenders.c
     src/clipboard.c
@@ -34,9 +38,11 @@ set(ALLEGRO_SRC_FILES
     src/memblit.c
     src/memdraw.c
     src/memory.c
+    src/mipmap.c
     src/monitor.c
     src/mousenu.c
     src/mouse_cursor.c
+    src/parallel.c
     src/path.c
     src/pixels.c
     src/shader.c
@@ -47,6 +53,7 @@ set(ALLEGRO_SRC_FILES
     src/touch_input.c
     src/transformations.c
     src/tri_soft.c
+    src/tri_tiled.c
     src/utf8.c
     src/misc/aatree.c
     src/misc/bstrlib.c
@@ -0,0 +1,120 @@
+/*
+ *    Benchmark for converting and copying large memory bitmaps with
+ *    different numbers of threads, see [graphics] convert_threads.
+ *
+ *    Usage: ex_convert_bench [size] [max threads]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <allegro5/allegro.h>
+
+#include "common.c"
+
+/* How many seconds each measurement should approximately take. */
+#define TEST_TIME 1.0
+
+static int size = 4096;
+
+static double time_clone(ALLEGRO_BITMAP *bitmap, int format)
+{
+   ALLEGRO_BITMAP *clone;
+   double t0, t1;
+   int n = 0;
+
+   al_set_new_bitmap_format(format);
+   t0 = al_get_time();
+   do {
+      clone = al_clone_bitmap(bitmap);
+      if (!clone)
+         abort_example("Error cloning bitmap\n");
+      al_destroy_bitmap(clone);
+      n++;
+      t1 = al_get_time();
+   } while (t1 - t0 < TEST_TIME);
+
+   return (t1 - t0) / n;
+}
+
+static void fill(ALLEGRO_BITMAP *bitmap)
+{
+   ALLEGRO_LOCKED_REGION *lr;
+   int x, y;
+
+   lr = al_lock_bitmap(bitmap, ALLEGRO_PIXEL_FORMAT_ANY,
+      ALLEGRO_LOCK_WRITEONLY);
+   for (y = 0; y < size; y++) {
+      uint32_t *row = (uint32_t *)((char *)lr->data + y * lr->pitch);
+      for (x = 0; x < size; x++)
+         row[x] = x * 0x01020304u ^ y * 0x04030201u;
+   }
+   al_unlock_bitmap(bitmap);
+}
+
+int main(int argc, char **argv)
+{
+   static const struct {
+      int format;
+      char const *name;
+   } tests[] = {
+      {ALLEGRO_PIXEL_FORMAT_ARGB_8888, "copy"},
+      {ALLEGRO_PIXEL_FORMAT_ABGR_8888, "ARGB_8888 -> ABGR_8888"},
+      {ALLEGRO_PIXEL_FORMAT_RGB_565, "ARGB_8888 -> RGB_565"},
+      {ALLEGRO_PIXEL_FORMAT_ABGR_F32, "ARGB_8888 -> ABGR_F32"}
+   };
+   ALLEGRO_CONFIG *config;
+   ALLEGRO_BITMAP *bitmap;
+   double base[4];
+   int max_threads;
+   int threads, i;
+
+   if (!al_init()) {
+      abort_example("Could not init Allegro.\n");
+   }
+
+   open_log_monospace();
+
+   max_threads = al_get_cpu_count();
+   if (argc > 1)
+      size = strtol(argv[1], NULL, 10);
+   if (argc > 2)
+      max_threads = strtol(argv[2], NULL, 10);
+   if (max_threads < 1)
+      max_threads = 1;
+
+   al_set_new_bitmap_flags(ALLEGRO_MEMORY_BITMAP);
+   al_set_new_bitmap_format(ALLEGRO_PIXEL_FORMAT_ARGB_8888);
+   bitmap = al_create_bitmap(size, size);
+   if (!bitmap) {
+      abort_example("Error creating %dx%d bitmap\n", size, size);
+   }
+   fill(bitmap);
+
+   log_printf("%dx%d pixels, %d CPU cores\n\n", size, size,
+      al_get_cpu_count());
+   log_printf("%-24s %7s %10s %7s\n", "", "threads", "ms", "speedup");
+
+   config = al_get_system_config();
+   for (i = 0; i < 4; i++) {
+      for (threads = 1; threads <= max_threads; threads *= 2) {
+         char value[16];
+         double t;
+
+         sprintf(value, "%d", threads);
+         al_set_config_value(config, "graphics", "convert_threads", value);
+         t = time_clone(bitmap, tests[i].format);
+         if (threads == 1)
+            base[i] = t;
+         log_printf("%-24s %7d %10.2f %6.2fx\n", tests[i].name, threads,
+            t * 1000, base[i] / t);
+      }
+   }
+
+   al_destroy_bitmap(bitmap);
+
+   close_log(false);
+
+   return 0;
+}
+
+/* vim: set sts=3 sw=3 et: */
@@ -0,0 +1,159 @@
+/*
+ *    Benchmark for triangulating large polygons with holes, comparing the
+ *    triangulators selected by [primitives] triangulator.
+ *
+ *    Usage: ex_triangulate_bench [vertices...]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <allegro5/allegro.h>
+#include <allegro5/allegro_primitives.h>
+
+#include "common.c"
+
+/* How many seconds each measurement should approximately take. */
+#define TEST_TIME 1.0
+
+/* Lakes in the island, each a ring of LAKE_VERTICES vertices. */
+#define NUM_LAKES 8
+#define LAKE_VERTICES 64
+
+static float *vertices;
+static int vertex_counts[NUM_LAKES + 2];
+static int num_triangles;
+static double total_area;
+
+static void emit(int a, int b, int c, void *userdata)
+{
+   const float *v0 = vertices + 2 * a;
+   const float *v1 = vertices + 2 * b;
+   const float *v2 = vertices + 2 * c;
+   (void)userdata;
+
+   total_area += fabs((v1[0] - v0[0]) * (double)(v2[1] - v0[1]) -
+      (v1[1] - v0[1]) * (double)(v2[0] - v0[0])) / 2;
+   num_triangles++;
+}
+
+/* An island with a ragged coastline of n vertices around the origin, in
+ * anti-clockwise order, and lakes in clockwise order.
+ */
+static void make_island(int n)
+{
+   float *v;
+   int i, j;
+
+   vertices = malloc(2 * (n + NUM_LAKES * LAKE_VERTICES) * sizeof(float));
+   v = vertices;
+   srand(n);
+   for (i = 0; i < n; i++) {
+      double a = -2 * ALLEGRO_PI * i / n;
+      double r = 1000 + 150 * sin(a * 7) + 100 * sin(a * 31) +
+         200.0 * rand() / RAND_MAX;
+      *v++ = r * cos(a);
+      *v++ = r * sin(a);
+   }
+   vertex_counts[0] = n;
+
+   for (j = 0; j < NUM_LAKES; j++) {
+      double cx = 400 * cos(2 * ALLEGRO_PI * j / NUM_LAKES);
+      double cy = 400 * sin(2 * ALLEGRO_PI * j / NUM_LAKES);
+      for (i = 0; i < LAKE_VERTICES; i++) {
+         double a = 2 * ALLEGRO_PI * i / LAKE_VERTICES;
+         double r = 80 + 30.0 * rand() / RAND_MAX;
+         *v++ = cx + r * cos(a);
+         *v++ = cy + r * sin(a);
+      }
+      vertex_counts[j + 1] = LAKE_VERTICES;
+   }
+   vertex_counts[NUM_LAKES + 1] = 0;
+}
+
+static double time_triangulate(char const *triangulator)
+{
+   double t0, t1;
+   int n = 0;
+
+   al_set_config_value(al_get_system_config(), "primitives", "triangulator",
+      triangulator);
+   t0 = al_get_time();
+   do {
+      num_triangles = 0;
+      total_area = 0;
+      if (!al_triangulate_polygon(vertices, 2 * sizeof(float), vertex_counts,
+            emit, NULL)) {
+         abort_example("Error triangulating polygon\n");
+      }
+      n++;
+      t1 = al_get_time();
+   } while (t1 - t0 < TEST_TIME);
+
+   return (t1 - t0) / n;
+}
+
+int main(int argc, char **argv)
+{
+   static int default_sizes[] = {1000, 5000, 20000, 50000};
+   int *sizes = default_sizes;
+   int num_sizes = 4;
+   int i;
+
+   if (!al_init()) {
+      abort_example("Could not init Allegro.\n");
+   }
+   if (!al_init_primitives_addon()) {
+      abort_example("Could not init primitives addon.\n");
+   }
+
+   open_log_monospace();
+
+   if (argc > 1) {
+      num_sizes = argc - 1;
+      sizes = malloc(num_sizes * sizeof(int));
+      for (i = 0; i < num_sizes; i++)
+         sizes[i] = strtol(argv[i + 1], NULL, 10);
+   }
+
+   log_printf("%d lakes of %d vertices each\n\n", NUM_LAKES, LAKE_VERTICES);
+   log_printf("%9s %10s %10s %8s %10s\n", "vertices", "lists ms", "auto ms",
+      "speedup", "triangles");
+
+   for (i = 0; i < num_sizes; i++) {
+      double t_lists, t_auto, area_lists;
+      int triangles_lists;
+
+      if (sizes[i] < 3)
+         continue;
+      make_island(sizes[i]);
+
+      t_lists = time_triangulate("lists");
+      triangles_lists = num_triangles;
+      area_lists = total_area;
+      t_auto = time_triangulate("auto");
+
+      log_printf("%9d %10.2f %10.2f %7.1fx %10d\n", sizes[i], t_lists * 1000,
+         t_auto * 1000, t_lists / t_auto, num_triangles);
+      if (num_triangles != triangles_lists ||
+            fabs(total_area - area_lists) > 1e-6 * area_lists) {
+         log_printf("  mismatch: lists made %d triangles covering %.0f, "
+            "auto %d covering %.0f\n", triangles_lists, area_lists,
+            num_triangles, total_area);
+      }
+
+      free(vertices);
+   }
+
+   al_set_config_value(al_get_system_config(), "primitives", "triangulator",
+      "auto");
+
+   if (sizes != default_sizes)
+      free(sizes);
+
+   close_log(false);
+
+   return 0;
+}
+
+/* vim: set sts=3 sw=3 et: */
@@ -30,6 +30,12 @@ enum {
    ALLEGRO_CONVERT_BITMAP           = 0x1000
 };
 
+#if defined(ALLEGRO_UNSTABLE) || defined(ALLEGRO_INTERNAL_UNSTABLE) || defined(ALLEGRO_SRC)
+enum {
+   ALLEGRO_RLE_BITMAP               = 0x2000
+};
+#endif
+
 
 AL_FUNC(void, al_set_new_bitmap_format, (int format));
 AL_FUNC(void, al_set_new_bitmap_flags, (int flags));
@@ -61,6 +67,12 @@ AL_FUNC(void, al_put_pixel, (int x, int y, ALLEGRO_COLOR color));
 AL_FUNC(void, al_put_blended_pixel, (int x, int y, ALLEGRO_COLOR color));
 AL_FUNC(ALLEGRO_COLOR, al_get_pixel, (ALLEGRO_BITMAP *bitmap, int x, int y));
 
+#if defined(ALLEGRO_UNSTABLE) || defined(ALLEGRO_INTERNAL_UNSTABLE) || defined(ALLEGRO_SRC)
+AL_FUNC(void, al_put_pixel_span, (int x, int y, int n, const ALLEGRO_COLOR *colors));
+AL_FUNC(void, al_put_blended_pixel_span, (int x, int y, int n, const ALLEGRO_COLOR *colors));
+AL_FUNC(void, al_get_pixel_span, (ALLEGRO_BITMAP *bitmap, int x, int y, int n, ALLEGRO_COLOR *colors));
+#endif
+
 /* Masking */
 AL_FUNC(void, al_convert_mask_to_alpha, (ALLEGRO_BITMAP *bitmap, ALLEGRO_COLOR mask_color));
 
@@ -83,6 +95,16 @@ AL_FUNC(ALLEGRO_BITMAP *, al_clone_bitmap, (ALLEGRO_BITMAP *bitmap));
 AL_FUNC(void, al_convert_bitmap, (ALLEGRO_BITMAP *bitmap));
 AL_FUNC(void, al_convert_memory_bitmaps, (void));
 
+#if defined(ALLEGRO_UNSTABLE) || defined(ALLEGRO_INTERNAL_UNSTABLE) || defined(ALLEGRO_SRC)
+AL_FUNC(bool, al_generate_bitmap_mipmaps, (ALLEGRO_BITMAP *bitmap));
+#endif
+
+#if defined(ALLEGRO_UNSTABLE) || defined(ALLEGRO_INTERNAL_UNSTABLE) || defined(ALLEGRO_SRC)
+/* Dirty rectangles */
+AL_FUNC(int, al_get_bitmap_dirty_rectangles, (ALLEGRO_BITMAP *bitmap, int *rects, int max_rects));
+AL_FUNC(void, al_reset_bitmap_dirty_rectangles, (ALLEGRO_BITMAP *bitmap));
+#endif
+
 #ifdef __cplusplus
    }
 #endif
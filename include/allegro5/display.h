@@ -140,6 +140,9 @@ AL_FUNC(bool, al_acknowledge_resize, (ALLEGRO_DISPLAY *display));
 AL_FUNC(bool, al_resize_display,     (ALLEGRO_DISPLAY *display, int width, int height));
 AL_FUNC(void, al_flip_display,       (void));
 AL_FUNC(void, al_update_display_region, (int x, int y, int width, int height));
+#if defined(ALLEGRO_UNSTABLE) || defined(ALLEGRO_INTERNAL_UNSTABLE) || defined(ALLEGRO_SRC)
+AL_FUNC(void, al_update_display_from_bitmap, (ALLEGRO_BITMAP *bitmap, int x, int y));
+#endif
 AL_FUNC(bool, al_is_compatible_bitmap, (ALLEGRO_BITMAP *bitmap));
 
 AL_FUNC(bool, al_wait_for_vsync, (void));
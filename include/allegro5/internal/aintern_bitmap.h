@@ -12,6 +12,7 @@ extern "C" {
 #endif
 
 typedef struct ALLEGRO_BITMAP_INTERFACE ALLEGRO_BITMAP_INTERFACE;
+typedef struct _AL_BITMAP_RLE _AL_BITMAP_RLE;
 
 struct ALLEGRO_BITMAP
 {
@@ -74,12 +75,28 @@ struct ALLEGRO_BITMAP
    void* lock_data;
    int lock_flags;
    ALLEGRO_LOCKED_REGION locked_region;
+   /* Memory bitmaps locked in another format are converted into this buffer,
+    * which is kept for the next lock. If lock_buffer_format is not zero it
+    * holds all of the bitmap in that format, see bitmap_lock.c.
+    */
+   void *lock_buffer;
+   size_t lock_buffer_size;
+   int lock_buffer_format;
 
    /* Transformation for this bitmap */
    ALLEGRO_TRANSFORM transform;
    ALLEGRO_TRANSFORM inverse_transform;
    bool              inverse_transform_dirty;
    ALLEGRO_TRANSFORM proj_transform;
+   /* The class of transform, see _al_get_current_transform_class. Zero if
+    * it was not classified yet.
+    */
+   int transform_class;
+   /* Whether proj_transform of a memory bitmap differs from the default
+    * orthographic one, so that the software rasterizer has to project
+    * primitives with it, see _al_use_soft_3d.
+    */
+   bool custom_proj_transform;
 
    /* Shader applied to this bitmap.  Set this field with
     * _al_set_bitmap_shader_field to maintain invariants.
@@ -99,6 +116,31 @@ struct ALLEGRO_BITMAP
 
    /* set_target_bitmap and lock_bitmap mark bitmaps as dirty for preservation */
    bool dirty;
+
+   /* Scaled down copies of memory bitmaps with ALLEGRO_MIPMAP, see mipmap.c.
+    * mipmaps[0] is half the size of the bitmap, and so on down to 1x1.
+    * Writing to the bitmap marks them as dirty.
+    */
+   ALLEGRO_BITMAP **mipmaps;
+   int num_mipmaps;
+   bool mipmaps_dirty;
+
+   /* Runs of memory bitmaps with ALLEGRO_RLE_BITMAP, see bitmap_rle.c.
+    * Writing to the bitmap marks them as dirty.
+    */
+   _AL_BITMAP_RLE *rle;
+   bool rle_dirty;
+
+   /* One byte per tile of memory bitmaps which is set when the tile is
+    * written to, see bitmap_dirty.c. NULL if all of the bitmap counts as
+    * changed.
+    */
+   uint8_t *dirty_tiles;
+
+   /* Depth buffer of memory bitmaps created with a depth, see
+    * bitmap_depth.c. Sub-bitmaps use the one of their parent.
+    */
+   void *depth_buffer;
 };
 
 struct ALLEGRO_BITMAP_INTERFACE
@@ -141,8 +183,10 @@ AL_FUNC(ALLEGRO_DISPLAY*, _al_get_bitmap_display, (ALLEGRO_BITMAP *bitmap));
 extern void (*_al_convert_funcs[ALLEGRO_NUM_PIXEL_FORMATS]
    [ALLEGRO_NUM_PIXEL_FORMATS])(const void *, int, void *, int,
    int, int, int, int, int, int);
+void _al_init_convert_funcs(void);
 
 /* Bitmap conversion */
+void _al_init_bitmap_conversion(void);
 void _al_convert_bitmap_data(
 	const void *src, int src_format, int src_pitch,
 	void *dst, int dst_format, int dst_pitch,
@@ -163,6 +207,59 @@ void _al_convert_to_memory_bitmap(ALLEGRO_BITMAP *bitmap);
 
 /* Simple bitmap drawing */
 void _al_put_pixel(ALLEGRO_BITMAP *bitmap, int x, int y, ALLEGRO_COLOR color);
+AL_FUNC(void, _al_put_pixels, (ALLEGRO_BITMAP *bitmap,
+   const float *pos, int pos_stride,
+   const ALLEGRO_COLOR *colors, int color_stride, int n, bool blend));
+
+/* Bitmap memory */
+void _al_init_bitmap_memory(void);
+int _al_get_bitmap_memory_pitch(int w, int pixel_size);
+void *_al_alloc_bitmap_memory(size_t size);
+void _al_free_bitmap_memory(void *memory);
+bool _al_get_memory_bitmap_lock_cache(void);
+void _al_destroy_bitmap_lock_buffer(ALLEGRO_BITMAP *bitmap);
+
+/* Mipmaps of memory bitmaps */
+void _al_update_bitmap_mipmaps(ALLEGRO_BITMAP *bitmap);
+ALLEGRO_BITMAP *_al_get_bitmap_mipmap(ALLEGRO_BITMAP *bitmap, int level);
+void _al_destroy_bitmap_mipmaps(ALLEGRO_BITMAP *bitmap);
+
+/* Run-length encoding of memory bitmaps */
+enum {
+   _AL_RLE_SKIP_CLEAR   = 1 << 0,
+   _AL_RLE_COPY_OPAQUE  = 1 << 1
+};
+
+struct _AL_BLEND_SPAN_8888;
+
+void _al_update_bitmap_rle(ALLEGRO_BITMAP *bitmap);
+bool _al_blend_bitmap_rle(ALLEGRO_BITMAP *bitmap,
+   const struct _AL_BLEND_SPAN_8888 *blend, int flags,
+   int sx, int sy, int w, int h,
+   const void *src, int src_pitch, void *dst, int dst_pitch);
+void _al_destroy_bitmap_rle(ALLEGRO_BITMAP *bitmap);
+
+/* Changed parts of memory bitmaps */
+void _al_mark_bitmap_written(ALLEGRO_BITMAP *bitmap, int x, int y,
+   int w, int h);
+void _al_destroy_bitmap_dirty_tiles(ALLEGRO_BITMAP *bitmap);
+
+/* Depth buffers of memory bitmaps */
+bool _al_create_bitmap_depth_buffer(ALLEGRO_BITMAP *bitmap);
+void _al_destroy_bitmap_depth_buffer(ALLEGRO_BITMAP *bitmap);
+void _al_clear_bitmap_depth_buffer(ALLEGRO_BITMAP *bitmap, float z);
+
+/* Depth buffers of bitmaps with a depth of up to 16 bits hold uint16_t
+ * values, the others hold floats. Depths range from 0 to 1.
+ */
+static INLINE uint16_t _al_depth_to_16(float z)
+{
+   if (!(z > 0.0f))
+      return 0;
+   if (z >= 1.0f)
+      return 0xffff;
+   return (uint16_t)(z * 65535.0f + 0.5f);
+}
 
 /* Bitmap I/O */
 void _al_init_iio_table(void);
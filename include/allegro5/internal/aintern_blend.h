@@ -242,6 +242,92 @@ void _al_blend_inline(
 #endif
 
 
+/* Maximum number of pixels the software drawers blend in one go. */
+#define _AL_BLEND_SPAN_SIZE 64
+
+typedef struct _AL_BLEND_SPAN _AL_BLEND_SPAN;
+
+/* A blender resolved into per-channel coefficients, which lets whole spans
+ * of pixels be blended with SIMD kernels. For each of the r, g, b, a
+ * channels the source and destination factors are
+ *
+ *    k[0] + k[1] * src.a + k[2] * src.c + k[3] * dst.c
+ *
+ * and the result is clamp(src_sign * src.c * sf + dst_sign * dst.c * df)
+ * into [lo, hi]. This gives the same results as _al_blend_inline.
+ */
+struct _AL_BLEND_SPAN {
+   float src_k[4][4];
+   float dst_k[4][4];
+   float src_sign[4];
+   float dst_sign[4];
+   float lo[4];
+   float hi[4];
+   /* Blends n colors from src into dst, in place. */
+   void (*blend)(const _AL_BLEND_SPAN *b, const ALLEGRO_COLOR *src,
+      ALLEGRO_COLOR *dst, int n);
+};
+
+typedef struct _AL_BLEND_SPAN_8888 _AL_BLEND_SPAN_8888;
+
+/* A blender for 32-bit pixels with 8 bits per channel and alpha in the top
+ * byte, which is applied with integer arithmetic. The source pixels are
+ * multiplied by the tint first, which is stored in the channel order of the
+ * pixels with 65535 meaning 1.0. The results are within 1 LSB of the float
+ * path, and exact for an untinted source.
+ */
+struct _AL_BLEND_SPAN_8888 {
+   uint16_t tint[4];
+   /* Blends n pixels from src into dst. A NULL src stands for opaque
+    * white pixels, i.e. the source color is the tint itself.
+    */
+   void (*blend)(const _AL_BLEND_SPAN_8888 *b, uint32_t *dst,
+      const uint32_t *src, int n);
+};
+
+typedef struct _AL_COMPILED_BLENDER _AL_COMPILED_BLENDER;
+
+/* Flags of a compiled blender. */
+enum {
+   /* The result is the source color, see _AL_DEST_IS_ZERO and
+    * _AL_SRC_NOT_MODIFIED.
+    */
+   _AL_BLEND_COPY       = 1 << 0,
+   /* The source color is added to the destination. */
+   _AL_BLEND_ADDITIVE   = 1 << 1
+};
+
+/* A blender and blend color resolved once for the software renderer. Each
+ * thread keeps its current blender compiled, see _al_get_compiled_blender.
+ */
+struct _AL_COMPILED_BLENDER {
+   int op, src_mode, dst_mode;
+   int op_alpha, src_alpha, dst_alpha;
+   ALLEGRO_COLOR const_color;
+   int flags;
+   /* The kind of integer blending used for 8888 pixels, or -1 if they
+    * need the float path.
+    */
+   int mode_8888;
+   _AL_BLEND_SPAN span;
+};
+
+void _al_init_blend_spans(void);
+AL_FUNC(void, _al_init_blend_span, (_AL_BLEND_SPAN *b,
+   int op, int src_mode, int dst_mode,
+   int op_alpha, int src_alpha, int dst_alpha,
+   const ALLEGRO_COLOR *const_color));
+AL_FUNC(bool, _al_init_blend_span_8888, (_AL_BLEND_SPAN_8888 *b, int format,
+   const _AL_COMPILED_BLENDER *blender, const ALLEGRO_COLOR *tint));
+void _al_compile_blender(_AL_COMPILED_BLENDER *cb,
+   int op, int src_mode, int dst_mode,
+   int op_alpha, int src_alpha, int dst_alpha,
+   const ALLEGRO_COLOR *const_color);
+bool _al_is_same_blender(const _AL_COMPILED_BLENDER *a,
+   const _AL_COMPILED_BLENDER *b);
+AL_FUNC(const _AL_COMPILED_BLENDER *, _al_get_compiled_blender, (void));
+void _al_set_compiled_blender(const _AL_COMPILED_BLENDER *cb);
+
 void _al_blend_memory(ALLEGRO_COLOR *src_color, ALLEGRO_BITMAP *dest,
    int dx, int dy, ALLEGRO_COLOR *result);
 
@@ -0,0 +1,51 @@
+#ifndef __al_included_allegro5_aintern_cpu_h
+#define __al_included_allegro5_aintern_cpu_h
+
+#ifdef __cplusplus
+   extern "C" {
+#endif
+
+
+/* _AL_HAVE_SSE2 is defined when SSE2 intrinsics can be used unconditionally.
+ * _AL_HAVE_AVX2 is defined when the compiler can additionally build AVX2 code
+ * into functions marked with _AL_TARGET, to be selected at runtime by
+ * checking _al_get_cpu_features().
+ */
+#if defined(__SSE2__) || defined(_M_X64) || \
+   (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+   #define _AL_HAVE_SSE2
+#endif
+
+#if defined(_AL_HAVE_SSE2) && (defined(__clang__) || \
+   (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))) || \
+   (defined(_MSC_VER) && _MSC_VER >= 1700))
+   #define _AL_HAVE_AVX2
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+   #define _AL_TARGET(isa) __attribute__((target(isa)))
+#else
+   #define _AL_TARGET(isa)
+#endif
+
+
+/* Instruction set extensions which the software renderer may use. */
+enum {
+   _AL_CPU_SSE2   = 1 << 0,
+   _AL_CPU_SSSE3  = 1 << 1,
+   _AL_CPU_SSE41  = 1 << 2,
+   _AL_CPU_AVX    = 1 << 3,
+   _AL_CPU_AVX2   = 1 << 4
+};
+
+void _al_init_cpu_features(void);
+AL_FUNC(int, _al_get_cpu_features, (void));
+
+
+#ifdef __cplusplus
+   }
+#endif
+
+#endif
+
+/* vim: set sts=3 sw=3 et: */
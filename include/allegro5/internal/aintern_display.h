@@ -164,6 +164,9 @@ int  _al_display_settings_sorter(const void *p0, const void *p1);
 int _al_get_suggested_display_option(ALLEGRO_DISPLAY *d,
    int option, int default_value);
 
+void _al_init_render_state(_ALLEGRO_RENDER_STATE *state);
+const _ALLEGRO_RENDER_STATE *_al_get_render_state(void);
+
 /* This is called from the primitives addon and for shaders. */
 AL_FUNC(void, _al_add_display_invalidated_callback, (ALLEGRO_DISPLAY *display,
    void (*display_invalidated)(ALLEGRO_DISPLAY*)));
@@ -178,6 +181,7 @@ AL_FUNC(void, _al_remove_display_validated_callback, (ALLEGRO_DISPLAY *display,
 bool _al_set_current_display_only(ALLEGRO_DISPLAY *display);
 void _al_set_new_display_settings(ALLEGRO_EXTRA_DISPLAY_SETTINGS *settings);
 ALLEGRO_EXTRA_DISPLAY_SETTINGS *_al_get_new_display_settings(void);
+_ALLEGRO_RENDER_STATE *_al_get_tls_render_state(void);
 
 
 #ifdef __cplusplus
@@ -1,15 +1,35 @@
 #ifndef __al_included_allegro5_aintern_memblit_h
 #define __al_included_allegro5_aintern_memblit_h
 
+#include "allegro5/internal/aintern_vector.h"
+
 #ifdef __cplusplus
    extern "C" {
 #endif
 
 
+/* The drawing to a memory bitmap queued up by al_hold_bitmap_drawing. Each
+ * thread has its own while it has any, like the hold flag itself.
+ */
+typedef struct _AL_HELD_BLITS {
+   _AL_VECTOR blits;
+   /* The blenders of the held quads, which refer to them by index. */
+   _AL_VECTOR blenders;
+   ALLEGRO_BITMAP *src;
+   ALLEGRO_BITMAP *dest;
+   int clip[4];
+   /* The part of the target the held blits may touch. */
+   int extent[4];
+} _AL_HELD_BLITS;
+
 void _al_draw_bitmap_region_memory(ALLEGRO_BITMAP *bitmap,
    ALLEGRO_COLOR tint,
    int sx, int sy, int sw, int sh, int dx, int dy, int flags);
 
+void _al_init_held_memory_blits(void);
+void _al_flush_held_memory_blits(void);
+void _al_flush_held_memory_blits_for(ALLEGRO_BITMAP *bitmap);
+
 
 #ifdef __cplusplus
    }
@@ -8,6 +8,7 @@
 
 void _al_clear_bitmap_by_locking(ALLEGRO_BITMAP *bitmap, ALLEGRO_COLOR *color);
 void _al_draw_pixel_memory(ALLEGRO_BITMAP *bmp, float x, float y, ALLEGRO_COLOR *color);
+void _al_fill_pixels(void *dst, const void *pixel, int pixel_size, int n, bool stream);
 
 
 #ifdef __cplusplus
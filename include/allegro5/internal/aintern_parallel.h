@@ -0,0 +1,21 @@
+#ifndef __al_included_allegro5_aintern_parallel_h
+#define __al_included_allegro5_aintern_parallel_h
+
+#ifdef __cplusplus
+   extern "C" {
+#endif
+
+
+void _al_init_parallel(void);
+int _al_parse_thread_count(const char *value);
+void _al_parallel_for(int n, int max_threads,
+   void (*func)(int i, void *arg), void *arg);
+
+
+#ifdef __cplusplus
+   }
+#endif
+
+#endif
+
+/* vim: set sts=3 sw=3 et: */
@@ -235,7 +235,7 @@
             uint8_t c = *(uint8_t *)(data);                                   \
             _AL_MAP_RGBA(color, c, c, c, 255);                                \
             if (advance)                                                      \
-               data += 2;                                                     \
+               data += 1;                                                     \
             break;                                                            \
          }                                                                    \
                                                                               \
@@ -447,10 +447,10 @@
             break;                                                            \
                                                                               \
          case ALLEGRO_PIXEL_FORMAT_SINGLE_CHANNEL_8: {                        \
-            uint8_t c = color.r;                                              \
+            uint8_t c = _al_fast_float_to_int(color.r * 255);                 \
             *(uint8_t *)data = c;                                             \
             if (advance)                                                      \
-               data += 3;                                                     \
+               data += 1;                                                     \
             break;                                                            \
          }                                                                    \
                                                                               \
@@ -10,6 +10,13 @@ void _al_tls_init_once(void);
 
 int *_al_tls_get_dtor_owner_count(void);
 
+bool *_al_tls_get_hold_memory_bitmap_drawing(void);
+
+struct _AL_HELD_BLITS **_al_tls_get_held_blits(void);
+
+AL_FUNC(void **, _al_tls_get_held_primitives, (void));
+AL_FUNC(void, _al_set_held_primitives_flush, (void (*flush)(void)));
+
 
 #ifdef __cplusplus
    }
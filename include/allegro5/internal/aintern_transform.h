@@ -1,9 +1,60 @@
 #ifndef __al_included_allegro5_aintern_transform_h
 #define __al_included_allegro5_aintern_transform_h
 
+#ifdef __cplusplus
+   extern "C" {
+#endif
+
+
+/* Classes of transforms, from the most to the least specific. Each class
+ * includes the ones before it.
+ */
+enum {
+   _AL_TRANSFORM_UNKNOWN,
+   _AL_TRANSFORM_IDENTITY,
+   /* Only m[3][0] and m[3][1] differ from the identity. */
+   _AL_TRANSFORM_TRANSLATION,
+   /* m[0][0] and m[1][1] may differ as well, so x and y are scaled along
+    * the axes.
+    */
+   _AL_TRANSFORM_SCALE,
+   /* Any of the six elements al_transform_coordinates uses may differ. */
+   _AL_TRANSFORM_AFFINE_2D,
+   _AL_TRANSFORM_GENERAL
+};
 
 bool _al_transform_is_translation(const ALLEGRO_TRANSFORM* trans,
    float *dx, float *dy);
+int _al_classify_transform(const ALLEGRO_TRANSFORM *trans);
+AL_FUNC(int, _al_get_current_transform_class, (void));
+bool _al_is_default_projection(ALLEGRO_BITMAP *bitmap,
+   const ALLEGRO_TRANSFORM *trans);
+
 
+/* Like al_transform_coordinates, for a transform of the given class. */
+static INLINE void _al_transform_coordinates_class(const ALLEGRO_TRANSFORM *trans,
+   int trans_class, float *x, float *y)
+{
+   switch (trans_class) {
+      case _AL_TRANSFORM_IDENTITY:
+         break;
+      case _AL_TRANSFORM_TRANSLATION:
+         *x += trans->m[3][0];
+         *y += trans->m[3][1];
+         break;
+      case _AL_TRANSFORM_SCALE:
+         *x = *x * trans->m[0][0] + trans->m[3][0];
+         *y = *y * trans->m[1][1] + trans->m[3][1];
+         break;
+      default:
+         al_transform_coordinates(trans, x, y);
+         break;
+   }
+}
+
+
+#ifdef __cplusplus
+   }
+#endif
 
 #endif
@@ -17,6 +17,7 @@ struct ALLEGRO_VERTEX {
 #endif
 
 AL_FUNC(void, _al_triangle_2d, (ALLEGRO_BITMAP* texture, ALLEGRO_VERTEX* v1, ALLEGRO_VERTEX* v2, ALLEGRO_VERTEX* v3));
+AL_FUNC(void, _al_triangle_2d_locked, (ALLEGRO_BITMAP* target, ALLEGRO_BITMAP* texture, ALLEGRO_VERTEX* v1, ALLEGRO_VERTEX* v2, ALLEGRO_VERTEX* v3));
 AL_FUNC(void, _al_draw_soft_triangle, (
    ALLEGRO_VERTEX* v1, ALLEGRO_VERTEX* v2, ALLEGRO_VERTEX* v3, uintptr_t state,
    void (*init)(uintptr_t, ALLEGRO_VERTEX*, ALLEGRO_VERTEX*, ALLEGRO_VERTEX*),
@@ -24,4 +25,31 @@ AL_FUNC(void, _al_draw_soft_triangle, (
    void (*step)(uintptr_t, int),
    void (*draw)(uintptr_t, int, int, int)));
 
+/* A vertex transformed by the view and projection transforms, but not yet
+ * divided by w, see _al_triangle_3d.
+ */
+typedef struct _AL_CLIP_VERTEX {
+   float x, y, z, w;
+   float u, v;
+   ALLEGRO_COLOR color;
+} _AL_CLIP_VERTEX;
+
+AL_FUNC(bool, _al_use_soft_3d, (ALLEGRO_BITMAP *target));
+AL_FUNC(void, _al_get_clip_transform, (ALLEGRO_BITMAP *target, ALLEGRO_TRANSFORM *trans));
+AL_FUNC(void, _al_clip_vertex, (const ALLEGRO_TRANSFORM *trans,
+   const ALLEGRO_VERTEX *in, _AL_CLIP_VERTEX *out));
+AL_FUNC(void, _al_triangle_3d, (ALLEGRO_BITMAP *texture,
+   const _AL_CLIP_VERTEX *v1, const _AL_CLIP_VERTEX *v2, const _AL_CLIP_VERTEX *v3));
+AL_FUNC(bool, _al_project_line_3d, (const _AL_CLIP_VERTEX *v1,
+   const _AL_CLIP_VERTEX *v2, ALLEGRO_VERTEX *out1, ALLEGRO_VERTEX *out2));
+AL_FUNC(bool, _al_project_point_3d, (const _AL_CLIP_VERTEX *v,
+   ALLEGRO_VERTEX *out));
+
+void _al_init_tiled_triangles(void);
+bool _al_queue_tiled_triangle(ALLEGRO_BITMAP *target, ALLEGRO_BITMAP *texture,
+   ALLEGRO_VERTEX *v1, ALLEGRO_VERTEX *v2, ALLEGRO_VERTEX *v3,
+   int x, int y, int w, int h);
+void _al_flush_tiled_triangles(void);
+void _al_flush_tiled_triangles_for(ALLEGRO_BITMAP *bitmap, bool write);
+
 #endif
@@ -34,6 +34,12 @@ AL_FUNC(void, al_scale_transform_3d, (ALLEGRO_TRANSFORM *trans, float sx, float
 AL_FUNC(void, al_transform_coordinates, (const ALLEGRO_TRANSFORM* trans, float* x, float* y));
 AL_FUNC(void, al_transform_coordinates_3d, (const ALLEGRO_TRANSFORM *trans,
    float *x, float *y, float *z));
+#if defined(ALLEGRO_UNSTABLE) || defined(ALLEGRO_INTERNAL_UNSTABLE) || defined(ALLEGRO_SRC)
+AL_FUNC(void, al_transform_coordinates_array, (const ALLEGRO_TRANSFORM *trans,
+   float *x, float *y, int stride, int num));
+AL_FUNC(void, al_transform_coordinates_3d_array, (const ALLEGRO_TRANSFORM *trans,
+   float *x, float *y, float *z, int stride, int num));
+#endif
 AL_FUNC(void, al_compose_transform, (ALLEGRO_TRANSFORM* trans, const ALLEGRO_TRANSFORM* other));
 AL_FUNC(const ALLEGRO_TRANSFORM*, al_get_current_transform, (void));
 AL_FUNC(const ALLEGRO_TRANSFORM*, al_get_current_inverse_transform, (void));
@@ -383,6 +383,243 @@ def converter_function(info_a, info_b):
 
     return r
 
+def simd_conversion(info_a, info_b):
+    """
+    Work out how to convert four or eight pixels at once with SIMD
+    instructions. Only 32-bit sources are handled, where all the components
+    have 8 bits, and only 16-bit and 32-bit destinations. Returns None if
+    the conversion is not handled, else a (shuffle, ops, add) tuple: either
+    a list of the source byte (or -1 for zero) for each destination byte, or
+    a list of (mask, shift) pairs to be ORed together. The add value is ORed
+    in at the end for a missing A component.
+    """
+    if not info_a or not info_b: return None
+    if info_a.float or info_b.float: return None
+    if info_a.single_channel or info_b.single_channel: return None
+    if info_a.size != 32 or info_b.size not in [15, 16, 32]: return None
+
+    shuffle = [-1, -1, -1, -1]
+    ops = {}
+    add = 0
+    for name in sorted(info_b.components.keys()):
+        if name == "X": continue
+        c_b = info_b.components[name]
+        if name not in info_a.components:
+            if name == "A":
+                add |= ((1 << c_b.size) - 1) << c_b.position
+            continue
+        c_a = info_a.components[name]
+        drop = c_a.size - c_b.size
+        mask = ((1 << c_b.size) - 1) << (c_a.position + drop)
+        shift = c_b.position - (c_a.position + drop)
+        ops[shift] = ops.get(shift, 0) | mask
+        if c_b.size == 8 and c_b.position % 8 == 0 and shuffle is not None:
+            shuffle[c_b.position // 8] = c_a.position // 8
+        else:
+            shuffle = None
+
+    if info_b.size != 32:
+        shuffle = None
+    return shuffle, sorted(ops.items()), add
+
+simd_isas = {
+    "sse2": {
+        "target": "",
+        "vec": "__m128i",
+        "n": 4,
+        "p": "_mm",
+        "si": "si128"},
+    "ssse3": {
+        "target": "_AL_TARGET(\"ssse3\") ",
+        "vec": "__m128i",
+        "n": 4,
+        "p": "_mm",
+        "si": "si128"},
+    "avx2": {
+        "target": "_AL_TARGET(\"avx2\") ",
+        "vec": "__m256i",
+        "n": 8,
+        "p": "_mm256",
+        "si": "si256"}}
+
+def simd_kernel(isa, info_b, shuffle, ops, add):
+    """
+    Create the lines converting the source pixels in s and storing them.
+    """
+    i = simd_isas[isa]
+    p = i["p"]
+    si = i["si"]
+    vec = i["vec"]
+    r = ""
+    if shuffle is not None:
+        mask = []
+        for pixel in range(i["n"]):
+            for byte in shuffle:
+                if byte < 0: mask.append("-1")
+                else: mask.append(str(pixel % 4 * 4 + byte))
+        r += "         %s d = %s_shuffle_epi8(s, %s_setr_epi8(" % (vec, p, p)
+        for j in range(0, len(mask), 16):
+            r += "\n            " + ", ".join(mask[j:j + 16])
+            r += "," if j + 16 < len(mask) else "));\n"
+    else:
+        for shift, mask in ops:
+            term = "s"
+            if shift < 0 and mask >> -shift == (1 << (32 + shift)) - 1:
+                pass
+            elif shift > 0 and mask == (1 << (32 - shift)) - 1:
+                pass
+            else:
+                term = "%s_and_%s(s, %s_set1_epi32((int)0x%08x))" % (
+                    p, si, p, mask)
+            if shift > 0:
+                term = "%s_slli_epi32(%s, %d)" % (p, term, shift)
+            elif shift < 0:
+                term = "%s_srli_epi32(%s, %d)" % (p, term, -shift)
+            if not r:
+                r += "         %s d = %s;\n" % (vec, term)
+            else:
+                r += "         d = %s_or_%s(d,\n            %s);\n" % (
+                    p, si, term)
+    if add:
+        r += "         d = %s_or_%s(d, %s_set1_epi32((int)0x%08x));\n" % (
+            p, si, p, add)
+
+    if info_b.size == 32:
+        r += "         %s_storeu_%s((%s *)dst_ptr, d);\n" % (p, si, vec)
+    elif isa == "avx2":
+        r += """\
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+"""
+    else:
+        r += """\
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+"""
+    return r
+
+def simd_converter_function(isa, info_a, info_b, shuffle, ops, add):
+    """
+    Create a string with one SIMD conversion function. Pixels left over at
+    the end of each row are converted with the macro.
+    """
+    i = simd_isas[isa]
+    name = info_a.name.lower() + "_to_" + info_b.name.lower()
+    macro_name = "ALLEGRO_CONVERT_" + info_a.name + "_TO_" + info_b.name
+    b_type = "uint32_t" if info_b.size == 32 else "uint16_t"
+    b_size = 4 if info_b.size == 32 else 2
+    target = i["target"]
+    vec = i["vec"]
+    n = i["n"]
+    p = i["p"]
+    si = i["si"]
+    kernel = simd_kernel(isa, info_b, shuffle, ops, add)
+
+    return """\
+static %(target)svoid %(name)s_%(isa)s(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   %(b_type)s *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / %(b_size)d - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      %(b_type)s *dst_end = dst_ptr + width;
+      %(b_type)s *dst_vec_end = dst_ptr + (width & ~%(n_mask)d);
+      while (dst_ptr < dst_vec_end) {
+         %(vec)s s = %(p)s_loadu_%(si)s((const %(vec)s *)src_ptr);
+%(kernel)s\
+         dst_ptr += %(n)d;
+         src_ptr += %(n)d;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = %(macro_name)s(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+""" % dict(locals(), n_mask=n - 1)
+
+def write_simd_converters(f):
+    """
+    Write out the SIMD conversion functions and the function selecting
+    them at runtime.
+    """
+    f.write("""\
+
+/* The SIMD converters need a compiler which can build SSSE3 and AVX2 code
+ * into single functions, they are picked by _al_init_convert_funcs.
+ */
+#ifdef _AL_HAVE_AVX2
+#include <immintrin.h>
+""")
+    entries = []
+    for a in formats_list:
+        for b in formats_list:
+            if b == a: continue
+            conversion = simd_conversion(a, b)
+            if not conversion: continue
+            shuffle, ops, add = conversion
+            isa = "sse2" if shuffle is None else "ssse3"
+            for i in [isa, "avx2"]:
+                f.write(simd_converter_function(i, a, b, shuffle, ops, add))
+            entries.append((a, b, isa))
+
+    f.write("""\
+
+typedef void (*CONVERT_FUNC)(const void *, int, void *, int,
+   int, int, int, int, int, int);
+
+typedef struct SIMD_CONVERTER {
+   int src_format, dst_format;
+   int features;
+   CONVERT_FUNC portable, simd, avx2;
+} SIMD_CONVERTER;
+
+static const SIMD_CONVERTER simd_converters[] = {
+""")
+    for a, b, isa in entries:
+        name = a.name.lower() + "_to_" + b.name.lower()
+        f.write("""\
+   {ALLEGRO_PIXEL_FORMAT_%s, ALLEGRO_PIXEL_FORMAT_%s, _AL_CPU_%s,
+      %s, %s_%s, %s_avx2},
+""" % (a.name, b.name, isa.upper(), name, name, isa, name))
+    f.write("""\
+};
+#endif
+
+/* Internal function: _al_init_convert_funcs
+ *  Puts the SIMD converters the CPU supports into _al_convert_funcs.
+ */
+void _al_init_convert_funcs(void)
+{
+#ifdef _AL_HAVE_AVX2
+   int features = _al_get_cpu_features();
+   unsigned i;
+
+   for (i = 0; i < sizeof(simd_converters) / sizeof(*simd_converters); i++) {
+      const SIMD_CONVERTER *c = &simd_converters[i];
+      CONVERT_FUNC func = c->portable;
+      if (features & c->features)
+         func = c->simd;
+      if (features & _AL_CPU_AVX2)
+         func = c->avx2;
+      _al_convert_funcs[c->src_format][c->dst_format] = func;
+   }
+#endif
+}
+""")
+
 def write_convert_c(filename):
     """
     Write out the file with the conversion functions.
@@ -393,6 +630,7 @@ def write_convert_c(filename):
 #include "allegro5/allegro.h"
 #include "allegro5/internal/aintern_bitmap.h"
 #include "allegro5/internal/aintern_convert.h"
+#include "allegro5/internal/aintern_cpu.h"
 """)
 
     for a in formats_list:
@@ -426,6 +664,11 @@ void (*_al_convert_funcs[ALLEGRO_NUM_PIXEL_FORMATS]
 
     f.write("""\
 };
+""")
+
+    write_simd_converters(f)
+
+    f.write("""\
 
 // Warning: This file was created by make_converters.py - do not edit.
 """)
@@ -14,14 +14,50 @@ def interp(string):
       string = string.replace('#{%s}' % item, str(eval(item, globals, locals)))
    return string
 
-def make_drawer(name):
-   global texture, grad, solid, shade, opaque, white
+# Target formats which get drawers specialized at compile time. Textured
+# drawers are specialized for textures in the same format as the target.
+# The pixel size of each format is given.
+formats = [
+   ("ABGR_8888", 4),
+   ("ARGB_8888", 4),
+   ("RGB_565", 2),
+   ("SINGLE_CHANNEL_8", 1)
+   ]
+
+# Formats which the integer blenders handle.
+int8_formats = [
+   "ALLEGRO_PIXEL_FORMAT_ABGR_8888",
+   "ALLEGRO_PIXEL_FORMAT_ARGB_8888"
+   ]
+
+drawers = [
+   "shader_solid_any_draw_shade",
+   "shader_solid_any_draw_opaque",
+   "shader_grad_any_draw_shade",
+   "shader_grad_any_draw_opaque",
+   "shader_texture_solid_any_draw_shade",
+   "shader_texture_solid_any_draw_shade_white",
+   "shader_texture_solid_any_draw_opaque",
+   "shader_texture_solid_any_draw_opaque_white",
+   "shader_texture_grad_any_draw_shade",
+   "shader_texture_grad_any_draw_opaque"
+   ]
+
+# Textured drawers get a twin which filters the texture bilinearly.
+drawers += [name + "_linear" for name in drawers if "_texture_" in name]
+
+def specialized_name(name, format):
+   return name.replace("_any_", "_" + format.lower() + "_")
+
+def make_drawer(name, format=None, size=None):
+   global texture, grad, solid, shade, opaque, white, linear, int8_texel
    texture = "_texture_" in name
    grad = "_grad_" in name
    solid = "_solid_" in name
    shade = "_shade" in name
    opaque = "_opaque" in name
    white = "_white" in name
+   linear = "_linear" in name
 
    if grad and solid:
       raise Exception("grad and solid")
@@ -30,6 +66,14 @@ def make_drawer(name):
    if shade and opaque:
       raise Exception("shade and opaque")
 
+   if format:
+      name = specialized_name(name, format)
+      format = "ALLEGRO_PIXEL_FORMAT_" + format
+      size = str(size)
+
+   # Bilinear filtering of 8888 textures is done on the packed pixels.
+   int8_texel = linear and format in int8_formats
+
    print interp("static void #{name} (uintptr_t state, int x1, int y, int x2) {")
 
    if not texture:
@@ -105,16 +149,28 @@ def make_drawer(name):
       }
       """
 
+   # 8888 targets blend with integer arithmetic when the blender and the
+   # tint allow it. Only a constant tint is supported.
+   int8 = format in int8_formats and shade and not grad
+
    print "{"
    if shade:
       print """\
-      int op, src_mode, dst_mode;
-      int op_alpha, src_alpha, dst_alpha;
-      ALLEGRO_COLOR const_color;
-      al_get_separate_blender(&op, &src_mode, &dst_mode,
-         &op_alpha, &src_alpha, &dst_alpha);
-      const_color = al_get_blend_color();
+      const _AL_COMPILED_BLENDER *blender = _al_get_compiled_blender();
+      const _AL_BLEND_SPAN *blend_span = &blender->span;
       """
+      if int8:
+         if white:
+            tint = "NULL"
+         elif texture:
+            tint = "&s->cur_color"
+         else:
+            tint = "&cur_color"
+         print interp("""\
+      _AL_BLEND_SPAN_8888 blend_8888;
+      const bool int8 = _al_init_blend_span_8888(&blend_8888, #{format},
+         blender, #{tint});
+      """)
 
    print "{"
    if texture:
@@ -122,8 +178,17 @@ def make_drawer(name):
       const int offset_x = s->texture->parent ? s->texture->xofs : 0;
       const int offset_y = s->texture->parent ? s->texture->yofs : 0;
       ALLEGRO_BITMAP* texture = s->texture->parent ? s->texture->parent : s->texture;
+      """
+      if format:
+         print interp("""\
+      ASSERT(texture->locked_region.format == #{format});
+      """)
+      else:
+         print """\
       const int src_format = texture->locked_region.format;
       const int src_size = texture->locked_region.pixel_size;
+      """
+      print """\
 
       /* Ensure u in [0, s->w) and v in [0, s->h). */
       while (u < 0) u += s->w;
@@ -135,65 +200,40 @@ def make_drawer(name):
       """
 
    print "{"
-   print """\
+   if format:
+      print interp("""\
+      uint8_t *dst_data = (uint8_t *)target->lock_data
+         + y * target->locked_region.pitch
+         + x1 * #{size};
+      ASSERT(target->locked_region.format == #{format});
+      """)
+
+      if opaque and white and (int8_texel or not linear):
+         make_loop(copy_format=True, src_size=size, cond=False)
+      else:
+         if int8:
+            print "if (int8)"
+            make_loop(src_size=size, cond=False, int8=True)
+            print "else"
+         make_loop(src_format=format, dst_format=format, src_size=size,
+            cond=False)
+   else:
+      print """\
       const int dst_format = target->locked_region.format;
       uint8_t *dst_data = (uint8_t *)target->lock_data
          + y * target->locked_region.pitch
          + x1 * target->locked_region.pixel_size;
       """
 
-   if shade:
-      make_if_blender_loop(
-            op='ALLEGRO_ADD',
-            src_mode='ALLEGRO_ONE',
-            src_alpha='ALLEGRO_ONE',
-            op_alpha='ALLEGRO_ADD',
-            dst_mode='ALLEGRO_INVERSE_ALPHA',
-            dst_alpha='ALLEGRO_INVERSE_ALPHA',
-            const_color='NULL',
-            if_format='ALLEGRO_PIXEL_FORMAT_ARGB_8888',
-            alpha_only=True
-            )
-      print "else"
-      make_if_blender_loop(
-            op='ALLEGRO_ADD',
-            src_mode='ALLEGRO_ALPHA',
-            src_alpha='ALLEGRO_ALPHA',
-            op_alpha='ALLEGRO_ADD',
-            dst_mode='ALLEGRO_INVERSE_ALPHA',
-            dst_alpha='ALLEGRO_INVERSE_ALPHA',
-            const_color='NULL',
-            if_format='ALLEGRO_PIXEL_FORMAT_ARGB_8888',
-            alpha_only=True
-            )
-      print "else"
-      make_if_blender_loop(
-            op='ALLEGRO_ADD',
-            src_mode='ALLEGRO_ONE',
-            src_alpha='ALLEGRO_ONE',
-            op_alpha='ALLEGRO_ADD',
-            dst_mode='ALLEGRO_ONE',
-            dst_alpha='ALLEGRO_ONE',
-            const_color='NULL',
-            if_format='ALLEGRO_PIXEL_FORMAT_ARGB_8888',
-            alpha_only=True
-            )
-      print "else"
-
-   if opaque and white:
-      make_loop(copy_format=True, src_size='4')
-      print "else"
-      make_loop(copy_format=True, src_size='3')
-      print "else"
-      make_loop(copy_format=True, src_size='2')
-      print "else"
-   else:
-      make_loop(
-            if_format='ALLEGRO_PIXEL_FORMAT_ARGB_8888'
-            )
-      print "else"
+      if opaque and white and not linear:
+         make_loop(copy_format=True, src_size='4')
+         print "else"
+         make_loop(copy_format=True, src_size='3')
+         print "else"
+         make_loop(copy_format=True, src_size='2')
+         print "else"
 
-   make_loop()
+      make_loop()
 
    print """\
    }
@@ -202,77 +242,17 @@ def make_drawer(name):
    }
    """
 
-def make_if_blender_loop(
-      op='op',
-      src_mode='src_mode',
-      dst_mode='dst_mode',
-      op_alpha='op_alpha',
-      src_alpha='src_alpha',
-      dst_alpha='dst_alpha',
-      src_format='src_format',
-      dst_format='dst_format',
-      const_color='NULL',
-      if_format=None,
-      alpha_only=False
-      ):
-   print interp("""\
-      if (op == #{op} &&
-            src_mode == #{src_mode} &&
-            src_alpha == #{src_alpha} &&
-            op_alpha == #{op_alpha} &&
-            dst_mode == #{dst_mode} &&
-            dst_alpha == #{dst_alpha}) {
-      """)
-
-   if texture and if_format:
-      make_loop(
-            op=op,
-            src_mode=src_mode,
-            src_alpha=src_alpha,
-            op_alpha=op_alpha,
-            dst_mode=dst_mode,
-            dst_alpha=dst_alpha,
-            const_color=const_color,
-            if_format=if_format,
-            alpha_only=alpha_only
-            )
-      print "else"
-
-   make_loop(
-      op=op,
-      src_mode=src_mode,
-      src_alpha=src_alpha,
-      op_alpha=op_alpha,
-      dst_mode=dst_mode,
-      dst_alpha=dst_alpha,
-      const_color=const_color,
-      alpha_only=alpha_only)
-
-   print "}"
-
 def make_loop(
-      op='op',
-      src_mode='src_mode',
-      dst_mode='dst_mode',
-      op_alpha='op_alpha',
-      src_alpha='src_alpha',
-      dst_alpha='dst_alpha',
       src_format='src_format',
       dst_format='dst_format',
       src_size='src_size',
-      const_color='&const_color',
-      if_format=None,
       copy_format=False,
-      alpha_only=False
+      cond=True,
+      int8=False
       ):
 
-   if if_format:
-      src_format = if_format
-      dst_format = if_format
-      print interp("if (dst_format == #{dst_format}")
-      if texture:
-         print interp("&& src_format == #{src_format}")
-      print ")"
+   if not cond:
+      pass
    elif copy_format:
       assert opaque and white
       print interp("if (dst_format == src_format && src_size == #{src_size})")
@@ -287,7 +267,7 @@ def make_loop(
          const al_fixed dv_dx = al_ftofix(s->dv_dx);
          """
 
-      if opaque:
+      if opaque and not linear:
          # If texture coordinates never wrap around then we can simplify the
          # innermost loop. It doesn't seem to have so great an impact when the
          # loop is complicated by blending.
@@ -298,57 +278,58 @@ def make_loop(
             if (end_u >= 0 && end_u < s->w && end_v >= 0 && end_v < s->h) {
             """
          make_innermost_loop(
-            op=op,
-            src_mode=src_mode,
-            dst_mode=dst_mode,
-            op_alpha=op_alpha,
-            src_alpha=src_alpha,
-            dst_alpha=dst_alpha,
             src_format=src_format,
             dst_format=dst_format,
-            const_color=const_color,
             src_size=src_size,
             copy_format=copy_format,
-            tiling=False,
-            alpha_only=alpha_only
+            tiling=False
             )
          print "} else"
 
    make_innermost_loop(
-      op=op,
-      src_mode=src_mode,
-      dst_mode=dst_mode,
-      op_alpha=op_alpha,
-      src_alpha=src_alpha,
-      dst_alpha=dst_alpha,
       src_format=src_format,
       dst_format=dst_format,
-      const_color=const_color,
       src_size=src_size,
       copy_format=copy_format,
-      alpha_only=alpha_only
+      int8=int8
       )
 
    print "}"
 
 def make_innermost_loop(
-      op='op',
-      src_mode='src_mode',
-      dst_mode='dst_mode',
-      op_alpha='op_alpha',
-      src_alpha='src_alpha',
-      dst_alpha='dst_alpha',
       src_format='src_format',
       dst_format='dst_format',
-      const_color='&const_color',
       src_size='src_size',
       copy_format=False,
       tiling=True,
-      alpha_only=True
+      int8=False
       ):
 
+   # When blending, the source colors and destination pixels of up to
+   # _AL_BLEND_SPAN_SIZE pixels are gathered first, then blended as a span.
+   # The integer blenders only need the source pixels gathered, and nothing
+   # at all for a solid color.
+   span = shade and not copy_format
+
    print "{"
 
+   # A solid color is written as a raw pixel pattern with wide stores.
+   if opaque and not texture and not grad:
+      print interp("""\
+         uint32_t pixel[4];
+         uint8_t *pixel_data = (uint8_t *)pixel;
+         _AL_INLINE_PUT_PIXEL(#{dst_format}, pixel_data, cur_color, false);
+         _al_fill_pixels(dst_data, pixel, target->locked_region.pixel_size,
+            x2 - x1 + 1, false);
+      }""")
+      return
+
+   if int8 and not texture:
+      print """\
+         blend_8888.blend(&blend_8888, (uint32_t *)dst_data, NULL, x2 - x1 + 1);
+      }"""
+      return
+
    if texture:
       # In non-tiling mode we can hoist offsets out of the loop.
       if tiling:
@@ -360,6 +341,11 @@ def make_innermost_loop(
             const al_fixed w = al_ftofix(s->w);
             const al_fixed h = al_ftofix(s->h);
             """
+         if linear:
+            print """\
+            int tx0, tx1, ty0, ty1, fx, fy;
+            uint8_t *row0, *row1;
+            """
          uu_ofs = "uu_ofs"
          vv_ofs = "vv_ofs"
       else:
@@ -369,12 +355,76 @@ def make_innermost_loop(
             """
          uu_ofs = vv_ofs = "0"
 
-   print "for (; x1 <= x2; x1++) {"
+   if int8:
+      print """\
+         uint32_t src_span[_AL_BLEND_SPAN_SIZE];
+         while (x1 <= x2) {
+            const int span_n = _ALLEGRO_MIN(x2 - x1 + 1, _AL_BLEND_SPAN_SIZE);
+            int i;
+            for (i = 0; i < span_n; i++, x1++) {
+         """
+   elif span:
+      print """\
+         ALLEGRO_COLOR src_span[_AL_BLEND_SPAN_SIZE];
+         ALLEGRO_COLOR dst_span[_AL_BLEND_SPAN_SIZE];
+         while (x1 <= x2) {
+            const int span_n = _ALLEGRO_MIN(x2 - x1 + 1, _AL_BLEND_SPAN_SIZE);
+            uint8_t *span_data = dst_data;
+            int i;
+            for (i = 0; i < span_n; i++, x1++) {
+         """
+   else:
+      print "for (; x1 <= x2; x1++) {"
 
    if not texture:
       print """\
          ALLEGRO_COLOR src_color = cur_color;
          """
+   elif linear:
+      print interp("""\
+         linear_texel(uu, s->w, &tx0, &tx1, &fx);
+         linear_texel(vv, s->h, &ty0, &ty1, &fy);
+         row0 = lock_data + (ty0 + #{vv_ofs}) * src_pitch;
+         row1 = lock_data + (ty1 + #{vv_ofs}) * src_pitch;
+         tx0 += #{uu_ofs};
+         tx1 += #{uu_ofs};
+         """)
+
+      if int8_texel:
+         print """\
+            uint32_t texel = linear_texel_8888(row0, row1, tx0, tx1, fx, fy);
+            """
+         if copy_format:
+            print """\
+            uint8_t *src_data = (uint8_t *)&texel;
+            """
+         elif int8:
+            print """\
+            src_span[i] = texel;
+            """
+         else:
+            print interp("""\
+            uint8_t *src_data = (uint8_t *)&texel;
+            ALLEGRO_COLOR src_color;
+            _AL_INLINE_GET_PIXEL(#{src_format}, src_data, src_color, false);
+            """)
+      else:
+         print interp("""\
+            ALLEGRO_COLOR src_color;
+            LINEAR_TEXEL_COLOR(#{src_format}, #{src_size}, row0, row1, tx0, tx1,
+               fx, fy, src_color);
+            """)
+
+      if copy_format or int8:
+         pass
+      elif grad:
+         print """\
+            SHADE_COLORS(src_color, cur_color);
+            """
+      elif not white:
+         print """\
+            SHADE_COLORS(src_color, s->cur_color);
+            """
    else:
       print interp("""\
          const int src_x = (uu >> 16) + #{uu_ofs};
@@ -386,6 +436,10 @@ def make_innermost_loop(
 
       if copy_format:
          pass
+      elif int8:
+         print """\
+            src_span[i] = *(uint32_t *)src_data;
+            """
       else:
          print interp("""\
             ALLEGRO_COLOR src_color;
@@ -420,21 +474,12 @@ def make_innermost_loop(
                break;
          }
          """)
+   elif int8:
+      pass
    elif shade:
-      blend = "_al_blend_inline"
-      if alpha_only:
-         blend = "_al_blend_alpha_inline"
       print interp("""\
-         {
-            ALLEGRO_COLOR dst_color;
-            ALLEGRO_COLOR result;
-            _AL_INLINE_GET_PIXEL(#{dst_format}, dst_data, dst_color, false);
-            #{blend}(&src_color, &dst_color,
-               #{op}, #{src_mode}, #{dst_mode},
-               #{op_alpha}, #{src_alpha}, #{dst_alpha},
-               #{const_color}, &result);
-            _AL_INLINE_PUT_PIXEL(#{dst_format}, dst_data, result, true);
-         }
+         src_span[i] = src_color;
+         _AL_INLINE_GET_PIXEL(#{dst_format}, dst_data, dst_span[i], true);
          """)
    else:
       print interp("""\
@@ -468,10 +513,45 @@ def make_innermost_loop(
          cur_color.a += gs->color_dx.a;
          """
 
+   if int8:
+      print """\
+            }
+            blend_8888.blend(&blend_8888, (uint32_t *)dst_data, src_span,
+               span_n);
+            dst_data += span_n * 4;"""
+   elif span:
+      print interp("""\
+            }
+            blend_span->blend(blend_span, src_span, dst_span, span_n);
+            for (i = 0; i < span_n; i++) {
+               _AL_INLINE_PUT_PIXEL(#{dst_format}, span_data, dst_span[i], true);
+            }""")
+
    print """\
       }
    }"""
 
+def make_selector(name):
+   texture = "_texture_" in name
+   print interp("""\
+static shader_draw select_#{name}(int dst_format, int src_format) {
+   """)
+   if texture:
+      print "if (src_format == dst_format)"
+   else:
+      print "(void)src_format;"
+   print "switch (dst_format) {"
+   for format, size in formats:
+      print interp("""\
+      case ALLEGRO_PIXEL_FORMAT_#{format}:
+         return #{specialized_name(name, format)};
+      """)
+   print interp("""\
+   }
+   return #{name};
+}
+""")
+
 if __name__ == "__main__":
    print """\
 // Warning: This file was created by make_scanline_drawers.py - do not edit.
@@ -483,18 +563,14 @@ if __name__ == "__main__":
 #endif
 """
 
-   make_drawer("shader_solid_any_draw_shade")
-   make_drawer("shader_solid_any_draw_opaque")
-
-   make_drawer("shader_grad_any_draw_shade")
-   make_drawer("shader_grad_any_draw_opaque")
+   for name in drawers:
+      make_drawer(name)
 
-   make_drawer("shader_texture_solid_any_draw_shade")
-   make_drawer("shader_texture_solid_any_draw_shade_white")
-   make_drawer("shader_texture_solid_any_draw_opaque")
-   make_drawer("shader_texture_solid_any_draw_opaque_white")
+   for format, size in formats:
+      for name in drawers:
+         make_drawer(name, format, size)
 
-   make_drawer("shader_texture_grad_any_draw_shade")
-   make_drawer("shader_texture_grad_any_draw_opaque")
+   for name in drawers:
+      make_selector(name)
 
 # vim: set sts=3 sw=3 et:
@@ -24,9 +24,12 @@
 #include "allegro5/internal/aintern.h"
 #include "allegro5/internal/aintern_bitmap.h"
 #include "allegro5/internal/aintern_display.h"
+#include "allegro5/internal/aintern_memblit.h"
+#include "allegro5/internal/aintern_parallel.h"
 #include "allegro5/internal/aintern_pixels.h"
 #include "allegro5/internal/aintern_shader.h"
 #include "allegro5/internal/aintern_system.h"
+#include "allegro5/internal/aintern_tri_soft.h"
 
 ALLEGRO_DEBUG_CHANNEL("bitmap")
 
@@ -34,7 +37,7 @@ ALLEGRO_DEBUG_CHANNEL("bitmap")
 /* Creates a memory bitmap.
  */
 static ALLEGRO_BITMAP *create_memory_bitmap(ALLEGRO_DISPLAY *current_display,
-   int w, int h, int format, int flags)
+   int w, int h, int format, int flags, int depth)
 {
    ALLEGRO_BITMAP *bitmap;
    int pitch;
@@ -48,7 +51,7 @@ static ALLEGRO_BITMAP *create_memory_bitmap(ALLEGRO_DISPLAY *current_display,
 
    bitmap = al_calloc(1, sizeof *bitmap);
 
-   pitch = w * al_get_pixel_size(format);
+   pitch = _al_get_bitmap_memory_pitch(w, al_get_pixel_size(format));
 
    bitmap->vt = NULL;
    bitmap->_format = format;
@@ -73,7 +76,14 @@ static ALLEGRO_BITMAP *create_memory_bitmap(ALLEGRO_DISPLAY *current_display,
    al_orthographic_transform(&bitmap->proj_transform, 0, 0, -1.0, w, h, 1.0);
    bitmap->parent = NULL;
    bitmap->xofs = bitmap->yofs = 0;
-   bitmap->memory = al_malloc(pitch * h);
+   bitmap->memory = _al_alloc_bitmap_memory((size_t)pitch * h);
+   bitmap->_depth = depth;
+
+   if (depth > 0 && !_al_create_bitmap_depth_buffer(bitmap)) {
+      _al_free_bitmap_memory(bitmap->memory);
+      al_free(bitmap);
+      return NULL;
+   }
    
    _al_register_convert_bitmap(bitmap);
    return bitmap;
@@ -85,8 +95,7 @@ static void destroy_memory_bitmap(ALLEGRO_BITMAP *bmp)
 {
    _al_unregister_convert_bitmap(bmp);
 
-   if (bmp->memory)
-      al_free(bmp->memory);
+   _al_free_bitmap_memory(bmp->memory);
    al_free(bmp);
 }
 
@@ -119,7 +128,7 @@ ALLEGRO_BITMAP *_al_create_bitmap_params(ALLEGRO_DISPLAY *current_display,
       if (flags & ALLEGRO_VIDEO_BITMAP)
          return NULL;
 
-      return create_memory_bitmap(current_display, w, h, format, flags);
+      return create_memory_bitmap(current_display, w, h, format, flags, depth);
    }
 
    /* Else it's a display bitmap */
@@ -166,7 +175,7 @@ ALLEGRO_BITMAP *_al_create_bitmap_params(ALLEGRO_DISPLAY *current_display,
       /* With ALLEGRO_CONVERT_BITMAP, just use a memory bitmap instead if
       * video failed.
       */
-      return create_memory_bitmap(current_display, w, h, format, flags);
+      return create_memory_bitmap(current_display, w, h, format, flags, depth);
    }
    
    /* We keep a list of bitmaps depending on the current display so that we can
@@ -204,6 +213,9 @@ void al_destroy_bitmap(ALLEGRO_BITMAP *bitmap)
       return;
    }
 
+   _al_flush_held_memory_blits_for(bitmap);
+   _al_flush_tiled_triangles_for(bitmap, true);
+
    /* As a convenience, implicitly untarget the bitmap on the calling thread
     * before it is destroyed, but maintain the current display.
     */
@@ -221,6 +233,11 @@ void al_destroy_bitmap(ALLEGRO_BITMAP *bitmap)
 
    if (!al_is_sub_bitmap(bitmap)) {
       ALLEGRO_DISPLAY* disp = _al_get_bitmap_display(bitmap);
+      _al_destroy_bitmap_mipmaps(bitmap);
+      _al_destroy_bitmap_rle(bitmap);
+      _al_destroy_bitmap_dirty_tiles(bitmap);
+      _al_destroy_bitmap_lock_buffer(bitmap);
+      _al_destroy_bitmap_depth_buffer(bitmap);
       if (al_get_bitmap_flags(bitmap) & ALLEGRO_MEMORY_BITMAP) {
          destroy_memory_bitmap(bitmap);
          return;
@@ -591,7 +608,26 @@ static bool transfer_bitmap_data(ALLEGRO_BITMAP *src, ALLEGRO_BITMAP *dst)
 }
 
 
-void _al_copy_bitmap_data(
+/* Conversions and copies are split into bands of rows for the worker pool
+ * if each band gets at least this many pixels.
+ */
+#define MIN_BAND_PIXELS  (256 * 256)
+
+/* The [graphics] convert_threads config key, see _al_init_bitmap_conversion. */
+static int convert_threads = 0;
+
+
+typedef struct CONVERT_JOB {
+   const char *src;
+   int src_format, src_pitch;
+   char *dst;
+   int dst_format, dst_pitch;
+   int sx, sy, dx, dy, width, height;
+   int band_rows;
+} CONVERT_JOB;
+
+
+static void copy_bitmap_data(
    const void *src, int src_pitch, void *dst, int dst_pitch,
    int sx, int sy, int dx, int dy, int width, int height,
    int format)
@@ -630,6 +666,92 @@ void _al_copy_bitmap_data(
    }
 }
 
+
+static void convert_band(int band, void *arg)
+{
+   const CONVERT_JOB *job = arg;
+   int y = band * job->band_rows;
+   int h = _ALLEGRO_MIN(job->band_rows, job->height - y);
+
+   if (job->src_format == job->dst_format) {
+      copy_bitmap_data(job->src, job->src_pitch, job->dst, job->dst_pitch,
+         job->sx, job->sy + y, job->dx, job->dy + y, job->width, h,
+         job->src_format);
+   }
+   else {
+      (_al_convert_funcs[job->src_format][job->dst_format])(
+         job->src, job->src_pitch, job->dst, job->dst_pitch,
+         job->sx, job->sy + y, job->dx, job->dy + y, job->width, h);
+   }
+}
+
+
+/* Splits a large conversion or copy into bands of rows for the worker pool,
+ * using up to as many threads as the [graphics] convert_threads config key
+ * says. Returns false if it should be done on this thread instead.
+ */
+static bool convert_in_bands(
+   const void *src, int src_format, int src_pitch,
+   void *dst, int dst_format, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   const int64_t pixels = (int64_t)width * height;
+   int block_height = al_get_pixel_block_height(src_format);
+   int bands, rows;
+   CONVERT_JOB job;
+
+   if (convert_threads < 2 || pixels < 2 * MIN_BAND_PIXELS)
+      return false;
+
+   bands = (int)_ALLEGRO_MIN(convert_threads, pixels / MIN_BAND_PIXELS);
+
+   rows = (height + bands - 1) / bands;
+   rows = (rows + block_height - 1) / block_height * block_height;
+   bands = (height + rows - 1) / rows;
+
+   job.src = src;
+   job.src_format = src_format;
+   job.src_pitch = src_pitch;
+   job.dst = dst;
+   job.dst_format = dst_format;
+   job.dst_pitch = dst_pitch;
+   job.sx = sx;
+   job.sy = sy;
+   job.dx = dx;
+   job.dy = dy;
+   job.width = width;
+   job.height = height;
+   job.band_rows = rows;
+
+   _al_parallel_for(bands, convert_threads, convert_band, &job);
+   return true;
+}
+
+
+/* Internal function: _al_init_bitmap_conversion
+ *  Reads the [graphics] convert_threads config key.
+ */
+void _al_init_bitmap_conversion(void)
+{
+   convert_threads = _al_parse_thread_count(al_get_config_value(
+      al_get_system_config(), "graphics", "convert_threads"));
+}
+
+
+void _al_copy_bitmap_data(
+   const void *src, int src_pitch, void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height,
+   int format)
+{
+   if (convert_in_bands(src, format, src_pitch, dst, format, dst_pitch,
+         sx, sy, dx, dy, width, height))
+      return;
+
+   copy_bitmap_data(src, src_pitch, dst, dst_pitch, sx, sy, dx, dy,
+      width, height, format);
+}
+
+
 void _al_convert_bitmap_data(
    const void *src, int src_format, int src_pitch,
    void *dst, int dst_format, int dst_pitch,
@@ -651,6 +773,10 @@ void _al_convert_bitmap_data(
    ASSERT(!_al_pixel_format_is_video_only(src_format));
    ASSERT(!_al_pixel_format_is_video_only(dst_format));
 
+   if (convert_in_bands(src, src_format, src_pitch, dst, dst_format,
+         dst_pitch, sx, sy, dx, dy, width, height))
+      return;
+
    (_al_convert_funcs[src_format][dst_format])(src, src_pitch,
       dst, dst_pitch, sx, sy, dx, dy, width, height);
 }
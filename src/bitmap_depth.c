@@ -0,0 +1,100 @@
+/*         ______   ___    ___
+ *        /\  _  \ /\_ \  /\_ \
+ *        \ \ \L\ \\//\ \ \//\ \      __     __   _ __   ___
+ *         \ \  __ \ \ \ \  \ \ \   /'__`\ /'_ `\/\`'__\/ __`\
+ *          \ \ \/\ \ \_\ \_ \_\ \_/\  __//\ \L\ \ \ \//\ \L\ \
+ *           \ \_\ \_\/\____\/\____\ \____\ \____ \ \_\\ \____/
+ *            \/_/\/_/\/____/\/____/\/____/\/___L\ \/_/ \/___/
+ *                                           /\____/
+ *                                           \_/__/
+ *
+ *      Depth buffers of memory bitmaps.
+ *
+ *      Memory bitmaps created with a depth set by al_set_new_bitmap_depth
+ *      get a depth buffer with one value per pixel, which the software
+ *      rasterizer tests and updates as the render state says, see
+ *      tri_soft.c.
+ *
+ *      See LICENSE.txt for copyright information.
+ */
+
+
+#include "allegro5/allegro.h"
+#include "allegro5/internal/aintern.h"
+#include "allegro5/internal/aintern_bitmap.h"
+
+ALLEGRO_DEBUG_CHANNEL("bitmap")
+
+
+static size_t depth_size(ALLEGRO_BITMAP *bitmap)
+{
+   return al_get_bitmap_depth(bitmap) <= 16 ? sizeof(uint16_t) : sizeof(float);
+}
+
+
+/* Internal function: _al_create_bitmap_depth_buffer
+ *  Allocates the depth buffer of a memory bitmap with a depth, cleared to
+ *  the far end. Returns false if there was not enough memory.
+ */
+bool _al_create_bitmap_depth_buffer(ALLEGRO_BITMAP *bitmap)
+{
+   ASSERT(!bitmap->parent);
+   ASSERT(al_get_bitmap_depth(bitmap) > 0);
+
+   bitmap->depth_buffer = al_malloc(depth_size(bitmap) * bitmap->w * bitmap->h);
+   if (!bitmap->depth_buffer) {
+      ALLEGRO_ERROR("Failed to allocate the depth buffer.\n");
+      return false;
+   }
+
+   _al_clear_bitmap_depth_buffer(bitmap, 1.0f);
+   return true;
+}
+
+
+/* Internal function: _al_destroy_bitmap_depth_buffer
+ */
+void _al_destroy_bitmap_depth_buffer(ALLEGRO_BITMAP *bitmap)
+{
+   al_free(bitmap->depth_buffer);
+   bitmap->depth_buffer = NULL;
+}
+
+
+/* Internal function: _al_clear_bitmap_depth_buffer
+ *  Sets the depth buffer of a memory bitmap, or the part of the one of its
+ *  parent it covers, to z inside the clipping rectangle.
+ */
+void _al_clear_bitmap_depth_buffer(ALLEGRO_BITMAP *bitmap, float z)
+{
+   ALLEGRO_BITMAP *parent = bitmap->parent ? bitmap->parent : bitmap;
+   const int xofs = bitmap->parent ? bitmap->xofs : 0;
+   const int yofs = bitmap->parent ? bitmap->yofs : 0;
+   const int x1 = bitmap->cl + xofs;
+   const int y1 = bitmap->ct + yofs;
+   const int w = bitmap->cr_excl - bitmap->cl;
+   const int h = bitmap->cb_excl - bitmap->ct;
+   int x, y;
+
+   if (!parent->depth_buffer || w <= 0 || h <= 0)
+      return;
+
+   if (depth_size(parent) == sizeof(uint16_t)) {
+      const uint16_t value = _al_depth_to_16(z);
+      for (y = y1; y < y1 + h; y++) {
+         uint16_t *row = (uint16_t *)parent->depth_buffer + y * parent->w;
+         for (x = x1; x < x1 + w; x++)
+            row[x] = value;
+      }
+   }
+   else {
+      for (y = y1; y < y1 + h; y++) {
+         float *row = (float *)parent->depth_buffer + y * parent->w;
+         for (x = x1; x < x1 + w; x++)
+            row[x] = z;
+      }
+   }
+}
+
+
+/* vim: set sts=3 sw=3 et: */
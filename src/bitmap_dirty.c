@@ -0,0 +1,261 @@
+/*         ______   ___    ___
+ *        /\  _  \ /\_ \  /\_ \
+ *        \ \ \L\ \\//\ \ \//\ \      __     __   _ __   ___
+ *         \ \  __ \ \ \ \  \ \ \   /'__`\ /'_ `\/\`'__\/ __`\
+ *          \ \ \/\ \ \_\ \_ \_\ \_/\  __//\ \L\ \ \ \//\ \L\ \
+ *           \ \_\ \_\/\____\/\____\ \____\ \____ \ \_\\ \____/
+ *            \/_/\/_/\/____/\/____/\/____/\/___L\ \/_/ \/___/
+ *                                           /\____/
+ *                                           \_/__/
+ *
+ *      Tracking of the changed parts of memory bitmaps.
+ *
+ *      Each memory bitmap is divided into square tiles, and every write
+ *      to it marks the tiles it may touch. The marks are only kept once
+ *      al_reset_bitmap_dirty_rectangles was called on the bitmap; before
+ *      that all of it counts as changed.
+ *
+ *      See LICENSE.txt for copyright information.
+ */
+
+
+#include <string.h>
+#include "allegro5/allegro.h"
+#include "allegro5/internal/aintern.h"
+#include "allegro5/internal/aintern_bitmap.h"
+#include "allegro5/internal/aintern_vector.h"
+
+
+#define TILE_SIZE  32
+
+typedef struct DIRTY_RECT {
+   /* In tiles, exclusive at the end. */
+   int x1, y1, x2, y2;
+} DIRTY_RECT;
+
+
+static int tiles_across(ALLEGRO_BITMAP *bitmap)
+{
+   return (bitmap->w + TILE_SIZE - 1) / TILE_SIZE;
+}
+
+
+static int tiles_down(ALLEGRO_BITMAP *bitmap)
+{
+   return (bitmap->h + TILE_SIZE - 1) / TILE_SIZE;
+}
+
+
+/* Clips a rectangle to the bitmap. Returns false if nothing is left. */
+static bool clip_to_bitmap(ALLEGRO_BITMAP *bitmap, int *x, int *y,
+   int *w, int *h)
+{
+   int x2 = _ALLEGRO_MIN(*x + *w, bitmap->w);
+   int y2 = _ALLEGRO_MIN(*y + *h, bitmap->h);
+
+   *x = _ALLEGRO_MAX(*x, 0);
+   *y = _ALLEGRO_MAX(*y, 0);
+   *w = x2 - *x;
+   *h = y2 - *y;
+   return *w > 0 && *h > 0;
+}
+
+
+/* Internal function: _al_mark_bitmap_written
+ *  Records that the given rectangle of a bitmap is about to be written to,
+ *  which makes its mipmaps, its runs, its converted copy and its dirty
+ *  rectangles out of date.
+ */
+void _al_mark_bitmap_written(ALLEGRO_BITMAP *bitmap, int x, int y,
+   int w, int h)
+{
+   int across;
+   int tx1, ty1, tx2, ty2;
+   int ty;
+
+   if (bitmap->parent) {
+      x += bitmap->xofs;
+      y += bitmap->yofs;
+      bitmap = bitmap->parent;
+   }
+
+   bitmap->mipmaps_dirty = true;
+   bitmap->rle_dirty = true;
+   bitmap->lock_buffer_format = 0;
+
+   if (!bitmap->dirty_tiles || !clip_to_bitmap(bitmap, &x, &y, &w, &h))
+      return;
+
+   across = tiles_across(bitmap);
+   tx1 = x / TILE_SIZE;
+   ty1 = y / TILE_SIZE;
+   tx2 = (x + w - 1) / TILE_SIZE;
+   ty2 = (y + h - 1) / TILE_SIZE;
+   for (ty = ty1; ty <= ty2; ty++)
+      memset(bitmap->dirty_tiles + ty * across + tx1, 1, tx2 - tx1 + 1);
+}
+
+
+/* Collects the dirty tiles within the given tile rectangle into rectangles,
+ * joining runs of tiles in a row and runs of the same width in consecutive
+ * rows.
+ */
+static void collect_rects(ALLEGRO_BITMAP *bitmap, int tx1, int ty1,
+   int tx2, int ty2, _AL_VECTOR *rects)
+{
+   const int across = tiles_across(bitmap);
+   unsigned int first_open = 0;
+   int tx, ty;
+
+   for (ty = ty1; ty < ty2; ty++) {
+      const uint8_t *row = bitmap->dirty_tiles + ty * across;
+      const unsigned int num_open = _al_vector_size(rects);
+
+      for (tx = tx1; tx < tx2; tx++) {
+         DIRTY_RECT *r = NULL;
+         unsigned int i;
+         int start;
+
+         if (!row[tx])
+            continue;
+         start = tx;
+         while (tx < tx2 && row[tx])
+            tx++;
+
+         /* Rectangles which reached the previous row may be extended. */
+         for (i = first_open; i < num_open; i++) {
+            DIRTY_RECT *open = _al_vector_ref(rects, i);
+            if (open->y2 == ty && open->x1 == start && open->x2 == tx) {
+               r = open;
+               break;
+            }
+         }
+         if (r) {
+            r->y2 = ty + 1;
+         }
+         else {
+            r = _al_vector_alloc_back(rects);
+            r->x1 = start;
+            r->y1 = ty;
+            r->x2 = tx;
+            r->y2 = ty + 1;
+         }
+      }
+
+      /* Skip past the rectangles which can not be extended anymore. */
+      while (first_open < _al_vector_size(rects)) {
+         DIRTY_RECT *r = _al_vector_ref(rects, first_open);
+         if (r->y2 == ty + 1)
+            break;
+         first_open++;
+      }
+   }
+}
+
+
+/* Function: al_get_bitmap_dirty_rectangles
+ */
+int al_get_bitmap_dirty_rectangles(ALLEGRO_BITMAP *bitmap, int *rects,
+   int max_rects)
+{
+   ALLEGRO_BITMAP *parent = bitmap->parent ? bitmap->parent : bitmap;
+   int x = bitmap->parent ? bitmap->xofs : 0;
+   int y = bitmap->parent ? bitmap->yofs : 0;
+   int w = bitmap->w;
+   int h = bitmap->h;
+   _AL_VECTOR tiles = _AL_VECTOR_INITIALIZER(DIRTY_RECT);
+   int n = 0;
+   unsigned int i;
+
+   ASSERT(rects || max_rects == 0);
+
+   if (!clip_to_bitmap(parent, &x, &y, &w, &h))
+      return 0;
+
+   if (!parent->dirty_tiles) {
+      if (max_rects > 0) {
+         rects[0] = x - (bitmap->parent ? bitmap->xofs : 0);
+         rects[1] = y - (bitmap->parent ? bitmap->yofs : 0);
+         rects[2] = w;
+         rects[3] = h;
+      }
+      return 1;
+   }
+
+   collect_rects(parent, x / TILE_SIZE, y / TILE_SIZE,
+      (x + w - 1) / TILE_SIZE + 1, (y + h - 1) / TILE_SIZE + 1, &tiles);
+
+   for (i = 0; i < _al_vector_size(&tiles); i++) {
+      const DIRTY_RECT *r = _al_vector_ref(&tiles, i);
+      int x1 = _ALLEGRO_MAX(r->x1 * TILE_SIZE, x);
+      int y1 = _ALLEGRO_MAX(r->y1 * TILE_SIZE, y);
+      int x2 = _ALLEGRO_MIN(r->x2 * TILE_SIZE, x + w);
+      int y2 = _ALLEGRO_MIN(r->y2 * TILE_SIZE, y + h);
+
+      if (n < max_rects) {
+         int *out = rects + n * 4;
+         out[0] = x1 - (bitmap->parent ? bitmap->xofs : 0);
+         out[1] = y1 - (bitmap->parent ? bitmap->yofs : 0);
+         out[2] = x2 - x1;
+         out[3] = y2 - y1;
+      }
+      n++;
+   }
+
+   _al_vector_free(&tiles);
+   return n;
+}
+
+
+/* Function: al_reset_bitmap_dirty_rectangles
+ */
+void al_reset_bitmap_dirty_rectangles(ALLEGRO_BITMAP *bitmap)
+{
+   ALLEGRO_BITMAP *parent = bitmap->parent ? bitmap->parent : bitmap;
+   int x = bitmap->parent ? bitmap->xofs : 0;
+   int y = bitmap->parent ? bitmap->yofs : 0;
+   int w = bitmap->w;
+   int h = bitmap->h;
+   int across = tiles_across(parent);
+   int tx1, ty1, tx2, ty2;
+   int ty;
+
+   /* Only the CPU writes to memory bitmaps, so only they are tracked. */
+   if (!(parent->_flags & ALLEGRO_MEMORY_BITMAP))
+      return;
+
+   if (!clip_to_bitmap(parent, &x, &y, &w, &h))
+      return;
+
+   if (!parent->dirty_tiles) {
+      parent->dirty_tiles = al_malloc(across * tiles_down(parent));
+      if (!parent->dirty_tiles)
+         return;
+      memset(parent->dirty_tiles, 1, across * tiles_down(parent));
+   }
+
+   /* Only tiles entirely within a sub-bitmap are reset, as the rest of a
+    * partly covered tile may have changed as well. The tiles on the right
+    * and bottom edge of the parent extend past it.
+    */
+   tx1 = (x + TILE_SIZE - 1) / TILE_SIZE;
+   ty1 = (y + TILE_SIZE - 1) / TILE_SIZE;
+   tx2 = (x + w == parent->w) ? across : (x + w) / TILE_SIZE;
+   ty2 = (y + h == parent->h) ? tiles_down(parent) : (y + h) / TILE_SIZE;
+   for (ty = ty1; ty < ty2; ty++) {
+      if (tx2 > tx1)
+         memset(parent->dirty_tiles + ty * across + tx1, 0, tx2 - tx1);
+   }
+}
+
+
+/* Internal function: _al_destroy_bitmap_dirty_tiles
+ *  Frees the dirty tiles of a bitmap, if it has any.
+ */
+void _al_destroy_bitmap_dirty_tiles(ALLEGRO_BITMAP *bitmap)
+{
+   al_free(bitmap->dirty_tiles);
+   bitmap->dirty_tiles = NULL;
+}
+
+/* vim: set sts=3 sw=3 et: */
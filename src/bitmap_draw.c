@@ -108,9 +108,12 @@ static void _draw_tinted_rotated_scaled_bitmap_region(ALLEGRO_BITMAP *bitmap,
       flags &= ~ALLEGRO_FLIP_VERTICAL;
    }
 
+   /* Plain blits are drawn a lot, so skip the identity steps. */
    al_translate_transform(&t, -cx, -cy);
-   al_scale_transform(&t, xscale, yscale);
-   al_rotate_transform(&t, angle);
+   if (xscale != 1 || yscale != 1)
+      al_scale_transform(&t, xscale, yscale);
+   if (angle != 0)
+      al_rotate_transform(&t, angle);
    al_translate_transform(&t, dx, dy);
    al_compose_transform(&t, &backup);
 
@@ -17,7 +17,25 @@
 #include "allegro5/allegro.h"
 #include "allegro5/internal/aintern.h"
 #include "allegro5/internal/aintern_bitmap.h"
+#include "allegro5/internal/aintern_memblit.h"
 #include "allegro5/internal/aintern_pixels.h"
+#include "allegro5/internal/aintern_tri_soft.h"
+
+
+/* Makes the lock buffer of a memory bitmap hold at least size bytes. Any
+ * converted copy in it is lost.
+ */
+static bool get_lock_buffer(ALLEGRO_BITMAP *bitmap, size_t size)
+{
+   bitmap->lock_buffer_format = 0;
+   if (bitmap->lock_buffer_size >= size)
+      return true;
+
+   al_free(bitmap->lock_buffer);
+   bitmap->lock_buffer = al_malloc(size);
+   bitmap->lock_buffer_size = bitmap->lock_buffer ? size : 0;
+   return bitmap->lock_buffer != NULL;
+}
 
 
 /* Function: al_lock_bitmap_region
@@ -41,6 +59,12 @@ ALLEGRO_LOCKED_REGION *al_lock_bitmap_region(ALLEGRO_BITMAP *bitmap,
       ASSERT(al_get_pixel_block_height(format) == 1);
    }
 
+   /* Drawing which was held or queued for the tiled rasterizer must be
+    * done first.
+    */
+   _al_flush_held_memory_blits_for(bitmap);
+   _al_flush_tiled_triangles_for(bitmap, !(flags & ALLEGRO_LOCK_READONLY));
+
    /* For sub-bitmaps */
    if (bitmap->parent) {
       x += bitmap->xofs;
@@ -55,6 +79,9 @@ ALLEGRO_LOCKED_REGION *al_lock_bitmap_region(ALLEGRO_BITMAP *bitmap,
          !(flags & ALLEGRO_LOCK_READONLY))
       bitmap->dirty = true;
 
+   if (!(flags & ALLEGRO_LOCK_READONLY))
+      _al_mark_bitmap_written(bitmap, x, y, width, height);
+
    ASSERT(x+width <= bitmap->w);
    ASSERT(y+height <= bitmap->h);
 
@@ -90,9 +117,39 @@ ALLEGRO_LOCKED_REGION *al_lock_bitmap_region(ALLEGRO_BITMAP *bitmap,
          bitmap->locked_region.pitch = bitmap->pitch;
          bitmap->locked_region.pixel_size = al_get_pixel_size(bitmap_format);
       }
+      else if (bitmap->lock_buffer_format == f) {
+         /* The converted copy is still up to date. */
+         ASSERT(flags & ALLEGRO_LOCK_READONLY);
+         bitmap->locked_region.pitch = al_get_pixel_size(f) * bitmap->w;
+         bitmap->locked_region.data = (char *)bitmap->lock_buffer
+            + bitmap->locked_region.pitch * yc + xc * al_get_pixel_size(f);
+         bitmap->locked_region.format = f;
+         bitmap->locked_region.pixel_size = al_get_pixel_size(f);
+      }
+      else if ((flags & ALLEGRO_LOCK_READONLY) &&
+            _al_get_memory_bitmap_lock_cache()) {
+         /* Convert all of the bitmap so that the copy can serve later
+          * read-only locks of any region until the bitmap is written to.
+          */
+         int pitch = al_get_pixel_size(f) * bitmap->w;
+         if (!get_lock_buffer(bitmap, (size_t)pitch * bitmap->h))
+            return NULL;
+         _al_convert_bitmap_data(
+            bitmap->memory, bitmap_format, bitmap->pitch,
+            bitmap->lock_buffer, f, pitch,
+            0, 0, 0, 0, bitmap->w, bitmap->h);
+         bitmap->lock_buffer_format = f;
+         bitmap->locked_region.pitch = pitch;
+         bitmap->locked_region.data = (char *)bitmap->lock_buffer
+            + pitch * yc + xc * al_get_pixel_size(f);
+         bitmap->locked_region.format = f;
+         bitmap->locked_region.pixel_size = al_get_pixel_size(f);
+      }
       else {
          bitmap->locked_region.pitch = al_get_pixel_size(f) * wc;
-         bitmap->locked_region.data = al_malloc(bitmap->locked_region.pitch*hc);
+         if (!get_lock_buffer(bitmap, (size_t)bitmap->locked_region.pitch * hc))
+            return NULL;
+         bitmap->locked_region.data = bitmap->lock_buffer;
          bitmap->locked_region.format = f;
          bitmap->locked_region.pixel_size = al_get_pixel_size(f);
          if (!(bitmap->lock_flags & ALLEGRO_LOCK_WRITEONLY)) {
@@ -154,7 +211,7 @@ void al_unlock_bitmap(ALLEGRO_BITMAP *bitmap)
                bitmap->memory, bitmap_format, bitmap->pitch,
                0, 0, bitmap->lock_x, bitmap->lock_y, bitmap->lock_w, bitmap->lock_h);
          }
-         al_free(bitmap->locked_region.data);
+         /* The data is in the lock buffer, which is kept for the next lock. */
       }
    }
 
@@ -162,6 +219,18 @@ void al_unlock_bitmap(ALLEGRO_BITMAP *bitmap)
 }
 
 
+/* Internal function: _al_destroy_bitmap_lock_buffer
+ *  Frees the lock buffer of a bitmap, if it has one.
+ */
+void _al_destroy_bitmap_lock_buffer(ALLEGRO_BITMAP *bitmap)
+{
+   al_free(bitmap->lock_buffer);
+   bitmap->lock_buffer = NULL;
+   bitmap->lock_buffer_size = 0;
+   bitmap->lock_buffer_format = 0;
+}
+
+
 /* Function: al_is_bitmap_locked
  */
 bool al_is_bitmap_locked(ALLEGRO_BITMAP *bitmap)
@@ -0,0 +1,253 @@
+/*         ______   ___    ___
+ *        /\  _  \ /\_ \  /\_ \
+ *        \ \ \L\ \\//\ \ \//\ \      __     __   _ __   ___
+ *         \ \  __ \ \ \ \  \ \ \   /'__`\ /'_ `\/\`'__\/ __`\
+ *          \ \ \/\ \ \_\ \_ \_\ \_/\  __//\ \L\ \ \ \//\ \L\ \
+ *           \ \_\ \_\/\____\/\____\ \____\ \____ \ \_\\ \____/
+ *            \/_/\/_/\/____/\/____/\/____/\/___L\ \/_/ \/___/
+ *                                           /\____/
+ *                                           \_/__/
+ *
+ *      Pixel storage of memory bitmaps.
+ *
+ *      See LICENSE.txt for copyright information.
+ */
+
+
+#include <stdlib.h>
+#include "allegro5/allegro.h"
+#include "allegro5/internal/aintern.h"
+#include "allegro5/internal/aintern_bitmap.h"
+#include "allegro5/internal/aintern_exitfunc.h"
+#include "allegro5/internal/aintern_thread.h"
+#include "allegro5/internal/aintern_vector.h"
+
+ALLEGRO_DEBUG_CHANNEL("bitmap")
+
+
+/* Pixel storage starts on a cache line. */
+#define CACHE_LINE_SIZE  64
+
+/* With the default padding, rows start on this boundary so that SIMD code
+ * can use aligned loads and stores.
+ */
+#define ROW_ALIGNMENT  32
+
+/* Rows of bitmaps with a pitch which is a multiple of this map to the same
+ * few sets of the CPU caches, so walking down a column keeps evicting itself.
+ */
+#define ALIASING_STRIDE  2048
+
+#define DEFAULT_POOL_SIZE  (32 << 20)
+
+enum {
+   PADDING_NONE,
+   PADDING_ALIGN,
+   PADDING_AUTO
+};
+
+/* Stored right before the pixel storage. */
+typedef struct BLOCK_HEADER {
+   void *block;
+   size_t size;
+} BLOCK_HEADER;
+
+static int padding = PADDING_AUTO;
+static bool lock_cache = false;
+
+/* Pixel storage of destroyed memory bitmaps kept for reuse, oldest first. */
+static _AL_MUTEX pool_mutex = _AL_MUTEX_UNINITED;
+static _AL_VECTOR pool = _AL_VECTOR_INITIALIZER(void *);
+static size_t pool_bytes;
+static size_t max_pool_bytes = DEFAULT_POOL_SIZE;
+
+
+static BLOCK_HEADER *get_header(void *memory)
+{
+   return (BLOCK_HEADER *)memory - 1;
+}
+
+
+static void free_block(void *memory)
+{
+   al_free(get_header(memory)->block);
+}
+
+
+static void *alloc_block(size_t size)
+{
+   char *block = al_malloc(sizeof(BLOCK_HEADER) + CACHE_LINE_SIZE - 1 + size);
+   uintptr_t memory;
+
+   if (!block)
+      return NULL;
+
+   memory = (uintptr_t)(block + sizeof(BLOCK_HEADER));
+   memory = (memory + CACHE_LINE_SIZE - 1) & ~(uintptr_t)(CACHE_LINE_SIZE - 1);
+   get_header((void *)memory)->block = block;
+   get_header((void *)memory)->size = size;
+   return (void *)memory;
+}
+
+
+/* Removes and returns the most recently pooled storage of the given size,
+ * which is most likely to still be in the cache.
+ */
+static void *take_from_pool(size_t size)
+{
+   void *memory = NULL;
+   int i;
+
+   _al_mutex_lock(&pool_mutex);
+   for (i = _al_vector_size(&pool) - 1; i >= 0; i--) {
+      void **slot = _al_vector_ref(&pool, i);
+      if (get_header(*slot)->size == size) {
+         memory = *slot;
+         _al_vector_delete_at(&pool, i);
+         pool_bytes -= size;
+         break;
+      }
+   }
+   _al_mutex_unlock(&pool_mutex);
+
+   return memory;
+}
+
+
+/* Evicts the oldest storage if the pool would grow too large. Returns false
+ * if the storage does not fit at all.
+ */
+static bool give_to_pool(void *memory)
+{
+   size_t size = get_header(memory)->size;
+   void **back;
+
+   if (size > max_pool_bytes)
+      return false;
+
+   _al_mutex_lock(&pool_mutex);
+   while (pool_bytes + size > max_pool_bytes) {
+      void **oldest = _al_vector_ref_front(&pool);
+      pool_bytes -= get_header(*oldest)->size;
+      free_block(*oldest);
+      _al_vector_delete_at(&pool, 0);
+   }
+   back = _al_vector_alloc_back(&pool);
+   *back = memory;
+   pool_bytes += size;
+   _al_mutex_unlock(&pool_mutex);
+
+   return true;
+}
+
+
+/* Internal function: _al_get_bitmap_memory_pitch
+ *  Returns the pitch of a memory bitmap with the given width and pixel size,
+ *  following the [graphics] memory_bitmap_padding config key.
+ */
+int _al_get_bitmap_memory_pitch(int w, int pixel_size)
+{
+   int pitch = w * pixel_size;
+
+   if (padding == PADDING_NONE)
+      return pitch;
+
+   pitch = (pitch + ROW_ALIGNMENT - 1) & ~(ROW_ALIGNMENT - 1);
+   if (padding == PADDING_AUTO && pitch % ALIASING_STRIDE == 0)
+      pitch += CACHE_LINE_SIZE;
+   return pitch;
+}
+
+
+/* Internal function: _al_alloc_bitmap_memory
+ *  Allocates pixel storage for a memory bitmap, aligned to a cache line.
+ *  Storage of the same size which was freed with _al_free_bitmap_memory is
+ *  reused. The contents are undefined.
+ */
+void *_al_alloc_bitmap_memory(size_t size)
+{
+   void *memory = NULL;
+
+   if (max_pool_bytes > 0)
+      memory = take_from_pool(size);
+   if (!memory)
+      memory = alloc_block(size);
+   return memory;
+}
+
+
+/* Internal function: _al_free_bitmap_memory
+ *  Frees storage returned by _al_alloc_bitmap_memory, or keeps it for reuse
+ *  if the pool is not full.
+ */
+void _al_free_bitmap_memory(void *memory)
+{
+   if (!memory)
+      return;
+   if (max_pool_bytes > 0 && give_to_pool(memory))
+      return;
+   free_block(memory);
+}
+
+
+static void shutdown_bitmap_memory(void)
+{
+   /* Bitmaps destroyed after this, by the system driver, free directly. */
+   max_pool_bytes = 0;
+
+   while (!_al_vector_is_empty(&pool)) {
+      void **back = _al_vector_ref_back(&pool);
+      free_block(*back);
+      _al_vector_delete_at(&pool, _al_vector_size(&pool) - 1);
+   }
+   _al_vector_free(&pool);
+   pool_bytes = 0;
+
+   _al_mutex_destroy(&pool_mutex);
+}
+
+
+/* Internal function: _al_get_memory_bitmap_lock_cache
+ *  Returns whether memory bitmaps keep a converted copy of themselves after
+ *  read-only locks in another format.
+ */
+bool _al_get_memory_bitmap_lock_cache(void)
+{
+   return lock_cache;
+}
+
+
+/* Internal function: _al_init_bitmap_memory
+ *  Reads the [graphics] memory_bitmap_padding, memory_bitmap_pool and
+ *  memory_bitmap_lock_cache config keys.
+ */
+void _al_init_bitmap_memory(void)
+{
+   ALLEGRO_CONFIG *config = al_get_system_config();
+   const char *value;
+
+   padding = PADDING_AUTO;
+   value = al_get_config_value(config, "graphics", "memory_bitmap_padding");
+   if (value && !_al_stricmp(value, "none"))
+      padding = PADDING_NONE;
+   else if (value && !_al_stricmp(value, "align"))
+      padding = PADDING_ALIGN;
+
+   max_pool_bytes = DEFAULT_POOL_SIZE;
+   value = al_get_config_value(config, "graphics", "memory_bitmap_pool");
+   if (value) {
+      int megabytes = atoi(value);
+      max_pool_bytes = megabytes > 0 ? (size_t)megabytes << 20 : 0;
+   }
+
+   value = al_get_config_value(config, "graphics", "memory_bitmap_lock_cache");
+   lock_cache = value && !_al_stricmp(value, "true");
+
+   ALLEGRO_DEBUG("Memory bitmap padding %d, pool of %u bytes, lock cache %d\n",
+      padding, (unsigned)max_pool_bytes, lock_cache);
+
+   _al_mutex_init(&pool_mutex);
+   _al_add_exit_func(shutdown_bitmap_memory, "shutdown_bitmap_memory");
+}
+
+/* vim: set sts=3 sw=3 et: */
@@ -13,14 +13,20 @@
  *      See LICENSE.txt for copyright information.
  */
 
+#include <limits.h>
+#include <math.h>
 #include <string.h> /* for memset */
 #include "allegro5/allegro.h"
+#include "allegro5/internal/aintern.h"
 #include "allegro5/internal/aintern_bitmap.h"
 #include "allegro5/internal/aintern_blend.h"
 #include "allegro5/internal/aintern_pixels.h"
 
 ALLEGRO_DEBUG_CHANNEL("bitmap")
 
+/* How many pixels of a span are blended at once. */
+#define BLEND_CHUNK  64
+
 
 /* Function: al_get_pixel
  */
@@ -145,4 +151,285 @@ void al_put_blended_pixel(int x, int y, ALLEGRO_COLOR color)
 }
 
 
+/* The rectangle of the parent of bitmap which pixels may be written to, i.e.
+ * the clipping rectangle of bitmap within the one of its parent and the
+ * locked region, if any. x2 and y2 are exclusive.
+ */
+static void get_write_rect(ALLEGRO_BITMAP *bitmap,
+   int *x1, int *y1, int *x2, int *y2)
+{
+   ALLEGRO_BITMAP *parent = bitmap->parent ? bitmap->parent : bitmap;
+   const int xofs = bitmap->parent ? bitmap->xofs : 0;
+   const int yofs = bitmap->parent ? bitmap->yofs : 0;
+
+   *x1 = _ALLEGRO_MAX(bitmap->cl + xofs, parent->cl);
+   *y1 = _ALLEGRO_MAX(bitmap->ct + yofs, parent->ct);
+   *x2 = _ALLEGRO_MIN(bitmap->cr_excl + xofs, parent->cr_excl);
+   *y2 = _ALLEGRO_MIN(bitmap->cb_excl + yofs, parent->cb_excl);
+
+   if (parent->locked) {
+      *x1 = _ALLEGRO_MAX(*x1, parent->lock_x);
+      *y1 = _ALLEGRO_MAX(*y1, parent->lock_y);
+      *x2 = _ALLEGRO_MIN(*x2, parent->lock_x + parent->lock_w);
+      *y2 = _ALLEGRO_MIN(*y2, parent->lock_y + parent->lock_h);
+   }
+}
+
+
+/* Locks a region of a bitmap without a parent for the pixel functions,
+ * unless it is locked already. Returns false if its pixels can't be
+ * accessed, and sets *unlock if the caller has to unlock it.
+ */
+static bool begin_pixels(ALLEGRO_BITMAP *parent, int x, int y, int w, int h,
+   int flags, bool *unlock)
+{
+   *unlock = false;
+
+   if (!parent->locked) {
+      if (!al_lock_bitmap_region(parent, x, y, w, h,
+            ALLEGRO_PIXEL_FORMAT_ANY, flags)) {
+         return false;
+      }
+      *unlock = true;
+   }
+
+   if (_al_pixel_format_is_video_only(parent->locked_region.format)) {
+      ALLEGRO_ERROR("Invalid lock format.");
+      if (*unlock)
+         al_unlock_bitmap(parent);
+      return false;
+   }
+
+   return true;
+}
+
+
+static char *get_pixel_ptr(ALLEGRO_BITMAP *parent, int x, int y)
+{
+   return (char *)parent->locked_region.data
+      + (y - parent->lock_y) * parent->locked_region.pitch
+      + (x - parent->lock_x) * parent->locked_region.pixel_size;
+}
+
+
+/* Function: al_get_pixel_span
+ */
+void al_get_pixel_span(ALLEGRO_BITMAP *bitmap, int x, int y, int n,
+   ALLEGRO_COLOR *colors)
+{
+   ALLEGRO_BITMAP *parent = bitmap->parent ? bitmap->parent : bitmap;
+   const int xofs = bitmap->parent ? bitmap->xofs : 0;
+   const int yofs = bitmap->parent ? bitmap->yofs : 0;
+   int x1, x2, y1, y2;
+   bool unlock;
+   char *data;
+   int format;
+   int i;
+
+   if (n <= 0)
+      return;
+   memset(colors, 0, n * sizeof *colors);
+
+   x += xofs;
+   y += yofs;
+   x1 = _ALLEGRO_MAX(xofs, 0);
+   y1 = _ALLEGRO_MAX(yofs, 0);
+   x2 = _ALLEGRO_MIN(xofs + bitmap->w, parent->w);
+   y2 = _ALLEGRO_MIN(yofs + bitmap->h, parent->h);
+   if (parent->locked) {
+      x1 = _ALLEGRO_MAX(x1, parent->lock_x);
+      y1 = _ALLEGRO_MAX(y1, parent->lock_y);
+      x2 = _ALLEGRO_MIN(x2, parent->lock_x + parent->lock_w);
+      y2 = _ALLEGRO_MIN(y2, parent->lock_y + parent->lock_h);
+   }
+
+   if (y < y1 || y >= y2)
+      return;
+   if (x < x1) {
+      colors += x1 - x;
+      n -= x1 - x;
+      x = x1;
+   }
+   if (x + n > x2)
+      n = x2 - x;
+   if (n <= 0)
+      return;
+
+   if (!begin_pixels(parent, x, y, n, 1, ALLEGRO_LOCK_READONLY, &unlock))
+      return;
+
+   format = parent->locked_region.format;
+   data = get_pixel_ptr(parent, x, y);
+   for (i = 0; i < n; i++) {
+      ALLEGRO_COLOR color;
+      _AL_INLINE_GET_PIXEL(format, data, color, true);
+      colors[i] = color;
+   }
+
+   if (unlock)
+      al_unlock_bitmap(parent);
+}
+
+
+static void put_pixel_span(ALLEGRO_BITMAP *bitmap, int x, int y, int n,
+   const ALLEGRO_COLOR *colors, bool blend)
+{
+   ALLEGRO_BITMAP *parent = bitmap->parent ? bitmap->parent : bitmap;
+   int x1, y1, x2, y2;
+   const _AL_BLEND_SPAN *blender;
+   bool unlock;
+   char *data;
+   int format;
+   int i;
+
+   if (bitmap->parent) {
+      x += bitmap->xofs;
+      y += bitmap->yofs;
+   }
+
+   get_write_rect(bitmap, &x1, &y1, &x2, &y2);
+   if (y < y1 || y >= y2)
+      return;
+   if (x < x1) {
+      colors += x1 - x;
+      n -= x1 - x;
+      x = x1;
+   }
+   if (x + n > x2)
+      n = x2 - x;
+   if (n <= 0)
+      return;
+
+   if (!begin_pixels(parent, x, y, n, 1,
+         blend ? ALLEGRO_LOCK_READWRITE : ALLEGRO_LOCK_WRITEONLY, &unlock)) {
+      return;
+   }
+
+   format = parent->locked_region.format;
+   data = get_pixel_ptr(parent, x, y);
+
+   if (blend) {
+      blender = &_al_get_compiled_blender()->span;
+      while (n > 0) {
+         ALLEGRO_COLOR result[BLEND_CHUNK];
+         const int m = _ALLEGRO_MIN(n, BLEND_CHUNK);
+         char *src = data;
+
+         for (i = 0; i < m; i++) {
+            ALLEGRO_COLOR color;
+            _AL_INLINE_GET_PIXEL(format, src, color, true);
+            result[i] = color;
+         }
+         blender->blend(blender, colors, result, m);
+         for (i = 0; i < m; i++) {
+            ALLEGRO_COLOR color = result[i];
+            _AL_INLINE_PUT_PIXEL(format, data, color, true);
+         }
+         colors += m;
+         n -= m;
+      }
+   }
+   else {
+      for (i = 0; i < n; i++) {
+         ALLEGRO_COLOR color = colors[i];
+         _AL_INLINE_PUT_PIXEL(format, data, color, true);
+      }
+   }
+
+   if (unlock)
+      al_unlock_bitmap(parent);
+}
+
+
+/* Function: al_put_pixel_span
+ */
+void al_put_pixel_span(int x, int y, int n, const ALLEGRO_COLOR *colors)
+{
+   put_pixel_span(al_get_target_bitmap(), x, y, n, colors, false);
+}
+
+
+/* Function: al_put_blended_pixel_span
+ */
+void al_put_blended_pixel_span(int x, int y, int n,
+   const ALLEGRO_COLOR *colors)
+{
+   put_pixel_span(al_get_target_bitmap(), x, y, n, colors, true);
+}
+
+
+/* Internal function: _al_put_pixels
+ *  Writes n pixels to bitmap, blended with the current blender if blend is
+ *  set. Pixel i goes to the pixel containing the point given by the x and y
+ *  floats at pos + i * pos_stride bytes and has the color at
+ *  colors + i * color_stride bytes, so both can point into an array of
+ *  vertices. The clipping rectangle, the lock and the blender are resolved
+ *  once for all of them.
+ */
+void _al_put_pixels(ALLEGRO_BITMAP *bitmap, const float *pos, int pos_stride,
+   const ALLEGRO_COLOR *colors, int color_stride, int n, bool blend)
+{
+   ALLEGRO_BITMAP *parent = bitmap->parent ? bitmap->parent : bitmap;
+   const float xofs = bitmap->parent ? bitmap->xofs : 0;
+   const float yofs = bitmap->parent ? bitmap->yofs : 0;
+   int x1, y1, x2, y2;
+   int min_x = INT_MAX, min_y = INT_MAX, max_x = INT_MIN, max_y = INT_MIN;
+   const _AL_BLEND_SPAN *blender = NULL;
+   bool unlock;
+   int format;
+   int i;
+
+   get_write_rect(bitmap, &x1, &y1, &x2, &y2);
+
+   /* Only lock the region the pixels are in. */
+   for (i = 0; i < n; i++) {
+      const float *p = (const float *)((const char *)pos + i * pos_stride);
+      const float x = floorf(p[0]) + xofs;
+      const float y = floorf(p[1]) + yofs;
+
+      if (!(x >= x1 && x < x2 && y >= y1 && y < y2))
+         continue;
+      min_x = _ALLEGRO_MIN(min_x, (int)x);
+      min_y = _ALLEGRO_MIN(min_y, (int)y);
+      max_x = _ALLEGRO_MAX(max_x, (int)x);
+      max_y = _ALLEGRO_MAX(max_y, (int)y);
+   }
+   if (min_x > max_x)
+      return;
+
+   if (!begin_pixels(parent, min_x, min_y, max_x - min_x + 1,
+         max_y - min_y + 1, ALLEGRO_LOCK_READWRITE, &unlock)) {
+      return;
+   }
+
+   if (blend)
+      blender = &_al_get_compiled_blender()->span;
+   format = parent->locked_region.format;
+
+   for (i = 0; i < n; i++) {
+      const float *p = (const float *)((const char *)pos + i * pos_stride);
+      const float x = floorf(p[0]) + xofs;
+      const float y = floorf(p[1]) + yofs;
+      ALLEGRO_COLOR color;
+      char *data;
+
+      if (!(x >= x1 && x < x2 && y >= y1 && y < y2))
+         continue;
+
+      data = get_pixel_ptr(parent, (int)x, (int)y);
+      color = *(const ALLEGRO_COLOR *)((const char *)colors + i * color_stride);
+      if (blend) {
+         ALLEGRO_COLOR result;
+         _AL_INLINE_GET_PIXEL(format, data, result, false);
+         blender->blend(blender, &color, &result, 1);
+         color = result;
+      }
+      _AL_INLINE_PUT_PIXEL(format, data, color, false);
+   }
+
+   if (unlock)
+      al_unlock_bitmap(parent);
+}
+
+
 /* vim: set sts=3 sw=3 et: */
@@ -0,0 +1,290 @@
+/*         ______   ___    ___
+ *        /\  _  \ /\_ \  /\_ \
+ *        \ \ \L\ \\//\ \ \//\ \      __     __   _ __   ___
+ *         \ \  __ \ \ \ \  \ \ \   /'__`\ /'_ `\/\`'__\/ __`\
+ *          \ \ \/\ \ \_\ \_ \_\ \_/\  __//\ \L\ \ \ \//\ \L\ \
+ *           \ \_\ \_\/\____\/\____\ \____\ \____ \ \_\\ \____/
+ *            \/_/\/_/\/____/\/____/\/____/\/___L\ \/_/ \/___/
+ *                                           /\____/
+ *                                           \_/__/
+ *
+ *      Run-length encoding of memory bitmaps.
+ *
+ *      Memory bitmaps with ALLEGRO_RLE_BITMAP keep each row as a list of
+ *      runs of blank, transparent, opaque and translucent pixels. Drawing
+ *      them with an alpha blender at a whole pixel offset skips the blank
+ *      runs, copies the opaque ones and only blends the rest.
+ *
+ *      See LICENSE.txt for copyright information.
+ */
+
+
+#include <string.h>
+#include "allegro5/allegro.h"
+#include "allegro5/internal/aintern.h"
+#include "allegro5/internal/aintern_bitmap.h"
+#include "allegro5/internal/aintern_blend.h"
+#include "allegro5/internal/aintern_tri_soft.h"
+
+ALLEGRO_DEBUG_CHANNEL("bitmap")
+
+
+/* Each run is stored as its kind in the top two bits and its length in the
+ * rest.
+ */
+#define RUN_SHIFT       30
+#define RUN_LENGTH(r)   ((int)((r) & ((1u << RUN_SHIFT) - 1)))
+#define RUN_KIND(r)     ((int)((r) >> RUN_SHIFT))
+
+enum {
+   RUN_BLANK,        /* all bits zero */
+   RUN_CLEAR,        /* zero alpha but some color */
+   RUN_OPAQUE,
+   RUN_TRANSLUCENT
+};
+
+enum {
+   ACTION_SKIP,
+   ACTION_COPY,
+   ACTION_BLEND
+};
+
+struct _AL_BITMAP_RLE {
+   int format;
+   /* The runs of row y are runs[rows[y]] up to runs[rows[y + 1]]. */
+   int *rows;
+   uint32_t *runs;
+};
+
+
+static bool is_rle_format(int format)
+{
+   /* The formats of _AL_BLEND_SPAN_8888, with alpha in the top byte. */
+   switch (format) {
+      case ALLEGRO_PIXEL_FORMAT_ARGB_8888:
+      case ALLEGRO_PIXEL_FORMAT_ABGR_8888:
+#ifdef ALLEGRO_LITTLE_ENDIAN
+      case ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE:
+#endif
+         return true;
+      default:
+         return false;
+   }
+}
+
+
+static bool wants_rle(ALLEGRO_BITMAP *bitmap)
+{
+   return !bitmap->parent &&
+      (bitmap->_flags & ALLEGRO_MEMORY_BITMAP) &&
+      (bitmap->_flags & ALLEGRO_RLE_BITMAP) &&
+      is_rle_format(bitmap->_format) &&
+      bitmap->memory;
+}
+
+
+static int pixel_kind(uint32_t pixel)
+{
+   const uint32_t alpha = pixel >> 24;
+
+   if (pixel == 0)
+      return RUN_BLANK;
+   if (alpha == 0)
+      return RUN_CLEAR;
+   if (alpha == 255)
+      return RUN_OPAQUE;
+   return RUN_TRANSLUCENT;
+}
+
+
+/* Encodes a row into runs, or only counts them if runs is NULL. */
+static int encode_row(const uint32_t *pixels, int w, uint32_t *runs)
+{
+   int n = 0;
+   int x = 0;
+
+   while (x < w) {
+      const int kind = pixel_kind(pixels[x]);
+      const int start = x;
+
+      for (x++; x < w && pixel_kind(pixels[x]) == kind; x++)
+         ;
+      if (runs)
+         runs[n] = ((uint32_t)kind << RUN_SHIFT) | (uint32_t)(x - start);
+      n++;
+   }
+
+   return n;
+}
+
+
+static void destroy_rle(ALLEGRO_BITMAP *bitmap)
+{
+   al_free(bitmap->rle->rows);
+   al_free(bitmap->rle->runs);
+   al_free(bitmap->rle);
+   bitmap->rle = NULL;
+}
+
+
+static bool encode_bitmap(ALLEGRO_BITMAP *bitmap)
+{
+   _AL_BITMAP_RLE *rle = bitmap->rle;
+   int n = 0;
+   int y;
+
+   for (y = 0; y < bitmap->h; y++) {
+      const uint32_t *pixels =
+         (const uint32_t *)(bitmap->memory + y * bitmap->pitch);
+      n += encode_row(pixels, bitmap->w, NULL);
+   }
+
+   al_free(rle->runs);
+   rle->runs = al_malloc(n * sizeof(uint32_t));
+   if (!rle->runs)
+      return false;
+
+   n = 0;
+   for (y = 0; y < bitmap->h; y++) {
+      const uint32_t *pixels =
+         (const uint32_t *)(bitmap->memory + y * bitmap->pitch);
+      rle->rows[y] = n;
+      n += encode_row(pixels, bitmap->w, rle->runs + n);
+   }
+   rle->rows[bitmap->h] = n;
+   rle->format = bitmap->_format;
+
+   ALLEGRO_DEBUG("Encoded %dx%d bitmap into %d runs\n", bitmap->w,
+      bitmap->h, n);
+   return true;
+}
+
+
+/* Internal function: _al_update_bitmap_rle
+ *  Encodes a memory bitmap with ALLEGRO_RLE_BITMAP again if it was changed
+ *  since it was last encoded. Bitmaps in formats other than the 8888 ones
+ *  are not encoded.
+ */
+void _al_update_bitmap_rle(ALLEGRO_BITMAP *bitmap)
+{
+   if (!wants_rle(bitmap))
+      return;
+
+   if (!bitmap->rle) {
+      bitmap->rle = al_calloc(1, sizeof(_AL_BITMAP_RLE));
+      if (!bitmap->rle)
+         return;
+      bitmap->rle->rows = al_malloc((bitmap->h + 1) * sizeof(int));
+      if (!bitmap->rle->rows) {
+         destroy_rle(bitmap);
+         return;
+      }
+   }
+   else if (!bitmap->rle_dirty && bitmap->rle->format == bitmap->_format) {
+      return;
+   }
+
+   /* Triangles queued for the tiled rasterizer have marked it already. */
+   _al_flush_tiled_triangles_for(bitmap, false);
+
+   if (!encode_bitmap(bitmap)) {
+      destroy_rle(bitmap);
+      return;
+   }
+   bitmap->rle_dirty = false;
+}
+
+
+static void apply_action(int action, const _AL_BLEND_SPAN_8888 *blend,
+   uint32_t *dst, const uint32_t *src, int n)
+{
+   switch (action) {
+      case ACTION_COPY:
+         memcpy(dst, src, n * sizeof(uint32_t));
+         break;
+      case ACTION_BLEND:
+         blend->blend(blend, dst, src, n);
+         break;
+   }
+}
+
+
+/* Internal function: _al_blend_bitmap_rle
+ *  Blends a region of a memory bitmap with an up to date encoding into a
+ *  locked region in the same format, like calling the blender on each row.
+ *  The blender must be one under which blank pixels leave the destination
+ *  unchanged, as the alpha blenders do. With _AL_RLE_SKIP_CLEAR pixels with
+ *  zero alpha do as well, and with _AL_RLE_COPY_OPAQUE opaque pixels replace
+ *  the destination.
+ *
+ *  src points to pixel (sx, sy) of the bitmap and dst to the first pixel to
+ *  blend into. Returns false without drawing anything if the bitmap has no
+ *  encoding to use.
+ */
+bool _al_blend_bitmap_rle(ALLEGRO_BITMAP *bitmap,
+   const _AL_BLEND_SPAN_8888 *blend, int flags,
+   int sx, int sy, int w, int h,
+   const void *src, int src_pitch, void *dst, int dst_pitch)
+{
+   const _AL_BITMAP_RLE *rle = bitmap->rle;
+   const int x2 = sx + w;
+   int actions[4];
+   int y;
+
+   if (!wants_rle(bitmap) || !rle || bitmap->rle_dirty ||
+         rle->format != bitmap->_format)
+      return false;
+
+   ASSERT(sx >= 0 && x2 <= bitmap->w);
+   ASSERT(sy >= 0 && sy + h <= bitmap->h);
+
+   actions[RUN_BLANK] = ACTION_SKIP;
+   actions[RUN_CLEAR] = (flags & _AL_RLE_SKIP_CLEAR) ?
+      ACTION_SKIP : ACTION_BLEND;
+   actions[RUN_OPAQUE] = (flags & _AL_RLE_COPY_OPAQUE) ?
+      ACTION_COPY : ACTION_BLEND;
+   actions[RUN_TRANSLUCENT] = ACTION_BLEND;
+
+   for (y = 0; y < h; y++) {
+      const uint32_t *run = rle->runs + rle->rows[sy + y];
+      const uint32_t *src_row =
+         (const uint32_t *)((const char *)src + y * src_pitch);
+      uint32_t *dst_row = (uint32_t *)((char *)dst + y * dst_pitch);
+      int x = 0;
+
+      /* Consecutive runs with the same action are handled together. The
+       * runs cover the whole row, so there always is one more while x is
+       * less than x2.
+       */
+      while (x < x2) {
+         const int action = actions[RUN_KIND(*run)];
+         const int start = _ALLEGRO_MAX(x, sx);
+         int end;
+
+         do {
+            x += RUN_LENGTH(*run);
+            run++;
+         } while (x < x2 && actions[RUN_KIND(*run)] == action);
+
+         end = _ALLEGRO_MIN(x, x2);
+         if (end > start) {
+            apply_action(action, blend, dst_row + (start - sx),
+               src_row + (start - sx), end - start);
+         }
+      }
+   }
+
+   return true;
+}
+
+
+/* Internal function: _al_destroy_bitmap_rle
+ *  Frees the encoding of a bitmap, if it has one.
+ */
+void _al_destroy_bitmap_rle(ALLEGRO_BITMAP *bitmap)
+{
+   if (bitmap->rle)
+      destroy_rle(bitmap);
+}
+
+/* vim: set sts=3 sw=3 et: */
@@ -20,6 +20,7 @@
 #include "allegro5/internal/aintern_exitfunc.h"
 #include "allegro5/internal/aintern_shader.h"
 #include "allegro5/internal/aintern_system.h"
+#include "allegro5/internal/aintern_transform.h"
 #include "allegro5/internal/aintern_vector.h"
 
 ALLEGRO_DEBUG_CHANNEL("bitmap")
@@ -189,16 +190,14 @@ void al_convert_bitmap(ALLEGRO_BITMAP *bitmap)
    bitmap->cr_excl = clone->cr_excl;
    bitmap->cb_excl = clone->cb_excl;
    bitmap->transform = clone->transform;
+   bitmap->transform_class = clone->transform_class;
    bitmap->inverse_transform = clone->inverse_transform;
    bitmap->inverse_transform_dirty = clone->inverse_transform_dirty;
 
-   /* Memory bitmaps do not support custom projection transforms,
-    * so reset it to the orthographic transform. */
+   bitmap->proj_transform = clone->proj_transform;
    if (new_bitmap_flags & ALLEGRO_MEMORY_BITMAP) {
-      al_identity_transform(&bitmap->proj_transform);
-      al_orthographic_transform(&bitmap->proj_transform, 0, 0, -1.0, bitmap->w, bitmap->h, 1.0);
-   } else {
-      bitmap->proj_transform = clone->proj_transform;
+      bitmap->custom_proj_transform =
+         !_al_is_default_projection(bitmap, &bitmap->proj_transform);
    }
 
    /* If we just converted this bitmap, and the backing bitmap is the same
@@ -19,23 +19,776 @@
 #include "allegro5/internal/aintern.h"
 #include "allegro5/internal/aintern_bitmap.h"
 #include "allegro5/internal/aintern_blend.h"
+#include "allegro5/internal/aintern_cpu.h"
 #include "allegro5/internal/aintern_display.h"
+#include <float.h>
 #include <string.h>
 
+#ifdef _AL_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef _AL_HAVE_AVX2
+#include <immintrin.h>
+#endif
+
+ALLEGRO_DEBUG_CHANNEL("blenders")
+
+typedef void (*blend_span_func)(const _AL_BLEND_SPAN *b,
+   const ALLEGRO_COLOR *src, ALLEGRO_COLOR *dst, int n);
+
+/* Kernels for the general case and for the three most common blenders. */
+typedef struct BLEND_SPAN_KERNELS {
+   blend_span_func generic;
+   blend_span_func premul;    /* ADD, ONE, INVERSE_ALPHA */
+   blend_span_func alpha;     /* ADD, ALPHA, INVERSE_ALPHA */
+   blend_span_func add;       /* ADD, ONE, ONE */
+} BLEND_SPAN_KERNELS;
+
+
+/* Portable kernels. These have to match _al_blend_inline exactly, so the
+ * operations are done in the same order.
+ */
+
+static void blend_span_generic_c(const _AL_BLEND_SPAN *b,
+   const ALLEGRO_COLOR *src, ALLEGRO_COLOR *dst, int n)
+{
+   int i, c;
+
+   for (i = 0; i < n; i++) {
+      const float *s = (const float *)&src[i];
+      float *d = (float *)&dst[i];
+      const float sa = s[3];
+
+      for (c = 0; c < 4; c++) {
+         const float sf = b->src_k[0][c] + b->src_k[1][c] * sa
+            + b->src_k[2][c] * s[c] + b->src_k[3][c] * d[c];
+         const float df = b->dst_k[0][c] + b->dst_k[1][c] * sa
+            + b->dst_k[2][c] * s[c] + b->dst_k[3][c] * d[c];
+         float v = s[c] * sf * b->src_sign[c] + d[c] * df * b->dst_sign[c];
+         v = b->hi[c] < v ? b->hi[c] : v;
+         d[c] = b->lo[c] > v ? b->lo[c] : v;
+      }
+   }
+}
+
+#define BLEND_SPAN_C(name, SF, DF)                                            \
+static void name(const _AL_BLEND_SPAN *b,                                     \
+   const ALLEGRO_COLOR *src, ALLEGRO_COLOR *dst, int n)                       \
+{                                                                             \
+   int i;                                                                     \
+   (void)b;                                                                   \
+   for (i = 0; i < n; i++) {                                                  \
+      const ALLEGRO_COLOR s = src[i];                                         \
+      const float sf = SF;                                                    \
+      const float df = DF;                                                    \
+      ALLEGRO_COLOR *d = &dst[i];                                             \
+      d->r = _ALLEGRO_MIN(1, s.r * sf + d->r * df);                           \
+      d->g = _ALLEGRO_MIN(1, s.g * sf + d->g * df);                           \
+      d->b = _ALLEGRO_MIN(1, s.b * sf + d->b * df);                           \
+      d->a = _ALLEGRO_MIN(1, s.a * sf + d->a * df);                           \
+   }                                                                          \
+}
+
+BLEND_SPAN_C(blend_span_premul_c, 1, 1 - s.a)
+BLEND_SPAN_C(blend_span_alpha_c, s.a, 1 - s.a)
+BLEND_SPAN_C(blend_span_add_c, 1, 1)
+
+#undef BLEND_SPAN_C
+
+static const BLEND_SPAN_KERNELS blend_span_c = {
+   blend_span_generic_c,
+   blend_span_premul_c,
+   blend_span_alpha_c,
+   blend_span_add_c
+};
+
+
+#ifdef _AL_HAVE_SSE2
+
+/* One pixel per register. */
+
+static void blend_span_generic_sse2(const _AL_BLEND_SPAN *b,
+   const ALLEGRO_COLOR *src, ALLEGRO_COLOR *dst, int n)
+{
+   const __m128 sk0 = _mm_loadu_ps(b->src_k[0]);
+   const __m128 sk1 = _mm_loadu_ps(b->src_k[1]);
+   const __m128 sk2 = _mm_loadu_ps(b->src_k[2]);
+   const __m128 sk3 = _mm_loadu_ps(b->src_k[3]);
+   const __m128 dk0 = _mm_loadu_ps(b->dst_k[0]);
+   const __m128 dk1 = _mm_loadu_ps(b->dst_k[1]);
+   const __m128 dk2 = _mm_loadu_ps(b->dst_k[2]);
+   const __m128 dk3 = _mm_loadu_ps(b->dst_k[3]);
+   const __m128 ssign = _mm_loadu_ps(b->src_sign);
+   const __m128 dsign = _mm_loadu_ps(b->dst_sign);
+   const __m128 lo = _mm_loadu_ps(b->lo);
+   const __m128 hi = _mm_loadu_ps(b->hi);
+   int i;
+
+   for (i = 0; i < n; i++) {
+      const __m128 s = _mm_loadu_ps(&src[i].r);
+      const __m128 d = _mm_loadu_ps(&dst[i].r);
+      const __m128 sa = _mm_shuffle_ps(s, s, _MM_SHUFFLE(3, 3, 3, 3));
+      const __m128 sf = _mm_add_ps(_mm_add_ps(_mm_add_ps(sk0,
+         _mm_mul_ps(sk1, sa)), _mm_mul_ps(sk2, s)), _mm_mul_ps(sk3, d));
+      const __m128 df = _mm_add_ps(_mm_add_ps(_mm_add_ps(dk0,
+         _mm_mul_ps(dk1, sa)), _mm_mul_ps(dk2, s)), _mm_mul_ps(dk3, d));
+      const __m128 v = _mm_add_ps(
+         _mm_mul_ps(_mm_mul_ps(s, sf), ssign),
+         _mm_mul_ps(_mm_mul_ps(d, df), dsign));
+      _mm_storeu_ps(&dst[i].r, _mm_max_ps(lo, _mm_min_ps(hi, v)));
+   }
+}
+
+#define BLEND_SPAN_SSE2(name, SF, DF)                                         \
+static void name(const _AL_BLEND_SPAN *b,                                     \
+   const ALLEGRO_COLOR *src, ALLEGRO_COLOR *dst, int n)                       \
+{                                                                             \
+   const __m128 one = _mm_set1_ps(1);                                         \
+   int i;                                                                     \
+   (void)b;                                                                   \
+   for (i = 0; i < n; i++) {                                                  \
+      const __m128 s = _mm_loadu_ps(&src[i].r);                               \
+      const __m128 d = _mm_loadu_ps(&dst[i].r);                               \
+      const __m128 sa = _mm_shuffle_ps(s, s, _MM_SHUFFLE(3, 3, 3, 3));        \
+      const __m128 v = _mm_add_ps(SF, _mm_mul_ps(d, DF));                     \
+      (void)sa;                                                               \
+      _mm_storeu_ps(&dst[i].r, _mm_min_ps(one, v));                           \
+   }                                                                          \
+}
+
+BLEND_SPAN_SSE2(blend_span_premul_sse2, s, _mm_sub_ps(one, sa))
+BLEND_SPAN_SSE2(blend_span_alpha_sse2, _mm_mul_ps(s, sa), _mm_sub_ps(one, sa))
+BLEND_SPAN_SSE2(blend_span_add_sse2, s, one)
+
+#undef BLEND_SPAN_SSE2
+
+static const BLEND_SPAN_KERNELS blend_span_sse2 = {
+   blend_span_generic_sse2,
+   blend_span_premul_sse2,
+   blend_span_alpha_sse2,
+   blend_span_add_sse2
+};
+
+#endif /* _AL_HAVE_SSE2 */
+
+
+#ifdef _AL_HAVE_AVX2
+
+/* Two pixels per register, the odd one out is done by the SSE2 kernel. */
+
+static _AL_TARGET("avx2") __m256 load_coeff_avx2(const float *k)
+{
+   const __m128 x = _mm_loadu_ps(k);
+   return _mm256_insertf128_ps(_mm256_castps128_ps256(x), x, 1);
+}
+
+static _AL_TARGET("avx2") void blend_span_generic_avx2(
+   const _AL_BLEND_SPAN *b, const ALLEGRO_COLOR *src, ALLEGRO_COLOR *dst,
+   int n)
+{
+   const __m256 sk0 = load_coeff_avx2(b->src_k[0]);
+   const __m256 sk1 = load_coeff_avx2(b->src_k[1]);
+   const __m256 sk2 = load_coeff_avx2(b->src_k[2]);
+   const __m256 sk3 = load_coeff_avx2(b->src_k[3]);
+   const __m256 dk0 = load_coeff_avx2(b->dst_k[0]);
+   const __m256 dk1 = load_coeff_avx2(b->dst_k[1]);
+   const __m256 dk2 = load_coeff_avx2(b->dst_k[2]);
+   const __m256 dk3 = load_coeff_avx2(b->dst_k[3]);
+   const __m256 ssign = load_coeff_avx2(b->src_sign);
+   const __m256 dsign = load_coeff_avx2(b->dst_sign);
+   const __m256 lo = load_coeff_avx2(b->lo);
+   const __m256 hi = load_coeff_avx2(b->hi);
+   int i;
+
+   for (i = 0; i + 2 <= n; i += 2) {
+      const __m256 s = _mm256_loadu_ps(&src[i].r);
+      const __m256 d = _mm256_loadu_ps(&dst[i].r);
+      const __m256 sa = _mm256_permute_ps(s, _MM_SHUFFLE(3, 3, 3, 3));
+      const __m256 sf = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(sk0,
+         _mm256_mul_ps(sk1, sa)), _mm256_mul_ps(sk2, s)),
+         _mm256_mul_ps(sk3, d));
+      const __m256 df = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(dk0,
+         _mm256_mul_ps(dk1, sa)), _mm256_mul_ps(dk2, s)),
+         _mm256_mul_ps(dk3, d));
+      const __m256 v = _mm256_add_ps(
+         _mm256_mul_ps(_mm256_mul_ps(s, sf), ssign),
+         _mm256_mul_ps(_mm256_mul_ps(d, df), dsign));
+      _mm256_storeu_ps(&dst[i].r, _mm256_max_ps(lo, _mm256_min_ps(hi, v)));
+   }
+
+   if (i < n)
+      blend_span_generic_sse2(b, src + i, dst + i, 1);
+}
+
+#define BLEND_SPAN_AVX2(name, SF, DF, tail)                                   \
+static _AL_TARGET("avx2") void name(const _AL_BLEND_SPAN *b,                  \
+   const ALLEGRO_COLOR *src, ALLEGRO_COLOR *dst, int n)                       \
+{                                                                             \
+   const __m256 one = _mm256_set1_ps(1);                                      \
+   int i;                                                                     \
+   for (i = 0; i + 2 <= n; i += 2) {                                          \
+      const __m256 s = _mm256_loadu_ps(&src[i].r);                            \
+      const __m256 d = _mm256_loadu_ps(&dst[i].r);                            \
+      const __m256 sa = _mm256_permute_ps(s, _MM_SHUFFLE(3, 3, 3, 3));        \
+      const __m256 v = _mm256_add_ps(SF, _mm256_mul_ps(d, DF));               \
+      (void)sa;                                                               \
+      _mm256_storeu_ps(&dst[i].r, _mm256_min_ps(one, v));                     \
+   }                                                                          \
+   if (i < n)                                                                 \
+      tail(b, src + i, dst + i, 1);                                           \
+}
+
+BLEND_SPAN_AVX2(blend_span_premul_avx2, s, _mm256_sub_ps(one, sa),
+   blend_span_premul_sse2)
+BLEND_SPAN_AVX2(blend_span_alpha_avx2, _mm256_mul_ps(s, sa),
+   _mm256_sub_ps(one, sa), blend_span_alpha_sse2)
+BLEND_SPAN_AVX2(blend_span_add_avx2, s, one, blend_span_add_sse2)
+
+#undef BLEND_SPAN_AVX2
+
+static const BLEND_SPAN_KERNELS blend_span_avx2 = {
+   blend_span_generic_avx2,
+   blend_span_premul_avx2,
+   blend_span_alpha_avx2,
+   blend_span_add_avx2
+};
+
+#endif /* _AL_HAVE_AVX2 */
+
+
+/* Integer kernels for 32-bit pixels with 8 bits per channel and alpha in the
+ * top byte. The untinted kernels compute exact results, rounded down like
+ * _AL_INLINE_PUT_PIXEL does, using x / 255 == (x + 1 + (x >> 8)) >> 8 for
+ * 0 <= x <= 65535. The tinted kernels work with 16 bits per channel where
+ * 65535 is 1.0, c * 257 expands an 8-bit channel and x / 257 narrows it
+ * again, which keeps them within 1 LSB of the float path. Products are
+ * approximated by (x * y + x) >> 16, which is exact when either factor is
+ * 0 or 1, so e.g. fully transparent source pixels leave dst untouched.
+ */
+
+typedef void (*blend_span_8888_func)(const _AL_BLEND_SPAN_8888 *b,
+   uint32_t *dst, const uint32_t *src, int n);
+
+enum {
+   BLEND_8888_COPY,     /* ADD, ONE, ZERO */
+   BLEND_8888_PREMUL,   /* ADD, ONE, INVERSE_ALPHA */
+   BLEND_8888_ALPHA,    /* ADD, ALPHA, INVERSE_ALPHA */
+   BLEND_8888_ADD,      /* ADD, ONE, ONE */
+   BLEND_8888_MODES
+};
+
+#define DIV255(x)    (((x) + 1 + ((x) >> 8)) >> 8)
+#define DIV257(x)    (((x) * 65281) >> 24)
+#define MUL16(x, y)  (((x) * (y) + (x)) >> 16)
+
+#define BLEND_SPAN_8888_C(name, BLEND)                                        \
+static void name(const _AL_BLEND_SPAN_8888 *b,                                \
+   uint32_t *dst, const uint32_t *src, int n)                                 \
+{                                                                             \
+   int i, c;                                                                  \
+   (void)b;                                                                   \
+   if (!src) {                                                                \
+      /* Opaque white stays opaque white with all of these blenders. */       \
+      for (i = 0; i < n; i++)                                                 \
+         dst[i] = 0xffffffff;                                                 \
+      return;                                                                 \
+   }                                                                          \
+   for (i = 0; i < n; i++) {                                                  \
+      const uint32_t s = src[i];                                              \
+      const uint32_t d = dst[i];                                              \
+      const uint32_t sa = s >> 24;                                            \
+      uint32_t r = 0;                                                         \
+      for (c = 0; c < 32; c += 8) {                                           \
+         const uint32_t sc = (s >> c) & 0xff;                                 \
+         const uint32_t dc = (d >> c) & 0xff;                                 \
+         const uint32_t v = BLEND;                                            \
+         (void)sa; (void)dc;                                                  \
+         r |= _ALLEGRO_MIN(v, 255) << c;                                      \
+      }                                                                       \
+      dst[i] = r;                                                             \
+   }                                                                          \
+}
+
+BLEND_SPAN_8888_C(blend_span_8888_copy_c, sc)
+BLEND_SPAN_8888_C(blend_span_8888_premul_c, sc + DIV255(dc * (255 - sa)))
+BLEND_SPAN_8888_C(blend_span_8888_alpha_c, DIV255(sc * sa + dc * (255 - sa)))
+BLEND_SPAN_8888_C(blend_span_8888_add_c, sc + dc)
+
+#undef BLEND_SPAN_8888_C
+
+#define BLEND_SPAN_8888_TINT_C(name, BLEND)                                   \
+static void name(const _AL_BLEND_SPAN_8888 *b,                                \
+   uint32_t *dst, const uint32_t *src, int n)                                 \
+{                                                                             \
+   int i, c;                                                                  \
+   for (i = 0; i < n; i++) {                                                  \
+      const uint32_t s = src ? src[i] : 0xffffffff;                           \
+      const uint32_t d = dst[i];                                              \
+      uint32_t s16[4];                                                        \
+      uint32_t sa;                                                            \
+      uint32_t r = 0;                                                         \
+      for (c = 0; c < 4; c++) {                                               \
+         s16[c] = src ? MUL16(((s >> c * 8) & 0xff) * 257, b->tint[c])        \
+            : b->tint[c];                                                     \
+      }                                                                       \
+      sa = s16[3];                                                            \
+      for (c = 0; c < 4; c++) {                                               \
+         const uint32_t sc = s16[c];                                          \
+         const uint32_t dc = ((d >> c * 8) & 0xff) * 257;                     \
+         const uint32_t v = BLEND;                                            \
+         (void)sa; (void)dc;                                                  \
+         r |= DIV257(_ALLEGRO_MIN(v, 65535)) << c * 8;                        \
+      }                                                                       \
+      dst[i] = r;                                                             \
+   }                                                                          \
+}
+
+BLEND_SPAN_8888_TINT_C(blend_span_8888_copy_tint_c, sc)
+BLEND_SPAN_8888_TINT_C(blend_span_8888_premul_tint_c,
+   sc + MUL16(dc, 65535 - sa))
+BLEND_SPAN_8888_TINT_C(blend_span_8888_alpha_tint_c,
+   MUL16(sc, sa) + MUL16(dc, 65535 - sa))
+BLEND_SPAN_8888_TINT_C(blend_span_8888_add_tint_c, sc + dc)
+
+#undef BLEND_SPAN_8888_TINT_C
+
+/* Indexed by whether the source is tinted, then by the blender. */
+static const blend_span_8888_func blend_span_8888_c[2][BLEND_8888_MODES] = {
+   {
+      blend_span_8888_copy_c,
+      blend_span_8888_premul_c,
+      blend_span_8888_alpha_c,
+      blend_span_8888_add_c
+   },
+   {
+      blend_span_8888_copy_tint_c,
+      blend_span_8888_premul_tint_c,
+      blend_span_8888_alpha_tint_c,
+      blend_span_8888_add_tint_c
+   }
+};
+
+
+#ifdef _AL_HAVE_SSE2
+
+/* Four pixels per iteration, two per register with 16 bits per channel. The
+ * results are the same as those of the portable kernels, which also do the
+ * remaining pixels.
+ */
+
+static INLINE __m128i alpha16_sse2(__m128i x)
+{
+   x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(3, 3, 3, 3));
+   return _mm_shufflehi_epi16(x, _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+static INLINE __m128i div255_sse2(__m128i x)
+{
+   const __m128i one = _mm_set1_epi16(1);
+   x = _mm_add_epi16(_mm_add_epi16(x, one), _mm_srli_epi16(x, 8));
+   return _mm_srli_epi16(x, 8);
+}
+
+static INLINE __m128i mul16_sse2(__m128i x, __m128i y)
+{
+   const __m128i lo = _mm_mullo_epi16(x, y);
+   const __m128i sum = _mm_add_epi16(lo, x);
+   /* The carry out of lo + x. */
+   const __m128i carry = _mm_srli_epi16(_mm_or_si128(_mm_and_si128(lo, x),
+      _mm_andnot_si128(sum, _mm_or_si128(lo, x))), 15);
+   return _mm_add_epi16(_mm_mulhi_epu16(x, y), carry);
+}
+
+static INLINE __m128i div257_sse2(__m128i x)
+{
+   return _mm_srli_epi16(_mm_mulhi_epu16(x, _mm_set1_epi16((short)65281)), 8);
+}
+
+/* The results may exceed 255, _mm_packus_epi16 saturates them. */
+#define BLEND_SPAN_8888_SSE2(name, BLEND, tail)                               \
+static void name(const _AL_BLEND_SPAN_8888 *b,                                \
+   uint32_t *dst, const uint32_t *src, int n)                                 \
+{                                                                             \
+   const __m128i zero = _mm_setzero_si128();                                  \
+   const __m128i c255 = _mm_set1_epi16(255);                                  \
+   int i;                                                                     \
+   if (!src) {                                                                \
+      tail(b, dst, src, n);                                                   \
+      return;                                                                 \
+   }                                                                          \
+   for (i = 0; i + 4 <= n; i += 4) {                                          \
+      const __m128i s8 = _mm_loadu_si128((const __m128i *)(src + i));         \
+      const __m128i d8 = _mm_loadu_si128((const __m128i *)(dst + i));         \
+      __m128i r[2];                                                           \
+      int h;                                                                  \
+      for (h = 0; h < 2; h++) {                                               \
+         const __m128i s = h ? _mm_unpackhi_epi8(s8, zero)                    \
+            : _mm_unpacklo_epi8(s8, zero);                                    \
+         const __m128i d = h ? _mm_unpackhi_epi8(d8, zero)                    \
+            : _mm_unpacklo_epi8(d8, zero);                                    \
+         const __m128i isa = _mm_sub_epi16(c255, alpha16_sse2(s));            \
+         (void)d; (void)isa;                                                  \
+         r[h] = BLEND;                                                        \
+      }                                                                       \
+      _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(r[0], r[1]));   \
+   }                                                                          \
+   tail(b, dst + i, src + i, n - i);                                          \
+}
+
+BLEND_SPAN_8888_SSE2(blend_span_8888_copy_sse2, s, blend_span_8888_copy_c)
+BLEND_SPAN_8888_SSE2(blend_span_8888_premul_sse2,
+   _mm_add_epi16(s, div255_sse2(_mm_mullo_epi16(d, isa))),
+   blend_span_8888_premul_c)
+BLEND_SPAN_8888_SSE2(blend_span_8888_alpha_sse2,
+   div255_sse2(_mm_add_epi16(_mm_mullo_epi16(s, alpha16_sse2(s)),
+      _mm_mullo_epi16(d, isa))),
+   blend_span_8888_alpha_c)
+BLEND_SPAN_8888_SSE2(blend_span_8888_add_sse2, _mm_add_epi16(s, d),
+   blend_span_8888_add_c)
+
+#undef BLEND_SPAN_8888_SSE2
+
+#define BLEND_SPAN_8888_TINT_SSE2(name, BLEND, tail)                          \
+static void name(const _AL_BLEND_SPAN_8888 *b,                                \
+   uint32_t *dst, const uint32_t *src, int n)                                 \
+{                                                                             \
+   const __m128i t = _mm_unpacklo_epi64(                                      \
+      _mm_loadl_epi64((const __m128i *)b->tint),                              \
+      _mm_loadl_epi64((const __m128i *)b->tint));                             \
+   const __m128i ones = _mm_set1_epi16(-1);                                   \
+   int i;                                                                     \
+   for (i = 0; i + 4 <= n; i += 4) {                                          \
+      const __m128i s8 = src ? _mm_loadu_si128((const __m128i *)(src + i))    \
+         : _mm_setzero_si128();                                               \
+      const __m128i d8 = _mm_loadu_si128((const __m128i *)(dst + i));         \
+      __m128i r[2];                                                           \
+      int h;                                                                  \
+      for (h = 0; h < 2; h++) {                                               \
+         const __m128i s = !src ? t : mul16_sse2(                             \
+            h ? _mm_unpackhi_epi8(s8, s8) : _mm_unpacklo_epi8(s8, s8), t);    \
+         const __m128i d = h ? _mm_unpackhi_epi8(d8, d8)                      \
+            : _mm_unpacklo_epi8(d8, d8);                                      \
+         const __m128i sa = alpha16_sse2(s);                                  \
+         const __m128i isa = _mm_xor_si128(sa, ones);                         \
+         (void)d; (void)sa; (void)isa;                                        \
+         r[h] = div257_sse2(BLEND);                                           \
+      }                                                                       \
+      _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(r[0], r[1]));   \
+   }                                                                          \
+   tail(b, dst + i, src ? src + i : NULL, n - i);                             \
+}
+
+BLEND_SPAN_8888_TINT_SSE2(blend_span_8888_copy_tint_sse2, s,
+   blend_span_8888_copy_tint_c)
+BLEND_SPAN_8888_TINT_SSE2(blend_span_8888_premul_tint_sse2,
+   _mm_adds_epu16(s, mul16_sse2(d, isa)),
+   blend_span_8888_premul_tint_c)
+BLEND_SPAN_8888_TINT_SSE2(blend_span_8888_alpha_tint_sse2,
+   _mm_add_epi16(mul16_sse2(s, sa), mul16_sse2(d, isa)),
+   blend_span_8888_alpha_tint_c)
+BLEND_SPAN_8888_TINT_SSE2(blend_span_8888_add_tint_sse2,
+   _mm_adds_epu16(s, d), blend_span_8888_add_tint_c)
+
+#undef BLEND_SPAN_8888_TINT_SSE2
+
+static const blend_span_8888_func blend_span_8888_sse2[2][BLEND_8888_MODES] = {
+   {
+      blend_span_8888_copy_sse2,
+      blend_span_8888_premul_sse2,
+      blend_span_8888_alpha_sse2,
+      blend_span_8888_add_sse2
+   },
+   {
+      blend_span_8888_copy_tint_sse2,
+      blend_span_8888_premul_tint_sse2,
+      blend_span_8888_alpha_tint_sse2,
+      blend_span_8888_add_tint_sse2
+   }
+};
+
+#endif /* _AL_HAVE_SSE2 */
+
+
+static const BLEND_SPAN_KERNELS *blend_span_kernels = &blend_span_c;
+static const blend_span_8888_func (*blend_span_8888_kernels)[BLEND_8888_MODES]
+   = blend_span_8888_c;
+
+
+/* Internal function: _al_init_blend_spans
+ *  Selects the span blending kernels for the CPU we are running on.
+ */
+void _al_init_blend_spans(void)
+{
+   int features = _al_get_cpu_features();
+   const char *name = "portable";
+
+   (void)features;
+   blend_span_kernels = &blend_span_c;
+   blend_span_8888_kernels = blend_span_8888_c;
+#ifdef _AL_HAVE_SSE2
+   if (features & _AL_CPU_SSE2) {
+      blend_span_kernels = &blend_span_sse2;
+      blend_span_8888_kernels = blend_span_8888_sse2;
+      name = "SSE2";
+   }
+#endif
+#ifdef _AL_HAVE_AVX2
+   if (features & _AL_CPU_AVX2) {
+      blend_span_kernels = &blend_span_avx2;
+      name = "AVX2";
+   }
+#endif
+
+   ALLEGRO_DEBUG("Using %s span blenders\n", name);
+}
+
+
+static void set_factor(float k[4][4], int c, int factor, bool alpha,
+   const ALLEGRO_COLOR *const_color)
+{
+   const float *cc = (const float *)const_color;
+
+   switch (factor) {
+      case ALLEGRO_ZERO:
+         break;
+      case ALLEGRO_ONE:
+         k[0][c] = 1;
+         break;
+      case ALLEGRO_ALPHA:
+         k[1][c] = 1;
+         break;
+      case ALLEGRO_INVERSE_ALPHA:
+         k[0][c] = 1;
+         k[1][c] = -1;
+         break;
+      /* For the alpha channel these pick the source or destination alpha,
+       * which is the alpha channel of the source or destination color.
+       */
+      case ALLEGRO_SRC_COLOR:
+         k[2][c] = 1;
+         break;
+      case ALLEGRO_DEST_COLOR:
+         k[3][c] = 1;
+         break;
+      case ALLEGRO_INVERSE_SRC_COLOR:
+         k[0][c] = 1;
+         k[2][c] = -1;
+         break;
+      case ALLEGRO_INVERSE_DEST_COLOR:
+         k[0][c] = 1;
+         k[3][c] = -1;
+         break;
+      case ALLEGRO_CONST_COLOR:
+         k[0][c] = alpha ? cc[3] : cc[c];
+         break;
+      case ALLEGRO_INVERSE_CONST_COLOR:
+         k[0][c] = 1 - (alpha ? cc[3] : cc[c]);
+         break;
+      default:
+         ASSERT(false);
+         break;
+   }
+}
+
+
+static void set_op(_AL_BLEND_SPAN *b, int c, int op)
+{
+   switch (op) {
+      case ALLEGRO_ADD:
+         b->src_sign[c] = 1;
+         b->dst_sign[c] = 1;
+         b->lo[c] = -FLT_MAX;
+         b->hi[c] = 1;
+         break;
+      case ALLEGRO_SRC_MINUS_DEST:
+         b->src_sign[c] = 1;
+         b->dst_sign[c] = -1;
+         b->lo[c] = 0;
+         b->hi[c] = FLT_MAX;
+         break;
+      case ALLEGRO_DEST_MINUS_SRC:
+         b->src_sign[c] = -1;
+         b->dst_sign[c] = 1;
+         b->lo[c] = 0;
+         b->hi[c] = FLT_MAX;
+         break;
+      default:
+         ASSERT(false);
+         break;
+   }
+}
+
+
+/* Internal function: _al_init_blend_span
+ *  Resolves a blender into b. const_color may only be NULL if the blender
+ *  does not use the blend color.
+ */
+void _al_init_blend_span(_AL_BLEND_SPAN *b,
+   int op, int src_mode, int dst_mode,
+   int op_alpha, int src_alpha, int dst_alpha,
+   const ALLEGRO_COLOR *const_color)
+{
+   int c;
+
+   if (op == ALLEGRO_ADD && op_alpha == ALLEGRO_ADD &&
+         src_mode == src_alpha && dst_mode == dst_alpha) {
+      if (src_mode == ALLEGRO_ONE && dst_mode == ALLEGRO_INVERSE_ALPHA) {
+         b->blend = blend_span_kernels->premul;
+         return;
+      }
+      if (src_mode == ALLEGRO_ALPHA && dst_mode == ALLEGRO_INVERSE_ALPHA) {
+         b->blend = blend_span_kernels->alpha;
+         return;
+      }
+      if (src_mode == ALLEGRO_ONE && dst_mode == ALLEGRO_ONE) {
+         b->blend = blend_span_kernels->add;
+         return;
+      }
+   }
+
+   memset(b->src_k, 0, sizeof(b->src_k));
+   memset(b->dst_k, 0, sizeof(b->dst_k));
+   for (c = 0; c < 3; c++) {
+      set_factor(b->src_k, c, src_mode, false, const_color);
+      set_factor(b->dst_k, c, dst_mode, false, const_color);
+      set_op(b, c, op);
+   }
+   set_factor(b->src_k, 3, src_alpha, true, const_color);
+   set_factor(b->dst_k, 3, dst_alpha, true, const_color);
+   set_op(b, 3, op_alpha);
+
+   b->blend = blend_span_kernels->generic;
+}
+
+
+static int get_mode_8888(int op, int src_mode, int dst_mode,
+   int op_alpha, int src_alpha, int dst_alpha)
+{
+   if (op != ALLEGRO_ADD || op_alpha != ALLEGRO_ADD ||
+         src_mode != src_alpha || dst_mode != dst_alpha)
+      return -1;
+
+   if (src_mode == ALLEGRO_ONE && dst_mode == ALLEGRO_ZERO)
+      return BLEND_8888_COPY;
+   if (src_mode == ALLEGRO_ONE && dst_mode == ALLEGRO_INVERSE_ALPHA)
+      return BLEND_8888_PREMUL;
+   if (src_mode == ALLEGRO_ALPHA && dst_mode == ALLEGRO_INVERSE_ALPHA)
+      return BLEND_8888_ALPHA;
+   if (src_mode == ALLEGRO_ONE && dst_mode == ALLEGRO_ONE)
+      return BLEND_8888_ADD;
+   return -1;
+}
+
+
+/* Internal function: _al_compile_blender
+ *  Resolves a blender and blend color into cb.
+ */
+void _al_compile_blender(_AL_COMPILED_BLENDER *cb,
+   int op, int src_mode, int dst_mode,
+   int op_alpha, int src_alpha, int dst_alpha,
+   const ALLEGRO_COLOR *const_color)
+{
+   cb->op = op;
+   cb->src_mode = src_mode;
+   cb->dst_mode = dst_mode;
+   cb->op_alpha = op_alpha;
+   cb->src_alpha = src_alpha;
+   cb->dst_alpha = dst_alpha;
+   cb->const_color = *const_color;
+
+   cb->flags = 0;
+   if (_AL_DEST_IS_ZERO && _AL_SRC_NOT_MODIFIED)
+      cb->flags |= _AL_BLEND_COPY;
+   if (op == ALLEGRO_ADD && op_alpha == ALLEGRO_ADD &&
+         _AL_SRC_NOT_MODIFIED &&
+         dst_mode == ALLEGRO_ONE && dst_alpha == ALLEGRO_ONE)
+      cb->flags |= _AL_BLEND_ADDITIVE;
+
+   cb->mode_8888 = get_mode_8888(op, src_mode, dst_mode,
+      op_alpha, src_alpha, dst_alpha);
+
+   _al_init_blend_span(&cb->span, op, src_mode, dst_mode,
+      op_alpha, src_alpha, dst_alpha, const_color);
+}
+
+
+/* Internal function: _al_is_same_blender
+ *  Returns whether two compiled blenders were compiled from the same
+ *  blender and blend color.
+ */
+bool _al_is_same_blender(const _AL_COMPILED_BLENDER *a,
+   const _AL_COMPILED_BLENDER *b)
+{
+   return a->op == b->op && a->src_mode == b->src_mode &&
+      a->dst_mode == b->dst_mode && a->op_alpha == b->op_alpha &&
+      a->src_alpha == b->src_alpha && a->dst_alpha == b->dst_alpha &&
+      a->const_color.r == b->const_color.r &&
+      a->const_color.g == b->const_color.g &&
+      a->const_color.b == b->const_color.b &&
+      a->const_color.a == b->const_color.a;
+}
+
+
+/* Internal function: _al_init_blend_span_8888
+ *  Sets up b for blending pixels in the given format with a compiled
+ *  blender using integer arithmetic. tint may be NULL for white. Returns
+ *  false if the format, the blender or the tint is not supported, in which
+ *  case the float path has to be used.
+ */
+bool _al_init_blend_span_8888(_AL_BLEND_SPAN_8888 *b, int format,
+   const _AL_COMPILED_BLENDER *blender, const ALLEGRO_COLOR *tint)
+{
+   int red;
+   bool tinted;
+
+   if (blender->mode_8888 < 0)
+      return false;
+
+   switch (format) {
+      case ALLEGRO_PIXEL_FORMAT_ARGB_8888:
+         red = 2;
+         break;
+      case ALLEGRO_PIXEL_FORMAT_ABGR_8888:
+#ifdef ALLEGRO_LITTLE_ENDIAN
+      case ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE:
+#endif
+         red = 0;
+         break;
+      default:
+         return false;
+   }
+
+   tinted = tint && (tint->r != 1 || tint->g != 1 || tint->b != 1 ||
+      tint->a != 1);
+   if (tinted) {
+      const float *t = (const float *)tint;
+      int c;
+
+      for (c = 0; c < 4; c++) {
+         if (!(t[c] >= 0 && t[c] <= 1))
+            return false;
+      }
+      b->tint[red] = (uint16_t)(tint->r * 65535 + 0.5f);
+      b->tint[1] = (uint16_t)(tint->g * 65535 + 0.5f);
+      b->tint[2 - red] = (uint16_t)(tint->b * 65535 + 0.5f);
+      b->tint[3] = (uint16_t)(tint->a * 65535 + 0.5f);
+   }
+   else {
+      b->tint[0] = b->tint[1] = b->tint[2] = b->tint[3] = 65535;
+   }
+
+   b->blend = blend_span_8888_kernels[tinted][blender->mode_8888];
+   return true;
+}
+
+
 void _al_blend_memory(ALLEGRO_COLOR *scol,
    ALLEGRO_BITMAP *dest,
    int dx, int dy, ALLEGRO_COLOR *result)
 {
-   ALLEGRO_COLOR dcol;
-   ALLEGRO_COLOR constcol;
-   int op, src_blend, dest_blend, alpha_op, alpha_src_blend, alpha_dest_blend;
-   dcol = al_get_pixel(dest, dx, dy);
-   al_get_separate_blender(&op, &src_blend, &dest_blend,
-                           &alpha_op, &alpha_src_blend, &alpha_dest_blend);
-   constcol = al_get_blend_color();
-   _al_blend_inline(scol, &dcol,
-                    op, src_blend, dest_blend,
-                    alpha_op, alpha_src_blend, alpha_dest_blend,
-                    &constcol, result);
-   (void) _al_blend_alpha_inline; // silence compiler
+   const _AL_COMPILED_BLENDER *blender = _al_get_compiled_blender();
+   *result = al_get_pixel(dest, dx, dy);
+   blender->span.blend(&blender->span, scol, result, 1);
+   (void) _al_blend_inline; // silence compiler
+   (void) _al_blend_alpha_inline;
 }
@@ -2,6 +2,7 @@
 #include "allegro5/allegro.h"
 #include "allegro5/internal/aintern_bitmap.h"
 #include "allegro5/internal/aintern_convert.h"
+#include "allegro5/internal/aintern_cpu.h"
 static void argb_8888_to_rgba_8888(const void *src, int src_pitch,
    void *dst, int dst_pitch,
    int sx, int sy, int dx, int dy, int width, int height)
@@ -8482,4 +8483,7086 @@ void (*_al_convert_funcs[ALLEGRO_NUM_PIXEL_FORMATS]
    {NULL},
 };
 
+/* The SIMD converters need a compiler which can build SSSE3 and AVX2 code
+ * into single functions, they are picked by _al_init_convert_funcs.
+ */
+#ifdef _AL_HAVE_AVX2
+#include <immintrin.h>
+static _AL_TARGET("ssse3") void argb_8888_to_rgba_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_RGBA_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void argb_8888_to_rgba_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+            3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_RGBA_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void argb_8888_to_argb_4444_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0xf0000000)), 16);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f00000)), 12));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f000)), 8));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f0)), 4));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_ARGB_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void argb_8888_to_argb_4444_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0xf0000000)), 16);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f00000)), 12));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f000)), 8));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f0)), 4));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_ARGB_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void argb_8888_to_rgb_565_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 8);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000fc00)), 5));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 3));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_RGB_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void argb_8888_to_rgb_565_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 8);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000fc00)), 5));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 3));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_RGB_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void argb_8888_to_rgb_555_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 9);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 6));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 3));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_RGB_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void argb_8888_to_rgb_555_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 9);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 6));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 3));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_RGB_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void argb_8888_to_rgba_5551_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(s, 31);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 8));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 5));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 2));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_RGBA_5551(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void argb_8888_to_rgba_5551_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(s, 31);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 8));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 5));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 2));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_RGBA_5551(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void argb_8888_to_argb_1555_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x80000000)), 16);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 9));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 6));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 3));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_ARGB_1555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void argb_8888_to_argb_1555_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x80000000)), 16);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 9));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 6));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 3));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_ARGB_1555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void argb_8888_to_abgr_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_ABGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void argb_8888_to_abgr_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+            2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_ABGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void argb_8888_to_xbgr_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_XBGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void argb_8888_to_xbgr_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1,
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_XBGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void argb_8888_to_bgr_565_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 19);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000fc00)), 5));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 8));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_BGR_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void argb_8888_to_bgr_565_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 19);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000fc00)), 5));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 8));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_BGR_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void argb_8888_to_bgr_555_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 19);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 6));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 7));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_BGR_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void argb_8888_to_bgr_555_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 19);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 6));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 7));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_BGR_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void argb_8888_to_rgbx_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            -1, 0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_RGBX_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void argb_8888_to_rgbx_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            -1, 0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14,
+            -1, 0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_RGBX_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void argb_8888_to_xrgb_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14, -1));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_XRGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void argb_8888_to_xrgb_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14, -1,
+            0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14, -1));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_XRGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void argb_8888_to_abgr_8888_le_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_ABGR_8888_LE(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void argb_8888_to_abgr_8888_le_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+            2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_ABGR_8888_LE(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void argb_8888_to_rgba_4444_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(s, 28);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f00000)), 8));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f000)), 4));
+         d = _mm_or_si128(d,
+            _mm_and_si128(s, _mm_set1_epi32((int)0x000000f0)));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_RGBA_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void argb_8888_to_rgba_4444_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(s, 28);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f00000)), 8));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f000)), 4));
+         d = _mm256_or_si256(d,
+            _mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f0)));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ARGB_8888_TO_RGBA_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void rgba_8888_to_argb_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_ARGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgba_8888_to_argb_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12,
+            1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_ARGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void rgba_8888_to_argb_4444_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0xf0000000)), 20);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f00000)), 16));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f000)), 12));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f0)), 8));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_ARGB_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgba_8888_to_argb_4444_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0xf0000000)), 20);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f00000)), 16));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f000)), 12));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f0)), 8));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_ARGB_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void rgba_8888_to_rgb_565_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0xf8000000)), 16);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00fc0000)), 13));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 11));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_RGB_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgba_8888_to_rgb_565_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0xf8000000)), 16);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00fc0000)), 13));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 11));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_RGB_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void rgba_8888_to_rgb_555_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0xf8000000)), 17);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 14));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 11));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_RGB_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgba_8888_to_rgb_555_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0xf8000000)), 17);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 14));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 11));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_RGB_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void rgba_8888_to_rgba_5551_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0xf8000000)), 16);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 13));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 10));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00000080)), 7));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_RGBA_5551(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgba_8888_to_rgba_5551_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0xf8000000)), 16);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 13));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 10));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00000080)), 7));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_RGBA_5551(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void rgba_8888_to_argb_1555_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0xf8000000)), 17);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 14));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 11));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00000080)), 8));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_ARGB_1555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgba_8888_to_argb_1555_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0xf8000000)), 17);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 14));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 11));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00000080)), 8));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_ARGB_1555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void rgba_8888_to_abgr_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_ABGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgba_8888_to_abgr_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_ABGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void rgba_8888_to_xbgr_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            3, 2, 1, -1, 7, 6, 5, -1, 11, 10, 9, -1, 15, 14, 13, -1));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_XBGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgba_8888_to_xbgr_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            3, 2, 1, -1, 7, 6, 5, -1, 11, 10, 9, -1, 15, 14, 13, -1,
+            3, 2, 1, -1, 7, 6, 5, -1, 11, 10, 9, -1, 15, 14, 13, -1));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_XBGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void rgba_8888_to_bgr_565_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(s, 27);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00fc0000)), 13));
+         d = _mm_or_si128(d,
+            _mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_BGR_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgba_8888_to_bgr_565_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(s, 27);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00fc0000)), 13));
+         d = _mm256_or_si256(d,
+            _mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_BGR_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void rgba_8888_to_bgr_555_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(s, 27);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 14));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 1));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_BGR_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgba_8888_to_bgr_555_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(s, 27);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 14));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 1));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_BGR_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void rgba_8888_to_rgbx_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            -1, 1, 2, 3, -1, 5, 6, 7, -1, 9, 10, 11, -1, 13, 14, 15));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_RGBX_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgba_8888_to_rgbx_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            -1, 1, 2, 3, -1, 5, 6, 7, -1, 9, 10, 11, -1, 13, 14, 15,
+            -1, 1, 2, 3, -1, 5, 6, 7, -1, 9, 10, 11, -1, 13, 14, 15));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_RGBX_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void rgba_8888_to_xrgb_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            1, 2, 3, -1, 5, 6, 7, -1, 9, 10, 11, -1, 13, 14, 15, -1));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_XRGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgba_8888_to_xrgb_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            1, 2, 3, -1, 5, 6, 7, -1, 9, 10, 11, -1, 13, 14, 15, -1,
+            1, 2, 3, -1, 5, 6, 7, -1, 9, 10, 11, -1, 13, 14, 15, -1));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_XRGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void rgba_8888_to_abgr_8888_le_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_ABGR_8888_LE(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgba_8888_to_abgr_8888_le_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_ABGR_8888_LE(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void rgba_8888_to_rgba_4444_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0xf0000000)), 16);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f00000)), 12));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f000)), 8));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f0)), 4));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_RGBA_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgba_8888_to_rgba_4444_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0xf0000000)), 16);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f00000)), 12));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f000)), 8));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f0)), 4));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBA_8888_TO_RGBA_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void abgr_8888_to_argb_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_ARGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_to_argb_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+            2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_ARGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void abgr_8888_to_rgba_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_RGBA_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_to_rgba_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_RGBA_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void abgr_8888_to_argb_4444_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f00000)), 20);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0xf0000000)), 16));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f000)), 8));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f0)), 4));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_ARGB_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_to_argb_4444_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f00000)), 20);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0xf0000000)), 16));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f000)), 8));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f0)), 4));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_ARGB_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void abgr_8888_to_rgb_565_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 19);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000fc00)), 5));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 8));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_RGB_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_to_rgb_565_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 19);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000fc00)), 5));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 8));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_RGB_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void abgr_8888_to_rgb_555_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 19);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 6));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 7));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_RGB_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_to_rgb_555_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 19);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 6));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 7));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_RGB_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void abgr_8888_to_rgba_5551_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(s, 31);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 18));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 5));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 8));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_RGBA_5551(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_to_rgba_5551_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(s, 31);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 18));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 5));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 8));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_RGBA_5551(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void abgr_8888_to_argb_1555_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 19);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x80000000)), 16));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 6));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 7));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_ARGB_1555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_to_argb_1555_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 19);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x80000000)), 16));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 6));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 7));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_ARGB_1555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void abgr_8888_to_xbgr_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14, -1));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_XBGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_to_xbgr_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14, -1,
+            0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14, -1));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_XBGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void abgr_8888_to_bgr_565_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 8);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000fc00)), 5));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 3));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_BGR_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_to_bgr_565_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 8);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000fc00)), 5));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 3));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_BGR_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void abgr_8888_to_bgr_555_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 9);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 6));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 3));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_BGR_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_to_bgr_555_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 9);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 6));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 3));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_BGR_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void abgr_8888_to_rgbx_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            -1, 2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_RGBX_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_to_rgbx_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            -1, 2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12,
+            -1, 2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_RGBX_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void abgr_8888_to_xrgb_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_XRGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_to_xrgb_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1,
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_XRGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void abgr_8888_to_abgr_8888_le_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_ABGR_8888_LE(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_to_abgr_8888_le_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_ABGR_8888_LE(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void abgr_8888_to_rgba_4444_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(s, 28);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f00000)), 16));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f000)), 4));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f0)), 8));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_RGBA_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_to_rgba_4444_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(s, 28);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f00000)), 16));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f000)), 4));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f0)), 8));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_TO_RGBA_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void xbgr_8888_to_argb_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0xff000000));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_ARGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xbgr_8888_to_argb_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1,
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0xff000000));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_ARGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void xbgr_8888_to_rgba_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            -1, 2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0x000000ff));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_RGBA_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xbgr_8888_to_rgba_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            -1, 2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12,
+            -1, 2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0x000000ff));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_RGBA_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void xbgr_8888_to_argb_4444_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f00000)), 20);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f000)), 8));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f0)), 4));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0x0000f000));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_ARGB_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xbgr_8888_to_argb_4444_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f00000)), 20);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f000)), 8));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f0)), 4));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0x0000f000));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_ARGB_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void xbgr_8888_to_rgb_565_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 19);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000fc00)), 5));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 8));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_RGB_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xbgr_8888_to_rgb_565_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 19);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000fc00)), 5));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 8));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_RGB_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void xbgr_8888_to_rgb_555_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 19);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 6));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 7));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_RGB_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xbgr_8888_to_rgb_555_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 19);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 6));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 7));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_RGB_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void xbgr_8888_to_rgba_5551_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 18);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 5));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 8));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0x00000001));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_RGBA_5551(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xbgr_8888_to_rgba_5551_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 18);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 5));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 8));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0x00000001));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_RGBA_5551(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void xbgr_8888_to_argb_1555_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 19);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 6));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 7));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0x00008000));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_ARGB_1555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xbgr_8888_to_argb_1555_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 19);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 6));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 7));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0x00008000));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_ARGB_1555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void xbgr_8888_to_abgr_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14, -1));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0xff000000));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_ABGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xbgr_8888_to_abgr_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14, -1,
+            0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14, -1));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0xff000000));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_ABGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void xbgr_8888_to_bgr_565_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 8);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000fc00)), 5));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 3));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_BGR_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xbgr_8888_to_bgr_565_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 8);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000fc00)), 5));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 3));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_BGR_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void xbgr_8888_to_bgr_555_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 9);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 6));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 3));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_BGR_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xbgr_8888_to_bgr_555_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 9);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 6));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 3));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_BGR_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void xbgr_8888_to_rgbx_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            -1, 2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_RGBX_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xbgr_8888_to_rgbx_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            -1, 2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12,
+            -1, 2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_RGBX_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void xbgr_8888_to_xrgb_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_XRGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xbgr_8888_to_xrgb_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1,
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_XRGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void xbgr_8888_to_abgr_8888_le_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14, -1));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0xff000000));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_ABGR_8888_LE(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xbgr_8888_to_abgr_8888_le_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14, -1,
+            0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14, -1));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0xff000000));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_ABGR_8888_LE(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void xbgr_8888_to_rgba_4444_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f00000)), 16);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f000)), 4));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f0)), 8));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0x0000000f));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_RGBA_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xbgr_8888_to_rgba_4444_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f00000)), 16);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f000)), 4));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f0)), 8));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0x0000000f));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XBGR_8888_TO_RGBA_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void rgbx_8888_to_argb_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            1, 2, 3, -1, 5, 6, 7, -1, 9, 10, 11, -1, 13, 14, 15, -1));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0xff000000));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_ARGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgbx_8888_to_argb_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            1, 2, 3, -1, 5, 6, 7, -1, 9, 10, 11, -1, 13, 14, 15, -1,
+            1, 2, 3, -1, 5, 6, 7, -1, 9, 10, 11, -1, 13, 14, 15, -1));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0xff000000));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_ARGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void rgbx_8888_to_rgba_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            -1, 1, 2, 3, -1, 5, 6, 7, -1, 9, 10, 11, -1, 13, 14, 15));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0x000000ff));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_RGBA_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgbx_8888_to_rgba_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            -1, 1, 2, 3, -1, 5, 6, 7, -1, 9, 10, 11, -1, 13, 14, 15,
+            -1, 1, 2, 3, -1, 5, 6, 7, -1, 9, 10, 11, -1, 13, 14, 15));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0x000000ff));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_RGBA_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void rgbx_8888_to_argb_4444_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0xf0000000)), 20);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f00000)), 16));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f000)), 12));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0x0000f000));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_ARGB_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgbx_8888_to_argb_4444_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0xf0000000)), 20);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f00000)), 16));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f000)), 12));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0x0000f000));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_ARGB_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void rgbx_8888_to_rgb_565_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0xf8000000)), 16);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00fc0000)), 13));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 11));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_RGB_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgbx_8888_to_rgb_565_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0xf8000000)), 16);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00fc0000)), 13));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 11));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_RGB_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void rgbx_8888_to_rgb_555_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0xf8000000)), 17);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 14));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 11));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_RGB_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgbx_8888_to_rgb_555_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0xf8000000)), 17);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 14));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 11));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_RGB_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void rgbx_8888_to_rgba_5551_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0xf8000000)), 16);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 13));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 10));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0x00000001));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_RGBA_5551(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgbx_8888_to_rgba_5551_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0xf8000000)), 16);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 13));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 10));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0x00000001));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_RGBA_5551(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void rgbx_8888_to_argb_1555_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0xf8000000)), 17);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 14));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 11));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0x00008000));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_ARGB_1555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgbx_8888_to_argb_1555_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0xf8000000)), 17);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 14));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 11));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0x00008000));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_ARGB_1555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void rgbx_8888_to_abgr_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            3, 2, 1, -1, 7, 6, 5, -1, 11, 10, 9, -1, 15, 14, 13, -1));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0xff000000));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_ABGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgbx_8888_to_abgr_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            3, 2, 1, -1, 7, 6, 5, -1, 11, 10, 9, -1, 15, 14, 13, -1,
+            3, 2, 1, -1, 7, 6, 5, -1, 11, 10, 9, -1, 15, 14, 13, -1));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0xff000000));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_ABGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void rgbx_8888_to_xbgr_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            3, 2, 1, -1, 7, 6, 5, -1, 11, 10, 9, -1, 15, 14, 13, -1));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_XBGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgbx_8888_to_xbgr_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            3, 2, 1, -1, 7, 6, 5, -1, 11, 10, 9, -1, 15, 14, 13, -1,
+            3, 2, 1, -1, 7, 6, 5, -1, 11, 10, 9, -1, 15, 14, 13, -1));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_XBGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void rgbx_8888_to_bgr_565_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(s, 27);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00fc0000)), 13));
+         d = _mm_or_si128(d,
+            _mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_BGR_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgbx_8888_to_bgr_565_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(s, 27);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00fc0000)), 13));
+         d = _mm256_or_si256(d,
+            _mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_BGR_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void rgbx_8888_to_bgr_555_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(s, 27);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 14));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 1));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_BGR_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgbx_8888_to_bgr_555_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(s, 27);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 14));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 1));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_BGR_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void rgbx_8888_to_xrgb_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            1, 2, 3, -1, 5, 6, 7, -1, 9, 10, 11, -1, 13, 14, 15, -1));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_XRGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgbx_8888_to_xrgb_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            1, 2, 3, -1, 5, 6, 7, -1, 9, 10, 11, -1, 13, 14, 15, -1,
+            1, 2, 3, -1, 5, 6, 7, -1, 9, 10, 11, -1, 13, 14, 15, -1));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_XRGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void rgbx_8888_to_abgr_8888_le_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            3, 2, 1, -1, 7, 6, 5, -1, 11, 10, 9, -1, 15, 14, 13, -1));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0xff000000));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_ABGR_8888_LE(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgbx_8888_to_abgr_8888_le_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            3, 2, 1, -1, 7, 6, 5, -1, 11, 10, 9, -1, 15, 14, 13, -1,
+            3, 2, 1, -1, 7, 6, 5, -1, 11, 10, 9, -1, 15, 14, 13, -1));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0xff000000));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_ABGR_8888_LE(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void rgbx_8888_to_rgba_4444_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0xf0000000)), 16);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f00000)), 12));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f000)), 8));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0x0000000f));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_RGBA_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void rgbx_8888_to_rgba_4444_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0xf0000000)), 16);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f00000)), 12));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f000)), 8));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0x0000000f));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_RGBX_8888_TO_RGBA_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void xrgb_8888_to_argb_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14, -1));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0xff000000));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_ARGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xrgb_8888_to_argb_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14, -1,
+            0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14, -1));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0xff000000));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_ARGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void xrgb_8888_to_rgba_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            -1, 0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0x000000ff));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_RGBA_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xrgb_8888_to_rgba_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            -1, 0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14,
+            -1, 0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0x000000ff));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_RGBA_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void xrgb_8888_to_argb_4444_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f00000)), 12);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f000)), 8));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f0)), 4));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0x0000f000));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_ARGB_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xrgb_8888_to_argb_4444_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f00000)), 12);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f000)), 8));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f0)), 4));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0x0000f000));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_ARGB_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void xrgb_8888_to_rgb_565_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 8);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000fc00)), 5));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 3));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_RGB_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xrgb_8888_to_rgb_565_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 8);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000fc00)), 5));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 3));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_RGB_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void xrgb_8888_to_rgb_555_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 9);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 6));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 3));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_RGB_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xrgb_8888_to_rgb_555_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 9);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 6));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 3));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_RGB_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void xrgb_8888_to_rgba_5551_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 8);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 5));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 2));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0x00000001));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_RGBA_5551(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xrgb_8888_to_rgba_5551_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 8);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 5));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 2));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0x00000001));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_RGBA_5551(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void xrgb_8888_to_argb_1555_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 9);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 6));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 3));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0x00008000));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_ARGB_1555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xrgb_8888_to_argb_1555_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 9);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 6));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 3));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0x00008000));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_ARGB_1555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void xrgb_8888_to_abgr_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0xff000000));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_ABGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xrgb_8888_to_abgr_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1,
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0xff000000));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_ABGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void xrgb_8888_to_xbgr_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_XBGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xrgb_8888_to_xbgr_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1,
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_XBGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void xrgb_8888_to_bgr_565_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 19);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000fc00)), 5));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 8));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_BGR_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xrgb_8888_to_bgr_565_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 19);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000fc00)), 5));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 8));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_BGR_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void xrgb_8888_to_bgr_555_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 19);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 6));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 7));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_BGR_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xrgb_8888_to_bgr_555_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 19);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 6));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 7));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_BGR_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void xrgb_8888_to_rgbx_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            -1, 0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_RGBX_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xrgb_8888_to_rgbx_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            -1, 0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14,
+            -1, 0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_RGBX_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void xrgb_8888_to_abgr_8888_le_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0xff000000));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_ABGR_8888_LE(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xrgb_8888_to_abgr_8888_le_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1,
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0xff000000));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_ABGR_8888_LE(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void xrgb_8888_to_rgba_4444_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f00000)), 8);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f000)), 4));
+         d = _mm_or_si128(d,
+            _mm_and_si128(s, _mm_set1_epi32((int)0x000000f0)));
+         d = _mm_or_si128(d, _mm_set1_epi32((int)0x0000000f));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_RGBA_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void xrgb_8888_to_rgba_4444_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f00000)), 8);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f000)), 4));
+         d = _mm256_or_si256(d,
+            _mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f0)));
+         d = _mm256_or_si256(d, _mm256_set1_epi32((int)0x0000000f));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_XRGB_8888_TO_RGBA_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void abgr_8888_le_to_argb_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_ARGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_le_to_argb_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+            2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_ARGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void abgr_8888_le_to_rgba_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_RGBA_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_le_to_rgba_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_RGBA_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void abgr_8888_le_to_argb_4444_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f00000)), 20);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0xf0000000)), 16));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f000)), 8));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f0)), 4));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_ARGB_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_le_to_argb_4444_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f00000)), 20);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0xf0000000)), 16));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f000)), 8));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f0)), 4));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_ARGB_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void abgr_8888_le_to_rgb_565_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 19);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000fc00)), 5));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 8));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_RGB_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_le_to_rgb_565_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 19);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000fc00)), 5));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 8));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_RGB_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void abgr_8888_le_to_rgb_555_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 19);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 6));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 7));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_RGB_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_le_to_rgb_555_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 19);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 6));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 7));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_RGB_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void abgr_8888_le_to_rgba_5551_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(s, 31);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 18));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 5));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 8));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_RGBA_5551(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_le_to_rgba_5551_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(s, 31);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 18));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 5));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 8));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_RGBA_5551(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void abgr_8888_le_to_argb_1555_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 19);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x80000000)), 16));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 6));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 7));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_ARGB_1555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_le_to_argb_1555_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 19);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x80000000)), 16));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 6));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 7));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_ARGB_1555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void abgr_8888_le_to_abgr_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_ABGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_le_to_abgr_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_ABGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void abgr_8888_le_to_xbgr_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14, -1));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_XBGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_le_to_xbgr_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14, -1,
+            0, 1, 2, -1, 4, 5, 6, -1, 8, 9, 10, -1, 12, 13, 14, -1));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_XBGR_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void abgr_8888_le_to_bgr_565_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 8);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000fc00)), 5));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 3));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_BGR_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_le_to_bgr_565_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 8);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000fc00)), 5));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 3));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_BGR_565(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void abgr_8888_le_to_bgr_555_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f80000)), 9);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f800)), 6));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f8)), 3));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_BGR_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_le_to_bgr_555_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f80000)), 9);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f800)), 6));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f8)), 3));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_BGR_555(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void abgr_8888_le_to_rgbx_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            -1, 2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_RGBX_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_le_to_rgbx_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            -1, 2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12,
+            -1, 2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_RGBX_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("ssse3") void abgr_8888_le_to_xrgb_8888_ssse3(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_shuffle_epi8(s, _mm_setr_epi8(
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1));
+         _mm_storeu_si128((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_XRGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_le_to_xrgb_8888_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint32_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 4 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint32_t *dst_end = dst_ptr + width;
+      uint32_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_shuffle_epi8(s, _mm256_setr_epi8(
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1,
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1));
+         _mm256_storeu_si256((__m256i *)dst_ptr, d);
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_XRGB_8888(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static void abgr_8888_le_to_rgba_4444_sse2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~3);
+      while (dst_ptr < dst_vec_end) {
+         __m128i s = _mm_loadu_si128((const __m128i *)src_ptr);
+         __m128i d = _mm_srli_epi32(s, 28);
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x00f00000)), 16));
+         d = _mm_or_si128(d,
+            _mm_srli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x0000f000)), 4));
+         d = _mm_or_si128(d,
+            _mm_slli_epi32(_mm_and_si128(s, _mm_set1_epi32((int)0x000000f0)), 8));
+         d = _mm_sub_epi32(d, _mm_set1_epi32(0x8000));
+         d = _mm_packs_epi32(d, d);
+         d = _mm_add_epi16(d, _mm_set1_epi16((short)0x8000));
+         _mm_storel_epi64((__m128i *)dst_ptr, d);
+         dst_ptr += 4;
+         src_ptr += 4;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_RGBA_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+static _AL_TARGET("avx2") void abgr_8888_le_to_rgba_4444_avx2(const void *src, int src_pitch,
+   void *dst, int dst_pitch,
+   int sx, int sy, int dx, int dy, int width, int height)
+{
+   int y;
+   const uint32_t *src_ptr = (const uint32_t *)((const char *)src + sy * src_pitch);
+   uint16_t *dst_ptr = (void *)((char *)dst + dy * dst_pitch);
+   int src_gap = src_pitch / 4 - width;
+   int dst_gap = dst_pitch / 2 - width;
+   src_ptr += sx;
+   dst_ptr += dx;
+   for (y = 0; y < height; y++) {
+      uint16_t *dst_end = dst_ptr + width;
+      uint16_t *dst_vec_end = dst_ptr + (width & ~7);
+      while (dst_ptr < dst_vec_end) {
+         __m256i s = _mm256_loadu_si256((const __m256i *)src_ptr);
+         __m256i d = _mm256_srli_epi32(s, 28);
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x00f00000)), 16));
+         d = _mm256_or_si256(d,
+            _mm256_srli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x0000f000)), 4));
+         d = _mm256_or_si256(d,
+            _mm256_slli_epi32(_mm256_and_si256(s, _mm256_set1_epi32((int)0x000000f0)), 8));
+         d = _mm256_packus_epi32(d, d);
+         d = _mm256_permute4x64_epi64(d, 0x08);
+         _mm_storeu_si128((__m128i *)dst_ptr, _mm256_castsi256_si128(d));
+         dst_ptr += 8;
+         src_ptr += 8;
+      }
+      while (dst_ptr < dst_end) {
+         *dst_ptr = ALLEGRO_CONVERT_ABGR_8888_LE_TO_RGBA_4444(*src_ptr);
+         dst_ptr++;
+         src_ptr++;
+      }
+      src_ptr += src_gap;
+      dst_ptr += dst_gap;
+   }
+}
+
+typedef void (*CONVERT_FUNC)(const void *, int, void *, int,
+   int, int, int, int, int, int);
+
+typedef struct SIMD_CONVERTER {
+   int src_format, dst_format;
+   int features;
+   CONVERT_FUNC portable, simd, avx2;
+} SIMD_CONVERTER;
+
+static const SIMD_CONVERTER simd_converters[] = {
+   {ALLEGRO_PIXEL_FORMAT_ARGB_8888, ALLEGRO_PIXEL_FORMAT_RGBA_8888, _AL_CPU_SSSE3,
+      argb_8888_to_rgba_8888, argb_8888_to_rgba_8888_ssse3, argb_8888_to_rgba_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ARGB_8888, ALLEGRO_PIXEL_FORMAT_ARGB_4444, _AL_CPU_SSE2,
+      argb_8888_to_argb_4444, argb_8888_to_argb_4444_sse2, argb_8888_to_argb_4444_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ARGB_8888, ALLEGRO_PIXEL_FORMAT_RGB_565, _AL_CPU_SSE2,
+      argb_8888_to_rgb_565, argb_8888_to_rgb_565_sse2, argb_8888_to_rgb_565_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ARGB_8888, ALLEGRO_PIXEL_FORMAT_RGB_555, _AL_CPU_SSE2,
+      argb_8888_to_rgb_555, argb_8888_to_rgb_555_sse2, argb_8888_to_rgb_555_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ARGB_8888, ALLEGRO_PIXEL_FORMAT_RGBA_5551, _AL_CPU_SSE2,
+      argb_8888_to_rgba_5551, argb_8888_to_rgba_5551_sse2, argb_8888_to_rgba_5551_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ARGB_8888, ALLEGRO_PIXEL_FORMAT_ARGB_1555, _AL_CPU_SSE2,
+      argb_8888_to_argb_1555, argb_8888_to_argb_1555_sse2, argb_8888_to_argb_1555_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ARGB_8888, ALLEGRO_PIXEL_FORMAT_ABGR_8888, _AL_CPU_SSSE3,
+      argb_8888_to_abgr_8888, argb_8888_to_abgr_8888_ssse3, argb_8888_to_abgr_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ARGB_8888, ALLEGRO_PIXEL_FORMAT_XBGR_8888, _AL_CPU_SSSE3,
+      argb_8888_to_xbgr_8888, argb_8888_to_xbgr_8888_ssse3, argb_8888_to_xbgr_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ARGB_8888, ALLEGRO_PIXEL_FORMAT_BGR_565, _AL_CPU_SSE2,
+      argb_8888_to_bgr_565, argb_8888_to_bgr_565_sse2, argb_8888_to_bgr_565_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ARGB_8888, ALLEGRO_PIXEL_FORMAT_BGR_555, _AL_CPU_SSE2,
+      argb_8888_to_bgr_555, argb_8888_to_bgr_555_sse2, argb_8888_to_bgr_555_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ARGB_8888, ALLEGRO_PIXEL_FORMAT_RGBX_8888, _AL_CPU_SSSE3,
+      argb_8888_to_rgbx_8888, argb_8888_to_rgbx_8888_ssse3, argb_8888_to_rgbx_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ARGB_8888, ALLEGRO_PIXEL_FORMAT_XRGB_8888, _AL_CPU_SSSE3,
+      argb_8888_to_xrgb_8888, argb_8888_to_xrgb_8888_ssse3, argb_8888_to_xrgb_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ARGB_8888, ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, _AL_CPU_SSSE3,
+      argb_8888_to_abgr_8888_le, argb_8888_to_abgr_8888_le_ssse3, argb_8888_to_abgr_8888_le_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ARGB_8888, ALLEGRO_PIXEL_FORMAT_RGBA_4444, _AL_CPU_SSE2,
+      argb_8888_to_rgba_4444, argb_8888_to_rgba_4444_sse2, argb_8888_to_rgba_4444_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBA_8888, ALLEGRO_PIXEL_FORMAT_ARGB_8888, _AL_CPU_SSSE3,
+      rgba_8888_to_argb_8888, rgba_8888_to_argb_8888_ssse3, rgba_8888_to_argb_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBA_8888, ALLEGRO_PIXEL_FORMAT_ARGB_4444, _AL_CPU_SSE2,
+      rgba_8888_to_argb_4444, rgba_8888_to_argb_4444_sse2, rgba_8888_to_argb_4444_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBA_8888, ALLEGRO_PIXEL_FORMAT_RGB_565, _AL_CPU_SSE2,
+      rgba_8888_to_rgb_565, rgba_8888_to_rgb_565_sse2, rgba_8888_to_rgb_565_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBA_8888, ALLEGRO_PIXEL_FORMAT_RGB_555, _AL_CPU_SSE2,
+      rgba_8888_to_rgb_555, rgba_8888_to_rgb_555_sse2, rgba_8888_to_rgb_555_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBA_8888, ALLEGRO_PIXEL_FORMAT_RGBA_5551, _AL_CPU_SSE2,
+      rgba_8888_to_rgba_5551, rgba_8888_to_rgba_5551_sse2, rgba_8888_to_rgba_5551_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBA_8888, ALLEGRO_PIXEL_FORMAT_ARGB_1555, _AL_CPU_SSE2,
+      rgba_8888_to_argb_1555, rgba_8888_to_argb_1555_sse2, rgba_8888_to_argb_1555_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBA_8888, ALLEGRO_PIXEL_FORMAT_ABGR_8888, _AL_CPU_SSSE3,
+      rgba_8888_to_abgr_8888, rgba_8888_to_abgr_8888_ssse3, rgba_8888_to_abgr_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBA_8888, ALLEGRO_PIXEL_FORMAT_XBGR_8888, _AL_CPU_SSSE3,
+      rgba_8888_to_xbgr_8888, rgba_8888_to_xbgr_8888_ssse3, rgba_8888_to_xbgr_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBA_8888, ALLEGRO_PIXEL_FORMAT_BGR_565, _AL_CPU_SSE2,
+      rgba_8888_to_bgr_565, rgba_8888_to_bgr_565_sse2, rgba_8888_to_bgr_565_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBA_8888, ALLEGRO_PIXEL_FORMAT_BGR_555, _AL_CPU_SSE2,
+      rgba_8888_to_bgr_555, rgba_8888_to_bgr_555_sse2, rgba_8888_to_bgr_555_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBA_8888, ALLEGRO_PIXEL_FORMAT_RGBX_8888, _AL_CPU_SSSE3,
+      rgba_8888_to_rgbx_8888, rgba_8888_to_rgbx_8888_ssse3, rgba_8888_to_rgbx_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBA_8888, ALLEGRO_PIXEL_FORMAT_XRGB_8888, _AL_CPU_SSSE3,
+      rgba_8888_to_xrgb_8888, rgba_8888_to_xrgb_8888_ssse3, rgba_8888_to_xrgb_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBA_8888, ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, _AL_CPU_SSSE3,
+      rgba_8888_to_abgr_8888_le, rgba_8888_to_abgr_8888_le_ssse3, rgba_8888_to_abgr_8888_le_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBA_8888, ALLEGRO_PIXEL_FORMAT_RGBA_4444, _AL_CPU_SSE2,
+      rgba_8888_to_rgba_4444, rgba_8888_to_rgba_4444_sse2, rgba_8888_to_rgba_4444_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888, ALLEGRO_PIXEL_FORMAT_ARGB_8888, _AL_CPU_SSSE3,
+      abgr_8888_to_argb_8888, abgr_8888_to_argb_8888_ssse3, abgr_8888_to_argb_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888, ALLEGRO_PIXEL_FORMAT_RGBA_8888, _AL_CPU_SSSE3,
+      abgr_8888_to_rgba_8888, abgr_8888_to_rgba_8888_ssse3, abgr_8888_to_rgba_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888, ALLEGRO_PIXEL_FORMAT_ARGB_4444, _AL_CPU_SSE2,
+      abgr_8888_to_argb_4444, abgr_8888_to_argb_4444_sse2, abgr_8888_to_argb_4444_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888, ALLEGRO_PIXEL_FORMAT_RGB_565, _AL_CPU_SSE2,
+      abgr_8888_to_rgb_565, abgr_8888_to_rgb_565_sse2, abgr_8888_to_rgb_565_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888, ALLEGRO_PIXEL_FORMAT_RGB_555, _AL_CPU_SSE2,
+      abgr_8888_to_rgb_555, abgr_8888_to_rgb_555_sse2, abgr_8888_to_rgb_555_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888, ALLEGRO_PIXEL_FORMAT_RGBA_5551, _AL_CPU_SSE2,
+      abgr_8888_to_rgba_5551, abgr_8888_to_rgba_5551_sse2, abgr_8888_to_rgba_5551_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888, ALLEGRO_PIXEL_FORMAT_ARGB_1555, _AL_CPU_SSE2,
+      abgr_8888_to_argb_1555, abgr_8888_to_argb_1555_sse2, abgr_8888_to_argb_1555_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888, ALLEGRO_PIXEL_FORMAT_XBGR_8888, _AL_CPU_SSSE3,
+      abgr_8888_to_xbgr_8888, abgr_8888_to_xbgr_8888_ssse3, abgr_8888_to_xbgr_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888, ALLEGRO_PIXEL_FORMAT_BGR_565, _AL_CPU_SSE2,
+      abgr_8888_to_bgr_565, abgr_8888_to_bgr_565_sse2, abgr_8888_to_bgr_565_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888, ALLEGRO_PIXEL_FORMAT_BGR_555, _AL_CPU_SSE2,
+      abgr_8888_to_bgr_555, abgr_8888_to_bgr_555_sse2, abgr_8888_to_bgr_555_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888, ALLEGRO_PIXEL_FORMAT_RGBX_8888, _AL_CPU_SSSE3,
+      abgr_8888_to_rgbx_8888, abgr_8888_to_rgbx_8888_ssse3, abgr_8888_to_rgbx_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888, ALLEGRO_PIXEL_FORMAT_XRGB_8888, _AL_CPU_SSSE3,
+      abgr_8888_to_xrgb_8888, abgr_8888_to_xrgb_8888_ssse3, abgr_8888_to_xrgb_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888, ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, _AL_CPU_SSSE3,
+      abgr_8888_to_abgr_8888_le, abgr_8888_to_abgr_8888_le_ssse3, abgr_8888_to_abgr_8888_le_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888, ALLEGRO_PIXEL_FORMAT_RGBA_4444, _AL_CPU_SSE2,
+      abgr_8888_to_rgba_4444, abgr_8888_to_rgba_4444_sse2, abgr_8888_to_rgba_4444_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XBGR_8888, ALLEGRO_PIXEL_FORMAT_ARGB_8888, _AL_CPU_SSSE3,
+      xbgr_8888_to_argb_8888, xbgr_8888_to_argb_8888_ssse3, xbgr_8888_to_argb_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XBGR_8888, ALLEGRO_PIXEL_FORMAT_RGBA_8888, _AL_CPU_SSSE3,
+      xbgr_8888_to_rgba_8888, xbgr_8888_to_rgba_8888_ssse3, xbgr_8888_to_rgba_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XBGR_8888, ALLEGRO_PIXEL_FORMAT_ARGB_4444, _AL_CPU_SSE2,
+      xbgr_8888_to_argb_4444, xbgr_8888_to_argb_4444_sse2, xbgr_8888_to_argb_4444_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XBGR_8888, ALLEGRO_PIXEL_FORMAT_RGB_565, _AL_CPU_SSE2,
+      xbgr_8888_to_rgb_565, xbgr_8888_to_rgb_565_sse2, xbgr_8888_to_rgb_565_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XBGR_8888, ALLEGRO_PIXEL_FORMAT_RGB_555, _AL_CPU_SSE2,
+      xbgr_8888_to_rgb_555, xbgr_8888_to_rgb_555_sse2, xbgr_8888_to_rgb_555_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XBGR_8888, ALLEGRO_PIXEL_FORMAT_RGBA_5551, _AL_CPU_SSE2,
+      xbgr_8888_to_rgba_5551, xbgr_8888_to_rgba_5551_sse2, xbgr_8888_to_rgba_5551_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XBGR_8888, ALLEGRO_PIXEL_FORMAT_ARGB_1555, _AL_CPU_SSE2,
+      xbgr_8888_to_argb_1555, xbgr_8888_to_argb_1555_sse2, xbgr_8888_to_argb_1555_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XBGR_8888, ALLEGRO_PIXEL_FORMAT_ABGR_8888, _AL_CPU_SSSE3,
+      xbgr_8888_to_abgr_8888, xbgr_8888_to_abgr_8888_ssse3, xbgr_8888_to_abgr_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XBGR_8888, ALLEGRO_PIXEL_FORMAT_BGR_565, _AL_CPU_SSE2,
+      xbgr_8888_to_bgr_565, xbgr_8888_to_bgr_565_sse2, xbgr_8888_to_bgr_565_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XBGR_8888, ALLEGRO_PIXEL_FORMAT_BGR_555, _AL_CPU_SSE2,
+      xbgr_8888_to_bgr_555, xbgr_8888_to_bgr_555_sse2, xbgr_8888_to_bgr_555_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XBGR_8888, ALLEGRO_PIXEL_FORMAT_RGBX_8888, _AL_CPU_SSSE3,
+      xbgr_8888_to_rgbx_8888, xbgr_8888_to_rgbx_8888_ssse3, xbgr_8888_to_rgbx_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XBGR_8888, ALLEGRO_PIXEL_FORMAT_XRGB_8888, _AL_CPU_SSSE3,
+      xbgr_8888_to_xrgb_8888, xbgr_8888_to_xrgb_8888_ssse3, xbgr_8888_to_xrgb_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XBGR_8888, ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, _AL_CPU_SSSE3,
+      xbgr_8888_to_abgr_8888_le, xbgr_8888_to_abgr_8888_le_ssse3, xbgr_8888_to_abgr_8888_le_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XBGR_8888, ALLEGRO_PIXEL_FORMAT_RGBA_4444, _AL_CPU_SSE2,
+      xbgr_8888_to_rgba_4444, xbgr_8888_to_rgba_4444_sse2, xbgr_8888_to_rgba_4444_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBX_8888, ALLEGRO_PIXEL_FORMAT_ARGB_8888, _AL_CPU_SSSE3,
+      rgbx_8888_to_argb_8888, rgbx_8888_to_argb_8888_ssse3, rgbx_8888_to_argb_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBX_8888, ALLEGRO_PIXEL_FORMAT_RGBA_8888, _AL_CPU_SSSE3,
+      rgbx_8888_to_rgba_8888, rgbx_8888_to_rgba_8888_ssse3, rgbx_8888_to_rgba_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBX_8888, ALLEGRO_PIXEL_FORMAT_ARGB_4444, _AL_CPU_SSE2,
+      rgbx_8888_to_argb_4444, rgbx_8888_to_argb_4444_sse2, rgbx_8888_to_argb_4444_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBX_8888, ALLEGRO_PIXEL_FORMAT_RGB_565, _AL_CPU_SSE2,
+      rgbx_8888_to_rgb_565, rgbx_8888_to_rgb_565_sse2, rgbx_8888_to_rgb_565_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBX_8888, ALLEGRO_PIXEL_FORMAT_RGB_555, _AL_CPU_SSE2,
+      rgbx_8888_to_rgb_555, rgbx_8888_to_rgb_555_sse2, rgbx_8888_to_rgb_555_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBX_8888, ALLEGRO_PIXEL_FORMAT_RGBA_5551, _AL_CPU_SSE2,
+      rgbx_8888_to_rgba_5551, rgbx_8888_to_rgba_5551_sse2, rgbx_8888_to_rgba_5551_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBX_8888, ALLEGRO_PIXEL_FORMAT_ARGB_1555, _AL_CPU_SSE2,
+      rgbx_8888_to_argb_1555, rgbx_8888_to_argb_1555_sse2, rgbx_8888_to_argb_1555_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBX_8888, ALLEGRO_PIXEL_FORMAT_ABGR_8888, _AL_CPU_SSSE3,
+      rgbx_8888_to_abgr_8888, rgbx_8888_to_abgr_8888_ssse3, rgbx_8888_to_abgr_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBX_8888, ALLEGRO_PIXEL_FORMAT_XBGR_8888, _AL_CPU_SSSE3,
+      rgbx_8888_to_xbgr_8888, rgbx_8888_to_xbgr_8888_ssse3, rgbx_8888_to_xbgr_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBX_8888, ALLEGRO_PIXEL_FORMAT_BGR_565, _AL_CPU_SSE2,
+      rgbx_8888_to_bgr_565, rgbx_8888_to_bgr_565_sse2, rgbx_8888_to_bgr_565_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBX_8888, ALLEGRO_PIXEL_FORMAT_BGR_555, _AL_CPU_SSE2,
+      rgbx_8888_to_bgr_555, rgbx_8888_to_bgr_555_sse2, rgbx_8888_to_bgr_555_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBX_8888, ALLEGRO_PIXEL_FORMAT_XRGB_8888, _AL_CPU_SSSE3,
+      rgbx_8888_to_xrgb_8888, rgbx_8888_to_xrgb_8888_ssse3, rgbx_8888_to_xrgb_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBX_8888, ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, _AL_CPU_SSSE3,
+      rgbx_8888_to_abgr_8888_le, rgbx_8888_to_abgr_8888_le_ssse3, rgbx_8888_to_abgr_8888_le_avx2},
+   {ALLEGRO_PIXEL_FORMAT_RGBX_8888, ALLEGRO_PIXEL_FORMAT_RGBA_4444, _AL_CPU_SSE2,
+      rgbx_8888_to_rgba_4444, rgbx_8888_to_rgba_4444_sse2, rgbx_8888_to_rgba_4444_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XRGB_8888, ALLEGRO_PIXEL_FORMAT_ARGB_8888, _AL_CPU_SSSE3,
+      xrgb_8888_to_argb_8888, xrgb_8888_to_argb_8888_ssse3, xrgb_8888_to_argb_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XRGB_8888, ALLEGRO_PIXEL_FORMAT_RGBA_8888, _AL_CPU_SSSE3,
+      xrgb_8888_to_rgba_8888, xrgb_8888_to_rgba_8888_ssse3, xrgb_8888_to_rgba_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XRGB_8888, ALLEGRO_PIXEL_FORMAT_ARGB_4444, _AL_CPU_SSE2,
+      xrgb_8888_to_argb_4444, xrgb_8888_to_argb_4444_sse2, xrgb_8888_to_argb_4444_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XRGB_8888, ALLEGRO_PIXEL_FORMAT_RGB_565, _AL_CPU_SSE2,
+      xrgb_8888_to_rgb_565, xrgb_8888_to_rgb_565_sse2, xrgb_8888_to_rgb_565_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XRGB_8888, ALLEGRO_PIXEL_FORMAT_RGB_555, _AL_CPU_SSE2,
+      xrgb_8888_to_rgb_555, xrgb_8888_to_rgb_555_sse2, xrgb_8888_to_rgb_555_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XRGB_8888, ALLEGRO_PIXEL_FORMAT_RGBA_5551, _AL_CPU_SSE2,
+      xrgb_8888_to_rgba_5551, xrgb_8888_to_rgba_5551_sse2, xrgb_8888_to_rgba_5551_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XRGB_8888, ALLEGRO_PIXEL_FORMAT_ARGB_1555, _AL_CPU_SSE2,
+      xrgb_8888_to_argb_1555, xrgb_8888_to_argb_1555_sse2, xrgb_8888_to_argb_1555_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XRGB_8888, ALLEGRO_PIXEL_FORMAT_ABGR_8888, _AL_CPU_SSSE3,
+      xrgb_8888_to_abgr_8888, xrgb_8888_to_abgr_8888_ssse3, xrgb_8888_to_abgr_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XRGB_8888, ALLEGRO_PIXEL_FORMAT_XBGR_8888, _AL_CPU_SSSE3,
+      xrgb_8888_to_xbgr_8888, xrgb_8888_to_xbgr_8888_ssse3, xrgb_8888_to_xbgr_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XRGB_8888, ALLEGRO_PIXEL_FORMAT_BGR_565, _AL_CPU_SSE2,
+      xrgb_8888_to_bgr_565, xrgb_8888_to_bgr_565_sse2, xrgb_8888_to_bgr_565_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XRGB_8888, ALLEGRO_PIXEL_FORMAT_BGR_555, _AL_CPU_SSE2,
+      xrgb_8888_to_bgr_555, xrgb_8888_to_bgr_555_sse2, xrgb_8888_to_bgr_555_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XRGB_8888, ALLEGRO_PIXEL_FORMAT_RGBX_8888, _AL_CPU_SSSE3,
+      xrgb_8888_to_rgbx_8888, xrgb_8888_to_rgbx_8888_ssse3, xrgb_8888_to_rgbx_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XRGB_8888, ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, _AL_CPU_SSSE3,
+      xrgb_8888_to_abgr_8888_le, xrgb_8888_to_abgr_8888_le_ssse3, xrgb_8888_to_abgr_8888_le_avx2},
+   {ALLEGRO_PIXEL_FORMAT_XRGB_8888, ALLEGRO_PIXEL_FORMAT_RGBA_4444, _AL_CPU_SSE2,
+      xrgb_8888_to_rgba_4444, xrgb_8888_to_rgba_4444_sse2, xrgb_8888_to_rgba_4444_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_PIXEL_FORMAT_ARGB_8888, _AL_CPU_SSSE3,
+      abgr_8888_le_to_argb_8888, abgr_8888_le_to_argb_8888_ssse3, abgr_8888_le_to_argb_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_PIXEL_FORMAT_RGBA_8888, _AL_CPU_SSSE3,
+      abgr_8888_le_to_rgba_8888, abgr_8888_le_to_rgba_8888_ssse3, abgr_8888_le_to_rgba_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_PIXEL_FORMAT_ARGB_4444, _AL_CPU_SSE2,
+      abgr_8888_le_to_argb_4444, abgr_8888_le_to_argb_4444_sse2, abgr_8888_le_to_argb_4444_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_PIXEL_FORMAT_RGB_565, _AL_CPU_SSE2,
+      abgr_8888_le_to_rgb_565, abgr_8888_le_to_rgb_565_sse2, abgr_8888_le_to_rgb_565_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_PIXEL_FORMAT_RGB_555, _AL_CPU_SSE2,
+      abgr_8888_le_to_rgb_555, abgr_8888_le_to_rgb_555_sse2, abgr_8888_le_to_rgb_555_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_PIXEL_FORMAT_RGBA_5551, _AL_CPU_SSE2,
+      abgr_8888_le_to_rgba_5551, abgr_8888_le_to_rgba_5551_sse2, abgr_8888_le_to_rgba_5551_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_PIXEL_FORMAT_ARGB_1555, _AL_CPU_SSE2,
+      abgr_8888_le_to_argb_1555, abgr_8888_le_to_argb_1555_sse2, abgr_8888_le_to_argb_1555_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_PIXEL_FORMAT_ABGR_8888, _AL_CPU_SSSE3,
+      abgr_8888_le_to_abgr_8888, abgr_8888_le_to_abgr_8888_ssse3, abgr_8888_le_to_abgr_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_PIXEL_FORMAT_XBGR_8888, _AL_CPU_SSSE3,
+      abgr_8888_le_to_xbgr_8888, abgr_8888_le_to_xbgr_8888_ssse3, abgr_8888_le_to_xbgr_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_PIXEL_FORMAT_BGR_565, _AL_CPU_SSE2,
+      abgr_8888_le_to_bgr_565, abgr_8888_le_to_bgr_565_sse2, abgr_8888_le_to_bgr_565_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_PIXEL_FORMAT_BGR_555, _AL_CPU_SSE2,
+      abgr_8888_le_to_bgr_555, abgr_8888_le_to_bgr_555_sse2, abgr_8888_le_to_bgr_555_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_PIXEL_FORMAT_RGBX_8888, _AL_CPU_SSSE3,
+      abgr_8888_le_to_rgbx_8888, abgr_8888_le_to_rgbx_8888_ssse3, abgr_8888_le_to_rgbx_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_PIXEL_FORMAT_XRGB_8888, _AL_CPU_SSSE3,
+      abgr_8888_le_to_xrgb_8888, abgr_8888_le_to_xrgb_8888_ssse3, abgr_8888_le_to_xrgb_8888_avx2},
+   {ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_PIXEL_FORMAT_RGBA_4444, _AL_CPU_SSE2,
+      abgr_8888_le_to_rgba_4444, abgr_8888_le_to_rgba_4444_sse2, abgr_8888_le_to_rgba_4444_avx2},
+};
+#endif
+
+/* Internal function: _al_init_convert_funcs
+ *  Puts the SIMD converters the CPU supports into _al_convert_funcs.
+ */
+void _al_init_convert_funcs(void)
+{
+#ifdef _AL_HAVE_AVX2
+   int features = _al_get_cpu_features();
+   unsigned i;
+
+   for (i = 0; i < sizeof(simd_converters) / sizeof(*simd_converters); i++) {
+      const SIMD_CONVERTER *c = &simd_converters[i];
+      CONVERT_FUNC func = c->portable;
+      if (features & c->features)
+         func = c->simd;
+      if (features & _AL_CPU_AVX2)
+         func = c->avx2;
+      _al_convert_funcs[c->src_format][c->dst_format] = func;
+   }
+#endif
+}
+
 // Warning: This file was created by make_converters.py - do not edit.
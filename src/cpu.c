@@ -18,6 +18,8 @@
 #include "allegro5/allegro.h"
 #include "allegro5/cpu.h"
 #include "allegro5/internal/aintern.h"
+#include "allegro5/internal/aintern_cpu.h"
+#include <string.h>
 
 /* 
 * The CPU and pysical memory detection functions below use 
@@ -45,6 +47,18 @@
 #include <windows.h>
 #endif
 
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define ALLEGRO_CPUID_GCC
+#include <cpuid.h>
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#define ALLEGRO_CPUID_MSVC
+#include <intrin.h>
+#endif
+
+ALLEGRO_DEBUG_CHANNEL("cpu")
+
+static int cpu_features = 0;
+
 
 /* Function: al_get_cpu_count
  */
@@ -108,5 +122,105 @@ int al_get_ram_size(void)
 }
 
 
+#if defined(ALLEGRO_CPUID_GCC) || defined(ALLEGRO_CPUID_MSVC)
+static bool cpuid(unsigned leaf, unsigned subleaf, unsigned regs[4])
+{
+#ifdef ALLEGRO_CPUID_GCC
+   if ((unsigned)__get_cpuid_max(0, NULL) < leaf)
+      return false;
+   __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#else
+   int r[4];
+   __cpuid(r, 0);
+   if ((unsigned)r[0] < leaf)
+      return false;
+   __cpuidex(r, leaf, subleaf);
+   regs[0] = r[0]; regs[1] = r[1]; regs[2] = r[2]; regs[3] = r[3];
+#endif
+   return true;
+}
+
+/* Whether the OS saves the YMM registers on context switches. */
+static bool os_saves_ymm(void)
+{
+#ifdef ALLEGRO_CPUID_GCC
+   unsigned eax, edx;
+   __asm__ __volatile__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+   (void)edx;
+   return (eax & 6) == 6;
+#else
+   return (_xgetbv(0) & 6) == 6;
+#endif
+}
+#endif
+
+static int detect_cpu_features(void)
+{
+   int features = 0;
+#if defined(ALLEGRO_CPUID_GCC) || defined(ALLEGRO_CPUID_MSVC)
+   unsigned regs[4];
+
+   if (!cpuid(1, 0, regs))
+      return 0;
+
+   if (regs[3] & (1 << 26))
+      features |= _AL_CPU_SSE2;
+   if (regs[2] & (1 << 9))
+      features |= _AL_CPU_SSSE3;
+   if (regs[2] & (1 << 19))
+      features |= _AL_CPU_SSE41;
+   /* AVX needs both the CPU (bit 28) and the OS (OSXSAVE, bit 27). */
+   if ((regs[2] & (1 << 27)) && (regs[2] & (1 << 28)) && os_saves_ymm()) {
+      features |= _AL_CPU_AVX;
+      if (cpuid(7, 0, regs) && (regs[1] & (1 << 5)))
+         features |= _AL_CPU_AVX2;
+   }
+#endif
+   return features;
+}
+
+/* Internal function: _al_init_cpu_features
+ *  Detects the instruction set extensions available to the software
+ *  renderer. The set can be capped with the [cpu] simd config key.
+ */
+void _al_init_cpu_features(void)
+{
+   const char *cap;
+
+   cpu_features = detect_cpu_features();
+
+   cap = al_get_config_value(al_get_system_config(), "cpu", "simd");
+   if (cap && strcmp(cap, "default") != 0) {
+      if (!strcmp(cap, "none"))
+         cpu_features = 0;
+      else if (!strcmp(cap, "sse2"))
+         cpu_features &= _AL_CPU_SSE2;
+      else if (!strcmp(cap, "ssse3"))
+         cpu_features &= _AL_CPU_SSE2 | _AL_CPU_SSSE3;
+      else if (!strcmp(cap, "sse4.1"))
+         cpu_features &= _AL_CPU_SSE2 | _AL_CPU_SSSE3 | _AL_CPU_SSE41;
+      else if (!strcmp(cap, "avx"))
+         cpu_features &= ~_AL_CPU_AVX2;
+      else if (strcmp(cap, "avx2"))
+         ALLEGRO_WARN("Unknown [cpu] simd value: %s\n", cap);
+   }
+
+   ALLEGRO_INFO("CPU features:%s%s%s%s%s\n",
+      (cpu_features & _AL_CPU_SSE2) ? " sse2" : "",
+      (cpu_features & _AL_CPU_SSSE3) ? " ssse3" : "",
+      (cpu_features & _AL_CPU_SSE41) ? " sse4.1" : "",
+      (cpu_features & _AL_CPU_AVX) ? " avx" : "",
+      (cpu_features & _AL_CPU_AVX2) ? " avx2" : "");
+}
+
+/* Internal function: _al_get_cpu_features
+ *  Returns the _AL_CPU_* flags found by _al_init_cpu_features.
+ */
+int _al_get_cpu_features(void)
+{
+   return cpu_features;
+}
+
+
 /* vi: set ts=4 sw=4 expandtab: */
       
@@ -22,12 +22,16 @@
 
 
 
+#include <limits.h>
 #include "allegro5/allegro.h"
 #include "allegro5/internal/aintern.h"
 #include "allegro5/internal/aintern_bitmap.h"
 #include "allegro5/internal/aintern_display.h"
+#include "allegro5/internal/aintern_memblit.h"
 #include "allegro5/internal/aintern_shader.h"
 #include "allegro5/internal/aintern_system.h"
+#include "allegro5/internal/aintern_tls.h"
+#include "allegro5/internal/aintern_tri_soft.h"
 
 
 ALLEGRO_DEBUG_CHANNEL("display")
@@ -81,12 +85,7 @@ ALLEGRO_DISPLAY *al_create_display(int w, int h)
    _al_vector_init(&display->display_invalidated_callbacks, sizeof(void *));
    _al_vector_init(&display->display_validated_callbacks, sizeof(void *));
 
-   display->render_state.write_mask = ALLEGRO_MASK_RGBA | ALLEGRO_MASK_DEPTH;
-   display->render_state.depth_test = false;
-   display->render_state.depth_function = ALLEGRO_RENDER_LESS;
-   display->render_state.alpha_test = false;
-   display->render_state.alpha_function = ALLEGRO_RENDER_ALWAYS;
-   display->render_state.alpha_test_value = 0;
+   _al_init_render_state(&display->render_state);
 
    _al_vector_init(&display->bitmaps, sizeof(ALLEGRO_BITMAP*));
 
@@ -213,6 +212,58 @@ void al_update_display_region(int x, int y, int width, int height)
 
 
 
+/* Function: al_update_display_from_bitmap
+ */
+void al_update_display_from_bitmap(ALLEGRO_BITMAP *bitmap, int x, int y)
+{
+   ALLEGRO_DISPLAY *display = al_get_current_display();
+   ALLEGRO_STATE state;
+   ALLEGRO_TRANSFORM identity;
+   int *rects;
+   int n, i;
+   int x1 = INT_MAX, y1 = INT_MAX, x2 = INT_MIN, y2 = INT_MIN;
+
+   ASSERT(bitmap);
+
+   if (!display)
+      return;
+
+   n = al_get_bitmap_dirty_rectangles(bitmap, NULL, 0);
+   if (n == 0)
+      return;
+   rects = al_malloc(n * 4 * sizeof(int));
+   if (!rects)
+      return;
+   al_get_bitmap_dirty_rectangles(bitmap, rects, n);
+
+   al_store_state(&state, ALLEGRO_STATE_TARGET_BITMAP |
+      ALLEGRO_STATE_BLENDER | ALLEGRO_STATE_TRANSFORM);
+   al_set_target_backbuffer(display);
+   al_identity_transform(&identity);
+   al_use_transform(&identity);
+   al_set_blender(ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_ZERO);
+
+   for (i = 0; i < n; i++) {
+      const int *r = rects + i * 4;
+      al_draw_bitmap_region(bitmap, r[0], r[1], r[2], r[3],
+         x + r[0], y + r[1], 0);
+      x1 = _ALLEGRO_MIN(x1, x + r[0]);
+      y1 = _ALLEGRO_MIN(y1, y + r[1]);
+      x2 = _ALLEGRO_MAX(x2, x + r[0] + r[2]);
+      y2 = _ALLEGRO_MAX(y2, y + r[1] + r[3]);
+   }
+
+   al_restore_state(&state);
+   al_free(rects);
+
+   al_reset_bitmap_dirty_rectangles(bitmap);
+
+   /* Drivers may flip the whole display for every call. */
+   al_update_display_region(x1, y1, x2 - x1, y2 - y1);
+}
+
+
+
 /* Function: al_acknowledge_resize
  */
 bool al_acknowledge_resize(ALLEGRO_DISPLAY *display)
@@ -526,6 +577,17 @@ void al_hold_bitmap_drawing(bool hold)
          al_use_transform(al_get_current_transform());
       }
    }
+   else {
+      *_al_tls_get_hold_memory_bitmap_drawing() = hold;
+   }
+
+   /* Draw what was held for memory bitmaps, then the triangles queued for
+    * the tiled rasterizer.
+    */
+   if (!hold) {
+      _al_flush_held_memory_blits();
+      _al_flush_tiled_triangles();
+   }
 }
 
 /* Function: al_is_bitmap_drawing_held
@@ -537,7 +599,7 @@ bool al_is_bitmap_drawing_held(void)
    if (current_display)
       return current_display->cache_enabled;
    else
-      return false;
+      return *_al_tls_get_hold_memory_bitmap_drawing();
 }
 
 void _al_add_display_invalidated_callback(ALLEGRO_DISPLAY* display, void (*display_invalidated)(ALLEGRO_DISPLAY*))
@@ -590,40 +652,66 @@ void al_acknowledge_drawing_resume(ALLEGRO_DISPLAY *display)
    }
 }
 
+/* Internal function: _al_init_render_state
+ *  Sets the render state a display or thread starts out with.
+ */
+void _al_init_render_state(_ALLEGRO_RENDER_STATE *state)
+{
+   state->write_mask = ALLEGRO_MASK_RGBA | ALLEGRO_MASK_DEPTH;
+   state->depth_test = false;
+   state->depth_function = ALLEGRO_RENDER_LESS;
+   state->alpha_test = false;
+   state->alpha_function = ALLEGRO_RENDER_ALWAYS;
+   state->alpha_test_value = 0;
+}
+
+/* Internal function: _al_get_render_state
+ *  Returns the render state of the current display, which drawing to memory
+ *  bitmaps uses as well. Without a display each thread has its own.
+ */
+const _ALLEGRO_RENDER_STATE *_al_get_render_state(void)
+{
+   ALLEGRO_DISPLAY *display = al_get_current_display();
+
+   if (display)
+      return &display->render_state;
+   return _al_get_tls_render_state();
+}
+
 /* Function: al_set_render_state
  */
 void al_set_render_state(ALLEGRO_RENDER_STATE state, int value)
 {
    ALLEGRO_DISPLAY *display = al_get_current_display();
+   _ALLEGRO_RENDER_STATE *render_state;
 
-   if (!display)
-      return;
+   render_state = display ? &display->render_state : _al_get_tls_render_state();
 
    switch (state) {
       case ALLEGRO_ALPHA_TEST:
-         display->render_state.alpha_test = value;
+         render_state->alpha_test = value;
          break;
       case ALLEGRO_WRITE_MASK:
-         display->render_state.write_mask = value;
+         render_state->write_mask = value;
          break;
       case ALLEGRO_DEPTH_TEST:
-         display->render_state.depth_test = value;
+         render_state->depth_test = value;
          break;
       case ALLEGRO_DEPTH_FUNCTION:
-         display->render_state.depth_function = value;
+         render_state->depth_function = value;
          break;
       case ALLEGRO_ALPHA_FUNCTION:
-         display->render_state.alpha_function = value;
+         render_state->alpha_function = value;
          break;
       case ALLEGRO_ALPHA_TEST_VALUE:
-         display->render_state.alpha_test_value = value;
+         render_state->alpha_test_value = value;
          break;
       default:
          ALLEGRO_WARN("unknown state to change: %d\n", state);
          break;
    }
 
-   if (display->vt && display->vt->update_render_state) {
+   if (display && display->vt && display->vt->update_render_state) {
       display->vt->update_render_state(display);
    }
 }
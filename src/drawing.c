@@ -49,7 +49,7 @@ void al_clear_depth_buffer(float z)
    ASSERT(target);
 
    if (al_get_bitmap_flags(target) & ALLEGRO_MEMORY_BITMAP) {
-      /* has no depth buffer */
+      _al_clear_bitmap_depth_buffer(target, z);
    }
    else {
       ALLEGRO_DISPLAY *display = _al_get_bitmap_display(target);
@@ -18,10 +18,16 @@
 #include "allegro5/internal/aintern_bitmap.h"
 #include "allegro5/internal/aintern_blend.h"
 #include "allegro5/internal/aintern_convert.h"
+#include "allegro5/internal/aintern_exitfunc.h"
 #include "allegro5/internal/aintern_memblit.h"
+#include "allegro5/internal/aintern_pixels.h"
+#include "allegro5/internal/aintern_tls.h"
 #include "allegro5/internal/aintern_transform.h"
 #include "allegro5/internal/aintern_tri_soft.h"
+#include "allegro5/internal/aintern_vector.h"
+#include <limits.h>
 #include <math.h>
+#include <string.h>
 
 #define MIN _ALLEGRO_MIN
 #define MAX _ALLEGRO_MAX
@@ -30,9 +36,22 @@ static void _al_draw_transformed_scaled_bitmap_memory(
    ALLEGRO_BITMAP *src, ALLEGRO_COLOR tint,
    int sx, int sy, int sw, int sh, int dx, int dy, int dw, int dh,
    int flags);
+static void bitmap_quad(const ALLEGRO_TRANSFORM *trans, ALLEGRO_COLOR tint,
+   int sx, int sy, int sw, int sh, int dx, int dy, int dw, int dh,
+   int flags, ALLEGRO_VERTEX quad[4]);
+static void _al_draw_bitmap_region_memory_3d(ALLEGRO_BITMAP *src,
+   ALLEGRO_COLOR tint, int sx, int sy, int sw, int sh, int dx, int dy,
+   int flags);
 static void _al_draw_bitmap_region_memory_fast(ALLEGRO_BITMAP *bitmap,
    int sx, int sy, int sw, int sh,
    int dx, int dy, int flags);
+static void _al_draw_bitmap_region_memory_8888(ALLEGRO_BITMAP *bitmap,
+   const _AL_BLEND_SPAN_8888 *blend, int rle_flags,
+   int sx, int sy, int sw, int sh,
+   int dx, int dy, int flags);
+static void _al_draw_bitmap_region_memory_scaled(ALLEGRO_BITMAP *bitmap,
+   const _AL_BLEND_SPAN_8888 *blend,
+   int sx, int sy, int sw, int sh, int ox, int oy, int kx, int ky);
 
 
 /* The CLIPPER macro takes pre-clipped coordinates for both the source
@@ -130,27 +149,504 @@ static void _al_draw_bitmap_region_memory_fast(ALLEGRO_BITMAP *bitmap,
 }
 
 
+/* Drawing to a memory bitmap while it is held with al_hold_bitmap_drawing is
+ * queued up for as long as the source, the target and its clipping rectangle
+ * stay the same. The source and the target are then locked only once to draw
+ * the lot, in the order it was queued. The queue is kept with the hold flag
+ * in the thread local state, so a thread only ever draws its own.
+ */
+#define MAX_HELD_BLITS  16384
+
+enum {
+   HELD_COPY,
+   HELD_8888,
+   HELD_QUAD
+};
+
+typedef struct HELD_BLIT {
+   int type;
+   /* HELD_COPY and HELD_8888 */
+   int sx, sy, sw, sh;
+   int dx, dy;
+   _AL_BLEND_SPAN_8888 blend;
+   int rle_flags;
+   /* HELD_QUAD */
+   ALLEGRO_VERTEX quad[4];
+   int blender;
+} HELD_BLIT;
+
+
+static bool can_hold_blit(ALLEGRO_BITMAP *src, ALLEGRO_BITMAP *dest)
+{
+   ALLEGRO_BITMAP *dest_parent = dest->parent ? dest->parent : dest;
+
+   return al_is_bitmap_drawing_held() &&
+      (al_get_bitmap_flags(dest) & ALLEGRO_MEMORY_BITMAP) &&
+      !_al_pixel_format_is_compressed(al_get_bitmap_format(dest)) &&
+      !al_is_bitmap_locked(src) && !al_is_bitmap_locked(dest_parent);
+}
+
+
+/* Clips a blit at whole pixel offsets to the locked region of dest, which
+ * is the parent of the target. Returns false if nothing is left.
+ */
+static bool clip_held_blit(ALLEGRO_BITMAP *dest, int *sx, int *sy,
+   int *w, int *h, int *dx, int *dy)
+{
+   if (*dx < dest->lock_x) {
+      const int d = dest->lock_x - *dx;
+      *dx += d;
+      *sx += d;
+      *w -= d;
+   }
+   if (*dx + *w > dest->lock_x + dest->lock_w)
+      *w = dest->lock_x + dest->lock_w - *dx;
+
+   if (*dy < dest->lock_y) {
+      const int d = dest->lock_y - *dy;
+      *dy += d;
+      *sy += d;
+      *h -= d;
+   }
+   if (*dy + *h > dest->lock_y + dest->lock_h)
+      *h = dest->lock_y + dest->lock_h - *dy;
+
+   return *w > 0 && *h > 0;
+}
+
+
+static void draw_held_blit(ALLEGRO_BITMAP *src, ALLEGRO_BITMAP *dest,
+   HELD_BLIT *b)
+{
+   ALLEGRO_BITMAP *dest_parent = dest->parent ? dest->parent : dest;
+   int sx = b->sx, sy = b->sy, w = b->sw, h = b->sh;
+   int dx = b->dx, dy = b->dy;
+   int y;
+
+   if (b->type == HELD_QUAD) {
+      _al_update_bitmap_mipmaps(src);
+      _al_triangle_2d_locked(dest, src, &b->quad[0], &b->quad[1], &b->quad[2]);
+      _al_triangle_2d_locked(dest, src, &b->quad[0], &b->quad[2], &b->quad[3]);
+      return;
+   }
+
+   if (dest->parent) {
+      dx += dest->xofs;
+      dy += dest->yofs;
+   }
+   if (!clip_held_blit(dest_parent, &sx, &sy, &w, &h, &dx, &dy))
+      return;
+   dx -= dest_parent->lock_x;
+   dy -= dest_parent->lock_y;
+
+   if (b->type == HELD_COPY) {
+      _al_convert_bitmap_data(
+         src->lock_data, src->locked_region.format, src->locked_region.pitch,
+         dest_parent->lock_data, dest_parent->locked_region.format,
+         dest_parent->locked_region.pitch,
+         sx, sy, dx, dy, w, h);
+      return;
+   }
+
+   if (b->rle_flags >= 0 && _al_blend_bitmap_rle(src, &b->blend,
+         b->rle_flags, sx, sy, w, h,
+         (const uint32_t *)((char *)src->lock_data
+            + sy * src->locked_region.pitch) + sx,
+         src->locked_region.pitch,
+         (uint32_t *)((char *)dest_parent->lock_data
+            + dy * dest_parent->locked_region.pitch) + dx,
+         dest_parent->locked_region.pitch)) {
+      return;
+   }
+
+   for (y = 0; y < h; y++) {
+      b->blend.blend(&b->blend,
+         (uint32_t *)((char *)dest_parent->lock_data
+            + (dy + y) * dest_parent->locked_region.pitch) + dx,
+         (const uint32_t *)((char *)src->lock_data
+            + (sy + y) * src->locked_region.pitch) + sx,
+         w);
+   }
+}
+
+
+/* Draws and frees the held blits of the calling thread. */
+static void draw_held_blits(_AL_HELD_BLITS **tls_held)
+{
+   _AL_HELD_BLITS *held = *tls_held;
+   ALLEGRO_BITMAP *src = held->src;
+   ALLEGRO_BITMAP *dest = held->dest;
+   ALLEGRO_BITMAP *dest_parent;
+   _AL_VECTOR *blits = &held->blits;
+   _AL_VECTOR *blenders = &held->blenders;
+   int x1, y1, x2, y2;
+   unsigned int i;
+
+   /* Locking the bitmaps below flushes them again. */
+   *tls_held = NULL;
+
+   x1 = MAX(held->clip[0], held->extent[0]);
+   y1 = MAX(held->clip[1], held->extent[1]);
+   x2 = MIN(held->clip[2], held->extent[2]);
+   y2 = MIN(held->clip[3], held->extent[3]);
+   dest_parent = dest;
+   if (dest->parent) {
+      x1 += dest->xofs;
+      y1 += dest->yofs;
+      x2 += dest->xofs;
+      y2 += dest->yofs;
+      dest_parent = dest->parent;
+   }
+   x1 = MAX(x1, 0);
+   y1 = MAX(y1, 0);
+   x2 = MIN(x2, dest_parent->w);
+   y2 = MIN(y2, dest_parent->h);
+
+   if (x1 < x2 && y1 < y2 &&
+         al_lock_bitmap(src, ALLEGRO_PIXEL_FORMAT_ANY, ALLEGRO_LOCK_READONLY)) {
+      if (al_lock_bitmap_region(dest_parent, x1, y1, x2 - x1, y2 - y1,
+            ALLEGRO_PIXEL_FORMAT_ANY, ALLEGRO_LOCK_READWRITE)) {
+         const _AL_COMPILED_BLENDER saved = *_al_get_compiled_blender();
+         int blender = -1;
+
+         for (i = 0; i < _al_vector_size(blits); i++) {
+            HELD_BLIT *b = _al_vector_ref(blits, i);
+            if (b->type == HELD_QUAD && b->blender != blender) {
+               blender = b->blender;
+               _al_set_compiled_blender(_al_vector_ref(blenders, blender));
+            }
+            draw_held_blit(src, dest, b);
+         }
+
+         _al_set_compiled_blender(&saved);
+         al_unlock_bitmap(dest_parent);
+      }
+      al_unlock_bitmap(src);
+   }
+
+   _al_vector_free(blits);
+   _al_vector_free(blenders);
+   al_free(held);
+}
+
+
+/* Computes the part of the target a held blit may touch, like
+ * triangle_target_rect in tri_soft.c does for quads.
+ */
+static void held_blit_extent(const HELD_BLIT *b, int extent[4])
+{
+   float min_x, min_y, max_x, max_y;
+   int i;
+
+   if (b->type != HELD_QUAD) {
+      extent[0] = b->dx;
+      extent[1] = b->dy;
+      extent[2] = b->dx + b->sw;
+      extent[3] = b->dy + b->sh;
+      return;
+   }
+
+   min_x = max_x = b->quad[0].x;
+   min_y = max_y = b->quad[0].y;
+   for (i = 1; i < 4; i++) {
+      min_x = MIN(min_x, b->quad[i].x);
+      min_y = MIN(min_y, b->quad[i].y);
+      max_x = MAX(max_x, b->quad[i].x);
+      max_y = MAX(max_y, b->quad[i].y);
+   }
+   extent[0] = (int)floorf(min_x) - 1;
+   extent[1] = (int)floorf(min_y) - 1;
+   extent[2] = (int)ceilf(max_x) + 2;
+   extent[3] = (int)ceilf(max_y) + 2;
+}
+
+
+/* Returns the index of the current blender in the held blenders, adding it
+ * if it differs from the last one.
+ */
+static int hold_blender(_AL_HELD_BLITS *held)
+{
+   const _AL_COMPILED_BLENDER *blender = _al_get_compiled_blender();
+   const unsigned int n = _al_vector_size(&held->blenders);
+   _AL_COMPILED_BLENDER *copy;
+
+   if (n > 0 && _al_is_same_blender(_al_vector_ref_back(&held->blenders),
+         blender))
+      return n - 1;
+
+   copy = _al_vector_alloc_back(&held->blenders);
+   *copy = *blender;
+   return n;
+}
+
+
+/* Queues a blit to the held drawing of the calling thread. Returns false if
+ * it has to be drawn right away instead.
+ */
+static bool hold_blit(ALLEGRO_BITMAP *src, ALLEGRO_BITMAP *dest,
+   const HELD_BLIT *b)
+{
+   _AL_HELD_BLITS **tls_held = _al_tls_get_held_blits();
+   _AL_HELD_BLITS *held = *tls_held;
+   HELD_BLIT *copy;
+   int extent[4];
+
+   if (held && (src != held->src || dest != held->dest ||
+         dest->cl != held->clip[0] || dest->ct != held->clip[1] ||
+         dest->cr_excl != held->clip[2] || dest->cb_excl != held->clip[3] ||
+         _al_vector_size(&held->blits) >= MAX_HELD_BLITS)) {
+      draw_held_blits(tls_held);
+      held = NULL;
+   }
+
+   if (!held) {
+      held = al_malloc(sizeof *held);
+      if (!held)
+         return false;
+      _al_vector_init(&held->blits, sizeof(HELD_BLIT));
+      _al_vector_init(&held->blenders, sizeof(_AL_COMPILED_BLENDER));
+      held->src = src;
+      held->dest = dest;
+      held->clip[0] = dest->cl;
+      held->clip[1] = dest->ct;
+      held->clip[2] = dest->cr_excl;
+      held->clip[3] = dest->cb_excl;
+      held->extent[0] = held->extent[1] = INT_MAX;
+      held->extent[2] = held->extent[3] = INT_MIN;
+      *tls_held = held;
+   }
+
+   held_blit_extent(b, extent);
+   held->extent[0] = MIN(held->extent[0], extent[0]);
+   held->extent[1] = MIN(held->extent[1], extent[1]);
+   held->extent[2] = MAX(held->extent[2], extent[2]);
+   held->extent[3] = MAX(held->extent[3], extent[3]);
+
+   copy = _al_vector_alloc_back(&held->blits);
+   *copy = *b;
+   if (b->type == HELD_QUAD)
+      copy->blender = hold_blender(held);
+   return true;
+}
+
+
+/* Internal function: _al_flush_held_memory_blits
+ *  Draws the bitmaps held by the calling thread for a memory bitmap target.
+ */
+void _al_flush_held_memory_blits(void)
+{
+   _AL_HELD_BLITS **tls_held = _al_tls_get_held_blits();
+
+   if (*tls_held)
+      draw_held_blits(tls_held);
+}
+
+
+/* Internal function: _al_flush_held_memory_blits_for
+ *  Draws the bitmaps held by the calling thread if they are drawn to or from
+ *  the given bitmap. Call this before the pixels of the bitmap are accessed
+ *  in some other way.
+ */
+void _al_flush_held_memory_blits_for(ALLEGRO_BITMAP *bitmap)
+{
+   _AL_HELD_BLITS **tls_held = _al_tls_get_held_blits();
+   _AL_HELD_BLITS *held = *tls_held;
+   ALLEGRO_BITMAP *parent = bitmap->parent ? bitmap->parent : bitmap;
+
+   if (held && (parent == held->src || parent == held->dest ||
+         parent == held->dest->parent))
+      draw_held_blits(tls_held);
+}
+
+
+static void shutdown_held_memory_blits(void)
+{
+   _AL_HELD_BLITS **tls_held = _al_tls_get_held_blits();
+
+   if (*tls_held) {
+      _al_vector_free(&(*tls_held)->blits);
+      _al_vector_free(&(*tls_held)->blenders);
+      al_free(*tls_held);
+      *tls_held = NULL;
+   }
+}
+
+
+/* Internal function: _al_init_held_memory_blits
+ */
+void _al_init_held_memory_blits(void)
+{
+   _al_add_exit_func(shutdown_held_memory_blits, "shutdown_held_memory_blits");
+}
+
+
+/* Returns the _AL_RLE_* flags for drawing the runs of a bitmap with
+ * ALLEGRO_RLE_BITMAP with the given blender and tint, or -1 if blank pixels
+ * would change the destination.
+ */
+static int get_rle_flags(const _AL_COMPILED_BLENDER *blender,
+   const ALLEGRO_COLOR *tint)
+{
+   int flags = 0;
+
+   if (blender->op != ALLEGRO_ADD || blender->op_alpha != ALLEGRO_ADD ||
+         blender->src_mode != blender->src_alpha ||
+         blender->dst_mode != blender->dst_alpha ||
+         blender->dst_mode != ALLEGRO_INVERSE_ALPHA)
+      return -1;
+
+   if (blender->src_mode == ALLEGRO_ALPHA)
+      flags |= _AL_RLE_SKIP_CLEAR;
+   else if (blender->src_mode != ALLEGRO_ONE)
+      return -1;
+
+   if (tint->r == 1 && tint->g == 1 && tint->b == 1 && tint->a == 1)
+      flags |= _AL_RLE_COPY_OPAQUE;
+
+   return flags;
+}
+
+
+/* Checks if the current transform scales by whole factors along the axes,
+ * which may be negative to flip, and puts the origin of a region drawn at
+ * (dx, dy) at a whole pixel.
+ */
+static bool get_whole_scale(int dx, int dy, int *ox, int *oy,
+   int *kx, int *ky)
+{
+   const ALLEGRO_TRANSFORM *t = al_get_current_transform();
+   const float max_scale = 4096;
+   const float max_offset = 1 << 24;
+   float x, y;
+
+   if (_al_get_current_transform_class() > _AL_TRANSFORM_SCALE)
+      return false;
+
+   if (t->m[0][0] != floorf(t->m[0][0]) || fabsf(t->m[0][0]) > max_scale ||
+       t->m[1][1] != floorf(t->m[1][1]) || fabsf(t->m[1][1]) > max_scale)
+      return false;
+
+   /* The same as the first corner bitmap_quad computes. */
+   x = dx * t->m[0][0] + t->m[3][0];
+   y = dy * t->m[1][1] + t->m[3][1];
+   if (x != floorf(x) || fabsf(x) > max_offset ||
+       y != floorf(y) || fabsf(y) > max_offset)
+      return false;
+
+   *kx = (int)t->m[0][0];
+   *ky = (int)t->m[1][1];
+   *ox = (int)x;
+   *oy = (int)y;
+   return *kx != 0 && *ky != 0;
+}
+
+
 void _al_draw_bitmap_region_memory(ALLEGRO_BITMAP *src,
    ALLEGRO_COLOR tint,
    int sx, int sy, int sw, int sh,
    int dx, int dy, int flags)
 {
-   int op, src_mode, dst_mode;
-   int op_alpha, src_alpha, dst_alpha;
+   const _AL_COMPILED_BLENDER *blender = _al_get_compiled_blender();
    float xtrans, ytrans;
+   int ox, oy, kx, ky;
+   ALLEGRO_BITMAP *dest = al_get_target_bitmap();
+   ALLEGRO_BITMAP *dest_parent = dest->parent ? dest->parent : dest;
+   bool hold = can_hold_blit(src, dest);
+   HELD_BLIT b;
    
    ASSERT(src->parent == NULL);
 
-   al_get_separate_blender(&op, &src_mode, &dst_mode, &op_alpha, &src_alpha, &dst_alpha);
+   if (_al_use_soft_3d(dest)) {
+      _al_draw_bitmap_region_memory_3d(src, tint, sx, sy, sw, sh, dx, dy,
+         flags);
+      return;
+   }
 
-   if (_AL_DEST_IS_ZERO && _AL_SRC_NOT_MODIFIED_TINT_WHITE &&
+   if ((blender->flags & _AL_BLEND_COPY) &&
+      tint.r == 1.0f && tint.g == 1.0f && tint.b == 1.0f && tint.a == 1.0f &&
       _al_transform_is_translation(al_get_current_transform(), &xtrans, &ytrans))
    {
+      if (hold) {
+         b.type = HELD_COPY;
+         b.sx = sx;
+         b.sy = sy;
+         b.sw = sw;
+         b.sh = sh;
+         b.dx = dx + xtrans;
+         b.dy = dy + ytrans;
+         if (hold_blit(src, dest, &b))
+            return;
+      }
       _al_draw_bitmap_region_memory_fast(src, sx, sy, sw, sh,
          dx + xtrans, dy + ytrans, flags);
       return;
    }
 
+   /* Blending between 8888 bitmaps at whole pixel offsets is done with
+    * integer arithmetic, if the blender allows it. This covers the same
+    * pixels as drawing the two triangles would.
+    */
+   if (_al_transform_is_translation(al_get_current_transform(), &xtrans, &ytrans) &&
+      xtrans == floorf(xtrans) && ytrans == floorf(ytrans) &&
+      al_get_bitmap_format(src) == al_get_bitmap_format(dest) &&
+      !al_is_bitmap_locked(src) && !al_is_bitmap_locked(dest_parent) &&
+      _al_init_blend_span_8888(&b.blend, al_get_bitmap_format(src),
+         blender, &tint))
+   {
+      b.rle_flags = get_rle_flags(blender, &tint);
+      if (b.rle_flags >= 0)
+         _al_update_bitmap_rle(src);
+
+      if (hold) {
+         b.type = HELD_8888;
+         b.sx = sx;
+         b.sy = sy;
+         b.sw = sw;
+         b.sh = sh;
+         b.dx = dx + xtrans;
+         b.dy = dy + ytrans;
+         if (hold_blit(src, dest, &b))
+            return;
+      }
+      _al_draw_bitmap_region_memory_8888(src, &b.blend, b.rle_flags,
+         sx, sy, sw, sh,
+         dx + xtrans, dy + ytrans, flags);
+      return;
+   }
+
+   if (hold) {
+      b.type = HELD_QUAD;
+      bitmap_quad(al_get_current_transform(), tint, sx, sy, sw, sh, dx, dy, sw, sh, flags, b.quad);
+      if (hold_blit(src, dest, &b))
+         return;
+   }
+
+   /* Scaling by whole factors, which includes flipping, is done a row at a
+    * time if the triangles would pick the nearest texels.
+    */
+   if (flags == 0 &&
+      !(al_get_bitmap_flags(src) &
+         (ALLEGRO_MIN_LINEAR | ALLEGRO_MAG_LINEAR | ALLEGRO_MIPMAP)) &&
+      al_get_bitmap_format(src) == al_get_bitmap_format(dest) &&
+      !_al_pixel_format_is_compressed(al_get_bitmap_format(src)) &&
+      !al_is_bitmap_locked(src) && !al_is_bitmap_locked(dest_parent) &&
+      get_whole_scale(dx, dy, &ox, &oy, &kx, &ky))
+   {
+      const int format = al_get_bitmap_format(src);
+      const bool copy = (blender->flags & _AL_BLEND_COPY) &&
+         tint.r == 1.0f && tint.g == 1.0f && tint.b == 1.0f && tint.a == 1.0f;
+      /* Only the formats the rasterizer blends with integers too. */
+      const bool int8 = (format == ALLEGRO_PIXEL_FORMAT_ARGB_8888 ||
+         format == ALLEGRO_PIXEL_FORMAT_ABGR_8888);
+
+      if (copy || (int8 &&
+            _al_init_blend_span_8888(&b.blend, format, blender, &tint))) {
+         _al_draw_bitmap_region_memory_scaled(src, copy ? NULL : &b.blend,
+            sx, sy, sw, sh, ox, oy, kx, ky);
+         return;
+      }
+   }
+
    /* We used to have special cases for translation/scaling only, but the
     * general version received much more optimisation and ended up being
     * faster.
@@ -160,17 +656,22 @@ void _al_draw_bitmap_region_memory(ALLEGRO_BITMAP *src,
 }
 
 
-static void _al_draw_transformed_bitmap_memory(ALLEGRO_BITMAP *src,
-   ALLEGRO_COLOR tint,
-   int sx, int sy, int sw, int sh, int dw, int dh,
-   ALLEGRO_TRANSFORM* local_trans, int flags)
+/* Computes the corners of a bitmap drawn with the given transform, in
+ * the order they are drawn as a triangle fan.
+ */
+static void bitmap_quad(const ALLEGRO_TRANSFORM *trans, ALLEGRO_COLOR tint,
+   int sx, int sy, int sw, int sh, int dx, int dy, int dw, int dh,
+   int flags, ALLEGRO_VERTEX quad[4])
 {
+   ALLEGRO_TRANSFORM local_trans;
    float xsf[4], ysf[4];
    int tl = 0, tr = 1, bl = 3, br = 2;
    int tmp;
    ALLEGRO_VERTEX v[4];
 
-   ASSERT(_al_pixel_format_is_real(al_get_bitmap_format(src)));
+   al_identity_transform(&local_trans);
+   al_translate_transform(&local_trans, dx, dy);
+   al_compose_transform(&local_trans, trans);
 
    /* Decide what order to take corners in. */
    if (flags & ALLEGRO_FLIP_VERTICAL) {
@@ -203,9 +704,9 @@ static void _al_draw_transformed_bitmap_memory(ALLEGRO_BITMAP *src,
    xsf[2] = 0;
    ysf[2] = dh;
 
-   al_transform_coordinates(local_trans, &xsf[0], &ysf[0]);
-   al_transform_coordinates(local_trans, &xsf[1], &ysf[1]);
-   al_transform_coordinates(local_trans, &xsf[2], &ysf[2]);
+   al_transform_coordinates(&local_trans, &xsf[0], &ysf[0]);
+   al_transform_coordinates(&local_trans, &xsf[1], &ysf[1]);
+   al_transform_coordinates(&local_trans, &xsf[2], &ysf[2]);
 
    v[tl].x = xsf[0];
    v[tl].y = ysf[0];
@@ -235,27 +736,56 @@ static void _al_draw_transformed_bitmap_memory(ALLEGRO_BITMAP *src,
    v[bl].v = sy + sh;
    v[bl].color = tint;
 
+   quad[0] = v[tl];
+   quad[1] = v[tr];
+   quad[2] = v[br];
+   quad[3] = v[bl];
+}
+
+
+static void _al_draw_transformed_scaled_bitmap_memory(
+   ALLEGRO_BITMAP *src, ALLEGRO_COLOR tint,
+   int sx, int sy, int sw, int sh, int dx, int dy, int dw, int dh, int flags)
+{
+   ALLEGRO_VERTEX quad[4];
+
+   ASSERT(_al_pixel_format_is_real(al_get_bitmap_format(src)));
+
+   bitmap_quad(al_get_current_transform(), tint, sx, sy, sw, sh, dx, dy, dw, dh, flags, quad);
+
    al_lock_bitmap(src, ALLEGRO_PIXEL_FORMAT_ANY, ALLEGRO_LOCK_READONLY);
 
-   _al_triangle_2d(src, &v[tl], &v[tr], &v[br]);
-   _al_triangle_2d(src, &v[tl], &v[br], &v[bl]);
+   _al_triangle_2d(src, &quad[0], &quad[1], &quad[2]);
+   _al_triangle_2d(src, &quad[0], &quad[2], &quad[3]);
 
    al_unlock_bitmap(src);
 }
 
 
-static void _al_draw_transformed_scaled_bitmap_memory(
-   ALLEGRO_BITMAP *src, ALLEGRO_COLOR tint,
-   int sx, int sy, int sw, int sh, int dx, int dy, int dw, int dh, int flags)
+/* Draws the bitmap as two triangles which are projected and depth tested,
+ * see _al_use_soft_3d.
+ */
+static void _al_draw_bitmap_region_memory_3d(ALLEGRO_BITMAP *src,
+   ALLEGRO_COLOR tint, int sx, int sy, int sw, int sh, int dx, int dy,
+   int flags)
 {
-   ALLEGRO_TRANSFORM local_trans;
+   ALLEGRO_TRANSFORM ident, trans;
+   ALLEGRO_VERTEX quad[4];
+   _AL_CLIP_VERTEX clip[4];
+   int i;
 
-   al_identity_transform(&local_trans);
-   al_translate_transform(&local_trans, dx, dy);
-   al_compose_transform(&local_trans, al_get_current_transform());
+   al_identity_transform(&ident);
+   bitmap_quad(&ident, tint, sx, sy, sw, sh, dx, dy, sw, sh, flags, quad);
+   _al_get_clip_transform(al_get_target_bitmap(), &trans);
+   for (i = 0; i < 4; i++)
+      _al_clip_vertex(&trans, &quad[i], &clip[i]);
 
-   _al_draw_transformed_bitmap_memory(src, tint, sx, sy, sw, sh, dw, dh,
-      &local_trans, flags);
+   al_lock_bitmap(src, ALLEGRO_PIXEL_FORMAT_ANY, ALLEGRO_LOCK_READONLY);
+
+   _al_triangle_3d(src, &clip[0], &clip[1], &clip[2]);
+   _al_triangle_3d(src, &clip[0], &clip[2], &clip[3]);
+
+   al_unlock_bitmap(src);
 }
 
 
@@ -302,4 +832,167 @@ static void _al_draw_bitmap_region_memory_fast(ALLEGRO_BITMAP *bitmap,
 }
 
 
+static void _al_draw_bitmap_region_memory_8888(ALLEGRO_BITMAP *bitmap,
+   const _AL_BLEND_SPAN_8888 *blend, int rle_flags,
+   int sx, int sy, int sw, int sh,
+   int dx, int dy, int flags)
+{
+   ALLEGRO_LOCKED_REGION *src_region;
+   ALLEGRO_LOCKED_REGION *dst_region;
+   ALLEGRO_BITMAP *dest = al_get_target_bitmap();
+   int dw = sw, dh = sh;
+   int y;
+
+   ASSERT(bitmap->parent == NULL);
+   ASSERT(flags == 0);
+   (void)flags;
+
+   CLIPPER(bitmap, sx, sy, sw, sh, dest, dx, dy, dw, dh, 1, 1, flags)
+
+   if (!(src_region = al_lock_bitmap_region(bitmap, sx, sy, sw, sh,
+         ALLEGRO_PIXEL_FORMAT_ANY, ALLEGRO_LOCK_READONLY))) {
+      return;
+   }
+
+   if (!(dst_region = al_lock_bitmap_region(dest, dx, dy, sw, sh,
+         ALLEGRO_PIXEL_FORMAT_ANY, ALLEGRO_LOCK_READWRITE))) {
+      al_unlock_bitmap(bitmap);
+      return;
+   }
+
+   if (rle_flags < 0 || !_al_blend_bitmap_rle(bitmap, blend, rle_flags,
+         sx, sy, sw, sh, src_region->data, src_region->pitch,
+         dst_region->data, dst_region->pitch)) {
+      for (y = 0; y < sh; y++) {
+         blend->blend(blend,
+            (uint32_t *)((char *)dst_region->data + y * dst_region->pitch),
+            (const uint32_t *)((char *)src_region->data + y * src_region->pitch),
+            sw);
+      }
+   }
+
+   al_unlock_bitmap(bitmap);
+   al_unlock_bitmap(dest);
+}
+
+
+/* Draws a region with its origin at (ox, oy) of the target, scaled by kx
+ * and ky. Each target pixel gets the texel under its center, as with the
+ * nearest sampling of the triangle rasterizer. The texels of a row are
+ * gathered once for the rows they repeat on, then copied, or blended if
+ * blend is not NULL.
+ */
+static void _al_draw_bitmap_region_memory_scaled(ALLEGRO_BITMAP *bitmap,
+   const _AL_BLEND_SPAN_8888 *blend,
+   int sx, int sy, int sw, int sh, int ox, int oy, int kx, int ky)
+{
+   ALLEGRO_LOCKED_REGION *src_region;
+   ALLEGRO_LOCKED_REGION *dst_region;
+   ALLEGRO_BITMAP *dest = al_get_target_bitmap();
+   const int pixel_size = al_get_pixel_size(al_get_bitmap_format(bitmap));
+   int x1, y1, x2, y2;
+   int cl, ct, cr, cb;
+   int *texels;
+   uint8_t *row;
+   uint8_t *prev_row = NULL;
+   int last_v = -1;
+   int n, x, y;
+
+   ASSERT(bitmap->parent == NULL);
+   ASSERT(kx != 0 && ky != 0);
+
+   x1 = MIN(ox, ox + sw * kx);
+   y1 = MIN(oy, oy + sh * ky);
+   x2 = MAX(ox, ox + sw * kx);
+   y2 = MAX(oy, oy + sh * ky);
+
+   cl = dest->cl;
+   ct = dest->ct;
+   cr = dest->cr_excl;
+   cb = dest->cb_excl;
+   if (dest->parent) {
+      cl = MAX(cl, -dest->xofs);
+      ct = MAX(ct, -dest->yofs);
+      cr = MIN(cr, dest->parent->w - dest->xofs);
+      cb = MIN(cb, dest->parent->h - dest->yofs);
+   }
+
+   x1 = MAX(x1, cl);
+   y1 = MAX(y1, ct);
+   x2 = MIN(x2, cr);
+   y2 = MIN(y2, cb);
+   if (x1 >= x2 || y1 >= y2)
+      return;
+   n = x2 - x1;
+
+   /* The offset of the texel of each column, and a row of them. */
+   texels = al_malloc(n * (sizeof(int) + pixel_size));
+   if (!texels)
+      return;
+   row = (uint8_t *)(texels + n);
+   for (x = 0; x < n; x++) {
+      const int u = (kx > 0) ? (x1 + x - ox) / kx : (ox - 1 - x1 - x) / -kx;
+      texels[x] = u * pixel_size;
+   }
+
+   if (!(src_region = al_lock_bitmap_region(bitmap, sx, sy, sw, sh,
+         ALLEGRO_PIXEL_FORMAT_ANY, ALLEGRO_LOCK_READONLY))) {
+      al_free(texels);
+      return;
+   }
+
+   if (!(dst_region = al_lock_bitmap_region(dest, x1, y1, n, y2 - y1,
+         ALLEGRO_PIXEL_FORMAT_ANY,
+         blend ? ALLEGRO_LOCK_READWRITE : ALLEGRO_LOCK_WRITEONLY))) {
+      al_unlock_bitmap(bitmap);
+      al_free(texels);
+      return;
+   }
+
+   for (y = y1; y < y2; y++) {
+      const int v = (ky > 0) ? (y - oy) / ky : (oy - 1 - y) / -ky;
+      uint8_t *dst_row = (uint8_t *)dst_region->data +
+         (y - y1) * dst_region->pitch;
+      /* Without blending the texels are gathered right into the target. */
+      uint8_t *out = blend ? row : dst_row;
+
+      if (v != last_v) {
+         const uint8_t *src_row = (const uint8_t *)src_region->data +
+            v * src_region->pitch;
+
+         switch (pixel_size) {
+            case 4: {
+               uint32_t *out32 = (uint32_t *)out;
+               for (x = 0; x < n; x++)
+                  out32[x] = *(const uint32_t *)(src_row + texels[x]);
+               break;
+            }
+            case 2: {
+               uint16_t *out16 = (uint16_t *)out;
+               for (x = 0; x < n; x++)
+                  out16[x] = *(const uint16_t *)(src_row + texels[x]);
+               break;
+            }
+            default:
+               for (x = 0; x < n; x++)
+                  memcpy(out + x * pixel_size, src_row + texels[x], pixel_size);
+               break;
+         }
+         last_v = v;
+      }
+      else if (!blend) {
+         memcpy(dst_row, prev_row, n * pixel_size);
+      }
+
+      if (blend)
+         blend->blend(blend, (uint32_t *)dst_row, (const uint32_t *)row, n);
+      prev_row = dst_row;
+   }
+
+   al_unlock_bitmap(bitmap);
+   al_unlock_bitmap(dest);
+   al_free(texels);
+}
+
+
 /* vim: set sts=3 sw=3 et: */
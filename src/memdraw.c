@@ -16,16 +16,29 @@
  */
 
 
+#include <string.h>
 #include "allegro5/allegro.h"
 #include "allegro5/internal/aintern_bitmap.h"
 #include "allegro5/internal/aintern_blend.h"
+#include "allegro5/internal/aintern_cpu.h"
 #include "allegro5/internal/aintern_memdraw.h"
 #include "allegro5/internal/aintern_pixels.h"
 
 
-typedef struct {
-   float x[4];
-} float4;
+#ifdef _AL_HAVE_SSE2
+   #include <emmintrin.h>
+#endif
+
+
+/* The fill pattern repeats every this many bytes, a multiple of every pixel
+ * size up to 16 and of the store width.
+ */
+#define FILL_PERIOD  48
+
+/* Clears of more than this many bytes would evict everything else from the
+ * cache, so they bypass it.
+ */
+#define STREAM_THRESHOLD  (4 << 20)
 
 
 void _al_draw_pixel_memory(ALLEGRO_BITMAP *bitmap, float x, float y,
@@ -44,12 +57,94 @@ void _al_draw_pixel_memory(ALLEGRO_BITMAP *bitmap, float x, float y,
 }
 
 
+/* Internal function: _al_fill_pixels
+ *  Writes n copies of a raw pixel of 1 to 16 bytes, whose size must divide
+ *  48, to dst. With stream the stores bypass the cache, which is faster for
+ *  fills much larger than it.
+ */
+void _al_fill_pixels(void *dst, const void *pixel, int pixel_size, int n,
+   bool stream)
+{
+   uint8_t pattern[FILL_PERIOD + 32];
+   uint8_t *data = dst;
+   const uint8_t *src;
+   size_t bytes = (size_t)n * pixel_size;
+   size_t head;
+   int i;
+
+   ASSERT(pixel_size > 0 && pixel_size <= 16);
+   ASSERT(FILL_PERIOD % pixel_size == 0);
+
+   if (n <= 0)
+      return;
+
+   if (pixel_size == 1) {
+      memset(data, *(const uint8_t *)pixel, n);
+      return;
+   }
+
+   if (bytes < FILL_PERIOD) {
+      for (; n > 0; n--, data += pixel_size)
+         memcpy(data, pixel, pixel_size);
+      return;
+   }
+
+   /* Long enough to cover the alignment head plus one period from any
+    * starting phase.
+    */
+   for (i = 0; i < FILL_PERIOD + 16; i += pixel_size)
+      memcpy(pattern + i, pixel, pixel_size);
+
+   head = (16 - ((uintptr_t)data & 15)) & 15;
+   memcpy(data, pattern, head);
+   data += head;
+   bytes -= head;
+   src = pattern + head % pixel_size;
+
+#ifdef _AL_HAVE_SSE2
+   {
+      const __m128i v0 = _mm_loadu_si128((const __m128i *)src);
+      const __m128i v1 = _mm_loadu_si128((const __m128i *)(src + 16));
+      const __m128i v2 = _mm_loadu_si128((const __m128i *)(src + 32));
+
+      if (stream) {
+         for (; bytes >= FILL_PERIOD; bytes -= FILL_PERIOD) {
+            _mm_stream_si128((__m128i *)data, v0);
+            _mm_stream_si128((__m128i *)(data + 16), v1);
+            _mm_stream_si128((__m128i *)(data + 32), v2);
+            data += FILL_PERIOD;
+         }
+         _mm_sfence();
+      }
+      else {
+         for (; bytes >= FILL_PERIOD; bytes -= FILL_PERIOD) {
+            _mm_store_si128((__m128i *)data, v0);
+            _mm_store_si128((__m128i *)(data + 16), v1);
+            _mm_store_si128((__m128i *)(data + 32), v2);
+            data += FILL_PERIOD;
+         }
+      }
+   }
+#else
+   (void)stream;
+   for (; bytes >= FILL_PERIOD; bytes -= FILL_PERIOD) {
+      memcpy(data, src, FILL_PERIOD);
+      data += FILL_PERIOD;
+   }
+#endif
+
+   memcpy(data, src, bytes);
+}
+
+
 void _al_clear_bitmap_by_locking(ALLEGRO_BITMAP *bitmap, ALLEGRO_COLOR *color)
 {
    ALLEGRO_LOCKED_REGION *lr;
    int x1, y1, w, h;
-   int x, y;
+   int y;
    unsigned char *line_ptr;
+   uint8_t pixel[16];
+   bool stream;
 
    /* This function is not just used on memory bitmaps, but also on OpenGL
     * video bitmaps which are not the current target, or when locked.
@@ -73,80 +168,20 @@ void _al_clear_bitmap_by_locking(ALLEGRO_BITMAP *bitmap, ALLEGRO_COLOR *color)
 
    /* Write a single pixel so we can get the raw value. */
    _al_put_pixel(bitmap, x1, y1, *color);
+   ASSERT(lr->pixel_size <= (int)sizeof(pixel));
+   memcpy(pixel, lr->data, lr->pixel_size);
 
-   /* Fill in the region. */
+   /* Fill in the region, in one go if the rows are contiguous. */
+   stream = (size_t)h * w * lr->pixel_size >= STREAM_THRESHOLD;
    line_ptr = lr->data;
-   switch (lr->pixel_size) {
-      case 2: {
-         int pixel_value = bmp_read16(line_ptr);
-         for (y = y1; y < y1 + h; y++) {
-            if (pixel_value == 0) {    /* fast path */
-               memset(line_ptr, 0, 2 * w);
-            }
-            else {
-               uint16_t *data = (uint16_t *)line_ptr;
-               for (x = 0; x < w; x++) {
-                  bmp_write16(data, pixel_value);
-                  data++;
-               }
-            }
-            line_ptr += lr->pitch;
-         }
-         break;
-      }
-
-      case 3: {
-         int pixel_value = READ3BYTES(line_ptr);
-         for (y = y1; y < y1 + h; y++) {
-            unsigned char *data = (unsigned char *)line_ptr;
-            if (pixel_value == 0) {    /* fast path */
-               memset(data, 0, 3 * w);
-            }
-            else {
-               for (x = 0; x < w; x++) {
-                  WRITE3BYTES(data, pixel_value);
-                  data += 3;
-               }
-            }
-            line_ptr += lr->pitch;
-         }
-         break;
-      }
-
-      case 4: {
-         int pixel_value = bmp_read32(line_ptr);
-         for (y = y1; y < y1 + h; y++) {
-            uint32_t *data = (uint32_t *)line_ptr;
-            /* Special casing pixel_value == 0 doesn't seem to make any
-             * difference to speed, so don't bother.
-             */
-            for (x = 0; x < w; x++) {
-               bmp_write32(data, pixel_value);
-               data++;
-            }
-            line_ptr += lr->pitch;
-         }
-         break;
-      }
-
-      case sizeof(float4): {
-         float4 *data = (float4 *)line_ptr;
-         float4 pixel_value = *data;
-
-         for (y = y1; y < y1 + h; y++) {
-            data = (float4 *)line_ptr;
-            for (x = 0; x < w; x++) {
-               *data = pixel_value;
-               data++;
-            }
-            line_ptr += lr->pitch;
-         }
-         break;
+   if (lr->pitch == w * lr->pixel_size) {
+      _al_fill_pixels(line_ptr, pixel, lr->pixel_size, w * h, stream);
+   }
+   else {
+      for (y = 0; y < h; y++) {
+         _al_fill_pixels(line_ptr, pixel, lr->pixel_size, w, stream);
+         line_ptr += lr->pitch;
       }
-
-      default:
-        ASSERT(false);
-        break;
    }
 
    al_unlock_bitmap(bitmap);
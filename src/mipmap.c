@@ -0,0 +1,344 @@
+/*         ______   ___    ___
+ *        /\  _  \ /\_ \  /\_ \
+ *        \ \ \L\ \\//\ \ \//\ \      __     __   _ __   ___
+ *         \ \  __ \ \ \ \  \ \ \   /'__`\ /'_ `\/\`'__\/ __`\
+ *          \ \ \/\ \ \_\ \_ \_\ \_/\  __//\ \L\ \ \ \//\ \L\ \
+ *           \ \_\ \_\/\____\/\____\ \____\ \____ \ \_\\ \____/
+ *            \/_/\/_/\/____/\/____/\/____/\/___L\ \/_/ \/___/
+ *                                           /\____/
+ *                                           \_/__/
+ *
+ *      Mipmaps of memory bitmaps.
+ *
+ *      Memory bitmaps with ALLEGRO_MIPMAP keep a chain of copies, each half
+ *      the size of the one before it down to 1x1, which the software
+ *      rasterizer samples from when a bitmap is drawn scaled down. The chain
+ *      is rebuilt with a 2x2 box filter when the bitmap is drawn after it
+ *      was changed.
+ *
+ *      The levels are memory bitmaps which stay locked for reading, so that
+ *      the scanline drawers can use them as they are.
+ *
+ *      See LICENSE.txt for copyright information.
+ */
+
+
+#include "allegro5/allegro.h"
+#include "allegro5/internal/aintern.h"
+#include "allegro5/internal/aintern_bitmap.h"
+#include "allegro5/internal/aintern_cpu.h"
+#include "allegro5/internal/aintern_memblit.h"
+#include "allegro5/internal/aintern_pixels.h"
+#include "allegro5/internal/aintern_tri_soft.h"
+
+#ifdef _AL_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+ALLEGRO_DEBUG_CHANNEL("bitmap")
+
+
+/* Formats with four 8 bit channels, which can be averaged byte by byte. */
+static bool is_8888(int format)
+{
+   switch (format) {
+      case ALLEGRO_PIXEL_FORMAT_ARGB_8888:
+      case ALLEGRO_PIXEL_FORMAT_RGBA_8888:
+      case ALLEGRO_PIXEL_FORMAT_XRGB_8888:
+      case ALLEGRO_PIXEL_FORMAT_ABGR_8888:
+      case ALLEGRO_PIXEL_FORMAT_XBGR_8888:
+      case ALLEGRO_PIXEL_FORMAT_RGBX_8888:
+      case ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE:
+         return true;
+      default:
+         return false;
+   }
+}
+
+
+/* Averages 2x2 blocks of the rows r0 and r1 into the row d, from pixel x up
+ * to w. Source columns are clamped to last_x1, so a source which is only one
+ * pixel wide uses that column twice.
+ */
+static void downsample_row_8888_c(const uint8_t *r0, const uint8_t *r1,
+   uint8_t *d, int x, int w, int last_x1)
+{
+   int c;
+
+   for (; x < w; x++) {
+      const int x0 = 2 * x * 4;
+      const int x1 = _ALLEGRO_MIN(2 * x + 1, last_x1) * 4;
+      for (c = 0; c < 4; c++) {
+         d[x * 4 + c] = (r0[x0 + c] + r0[x1 + c] + r1[x0 + c] + r1[x1 + c]
+            + 2) >> 2;
+      }
+   }
+}
+
+
+#ifdef _AL_HAVE_SSE2
+
+/* Four destination pixels per iteration. Returns how many were done. */
+static int downsample_row_8888_sse2(const uint8_t *r0, const uint8_t *r1,
+   uint8_t *d, int w)
+{
+   const __m128i zero = _mm_setzero_si128();
+   const __m128i two = _mm_set1_epi16(2);
+   int x;
+
+   for (x = 0; x + 4 <= w; x += 4) {
+      const __m128i a0 = _mm_loadu_si128((const __m128i *)(r0 + x * 8));
+      const __m128i a1 = _mm_loadu_si128((const __m128i *)(r0 + x * 8 + 16));
+      const __m128i b0 = _mm_loadu_si128((const __m128i *)(r1 + x * 8));
+      const __m128i b1 = _mm_loadu_si128((const __m128i *)(r1 + x * 8 + 16));
+      /* Column sums of source pixels 0 and 1, 2 and 3, and so on. */
+      const __m128i lo0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero),
+         _mm_unpacklo_epi8(b0, zero));
+      const __m128i hi0 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero),
+         _mm_unpackhi_epi8(b0, zero));
+      const __m128i lo1 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero),
+         _mm_unpacklo_epi8(b1, zero));
+      const __m128i hi1 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero),
+         _mm_unpackhi_epi8(b1, zero));
+      /* Add up neighbouring columns. */
+      __m128i s0 = _mm_add_epi16(_mm_unpacklo_epi64(lo0, hi0),
+         _mm_unpackhi_epi64(lo0, hi0));
+      __m128i s1 = _mm_add_epi16(_mm_unpacklo_epi64(lo1, hi1),
+         _mm_unpackhi_epi64(lo1, hi1));
+      s0 = _mm_srli_epi16(_mm_add_epi16(s0, two), 2);
+      s1 = _mm_srli_epi16(_mm_add_epi16(s1, two), 2);
+      _mm_storeu_si128((__m128i *)(d + x * 4), _mm_packus_epi16(s0, s1));
+   }
+
+   return x;
+}
+
+#endif
+
+
+static void downsample_row_any(int format, const uint8_t *r0,
+   const uint8_t *r1, uint8_t *d, int w, int last_x1)
+{
+   const int size = al_get_pixel_size(format);
+   ALLEGRO_COLOR c0, c1, c2, c3, avg;
+   int x;
+
+   for (x = 0; x < w; x++) {
+      const int x0 = 2 * x * size;
+      const int x1 = _ALLEGRO_MIN(2 * x + 1, last_x1) * size;
+      const uint8_t *p00 = r0 + x0, *p01 = r0 + x1;
+      const uint8_t *p10 = r1 + x0, *p11 = r1 + x1;
+      uint8_t *p = d + x * size;
+      _AL_INLINE_GET_PIXEL(format, p00, c0, false);
+      _AL_INLINE_GET_PIXEL(format, p01, c1, false);
+      _AL_INLINE_GET_PIXEL(format, p10, c2, false);
+      _AL_INLINE_GET_PIXEL(format, p11, c3, false);
+      avg.r = (c0.r + c1.r + c2.r + c3.r) * 0.25f;
+      avg.g = (c0.g + c1.g + c2.g + c3.g) * 0.25f;
+      avg.b = (c0.b + c1.b + c2.b + c3.b) * 0.25f;
+      avg.a = (c0.a + c1.a + c2.a + c3.a) * 0.25f;
+      _AL_INLINE_PUT_PIXEL(format, p, avg, false);
+   }
+}
+
+
+/* Fills dst with the 2x2 box filtered pixels of src, which is at most twice
+ * as large in each direction.
+ */
+static void downsample(int format, const uint8_t *src, int src_pitch,
+   int src_w, int src_h, uint8_t *dst, int dst_pitch, int dst_w, int dst_h)
+{
+   const bool simd = (_al_get_cpu_features() & _AL_CPU_SSE2) != 0;
+   int y, x;
+
+   (void)simd;
+
+   for (y = 0; y < dst_h; y++) {
+      const uint8_t *r0 = src + 2 * y * src_pitch;
+      const uint8_t *r1 = src + _ALLEGRO_MIN(2 * y + 1, src_h - 1) * src_pitch;
+      uint8_t *d = dst + y * dst_pitch;
+
+      if (is_8888(format)) {
+         x = 0;
+#ifdef _AL_HAVE_SSE2
+         if (simd && src_w > 1)
+            x = downsample_row_8888_sse2(r0, r1, d, dst_w);
+#endif
+         downsample_row_8888_c(r0, r1, d, x, dst_w, src_w - 1);
+      }
+      else {
+         downsample_row_any(format, r0, r1, d, dst_w, src_w - 1);
+      }
+   }
+}
+
+
+static void destroy_levels(ALLEGRO_BITMAP *bitmap)
+{
+   int i;
+
+   for (i = 0; i < bitmap->num_mipmaps; i++) {
+      al_unlock_bitmap(bitmap->mipmaps[i]);
+      al_destroy_bitmap(bitmap->mipmaps[i]);
+   }
+   al_free(bitmap->mipmaps);
+   bitmap->mipmaps = NULL;
+   bitmap->num_mipmaps = 0;
+}
+
+
+static bool create_levels(ALLEGRO_BITMAP *bitmap)
+{
+   const int format = bitmap->_format;
+   int w = bitmap->w;
+   int h = bitmap->h;
+   int n = 0;
+   int i;
+
+   while (w > 1 || h > 1) {
+      w = _ALLEGRO_MAX(w / 2, 1);
+      h = _ALLEGRO_MAX(h / 2, 1);
+      n++;
+   }
+
+   bitmap->mipmaps = al_calloc(n, sizeof *bitmap->mipmaps);
+   if (n > 0 && !bitmap->mipmaps)
+      return false;
+
+   w = bitmap->w;
+   h = bitmap->h;
+   for (i = 0; i < n; i++) {
+      ALLEGRO_BITMAP *level;
+
+      w = _ALLEGRO_MAX(w / 2, 1);
+      h = _ALLEGRO_MAX(h / 2, 1);
+      level = _al_create_bitmap_params(NULL, w, h, format,
+         ALLEGRO_MEMORY_BITMAP, 0, 0);
+      if (!level || !al_lock_bitmap(level, format, ALLEGRO_LOCK_READONLY)) {
+         al_destroy_bitmap(level);
+         destroy_levels(bitmap);
+         return false;
+      }
+      bitmap->mipmaps[bitmap->num_mipmaps++] = level;
+   }
+
+   ALLEGRO_DEBUG("Created %d mipmap levels for %dx%d bitmap\n", n,
+      bitmap->w, bitmap->h);
+   return true;
+}
+
+
+static bool wants_mipmaps(ALLEGRO_BITMAP *bitmap)
+{
+   return !bitmap->parent &&
+      (bitmap->_flags & ALLEGRO_MEMORY_BITMAP) &&
+      (bitmap->_flags & ALLEGRO_MIPMAP) &&
+      (bitmap->w > 1 || bitmap->h > 1) &&
+      bitmap->memory;
+}
+
+
+/* Internal function: _al_update_bitmap_mipmaps
+ *  Rebuilds the mipmaps of a memory bitmap with ALLEGRO_MIPMAP if it was
+ *  changed since they were last built. This must be called on the drawing
+ *  thread before the bitmap is used as a texture.
+ */
+void _al_update_bitmap_mipmaps(ALLEGRO_BITMAP *bitmap)
+{
+   const uint8_t *src;
+   int src_pitch, src_w, src_h;
+   int i;
+
+   if (!wants_mipmaps(bitmap))
+      return;
+
+   /* Held blits mark the bitmap only when they are drawn, so this must come
+    * before the dirty flag is checked.
+    */
+   _al_flush_held_memory_blits_for(bitmap);
+   _al_flush_tiled_triangles_for(bitmap, false);
+
+   if (bitmap->num_mipmaps > 0 &&
+         bitmap->mipmaps[0]->_format != bitmap->_format) {
+      destroy_levels(bitmap);
+   }
+   if (bitmap->num_mipmaps == 0) {
+      if (!create_levels(bitmap))
+         return;
+   }
+   else if (!bitmap->mipmaps_dirty) {
+      return;
+   }
+
+   src = bitmap->memory;
+   src_pitch = bitmap->pitch;
+   src_w = bitmap->w;
+   src_h = bitmap->h;
+   for (i = 0; i < bitmap->num_mipmaps; i++) {
+      ALLEGRO_BITMAP *level = bitmap->mipmaps[i];
+      downsample(bitmap->_format, src, src_pitch, src_w, src_h,
+         level->memory, level->pitch, level->w, level->h);
+      src = level->memory;
+      src_pitch = level->pitch;
+      src_w = level->w;
+      src_h = level->h;
+   }
+
+   bitmap->mipmaps_dirty = false;
+}
+
+
+/* Internal function: _al_get_bitmap_mipmap
+ *  Returns the given mipmap level of a bitmap, where level 1 is half the
+ *  size of the bitmap, or the smallest one if there are fewer levels.
+ *  Returns NULL if the bitmap has no up to date mipmaps. The level is
+ *  locked for reading in the format of the bitmap.
+ */
+ALLEGRO_BITMAP *_al_get_bitmap_mipmap(ALLEGRO_BITMAP *bitmap, int level)
+{
+   if (level < 1 || !wants_mipmaps(bitmap) || bitmap->num_mipmaps == 0 ||
+         bitmap->mipmaps_dirty)
+      return NULL;
+   return bitmap->mipmaps[_ALLEGRO_MIN(level, bitmap->num_mipmaps) - 1];
+}
+
+
+/* Internal function: _al_destroy_bitmap_mipmaps
+ *  Frees the mipmaps of a bitmap, if it has any.
+ */
+void _al_destroy_bitmap_mipmaps(ALLEGRO_BITMAP *bitmap)
+{
+   if (bitmap->mipmaps)
+      destroy_levels(bitmap);
+}
+
+
+/* Function: al_generate_bitmap_mipmaps
+ */
+bool al_generate_bitmap_mipmaps(ALLEGRO_BITMAP *bitmap)
+{
+   if (bitmap->parent)
+      bitmap = bitmap->parent;
+
+   if (!(bitmap->_flags & ALLEGRO_MIPMAP))
+      return false;
+
+   /* The display driver keeps the mipmaps of video bitmaps up to date. */
+   if (!(bitmap->_flags & ALLEGRO_MEMORY_BITMAP))
+      return true;
+
+   if (bitmap->locked)
+      return false;
+
+   /* Drawing to the bitmap which is still queued must be done first, and
+    * queued drawing from it must not see the levels change.
+    */
+   _al_flush_held_memory_blits_for(bitmap);
+   _al_flush_tiled_triangles_for(bitmap, true);
+
+   bitmap->mipmaps_dirty = true;
+   _al_update_bitmap_mipmaps(bitmap);
+   return bitmap->num_mipmaps > 0 || (bitmap->w == 1 && bitmap->h == 1);
+}
+
+/* vim: set sts=3 sw=3 et: */
@@ -193,11 +193,6 @@ char const *_al_gl_error_string(GLenum e)
 }
 #undef ERR
 
-static INLINE void transform_vertex(float* x, float* y)
-{
-   al_transform_coordinates(al_get_current_transform(), x, y);
-}
-
 static void draw_quad(ALLEGRO_BITMAP *bitmap,
     ALLEGRO_COLOR tint,
     float sx, float sy, float sw, float sh,
@@ -269,14 +264,13 @@ static void draw_quad(ALLEGRO_BITMAP *bitmap,
    verts[4].b = tint.b;
    verts[4].a = tint.a;
    
+   verts[3] = verts[1];
+
    if (disp->cache_enabled) {
       /* If drawing is batched, we apply transformations manually. */
-      transform_vertex(&verts[0].x, &verts[0].y);
-      transform_vertex(&verts[1].x, &verts[1].y);
-      transform_vertex(&verts[2].x, &verts[2].y);
-      transform_vertex(&verts[4].x, &verts[4].y);
+      al_transform_coordinates_array(al_get_current_transform(),
+         &verts[0].x, &verts[0].y, sizeof(*verts), 5);
    }
-   verts[3] = verts[1];
    verts[5] = verts[2];
    
    if (!disp->cache_enabled)
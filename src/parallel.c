@@ -0,0 +1,192 @@
+/*         ______   ___    ___
+ *        /\  _  \ /\_ \  /\_ \
+ *        \ \ \L\ \\//\ \ \//\ \      __     __   _ __   ___
+ *         \ \  __ \ \ \ \  \ \ \   /'__`\ /'_ `\/\`'__\/ __`\
+ *          \ \ \/\ \ \_\ \_ \_\ \_/\  __//\ \L\ \ \ \//\ \L\ \
+ *           \ \_\ \_\/\____\/\____\ \____\ \____ \ \_\\ \____/
+ *            \/_/\/_/\/____/\/____/\/____/\/___L\ \/_/ \/___/
+ *                                           /\____/
+ *                                           \_/__/
+ *
+ *      Pool of worker threads for splitting up software rendering work.
+ *
+ *      The workers are started when they are first needed. One job runs
+ *      at a time; if the pool is busy, or a job is started from a worker,
+ *      the calling thread does all of the work itself.
+ *
+ *      See LICENSE.txt for copyright information.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "allegro5/allegro.h"
+#include "allegro5/internal/aintern.h"
+#include "allegro5/internal/aintern_exitfunc.h"
+#include "allegro5/internal/aintern_parallel.h"
+#include "allegro5/internal/aintern_thread.h"
+
+ALLEGRO_DEBUG_CHANNEL("parallel")
+
+
+/* The most threads a job is split between, including the calling one. */
+#define MAX_THREADS  64
+
+
+static bool inited = false;
+static _AL_MUTEX pool_mutex = _AL_MUTEX_UNINITED;
+static _AL_COND job_cond;
+static _AL_COND job_done_cond;
+static _AL_THREAD workers[MAX_THREADS - 1];
+static int num_workers = 0;
+
+/* The job in progress. Workers join it while there are free slots. */
+static bool job_active = false;
+static int job_slots = 0;
+static int job_busy = 0;
+static int job_next = 0;
+static int job_n = 0;
+static void (*job_func)(int i, void *arg) = NULL;
+static void *job_arg = NULL;
+
+
+/* Runs items of the job until there are none left. Must be called with
+ * pool_mutex held.
+ */
+static void run_items(void)
+{
+   int i;
+
+   while (job_next < job_n) {
+      i = job_next++;
+      _al_mutex_unlock(&pool_mutex);
+      job_func(i, job_arg);
+      _al_mutex_lock(&pool_mutex);
+   }
+}
+
+
+static void worker_proc(_AL_THREAD *thread, void *arg)
+{
+   _al_mutex_lock(&pool_mutex);
+   for (;;) {
+      while (!_al_get_thread_should_stop(thread) &&
+            !(job_active && job_slots > 0 && job_next < job_n))
+         _al_cond_wait(&job_cond, &pool_mutex);
+      if (_al_get_thread_should_stop(thread))
+         break;
+
+      job_slots--;
+      job_busy++;
+      run_items();
+      if (--job_busy == 0)
+         _al_cond_signal(&job_done_cond);
+   }
+   _al_mutex_unlock(&pool_mutex);
+
+   (void)arg;
+}
+
+
+/* Internal function: _al_parallel_for
+ *  Calls func(i, arg) for i from 0 to n - 1, on the calling thread and up
+ *  to max_threads - 1 worker threads, and waits until all calls returned.
+ *  The calls may happen in any order.
+ */
+void _al_parallel_for(int n, int max_threads,
+   void (*func)(int i, void *arg), void *arg)
+{
+   int threads = _ALLEGRO_MIN(_ALLEGRO_MIN(n, max_threads), MAX_THREADS);
+   int i;
+
+   if (threads < 2 || !inited)
+      goto serial;
+
+   _al_mutex_lock(&pool_mutex);
+   if (job_active) {
+      _al_mutex_unlock(&pool_mutex);
+      goto serial;
+   }
+
+   while (num_workers < threads - 1) {
+      _al_thread_create(&workers[num_workers], worker_proc, NULL);
+      num_workers++;
+      ALLEGRO_DEBUG("Started worker thread %d\n", num_workers);
+   }
+
+   job_active = true;
+   job_slots = threads - 1;
+   job_busy = 0;
+   job_next = 0;
+   job_n = n;
+   job_func = func;
+   job_arg = arg;
+   _al_cond_broadcast(&job_cond);
+
+   run_items();
+   while (job_busy > 0)
+      _al_cond_wait(&job_done_cond, &pool_mutex);
+
+   /* Workers waking up late must not join the job any more. */
+   job_active = false;
+   job_slots = 0;
+   _al_mutex_unlock(&pool_mutex);
+   return;
+
+serial:
+   for (i = 0; i < n; i++)
+      func(i, arg);
+}
+
+
+/* Internal function: _al_parse_thread_count
+ *  Parses a config value giving a number of threads, which can be 'auto'
+ *  for one per CPU core. Returns 0 for NULL.
+ */
+int _al_parse_thread_count(const char *value)
+{
+   if (!value)
+      return 0;
+   if (!strcmp(value, "auto"))
+      return _ALLEGRO_MAX(al_get_cpu_count(), 1);
+   return atoi(value);
+}
+
+
+static void shutdown_parallel(void)
+{
+   int i;
+
+   _al_mutex_lock(&pool_mutex);
+   for (i = 0; i < num_workers; i++)
+      _al_thread_set_should_stop(&workers[i]);
+   _al_cond_broadcast(&job_cond);
+   _al_mutex_unlock(&pool_mutex);
+
+   for (i = 0; i < num_workers; i++)
+      _al_thread_join(&workers[i]);
+   num_workers = 0;
+
+   _al_cond_destroy(&job_cond);
+   _al_cond_destroy(&job_done_cond);
+   _al_mutex_destroy(&pool_mutex);
+   inited = false;
+}
+
+
+/* Internal function: _al_init_parallel
+ *  Sets up the worker pool. No threads are started until a job needs them.
+ */
+void _al_init_parallel(void)
+{
+   _al_mutex_init(&pool_mutex);
+   _al_cond_init(&job_cond);
+   _al_cond_init(&job_done_cond);
+   job_active = false;
+   inited = true;
+
+   _al_add_exit_func(shutdown_parallel, "shutdown_parallel");
+}
+
+/* vim: set sts=3 sw=3 et: */
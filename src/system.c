@@ -26,14 +26,20 @@
 #endif
 #include ALLEGRO_INTERNAL_HEADER
 #include "allegro5/internal/aintern_bitmap.h"
+#define _AL_NO_BLEND_INLINE_FUNC
+#include "allegro5/internal/aintern_blend.h"
+#include "allegro5/internal/aintern_cpu.h"
 #include "allegro5/internal/aintern_debug.h"
 #include "allegro5/internal/aintern_dtor.h"
 #include "allegro5/internal/aintern_exitfunc.h"
+#include "allegro5/internal/aintern_memblit.h"
+#include "allegro5/internal/aintern_parallel.h"
 #include "allegro5/internal/aintern_pixels.h"
 #include "allegro5/internal/aintern_system.h"
 #include "allegro5/internal/aintern_thread.h"
 #include "allegro5/internal/aintern_timer.h"
 #include "allegro5/internal/aintern_tls.h"
+#include "allegro5/internal/aintern_tri_soft.h"
 #include "allegro5/internal/aintern_vector.h"
 
 ALLEGRO_DEBUG_CHANNEL("system")
@@ -263,10 +269,28 @@ bool al_install_system(int version, int (*atexit_ptr)(void (*)(void)))
 
    _al_init_pixels();
 
+   _al_init_cpu_features();
+
+   _al_init_blend_spans();
+   /* The blender of this thread may have been compiled with other kernels. */
+   al_set_blend_color(al_get_blend_color());
+
+   _al_init_convert_funcs();
+
+   _al_init_parallel();
+
+   _al_init_bitmap_conversion();
+
+   _al_init_tiled_triangles();
+
+   _al_init_held_memory_blits();
+
    _al_init_iio_table();
    
    _al_init_convert_bitmap_list();
 
+   _al_init_bitmap_memory();
+
    _al_init_timers();
 
 #ifdef ALLEGRO_CFG_SHADER_GLSL
@@ -39,11 +39,14 @@
 #include "allegro5/allegro.h"
 #include "allegro5/internal/aintern.h"
 #include "allegro5/internal/aintern_bitmap.h"
+#include "allegro5/internal/aintern_blend.h"
 #include "allegro5/internal/aintern_display.h"
 #include "allegro5/internal/aintern_file.h"
 #include "allegro5/internal/aintern_fshook.h"
+#include "allegro5/internal/aintern_memblit.h"
 #include "allegro5/internal/aintern_shader.h"
 #include "allegro5/internal/aintern_tls.h"
+#include "allegro5/internal/aintern_tri_soft.h"
 
 #ifdef ALLEGRO_ANDROID
 #include "allegro5/internal/aintern_android.h"
@@ -84,6 +87,7 @@ typedef struct thread_local_state {
 
    /* Blender */
    ALLEGRO_BLENDER current_blender;
+   _AL_COMPILED_BLENDER compiled_blender;
 
    /* Bitmap parameters */
    int new_bitmap_format;
@@ -107,12 +111,24 @@ typedef struct thread_local_state {
 
    /* Destructor ownership count */
    int dtor_owner_count;
+
+   /* Whether drawing to memory bitmaps is held, see al_hold_bitmap_drawing */
+   bool hold_memory_bitmap_drawing;
+   /* Memory bitmap drawing queued while it is held, if any */
+   struct _AL_HELD_BLITS *held_blits;
+
+   /* Primitives held by the primitives addon, if any */
+   void *held_primitives;
+
+   /* Render state used while there is no current display, see
+    * _al_get_render_state.
+    */
+   _ALLEGRO_RENDER_STATE render_state;
 } thread_local_state;
 
 
 typedef struct INTERNAL_STATE {
    thread_local_state tls;
-   ALLEGRO_BLENDER stored_blender;
    ALLEGRO_TRANSFORM stored_transform;
    ALLEGRO_TRANSFORM stored_projection_transform;
    int flags;
@@ -121,6 +137,12 @@ typedef struct INTERNAL_STATE {
 ALLEGRO_STATIC_ASSERT(tls, sizeof(ALLEGRO_STATE) > sizeof(INTERNAL_STATE));
 
 
+/* Draws the primitives held by the calling thread, see
+ * _al_set_held_primitives_flush.
+ */
+static void (*flush_held_primitives)(void) = NULL;
+
+
 static void initialize_blender(ALLEGRO_BLENDER *b)
 {
    b->blend_op = ALLEGRO_ADD;
@@ -133,6 +155,17 @@ static void initialize_blender(ALLEGRO_BLENDER *b)
 }
 
 
+static void compile_blender(thread_local_state *tls)
+{
+   ALLEGRO_BLENDER *b = &tls->current_blender;
+
+   _al_compile_blender(&tls->compiled_blender,
+      b->blend_op, b->blend_source, b->blend_dest,
+      b->blend_alpha_op, b->blend_alpha_source, b->blend_alpha_dest,
+      &b->blend_color);
+}
+
+
 static void initialize_tls_values(thread_local_state *tls)
 {
    memset(tls, 0, sizeof *tls);
@@ -142,6 +175,7 @@ static void initialize_tls_values(thread_local_state *tls)
    tls->new_window_y = INT_MAX;
 
    initialize_blender(&tls->current_blender);
+   compile_blender(tls);
    tls->new_bitmap_flags = ALLEGRO_CONVERT_BITMAP;
    tls->new_bitmap_format = ALLEGRO_PIXEL_FORMAT_ANY_WITH_ALPHA;
    tls->new_file_interface = &_al_file_interface_stdio;
@@ -149,6 +183,7 @@ static void initialize_tls_values(thread_local_state *tls)
    memset(tls->new_window_title, 0, ALLEGRO_NEW_WINDOW_TITLE_MAX_SIZE + 1);
 
    _al_fill_display_settings(&tls->new_display_settings);
+   _al_init_render_state(&tls->render_state);
 }
 
 
@@ -403,6 +438,9 @@ void al_set_target_bitmap(ALLEGRO_BITMAP *bitmap)
 
    ASSERT(!al_is_bitmap_drawing_held());
 
+   _al_flush_held_memory_blits();
+   _al_flush_tiled_triangles();
+
    if (bitmap) {
       if (bitmap->parent) {
          bitmap->parent->dirty = true;
@@ -415,6 +453,12 @@ void al_set_target_bitmap(ALLEGRO_BITMAP *bitmap)
    if ((tls = tls_get()) == NULL)
       return;
 
+   /* Held primitives are drawn while their target is sure to be there. */
+   if (tls->held_primitives && bitmap != tls->target_bitmap &&
+         flush_held_primitives) {
+      flush_held_primitives();
+   }
+
    old_display = tls->current_display;
 
    if (tls->target_bitmap)
@@ -527,6 +571,7 @@ void al_set_blend_color(ALLEGRO_COLOR color)
       return;
 
    tls->current_blender.blend_color = color;
+   compile_blender(tls);
 }
 
 
@@ -556,6 +601,7 @@ void al_set_separate_blender(int op, int src, int dst,
    b->blend_alpha_op = alpha_op;
    b->blend_alpha_source = alpha_src;
    b->blend_alpha_dest = alpha_dst;
+   compile_blender(tls);
 }
 
 
@@ -616,6 +662,48 @@ void al_get_separate_blender(int *op, int *src, int *dst,
 
 
 
+/* Internal function: _al_get_compiled_blender
+ *  Returns the current blender of the calling thread compiled for the
+ *  software renderer. It stays valid until the blender is changed.
+ */
+const _AL_COMPILED_BLENDER *_al_get_compiled_blender(void)
+{
+   thread_local_state *tls;
+
+   if ((tls = tls_get()) == NULL)
+      return NULL;
+
+   return &tls->compiled_blender;
+}
+
+
+
+/* Internal function: _al_set_compiled_blender
+ *  Makes a compiled blender the current blender of the calling thread,
+ *  without compiling it again.
+ */
+void _al_set_compiled_blender(const _AL_COMPILED_BLENDER *cb)
+{
+   thread_local_state *tls;
+   ALLEGRO_BLENDER *b;
+
+   if ((tls = tls_get()) == NULL)
+      return;
+
+   b = &tls->current_blender;
+
+   b->blend_op = cb->op;
+   b->blend_source = cb->src_mode;
+   b->blend_dest = cb->dst_mode;
+   b->blend_alpha_op = cb->op_alpha;
+   b->blend_alpha_source = cb->src_alpha;
+   b->blend_alpha_dest = cb->dst_alpha;
+   b->blend_color = cb->const_color;
+   tls->compiled_blender = *cb;
+}
+
+
+
 /* Function: al_set_new_bitmap_format
  */
 void al_set_new_bitmap_format(int format)
@@ -722,7 +810,7 @@ void al_store_state(ALLEGRO_STATE *state, int flags)
    }
 
    if (flags & ALLEGRO_STATE_BLENDER) {
-      stored->stored_blender = tls->current_blender;
+      _STORE(current_blender);
    }
 
    if (flags & ALLEGRO_STATE_NEW_FILE_INTERFACE) {
@@ -797,7 +885,8 @@ void al_restore_state(ALLEGRO_STATE const *state)
    }
 
    if (flags & ALLEGRO_STATE_BLENDER) {
-      tls->current_blender = stored->stored_blender;
+      _RESTORE(current_blender);
+      compile_blender(tls);
    }
 
    if (flags & ALLEGRO_STATE_NEW_FILE_INTERFACE) {
@@ -964,4 +1053,54 @@ int *_al_tls_get_dtor_owner_count(void)
 }
 
 
+bool *_al_tls_get_hold_memory_bitmap_drawing(void)
+{
+   thread_local_state *tls;
+
+   tls = tls_get();
+   return &tls->hold_memory_bitmap_drawing;
+}
+
+
+struct _AL_HELD_BLITS **_al_tls_get_held_blits(void)
+{
+   thread_local_state *tls;
+
+   tls = tls_get();
+   return &tls->held_blits;
+}
+
+
+/* Internal function: _al_tls_get_held_primitives
+ *  Returns the slot where the primitives addon keeps what the calling thread
+ *  holds.
+ */
+void **_al_tls_get_held_primitives(void)
+{
+   thread_local_state *tls;
+
+   tls = tls_get();
+   return &tls->held_primitives;
+}
+
+
+/* Internal function: _al_set_held_primitives_flush
+ *  Sets the function which draws the primitives held by the calling thread.
+ *  It is called before the target bitmap changes while any are held.
+ */
+void _al_set_held_primitives_flush(void (*flush)(void))
+{
+   flush_held_primitives = flush;
+}
+
+
+_ALLEGRO_RENDER_STATE *_al_get_tls_render_state(void)
+{
+   thread_local_state *tls;
+
+   tls = tls_get();
+   return &tls->render_state;
+}
+
+
 /* vim: set sts=3 sw=3 et: */
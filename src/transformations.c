@@ -18,11 +18,16 @@
 #include "allegro5/allegro.h"
 #include "allegro5/internal/aintern.h"
 #include "allegro5/internal/aintern_bitmap.h"
+#include "allegro5/internal/aintern_cpu.h"
 #include "allegro5/internal/aintern_display.h"
 #include "allegro5/internal/aintern_system.h"
 #include "allegro5/internal/aintern_transform.h"
 #include <math.h>
 
+#ifdef _AL_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
 /* ALLEGRO_DEBUG_CHANNEL("transformations") */
 
 /* Function: al_copy_transform
@@ -56,6 +61,7 @@ void al_use_transform(const ALLEGRO_TRANSFORM *trans)
       
       target->inverse_transform_dirty = true;
    }
+   target->transform_class = _al_classify_transform(trans);
 
    /*
     * When the drawing is held, we apply the transformations in software,
@@ -79,10 +85,6 @@ void al_use_projection_transform(const ALLEGRO_TRANSFORM *trans)
    if (!target)
       return;
 
-   /* Memory bitmaps don't support custom projection transforms */
-   if (al_get_bitmap_flags(target) & ALLEGRO_MEMORY_BITMAP)
-      return;
-
    /* Changes to a back buffer should affect the front buffer, and vice versa.
     * Currently we rely on the fact that in the OpenGL drivers the back buffer
     * and front buffer bitmaps are exactly the same, and the DirectX driver
@@ -93,6 +95,14 @@ void al_use_projection_transform(const ALLEGRO_TRANSFORM *trans)
       al_copy_transform(&target->proj_transform, trans);
    }
 
+   /* Memory bitmaps are drawn to by the software rasterizer, which only
+    * needs to project primitives with anything else but the default.
+    */
+   if (al_get_bitmap_flags(target) & ALLEGRO_MEMORY_BITMAP) {
+      target->custom_proj_transform =
+         !_al_is_default_projection(target, &target->proj_transform);
+   }
+
    display = _al_get_bitmap_display(target);
    if (display) {
       display->vt->update_transformation(display, target);
@@ -435,6 +445,176 @@ void al_transform_coordinates_3d(const ALLEGRO_TRANSFORM *trans,
    *z = rz;
 }
 
+/* The coordinate at byte offset i * stride from p. */
+#define STRIDED(p, i) ((float *)((char *)(p) + (ptrdiff_t)(i) * stride))
+
+#ifdef _AL_HAVE_SSE2
+
+/* Transforms pairs stored as x followed by y, two at a time. Returns how
+ * many were done.
+ */
+static int transform_pairs_sse2(const ALLEGRO_TRANSFORM *trans,
+   float *xy, int stride, int num)
+{
+   const __m128 a = _mm_setr_ps(trans->m[0][0], trans->m[0][1],
+      trans->m[0][0], trans->m[0][1]);
+   const __m128 b = _mm_setr_ps(trans->m[1][0], trans->m[1][1],
+      trans->m[1][0], trans->m[1][1]);
+   const __m128 c = _mm_setr_ps(trans->m[3][0], trans->m[3][1],
+      trans->m[3][0], trans->m[3][1]);
+   int i;
+
+   for (i = 0; i + 2 <= num; i += 2) {
+      float *p0 = STRIDED(xy, i);
+      float *p1 = STRIDED(xy, i + 1);
+      __m128 p = _mm_loadl_pi(_mm_setzero_ps(), (const __m64 *)p0);
+      __m128 xx, yy, r;
+
+      p = _mm_loadh_pi(p, (const __m64 *)p1);
+      xx = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 0, 0));
+      yy = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 1, 1));
+      /* The same order of operations as al_transform_coordinates. */
+      r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xx, a), _mm_mul_ps(yy, b)), c);
+      _mm_storel_pi((__m64 *)p0, r);
+      _mm_storeh_pi((__m64 *)p1, r);
+   }
+
+   return i;
+}
+
+
+/* Transforms separate arrays of x and y, four at a time. Returns how many
+ * were done.
+ */
+static int transform_arrays_sse2(const ALLEGRO_TRANSFORM *trans,
+   float *x, float *y, int num)
+{
+   const __m128 m00 = _mm_set1_ps(trans->m[0][0]);
+   const __m128 m01 = _mm_set1_ps(trans->m[0][1]);
+   const __m128 m10 = _mm_set1_ps(trans->m[1][0]);
+   const __m128 m11 = _mm_set1_ps(trans->m[1][1]);
+   const __m128 m30 = _mm_set1_ps(trans->m[3][0]);
+   const __m128 m31 = _mm_set1_ps(trans->m[3][1]);
+   int i;
+
+   for (i = 0; i + 4 <= num; i += 4) {
+      const __m128 xx = _mm_loadu_ps(x + i);
+      const __m128 yy = _mm_loadu_ps(y + i);
+      _mm_storeu_ps(x + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(xx, m00),
+         _mm_mul_ps(yy, m10)), m30));
+      _mm_storeu_ps(y + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(xx, m01),
+         _mm_mul_ps(yy, m11)), m31));
+   }
+
+   return i;
+}
+
+
+/* Transforms points stored as x, y and z in a row, one at a time. */
+static int transform_triples_sse2(const ALLEGRO_TRANSFORM *trans,
+   float *xyz, int stride, int num)
+{
+   const __m128 r0 = _mm_loadu_ps(trans->m[0]);
+   const __m128 r1 = _mm_loadu_ps(trans->m[1]);
+   const __m128 r2 = _mm_loadu_ps(trans->m[2]);
+   const __m128 r3 = _mm_loadu_ps(trans->m[3]);
+   int i;
+
+   for (i = 0; i < num; i++) {
+      float *p = STRIDED(xyz, i);
+      __m128 r = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p[0]), r0),
+         _mm_mul_ps(_mm_set1_ps(p[1]), r1));
+      r = _mm_add_ps(_mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(p[2]), r2)), r3);
+      _mm_storel_pi((__m64 *)p, r);
+      _mm_store_ss(p + 2, _mm_movehl_ps(r, r));
+   }
+
+   return i;
+}
+
+#endif /* _AL_HAVE_SSE2 */
+
+
+/* Function: al_transform_coordinates_array
+ */
+void al_transform_coordinates_array(const ALLEGRO_TRANSFORM *trans,
+   float *x, float *y, int stride, int num)
+{
+   int i = 0;
+   ASSERT(trans);
+   ASSERT(num >= 0);
+   ASSERT(num == 0 || (x && y));
+
+   #define M(i, j) trans->m[i][j]
+
+   switch (_al_classify_transform(trans)) {
+      case _AL_TRANSFORM_IDENTITY:
+         break;
+
+      case _AL_TRANSFORM_TRANSLATION:
+         for (; i < num; i++) {
+            *STRIDED(x, i) += M(3, 0);
+            *STRIDED(y, i) += M(3, 1);
+         }
+         break;
+
+      case _AL_TRANSFORM_SCALE:
+         for (; i < num; i++) {
+            float *px = STRIDED(x, i);
+            float *py = STRIDED(y, i);
+            *px = *px * M(0, 0) + M(3, 0);
+            *py = *py * M(1, 1) + M(3, 1);
+         }
+         break;
+
+      default:
+#ifdef _AL_HAVE_SSE2
+         if (y == x + 1)
+            i = transform_pairs_sse2(trans, x, stride, num);
+         else if (stride == sizeof(float))
+            i = transform_arrays_sse2(trans, x, y, num);
+#endif
+         for (; i < num; i++) {
+            float *px = STRIDED(x, i);
+            float *py = STRIDED(y, i);
+            const float t = *px;
+            *px = t * M(0, 0) + *py * M(1, 0) + M(3, 0);
+            *py = t * M(0, 1) + *py * M(1, 1) + M(3, 1);
+         }
+         break;
+   }
+
+   #undef M
+}
+
+/* Function: al_transform_coordinates_3d_array
+ */
+void al_transform_coordinates_3d_array(const ALLEGRO_TRANSFORM *trans,
+   float *x, float *y, float *z, int stride, int num)
+{
+   int i = 0;
+   ASSERT(trans);
+   ASSERT(num >= 0);
+   ASSERT(num == 0 || (x && y && z));
+
+   /* Such transforms leave z alone. */
+   if (_al_classify_transform(trans) <= _AL_TRANSFORM_AFFINE_2D) {
+      al_transform_coordinates_array(trans, x, y, stride, num);
+      return;
+   }
+
+#ifdef _AL_HAVE_SSE2
+   if (y == x + 1 && z == x + 2)
+      i = transform_triples_sse2(trans, x, stride, num);
+#endif
+   for (; i < num; i++) {
+      al_transform_coordinates_3d(trans, STRIDED(x, i), STRIDED(y, i),
+         STRIDED(z, i));
+   }
+}
+
+#undef STRIDED
+
 /* Function: al_compose_transform
  */
 void al_compose_transform(ALLEGRO_TRANSFORM *trans, const ALLEGRO_TRANSFORM *other)
@@ -460,20 +640,7 @@ void al_compose_transform(ALLEGRO_TRANSFORM *trans, const ALLEGRO_TRANSFORM *oth
 bool _al_transform_is_translation(const ALLEGRO_TRANSFORM* trans,
    float *dx, float *dy)
 {
-   if (trans->m[0][0] == 1 &&
-          trans->m[1][0] == 0 &&
-          trans->m[2][0] == 0 &&
-          trans->m[0][1] == 0 &&
-          trans->m[1][1] == 1 &&
-          trans->m[2][1] == 0 &&
-          trans->m[0][2] == 0 &&
-          trans->m[1][2] == 0 &&
-          trans->m[2][2] == 1 &&
-          trans->m[3][2] == 0 &&
-          trans->m[0][3] == 0 &&
-          trans->m[1][3] == 0 &&
-          trans->m[2][3] == 0 &&
-          trans->m[3][3] == 1) {
+   if (_al_classify_transform(trans) <= _AL_TRANSFORM_TRANSLATION) {
       *dx = trans->m[3][0];
       *dy = trans->m[3][1];
       return true;
@@ -481,6 +648,69 @@ bool _al_transform_is_translation(const ALLEGRO_TRANSFORM* trans,
    return false;
 }
 
+/* Internal function: _al_classify_transform
+ *  Returns the most specific _AL_TRANSFORM_* class the transform is in.
+ */
+int _al_classify_transform(const ALLEGRO_TRANSFORM *trans)
+{
+   #define M(i, j) trans->m[i][j]
+
+   if (M(2, 0) != 0 || M(2, 1) != 0 ||
+       M(0, 2) != 0 || M(1, 2) != 0 || M(2, 2) != 1 || M(3, 2) != 0 ||
+       M(0, 3) != 0 || M(1, 3) != 0 || M(2, 3) != 0 || M(3, 3) != 1)
+      return _AL_TRANSFORM_GENERAL;
+
+   if (M(1, 0) != 0 || M(0, 1) != 0)
+      return _AL_TRANSFORM_AFFINE_2D;
+
+   if (M(0, 0) != 1 || M(1, 1) != 1)
+      return _AL_TRANSFORM_SCALE;
+
+   if (M(3, 0) != 0 || M(3, 1) != 0)
+      return _AL_TRANSFORM_TRANSLATION;
+
+   return _AL_TRANSFORM_IDENTITY;
+
+   #undef M
+}
+
+/* Internal function: _al_get_current_transform_class
+ *  Returns the class of the transform of the target bitmap, which is kept
+ *  up to date by al_use_transform.
+ */
+int _al_get_current_transform_class(void)
+{
+   ALLEGRO_BITMAP *target = al_get_target_bitmap();
+
+   if (!target)
+      return _AL_TRANSFORM_GENERAL;
+
+   if (target->transform_class == _AL_TRANSFORM_UNKNOWN)
+      target->transform_class = _al_classify_transform(&target->transform);
+   return target->transform_class;
+}
+
+/* Internal function: _al_is_default_projection
+ *  Returns whether trans is the orthographic projection bitmaps start out
+ *  with, see al_use_projection_transform.
+ */
+bool _al_is_default_projection(ALLEGRO_BITMAP *bitmap,
+   const ALLEGRO_TRANSFORM *trans)
+{
+   ALLEGRO_TRANSFORM ortho;
+   int i, j;
+
+   al_identity_transform(&ortho);
+   al_orthographic_transform(&ortho, 0, 0, -1.0, bitmap->w, bitmap->h, 1.0);
+   for (i = 0; i < 4; i++) {
+      for (j = 0; j < 4; j++) {
+         if (trans->m[i][j] != ortho.m[i][j])
+            return false;
+      }
+   }
+   return true;
+}
+
 /* Function: al_orthographic_transform
  */
 void al_orthographic_transform(ALLEGRO_TRANSFORM *trans,
@@ -21,9 +21,12 @@
 #include "allegro5/internal/aintern.h"
 #include "allegro5/internal/aintern_bitmap.h"
 #include "allegro5/internal/aintern_blend.h"
+#include "allegro5/internal/aintern_display.h"
+#include "allegro5/internal/aintern_memdraw.h"
 #include "allegro5/internal/aintern_pixels.h"
 #include "allegro5/internal/aintern_tri_soft.h"
 #include <math.h>
+#include <string.h>
 
 ALLEGRO_DEBUG_CHANNEL("tri_soft")
 
@@ -43,7 +46,6 @@ typedef struct {
 static void shader_solid_any_init(uintptr_t state, ALLEGRO_VERTEX* v1, ALLEGRO_VERTEX* v2, ALLEGRO_VERTEX* v3)
 {
    state_solid_any_2d* s = (state_solid_any_2d*)state;
-   s->target = al_get_target_bitmap();
    s->cur_color = v1->color;
 
    (void)v2;
@@ -131,8 +133,6 @@ static void shader_grad_any_init(uintptr_t state, ALLEGRO_VERTEX* v1, ALLEGRO_VE
 
    state_grad_any_2d* s = (state_grad_any_2d*)state;
 
-   s->solid.target = al_get_target_bitmap();
-   
    s->off_x = v1->x - 0.5f;
    s->off_y = v1->y + 0.5f;
 
@@ -234,7 +234,6 @@ static void shader_texture_solid_any_init(uintptr_t state, ALLEGRO_VERTEX* v1, A
 
    state_texture_solid_any_2d* s = (state_texture_solid_any_2d*)state;
 
-   s->target = al_get_target_bitmap();
    s->cur_color = v1->color;
 
    s->off_x = v1->x - 0.5f;
@@ -320,7 +319,6 @@ static void shader_texture_grad_any_init(uintptr_t state, ALLEGRO_VERTEX* v1, AL
 
    state_texture_grad_any_2d* s = (state_texture_grad_any_2d*)state;
    
-   s->solid.target = al_get_target_bitmap();
    s->solid.w = al_get_bitmap_width(s->solid.texture);
    s->solid.h = al_get_bitmap_height(s->solid.texture);
 
@@ -403,14 +401,89 @@ static void shader_texture_grad_any_step(uintptr_t state, int minor)
    }
 }
 
+/*============================ Bilinear Filtering ============================*/
+
+/* Finds the two texels to either side of the 16.16 fixed point texture
+ * coordinate t, whose centers are at .5, and the 8 bit weight of the second
+ * one. Texels outside [0, size) are clamped to the edge.
+ */
+static _AL_ALWAYS_INLINE void linear_texel(al_fixed t, int size,
+   int *t0, int *t1, int *f)
+{
+   const al_fixed c = t - 0x8000;
+
+   *t0 = c >> 16;
+   *t1 = *t0 + 1;
+   *f = (c >> 8) & 0xff;
+   if (*t0 < 0)
+      *t0 = 0;
+   if (*t1 > size - 1)
+      *t1 = size - 1;
+}
+
+/* Interpolates between two 32-bit pixels with 8 bits per channel, two
+ * channels at a time, rounding to nearest.
+ */
+static _AL_ALWAYS_INLINE uint32_t lerp_8888(uint32_t a, uint32_t b, int f)
+{
+   const uint32_t rb = ((a & 0xff00ff) * (256 - f) + (b & 0xff00ff) * f
+      + 0x800080) >> 8;
+   const uint32_t ag = ((a >> 8) & 0xff00ff) * (256 - f)
+      + ((b >> 8) & 0xff00ff) * f + 0x800080;
+   return (rb & 0xff00ff) | (ag & 0xff00ff00);
+}
+
+static _AL_ALWAYS_INLINE uint32_t linear_texel_8888(const uint8_t *row0,
+   const uint8_t *row1, int x0, int x1, int fx, int fy)
+{
+   const uint32_t *p0 = (const uint32_t *)row0;
+   const uint32_t *p1 = (const uint32_t *)row1;
+   return lerp_8888(lerp_8888(p0[x0], p0[x1], fx),
+      lerp_8888(p1[x0], p1[x1], fx), fy);
+}
+
+#define LINEAR_TEXEL_COLOR(format, size, row0, row1, x0, x1, fx, fy, color) \
+   do {                                                                     \
+      ALLEGRO_COLOR _c00, _c01, _c10, _c11;                                 \
+      uint8_t *_p;                                                          \
+      const float _fx = (fx) * (1.0f / 256);                                \
+      const float _fy = (fy) * (1.0f / 256);                                \
+      _p = (row0) + (x0) * (size);                                          \
+      _AL_INLINE_GET_PIXEL(format, _p, _c00, false);                        \
+      _p = (row0) + (x1) * (size);                                          \
+      _AL_INLINE_GET_PIXEL(format, _p, _c10, false);                        \
+      _p = (row1) + (x0) * (size);                                          \
+      _AL_INLINE_GET_PIXEL(format, _p, _c01, false);                        \
+      _p = (row1) + (x1) * (size);                                          \
+      _AL_INLINE_GET_PIXEL(format, _p, _c11, false);                        \
+      _c00.r += (_c10.r - _c00.r) * _fx;                                    \
+      _c00.g += (_c10.g - _c00.g) * _fx;                                    \
+      _c00.b += (_c10.b - _c00.b) * _fx;                                    \
+      _c00.a += (_c10.a - _c00.a) * _fx;                                    \
+      _c01.r += (_c11.r - _c01.r) * _fx;                                    \
+      _c01.g += (_c11.g - _c01.g) * _fx;                                    \
+      _c01.b += (_c11.b - _c01.b) * _fx;                                    \
+      _c01.a += (_c11.a - _c01.a) * _fx;                                    \
+      (color).r = _c00.r + (_c01.r - _c00.r) * _fy;                         \
+      (color).g = _c00.g + (_c01.g - _c00.g) * _fy;                         \
+      (color).b = _c00.b + (_c01.b - _c00.b) * _fy;                         \
+      (color).a = _c00.a + (_c01.a - _c00.a) * _fy;                         \
+   } while (0)
+
 
 /* Include generated routines. */
 #include "scanline_drawers.inc"
 
 
+/*
+Steps through the rows of a triangle, calling the drawer for each span. It
+stops before row max_y, rows are numbered as the drawers expect them, see
+target_rows.
+*/
 static void triangle_stepper(uintptr_t state,
    shader_init init, shader_first first, shader_step step, shader_draw draw,
-   ALLEGRO_VERTEX* vtx1, ALLEGRO_VERTEX* vtx2, ALLEGRO_VERTEX* vtx3)
+   ALLEGRO_VERTEX* vtx1, ALLEGRO_VERTEX* vtx2, ALLEGRO_VERTEX* vtx3,
+   int max_y)
 {
    float Coords[6] = {vtx1->x - 0.5f, vtx1->y + 0.5f, vtx2->x - 0.5f, vtx2->y + 0.5f, vtx3->x - 0.5f, vtx3->y + 0.5f};
    float *V1 = Coords, *V2 = &Coords[2], *V3 = &Coords[4], *s;
@@ -425,7 +498,7 @@ static void triangle_stepper(uintptr_t state,
    float right_x_delta;
 
    int left_first, right_first, left_step, right_step;
-   int left_x, right_x, cur_y, mid_y, end_y;
+   int left_x, right_x, cur_y, mid_y, end_y, stop_y;
    float left_d_er, right_d_er;
 
    /*
@@ -464,6 +537,10 @@ static void triangle_stepper(uintptr_t state,
    if (cur_y == end_y)
       return;
 
+   stop_y = MIN(end_y, max_y);
+   if (cur_y >= stop_y)
+      return;
+
    /*
    As per definition, we take the ceiling
    */
@@ -545,7 +622,7 @@ static void triangle_stepper(uintptr_t state,
       /*
       Take the first step
       */
-      if (cur_y < mid_y) {
+      if (cur_y < MIN(mid_y, stop_y)) {
          left_x += left_first;
          left_error -= (float)left_first * left_y_delta;
 
@@ -566,7 +643,7 @@ static void triangle_stepper(uintptr_t state,
       /*
       ...and then continue taking normal steps until we finish the segment
       */
-      while (cur_y < mid_y) {
+      while (cur_y < MIN(mid_y, stop_y)) {
          left_error += left_d_er;
          left_x += left_step;
 
@@ -603,7 +680,7 @@ static void triangle_stepper(uintptr_t state,
    /*
    Draw the second segment, if possible
    */
-   if (cur_y < end_y) {
+   if (cur_y < stop_y) {
       if (major_on_the_left) {
          right_x = ceilf(V2[0]);
 
@@ -635,7 +712,7 @@ static void triangle_stepper(uintptr_t state,
       right_step = ceilf(right_x_delta / right_y_delta);
       right_d_er = -(float)right_step * right_y_delta;
 
-      if (cur_y < end_y) {
+      if (cur_y < stop_y) {
          left_x += left_first;
          left_error -= (float)left_first * left_y_delta;
 
@@ -653,7 +730,7 @@ static void triangle_stepper(uintptr_t state,
          right_error += right_x_delta;
       }
 
-      while (cur_y < end_y) {
+      while (cur_y < stop_y) {
          left_error += left_d_er;
          left_x += left_step;
 
@@ -684,22 +761,290 @@ static void triangle_stepper(uintptr_t state,
 }
 
 /*
-This one will check to see what exactly we need to draw...
-I.e. this will call all of the actual renderers and set the appropriate callbacks
+Triangles reaching further than this many pixels outside of the target bitmap
+are clipped to that distance before they are rasterized. The band keeps the
+coordinates the edge steppers work with small enough to be precise, while
+closer to the bitmap the drawers clip the spans, which draws exactly the same
+pixels as the whole triangle would. It only depends on the size of the bitmap
+so that drawing in bands of rows gives the same result as drawing it at once.
 */
-void _al_triangle_2d(ALLEGRO_BITMAP* texture, ALLEGRO_VERTEX* v1, ALLEGRO_VERTEX* v2, ALLEGRO_VERTEX* v3)
+#define GUARD_BAND  1024
+
+/* A triangle clipped to a rectangle has at most seven vertices. */
+#define MAX_CLIPPED_VERTICES  7
+
+/*
+The row after the last row of the locked region of the target, in the
+coordinates of the vertices. Rows are numbered as in triangle_stepper, one
+more than the pixel rows, see the y-- in the drawers.
+*/
+static int target_end_row(ALLEGRO_BITMAP *target)
+{
+   ALLEGRO_BITMAP *parent = target->parent ? target->parent : target;
+   const int yofs = target->parent ? target->yofs : 0;
+
+   return parent->lock_y + parent->lock_h - yofs + 1;
+}
+
+static void lerp_vertex(ALLEGRO_VERTEX *out, const ALLEGRO_VERTEX *a,
+   const ALLEGRO_VERTEX *b, float t)
+{
+   out->x = a->x + (b->x - a->x) * t;
+   out->y = a->y + (b->y - a->y) * t;
+   out->z = a->z + (b->z - a->z) * t;
+   out->u = a->u + (b->u - a->u) * t;
+   out->v = a->v + (b->v - a->v) * t;
+   out->color.r = a->color.r + (b->color.r - a->color.r) * t;
+   out->color.g = a->color.g + (b->color.g - a->color.g) * t;
+   out->color.b = a->color.b + (b->color.b - a->color.b) * t;
+   out->color.a = a->color.a + (b->color.a - a->color.a) * t;
+}
+
+/*
+Clips the convex polygon in with n vertices to the half plane where the x (or
+y, if clip_y is set) coordinate is on the inner side of limit, which is above
+it if sign is 1 and below it if sign is -1. Returns the number of vertices.
+*/
+static int clip_polygon(const ALLEGRO_VERTEX *in, int n, ALLEGRO_VERTEX *out,
+   bool clip_y, float limit, float sign)
+{
+   int i, m = 0;
+
+   for (i = 0; i < n; i++) {
+      const ALLEGRO_VERTEX *a = &in[i];
+      const ALLEGRO_VERTEX *b = &in[(i + 1) % n];
+      const float da = sign * ((clip_y ? a->y : a->x) - limit);
+      const float db = sign * ((clip_y ? b->y : b->x) - limit);
+
+      if (da >= 0)
+         out[m++] = *a;
+      if ((da >= 0) != (db >= 0)) {
+         lerp_vertex(&out[m], a, b, da / (da - db));
+         /* Put it on the edge exactly. */
+         if (clip_y)
+            out[m].y = limit;
+         else
+            out[m].x = limit;
+         m++;
+      }
+   }
+
+   return m;
+}
+
+/*
+Draws a triangle to the locked region of target, clipping it to the guard band
+around the bitmap first if it reaches beyond.
+*/
+static void draw_triangle(ALLEGRO_BITMAP *target, uintptr_t state,
+   shader_init init, shader_first first, shader_step step, shader_draw draw,
+   ALLEGRO_VERTEX* v1, ALLEGRO_VERTEX* v2, ALLEGRO_VERTEX* v3)
+{
+   ALLEGRO_VERTEX a[MAX_CLIPPED_VERTICES], b[MAX_CLIPPED_VERTICES];
+   const int max_y = target_end_row(target);
+   const float x1 = -GUARD_BAND;
+   const float y1 = -GUARD_BAND;
+   const float x2 = target->w + GUARD_BAND;
+   const float y2 = target->h + GUARD_BAND;
+   int i, n;
+
+   if (MIN(v1->x, MIN(v2->x, v3->x)) >= x1 &&
+         MAX(v1->x, MAX(v2->x, v3->x)) <= x2 &&
+         MIN(v1->y, MIN(v2->y, v3->y)) >= y1 &&
+         MAX(v1->y, MAX(v2->y, v3->y)) <= y2) {
+      triangle_stepper(state, init, first, step, draw, v1, v2, v3,
+         max_y);
+      return;
+   }
+
+   a[0] = *v1;
+   a[1] = *v2;
+   a[2] = *v3;
+   n = clip_polygon(a, 3, b, false, x1, 1);
+   n = clip_polygon(b, n, a, false, x2, -1);
+   n = clip_polygon(a, n, b, true, y1, 1);
+   n = clip_polygon(b, n, a, true, y2, -1);
+
+   for (i = 1; i + 1 < n; i++) {
+      triangle_stepper(state, init, first, step, draw, &a[0], &a[i], &a[i + 1],
+         max_y);
+   }
+}
+
+static int bitmap_region_is_locked(ALLEGRO_BITMAP* bmp, int x1, int y1, int w, int h)
+{
+   ASSERT(bmp);
+
+   if (!al_is_bitmap_locked(bmp))
+      return 0;
+   if (x1 + w > bmp->lock_x && y1 + h > bmp->lock_y && x1 < bmp->lock_x + bmp->lock_w && y1 < bmp->lock_y + bmp->lock_h)
+      return 1;
+   return 0;
+}
+
+/*
+Computes the part of the target the pixels from min_x, min_y to max_x, max_y
+cover, clipped to the clipping rectangle. Returns false if there is nothing to
+draw.
+*/
+static bool clip_target_rect(int min_x, int min_y, int max_x, int max_y,
+   int *x, int *y, int *w, int *h)
+{
+   int clip_min_x, clip_min_y, clip_max_x, clip_max_y;
+
+   al_get_clipping_rectangle(&clip_min_x, &clip_min_y, &clip_max_x, &clip_max_y);
+   clip_max_x += clip_min_x;
+   clip_max_y += clip_min_y;
+
+   /*
+   TODO: This bit is temporary, the min max's will be guaranteed to be within the bitmap
+   once clipping is implemented
+   */
+   if (min_x >= clip_max_x || min_y >= clip_max_y)
+      return false;
+   if (max_x >= clip_max_x)
+      max_x = clip_max_x;
+   if (max_y >= clip_max_y)
+      max_y = clip_max_y;
+
+   if (max_x < clip_min_x || max_y < clip_min_y)
+      return false;
+   if (min_x < clip_min_x)
+      min_x = clip_min_x;
+   if (min_y < clip_min_y)
+      min_y = clip_min_y;
+
+   *x = min_x;
+   *y = min_y;
+   *w = max_x - min_x;
+   *h = max_y - min_y;
+   return true;
+}
+
+/*
+Computes the part of the target a triangle may touch, clipped to the clipping
+rectangle. Returns false if there is nothing to draw.
+*/
+static bool triangle_target_rect(ALLEGRO_VERTEX* vtx1, ALLEGRO_VERTEX* vtx2,
+   ALLEGRO_VERTEX* vtx3, int *x, int *y, int *w, int *h)
+{
+   /*
+   Lock the region we are drawing to. We are choosing the minimum and maximum
+   possible pixels touched from the formula (easily verified by following the
+   above algorithm.
+   */
+   return clip_target_rect(
+      (int)floorf(MIN(vtx1->x, MIN(vtx2->x, vtx3->x))) - 1,
+      (int)floorf(MIN(vtx1->y, MIN(vtx2->y, vtx3->y))) - 1,
+      (int)ceilf(MAX(vtx1->x, MAX(vtx2->x, vtx3->x))) + 1,
+      (int)ceilf(MAX(vtx1->y, MAX(vtx2->y, vtx3->y))) + 1,
+      x, y, w, h);
+}
+
+/*
+Locks the given part of the target, unless the target is locked already.
+Returns false if there is nothing to draw.
+*/
+static bool lock_triangle_target(ALLEGRO_BITMAP *target,
+   int x, int y, int w, int h, int *need_unlock)
+{
+   *need_unlock = 0;
+
+   if (al_is_bitmap_locked(target)) {
+      if (!bitmap_region_is_locked(target, x, y, w, h) ||
+          _al_pixel_format_is_video_only(target->locked_region.format))
+         return false;
+   } else {
+      if (!al_lock_bitmap_region(target, x, y, w, h, ALLEGRO_PIXEL_FORMAT_ANY, 0))
+         return false;
+      *need_unlock = 1;
+   }
+
+   return true;
+}
+
+static int locked_format(ALLEGRO_BITMAP *bmp)
+{
+   if (bmp->parent)
+      bmp = bmp->parent;
+   return bmp->locked_region.format;
+}
+
+/* Whether the texture should be filtered bilinearly, as its
+ * ALLEGRO_MIN_LINEAR or ALLEGRO_MAG_LINEAR flag says depending on whether the
+ * triangle covers less or more pixels than texels.
+ */
+static bool texture_is_linear(ALLEGRO_BITMAP *texture,
+   ALLEGRO_VERTEX* v1, ALLEGRO_VERTEX* v2, ALLEGRO_VERTEX* v3)
+{
+   int flags = al_get_bitmap_flags(texture);
+   float xy_area, uv_area;
+
+   if (!(flags & (ALLEGRO_MIN_LINEAR | ALLEGRO_MAG_LINEAR)))
+      return false;
+
+   xy_area = (v2->x - v1->x) * (v3->y - v1->y) -
+      (v3->x - v1->x) * (v2->y - v1->y);
+   uv_area = (v2->u - v1->u) * (v3->v - v1->v) -
+      (v3->u - v1->u) * (v2->v - v1->v);
+   if (fabsf(uv_area) > fabsf(xy_area))
+      return flags & ALLEGRO_MIN_LINEAR;
+   return flags & ALLEGRO_MAG_LINEAR;
+}
+
+/* Picks the mipmap level whose texels come closest to one per pixel, from
+ * how far the texture coordinates move per pixel along x and y. These are
+ * the same everywhere in the triangle.
+ */
+static int mipmap_level(ALLEGRO_VERTEX* v1, ALLEGRO_VERTEX* v2,
+   ALLEGRO_VERTEX* v3)
+{
+   const float dx2 = v2->x - v1->x, dy2 = v2->y - v1->y;
+   const float dx3 = v3->x - v1->x, dy3 = v3->y - v1->y;
+   const float du2 = v2->u - v1->u, dv2 = v2->v - v1->v;
+   const float du3 = v3->u - v1->u, dv3 = v3->v - v1->v;
+   const float det = dx2 * dy3 - dx3 * dy2;
+   float du_dx, du_dy, dv_dx, dv_dy, rho2;
+   int level = 0;
+
+   if (det == 0.0f)
+      return 0;
+
+   du_dx = (du2 * dy3 - du3 * dy2) / det;
+   du_dy = (dx2 * du3 - dx3 * du2) / det;
+   dv_dx = (dv2 * dy3 - dv3 * dy2) / det;
+   dv_dy = (dx2 * dv3 - dx3 * dv2) / det;
+   rho2 = MAX(du_dx * du_dx + dv_dx * dv_dx, du_dy * du_dy + dv_dy * dv_dy);
+
+   /* Level n is used from 2^(n - 1/2) texels per pixel on. */
+   while (rho2 >= 2.0f && level < 31) {
+      rho2 *= 0.25f;
+      level++;
+   }
+   return level;
+}
+
+/* Internal function: _al_triangle_2d_locked
+ *  Draws a triangle into the locked region of target, which need not be the
+ *  target bitmap, with the current blender. The texture, if any, must be
+ *  locked as well. The drawers are picked from the locked pixel formats, so
+ *  that the ones specialized for them can be used. If the texture has up to
+ *  date mipmaps, the level matching the scale of the triangle is sampled.
+ */
+void _al_triangle_2d_locked(ALLEGRO_BITMAP *target, ALLEGRO_BITMAP* texture,
+   ALLEGRO_VERTEX* v1, ALLEGRO_VERTEX* v2, ALLEGRO_VERTEX* v3)
 {
    int shade = 1;
    int grad = 1;
-   int op, src_mode, dst_mode, op_alpha, src_alpha, dst_alpha;
    ALLEGRO_COLOR v1c, v2c, v3c;
+   int dst_format, src_format;
+   ALLEGRO_VERTEX mip_vtx[3];
 
    v1c = v1->color;
    v2c = v2->color;
    v3c = v3->color;
 
-   al_get_separate_blender(&op, &src_mode, &dst_mode, &op_alpha, &src_alpha, &dst_alpha);
-   if (_AL_DEST_IS_ZERO && _AL_SRC_NOT_MODIFIED) {
+   if (_al_get_compiled_blender()->flags & _AL_BLEND_COPY) {
       shade = 0;
    }
 
@@ -710,16 +1055,42 @@ void _al_triangle_2d(ALLEGRO_BITMAP* texture, ALLEGRO_VERTEX* v1, ALLEGRO_VERTEX
       grad = 0;
    }
 
+   dst_format = locked_format(target);
+   src_format = texture ? locked_format(texture) : ALLEGRO_PIXEL_FORMAT_ANY;
+
    if (texture) {
+      const bool linear = texture_is_linear(texture, v1, v2, v3);
+      ALLEGRO_BITMAP *mipmap = NULL;
+      if (al_get_bitmap_flags(texture) & ALLEGRO_MIPMAP) {
+         mipmap = _al_get_bitmap_mipmap(texture, mipmap_level(v1, v2, v3));
+      }
+      if (mipmap) {
+         /* Sample the smaller copy at the same relative coordinates. */
+         const float su = (float)mipmap->w / texture->w;
+         const float sv = (float)mipmap->h / texture->h;
+         mip_vtx[0] = *v1;
+         mip_vtx[1] = *v2;
+         mip_vtx[2] = *v3;
+         mip_vtx[0].u *= su; mip_vtx[0].v *= sv;
+         mip_vtx[1].u *= su; mip_vtx[1].v *= sv;
+         mip_vtx[2].u *= su; mip_vtx[2].v *= sv;
+         v1 = &mip_vtx[0];
+         v2 = &mip_vtx[1];
+         v3 = &mip_vtx[2];
+         texture = mipmap;
+         src_format = locked_format(texture);
+      }
+      shader_draw draw;
       if (grad) {
          state_texture_grad_any_2d state;
+         state.solid.target = target;
          state.solid.texture = texture;
-
          if (shade) {
-            _al_draw_soft_triangle(v1, v2, v3, (uintptr_t)&state, shader_texture_grad_any_init, shader_texture_grad_any_first, shader_texture_grad_any_step, shader_texture_grad_any_draw_shade);
+            draw = linear ? select_shader_texture_grad_any_draw_shade_linear(dst_format, src_format) : select_shader_texture_grad_any_draw_shade(dst_format, src_format);
          } else {
-            _al_draw_soft_triangle(v1, v2, v3, (uintptr_t)&state, shader_texture_grad_any_init, shader_texture_grad_any_first, shader_texture_grad_any_step, shader_texture_grad_any_draw_opaque);
+            draw = linear ? select_shader_texture_grad_any_draw_opaque_linear(dst_format, src_format) : select_shader_texture_grad_any_draw_opaque(dst_format, src_format);
          }
+         draw_triangle(target, (uintptr_t)&state, shader_texture_grad_any_init, shader_texture_grad_any_first, shader_texture_grad_any_step, draw, v1, v2, v3);
       } else {
          int white = 0;
          state_texture_solid_any_2d state;
@@ -727,118 +1098,737 @@ void _al_triangle_2d(ALLEGRO_BITMAP* texture, ALLEGRO_VERTEX* v1, ALLEGRO_VERTEX
          if (v1c.r == 1 && v1c.g == 1 && v1c.b == 1 && v1c.a == 1) {
             white = 1;
          }
+         state.target = target;
          state.texture = texture;
          if (shade) {
             if (white) {
-               _al_draw_soft_triangle(v1, v2, v3, (uintptr_t)&state, shader_texture_solid_any_init, shader_texture_solid_any_first, shader_texture_solid_any_step, shader_texture_solid_any_draw_shade_white);
+               draw = linear ? select_shader_texture_solid_any_draw_shade_white_linear(dst_format, src_format) : select_shader_texture_solid_any_draw_shade_white(dst_format, src_format);
             } else {
-               _al_draw_soft_triangle(v1, v2, v3, (uintptr_t)&state, shader_texture_solid_any_init, shader_texture_solid_any_first, shader_texture_solid_any_step, shader_texture_solid_any_draw_shade);
+               draw = linear ? select_shader_texture_solid_any_draw_shade_linear(dst_format, src_format) : select_shader_texture_solid_any_draw_shade(dst_format, src_format);
             }
          } else {
             if (white) {
-               _al_draw_soft_triangle(v1, v2, v3, (uintptr_t)&state, shader_texture_solid_any_init, shader_texture_solid_any_first, shader_texture_solid_any_step, shader_texture_solid_any_draw_opaque_white);
+               draw = linear ? select_shader_texture_solid_any_draw_opaque_white_linear(dst_format, src_format) : select_shader_texture_solid_any_draw_opaque_white(dst_format, src_format);
             } else {
-               _al_draw_soft_triangle(v1, v2, v3, (uintptr_t)&state, shader_texture_solid_any_init, shader_texture_solid_any_first, shader_texture_solid_any_step, shader_texture_solid_any_draw_opaque);
+               draw = linear ? select_shader_texture_solid_any_draw_opaque_linear(dst_format, src_format) : select_shader_texture_solid_any_draw_opaque(dst_format, src_format);
             }
          }
+         draw_triangle(target, (uintptr_t)&state, shader_texture_solid_any_init, shader_texture_solid_any_first, shader_texture_solid_any_step, draw, v1, v2, v3);
       }
    } else {
       if (grad) {
          state_grad_any_2d state;
+         state.solid.target = target;
          if (shade) {
-            _al_draw_soft_triangle(v1, v2, v3, (uintptr_t)&state, shader_grad_any_init, shader_grad_any_first, shader_grad_any_step, shader_grad_any_draw_shade);
+            draw_triangle(target, (uintptr_t)&state, shader_grad_any_init, shader_grad_any_first, shader_grad_any_step, select_shader_grad_any_draw_shade(dst_format, src_format), v1, v2, v3);
          } else {
-            _al_draw_soft_triangle(v1, v2, v3, (uintptr_t)&state, shader_grad_any_init, shader_grad_any_first, shader_grad_any_step, shader_grad_any_draw_opaque);
+            draw_triangle(target, (uintptr_t)&state, shader_grad_any_init, shader_grad_any_first, shader_grad_any_step, select_shader_grad_any_draw_opaque(dst_format, src_format), v1, v2, v3);
          }
       } else {
          state_solid_any_2d state;
+         state.target = target;
          if (shade) {
-            _al_draw_soft_triangle(v1, v2, v3, (uintptr_t)&state, shader_solid_any_init, shader_solid_any_first, shader_solid_any_step, shader_solid_any_draw_shade);
+            draw_triangle(target, (uintptr_t)&state, shader_solid_any_init, shader_solid_any_first, shader_solid_any_step, select_shader_solid_any_draw_shade(dst_format, src_format), v1, v2, v3);
          } else {
-            _al_draw_soft_triangle(v1, v2, v3, (uintptr_t)&state, shader_solid_any_init, shader_solid_any_first, shader_solid_any_step, shader_solid_any_draw_opaque);
+            draw_triangle(target, (uintptr_t)&state, shader_solid_any_init, shader_solid_any_first, shader_solid_any_step, select_shader_solid_any_draw_opaque(dst_format, src_format), v1, v2, v3);
          }
       }
    }
 }
 
-static int bitmap_region_is_locked(ALLEGRO_BITMAP* bmp, int x1, int y1, int w, int h)
+/*
+This one will check to see what exactly we need to draw...
+I.e. this will call all of the actual renderers and set the appropriate callbacks.
+Triangles drawn to memory bitmaps may be queued up for the tiled rasterizer
+instead, see tri_tiled.c.
+*/
+void _al_triangle_2d(ALLEGRO_BITMAP* texture, ALLEGRO_VERTEX* v1, ALLEGRO_VERTEX* v2, ALLEGRO_VERTEX* v3)
 {
-   ASSERT(bmp);
+   ALLEGRO_BITMAP *target = al_get_target_bitmap();
+   int x, y, w, h;
+   int need_unlock;
 
-   if (!al_is_bitmap_locked(bmp))
-      return 0;
-   if (x1 + w > bmp->lock_x && y1 + h > bmp->lock_y && x1 < bmp->lock_x + bmp->lock_w && y1 < bmp->lock_y + bmp->lock_h)
-      return 1;
-   return 0;
+   if (!triangle_target_rect(v1, v2, v3, &x, &y, &w, &h))
+      return;
+
+   if (texture)
+      _al_update_bitmap_mipmaps(texture);
+
+   if (_al_queue_tiled_triangle(target, texture, v1, v2, v3, x, y, w, h))
+      return;
+
+   if (!lock_triangle_target(target, x, y, w, h, &need_unlock))
+      return;
+
+   _al_triangle_2d_locked(target, texture, v1, v2, v3);
+
+   if (need_unlock)
+      al_unlock_bitmap(target);
 }
 
-void _al_draw_soft_triangle(
-   ALLEGRO_VERTEX* v1, ALLEGRO_VERTEX* v2, ALLEGRO_VERTEX* v3, uintptr_t state,
-   void (*init)(uintptr_t, ALLEGRO_VERTEX*, ALLEGRO_VERTEX*, ALLEGRO_VERTEX*),
-   void (*first)(uintptr_t, int, int, int, int),
-   void (*step)(uintptr_t, int),
-   void (*draw)(uintptr_t, int, int, int))
+/*========================== Perspective Triangles ===========================*/
+
+/*
+Triangles drawn with a projection transform other than the default one, or
+with the depth test enabled, take a path of their own. They are clipped in
+homogeneous coordinates and drawn by a generic drawer which interpolates the
+attributes divided by w, so that they are perspective correct. The drawer
+tests a whole span against the depth buffer first and only shades the pixels
+which passed.
+*/
+
+/* Clipped against the six planes of _al_triangle_3d, a triangle has at most
+ * nine vertices.
+ */
+#define MAX_CLIPPED_VERTICES_3D  9
+
+/* A vertex divided by w. x and y are in pixels, z is the depth and the other
+ * attributes are unchanged.
+ */
+typedef struct {
+   ALLEGRO_VERTEX v;
+   float q; /* 1 / w */
+} persp_vertex;
+
+/* An attribute as a function of the pixel coordinates, see PLANE_DETS. */
+typedef struct {
+   float dx, dy, c;
+} plane_eq;
+
+typedef struct {
+   ALLEGRO_BITMAP *target;
+   ALLEGRO_BITMAP *texture;
+   int w, h;
+   bool linear;
+   bool grad;
+   bool shade;
+   int write_mask;
+   bool depth_test;
+   int depth_function;
+   bool depth16;
+
+   float off_x;
+   float off_y;
+
+   /* Used when the vertices have the same color. */
+   ALLEGRO_COLOR color;
+
+   /* The depth, 1 / w, and the other attributes multiplied by it. */
+   plane_eq z, q, u, v, r, g, b, a;
+} state_perspective;
+
+#define SET_PLANE(p, a1, a2, a3)                \
+   do {                                         \
+      const float _a1 = (a1);                   \
+      const float _a2 = (a2);                   \
+      const float _a3 = (a3);                   \
+      PLANE_DETS(_p, _a1, _a2, _a3)             \
+      s->p.dx = -_p_det_x / det_u;              \
+      s->p.dy = -_p_det_y / det_u;              \
+      s->p.c = _p_det / det_u;                  \
+   } while (0)
+
+static void shader_perspective_init(uintptr_t state, ALLEGRO_VERTEX* v1, ALLEGRO_VERTEX* v2, ALLEGRO_VERTEX* v3)
 {
-   /*
-   ALLEGRO_VERTEX copy_v1, copy_v2; <- may be needed for clipping later on
-   */
-   ALLEGRO_VERTEX* vtx1 = v1;
-   ALLEGRO_VERTEX* vtx2 = v2;
-   ALLEGRO_VERTEX* vtx3 = v3;
-   ALLEGRO_BITMAP *target = al_get_target_bitmap();
-   int need_unlock = 0;
-   ALLEGRO_LOCKED_REGION *lr;
-   int min_x, max_x, min_y, max_y;
-   int clip_min_x, clip_min_y, clip_max_x, clip_max_y;
+   INIT_PREAMBLE
 
-   al_get_clipping_rectangle(&clip_min_x, &clip_min_y, &clip_max_x, &clip_max_y);
-   clip_max_x += clip_min_x;
-   clip_max_y += clip_min_y;
+   state_perspective* s = (state_perspective*)state;
+   const float q1 = ((persp_vertex *)v1)->q;
+   const float q2 = ((persp_vertex *)v2)->q;
+   const float q3 = ((persp_vertex *)v3)->q;
 
-   /*
-   TODO: Need to clip them first, make a copy of the vertices first then
-   */
+   s->off_x = v1->x - 0.5f;
+   s->off_y = v1->y + 0.5f;
 
-   /*
-   Lock the region we are drawing to. We are choosing the minimum and maximum
-   possible pixels touched from the formula (easily verified by following the
-   above algorithm.
-   */
+   memset(&s->z, 0, sizeof(plane_eq) * 8);
+   if (det_u == 0.0f)
+      return;
 
-   min_x = (int)floorf(MIN(vtx1->x, MIN(vtx2->x, vtx3->x))) - 1;
-   min_y = (int)floorf(MIN(vtx1->y, MIN(vtx2->y, vtx3->y))) - 1;
-   max_x = (int)ceilf(MAX(vtx1->x, MAX(vtx2->x, vtx3->x))) + 1;
-   max_y = (int)ceilf(MAX(vtx1->y, MAX(vtx2->y, vtx3->y))) + 1;
+   SET_PLANE(z, v1->z, v2->z, v3->z);
+   SET_PLANE(q, q1, q2, q3);
+   if (s->texture) {
+      SET_PLANE(u, v1->u * q1, v2->u * q2, v3->u * q3);
+      SET_PLANE(v, v1->v * q1, v2->v * q2, v3->v * q3);
+   }
+   if (s->grad) {
+      SET_PLANE(r, v1->color.r * q1, v2->color.r * q2, v3->color.r * q3);
+      SET_PLANE(g, v1->color.g * q1, v2->color.g * q2, v3->color.g * q3);
+      SET_PLANE(b, v1->color.b * q1, v2->color.b * q2, v3->color.b * q3);
+      SET_PLANE(a, v1->color.a * q1, v2->color.a * q2, v3->color.a * q3);
+   }
+}
 
-   /*
-   TODO: This bit is temporary, the min max's will be guaranteed to be within the bitmap
-   once clipping is implemented
-   */
-   if (min_x >= clip_max_x || min_y >= clip_max_y)
+#undef SET_PLANE
+
+#define PLANE_AT(p, x, y)  ((p).dx * (x) + (p).dy * (y) + (p).c)
+
+/* Tests the n pixels of a span against the depth buffer, updating it where
+ * they pass if the write mask allows. Returns how many passed, their indices
+ * are stored in pass.
+ */
+#define DEPTH_TEST_SPAN(type, convert)                                        \
+   do {                                                                       \
+      type *buf = (type *)depth_row;                                          \
+      switch (s->depth_function) {                                            \
+         case ALLEGRO_RENDER_NEVER:                                           \
+            break;                                                            \
+         case ALLEGRO_RENDER_ALWAYS:                                          \
+            DEPTH_TEST_LOOP(type, convert, true);                             \
+            break;                                                            \
+         case ALLEGRO_RENDER_LESS:                                            \
+            DEPTH_TEST_LOOP(type, convert, d < buf[i]);                       \
+            break;                                                            \
+         case ALLEGRO_RENDER_EQUAL:                                           \
+            DEPTH_TEST_LOOP(type, convert, d == buf[i]);                      \
+            break;                                                            \
+         case ALLEGRO_RENDER_LESS_EQUAL:                                      \
+            DEPTH_TEST_LOOP(type, convert, d <= buf[i]);                      \
+            break;                                                            \
+         case ALLEGRO_RENDER_GREATER:                                         \
+            DEPTH_TEST_LOOP(type, convert, d > buf[i]);                       \
+            break;                                                            \
+         case ALLEGRO_RENDER_NOT_EQUAL:                                       \
+            DEPTH_TEST_LOOP(type, convert, d != buf[i]);                      \
+            break;                                                            \
+         case ALLEGRO_RENDER_GREATER_EQUAL:                                    \
+            DEPTH_TEST_LOOP(type, convert, d >= buf[i]);                      \
+            break;                                                            \
+      }                                                                       \
+   } while (0)
+
+#define DEPTH_TEST_LOOP(type, convert, test)                                  \
+   do {                                                                       \
+      for (i = 0; i < n; i++) {                                               \
+         const type d = convert(z + dz * i);                                  \
+         if (test) {                                                          \
+            if (write)                                                        \
+               buf[i] = d;                                                    \
+            pass[m++] = i;                                                    \
+         }                                                                    \
+      }                                                                       \
+   } while (0)
+
+#define DEPTH_FLOAT(z)  (z)
+
+static int depth_test_span(const state_perspective *s, void *depth_row,
+   float z, float dz, int n, uint8_t *pass)
+{
+   const bool write = (s->write_mask & ALLEGRO_MASK_DEPTH) != 0;
+   int i, m = 0;
+
+   if (s->depth16)
+      DEPTH_TEST_SPAN(uint16_t, _al_depth_to_16);
+   else
+      DEPTH_TEST_SPAN(float, DEPTH_FLOAT);
+   return m;
+}
+
+#undef DEPTH_TEST_SPAN
+#undef DEPTH_TEST_LOOP
+#undef DEPTH_FLOAT
+
+/* Wraps a texture coordinate into [0, size). */
+static _AL_ALWAYS_INLINE float wrap_coordinate(float t, int size)
+{
+   t = fmodf(t, (float)size);
+   if (t < 0)
+      t += size;
+   /* Also catches NaN. */
+   if (!(t < size))
+      t = 0;
+   return t;
+}
+
+/* Computes the colors of the m pixels of a span listed in pass, x and y
+ * being the pixel center of the first one relative to the first vertex.
+ */
+static void shade_span(const state_perspective *s, float x, float y,
+   const uint8_t *pass, int m, ALLEGRO_COLOR *colors)
+{
+   const float q0 = PLANE_AT(s->q, x, y);
+   const float r0 = PLANE_AT(s->r, x, y);
+   const float g0 = PLANE_AT(s->g, x, y);
+   const float b0 = PLANE_AT(s->b, x, y);
+   const float a0 = PLANE_AT(s->a, x, y);
+   const float u0 = PLANE_AT(s->u, x, y);
+   const float v0 = PLANE_AT(s->v, x, y);
+   ALLEGRO_BITMAP *texture = NULL;
+   const uint8_t *tex_data = NULL;
+   int tex_format = 0, tex_size = 0, tex_pitch = 0;
+   int uu_ofs = 0, vv_ofs = 0;
+   int k;
+
+   if (s->texture) {
+      texture = s->texture->parent ? s->texture->parent : s->texture;
+      tex_format = texture->locked_region.format;
+      tex_size = texture->locked_region.pixel_size;
+      tex_pitch = texture->locked_region.pitch;
+      tex_data = texture->lock_data;
+      uu_ofs = (s->texture->parent ? s->texture->xofs : 0) - texture->lock_x;
+      vv_ofs = (s->texture->parent ? s->texture->yofs : 0) - texture->lock_y;
+   }
+
+   for (k = 0; k < m; k++) {
+      const int i = pass[k];
+      const float inv_q = 1.0f / (q0 + s->q.dx * i);
+      ALLEGRO_COLOR color;
+
+      if (s->grad) {
+         color.r = (r0 + s->r.dx * i) * inv_q;
+         color.g = (g0 + s->g.dx * i) * inv_q;
+         color.b = (b0 + s->b.dx * i) * inv_q;
+         color.a = (a0 + s->a.dx * i) * inv_q;
+      }
+      else {
+         color = s->color;
+      }
+
+      if (texture) {
+         const float u = wrap_coordinate((u0 + s->u.dx * i) * inv_q, s->w);
+         const float v = wrap_coordinate((v0 + s->v.dx * i) * inv_q, s->h);
+         ALLEGRO_COLOR texel;
+
+         if (s->linear) {
+            int x0, x1, fx, y0, y1, fy;
+            const uint8_t *row0, *row1;
+            linear_texel(al_ftofix(u), s->w, &x0, &x1, &fx);
+            linear_texel(al_ftofix(v), s->h, &y0, &y1, &fy);
+            row0 = tex_data + (y0 + vv_ofs) * tex_pitch;
+            row1 = tex_data + (y1 + vv_ofs) * tex_pitch;
+            LINEAR_TEXEL_COLOR(tex_format, tex_size, (uint8_t *)row0,
+               (uint8_t *)row1, x0 + uu_ofs, x1 + uu_ofs, fx, fy, texel);
+         }
+         else {
+            uint8_t *p = (uint8_t *)tex_data + ((int)v + vv_ofs) * tex_pitch
+               + ((int)u + uu_ofs) * tex_size;
+            _AL_INLINE_GET_PIXEL(tex_format, p, texel, false);
+         }
+         SHADE_COLORS(texel, color);
+         color = texel;
+      }
+
+      colors[k] = color;
+   }
+}
+
+/* Keeps the channels of dst the write mask excludes from src. */
+static _AL_ALWAYS_INLINE void mask_color(int mask, ALLEGRO_COLOR *src,
+   const ALLEGRO_COLOR *dst)
+{
+   if (!(mask & ALLEGRO_MASK_RED))
+      src->r = dst->r;
+   if (!(mask & ALLEGRO_MASK_GREEN))
+      src->g = dst->g;
+   if (!(mask & ALLEGRO_MASK_BLUE))
+      src->b = dst->b;
+   if (!(mask & ALLEGRO_MASK_ALPHA))
+      src->a = dst->a;
+}
+
+static void shader_perspective_draw(uintptr_t state, int x1, int y, int x2)
+{
+   state_perspective *s = (state_perspective *)state;
+   ALLEGRO_BITMAP *target = s->target;
+   const int color_mask = s->write_mask & ALLEGRO_MASK_RGBA;
+   const float cur_y = (float)y - s->off_y;
+   ALLEGRO_COLOR src_span[_AL_BLEND_SPAN_SIZE];
+   ALLEGRO_COLOR dst_span[_AL_BLEND_SPAN_SIZE];
+   uint8_t pass[_AL_BLEND_SPAN_SIZE];
+   int xofs = 0, yofs = 0;
+   int dst_format, dst_size;
+   uint8_t *dst_row;
+   float cur_x;
+   int x, i;
+
+   if (target->parent) {
+      xofs = target->xofs;
+      yofs = target->yofs;
+      target = target->parent;
+   }
+
+   x1 += xofs - target->lock_x;
+   x2 += xofs - target->lock_x;
+   y += yofs - target->lock_y;
+   y--;
+
+   if (y < 0 || y >= target->lock_h) {
       return;
-   if (max_x >= clip_max_x)
-      max_x = clip_max_x;
-   if (max_y >= clip_max_y)
-      max_y = clip_max_y;
+   }
+   if (x1 < 0) {
+      x1 = 0;
+   }
+   if (x2 > target->lock_w - 1) {
+      x2 = target->lock_w - 1;
+   }
 
-   if (max_x < clip_min_x || max_y < clip_min_y)
+   /* The pixel center of the first pixel, see shader_grad_any_first. */
+   cur_x = (float)(x1 + target->lock_x - xofs) - s->off_x;
+
+   dst_format = target->locked_region.format;
+   dst_size = target->locked_region.pixel_size;
+   dst_row = (uint8_t *)target->lock_data + y * target->locked_region.pitch;
+
+   for (x = x1; x <= x2; x += _AL_BLEND_SPAN_SIZE) {
+      const int n = _ALLEGRO_MIN(x2 - x + 1, _AL_BLEND_SPAN_SIZE);
+      const float span_x = cur_x + (x - x1);
+      int m;
+
+      if (s->depth_test) {
+         const int depth_size = s->depth16 ? 2 : 4;
+         uint8_t *depth_row = (uint8_t *)target->depth_buffer + depth_size *
+            ((y + target->lock_y) * target->w + x + target->lock_x);
+         m = depth_test_span(s, depth_row, PLANE_AT(s->z, span_x, cur_y),
+            s->z.dx, n, pass);
+      }
+      else {
+         for (i = 0; i < n; i++)
+            pass[i] = i;
+         m = n;
+      }
+
+      /* Nothing of this span is visible. */
+      if (m == 0 || color_mask == 0)
+         continue;
+
+      shade_span(s, span_x, cur_y, pass, m, src_span);
+
+      if (s->shade || color_mask != ALLEGRO_MASK_RGBA) {
+         for (i = 0; i < m; i++) {
+            uint8_t *p = dst_row + (x + pass[i]) * dst_size;
+            _AL_INLINE_GET_PIXEL(dst_format, p, dst_span[i], false);
+         }
+      }
+
+      if (s->shade) {
+         ALLEGRO_COLOR old_span[_AL_BLEND_SPAN_SIZE];
+         if (color_mask != ALLEGRO_MASK_RGBA)
+            memcpy(old_span, dst_span, m * sizeof(ALLEGRO_COLOR));
+         _al_get_compiled_blender()->span.blend(
+            &_al_get_compiled_blender()->span, src_span, dst_span, m);
+         for (i = 0; i < m; i++) {
+            uint8_t *p = dst_row + (x + pass[i]) * dst_size;
+            if (color_mask != ALLEGRO_MASK_RGBA)
+               mask_color(color_mask, &dst_span[i], &old_span[i]);
+            _AL_INLINE_PUT_PIXEL(dst_format, p, dst_span[i], false);
+         }
+      }
+      else {
+         for (i = 0; i < m; i++) {
+            uint8_t *p = dst_row + (x + pass[i]) * dst_size;
+            if (color_mask != ALLEGRO_MASK_RGBA)
+               mask_color(color_mask, &src_span[i], &dst_span[i]);
+            _AL_INLINE_PUT_PIXEL(dst_format, p, src_span[i], false);
+         }
+      }
+   }
+}
+
+#undef PLANE_AT
+
+/* The planes the homogeneous coordinates x, y, z, w of what is drawn have to
+ * be on the positive side of: the near and far planes and, for x and y, the
+ * guard band around the target, see GUARD_BAND. The w coefficients of the
+ * latter depend on the size of the target, see clip_planes.
+ */
+static void clip_planes(ALLEGRO_BITMAP *target, float planes[6][4])
+{
+   const float gx = 1.0f + 2.0f * GUARD_BAND / target->w;
+   const float gy = 1.0f + 2.0f * GUARD_BAND / target->h;
+   const float p[6][4] = {
+      { 0,  0,  1, 1},
+      { 0,  0, -1, 1},
+      { 1,  0,  0, gx},
+      {-1,  0,  0, gx},
+      { 0,  1,  0, gy},
+      { 0, -1,  0, gy}
+   };
+   memcpy(planes, p, sizeof(p));
+}
+
+static _AL_ALWAYS_INLINE float plane_distance(const float plane[4],
+   const _AL_CLIP_VERTEX *c)
+{
+   return plane[0] * c->x + plane[1] * c->y + plane[2] * c->z + plane[3] * c->w;
+}
+
+static void lerp_clip_vertex(_AL_CLIP_VERTEX *out, const _AL_CLIP_VERTEX *a,
+   const _AL_CLIP_VERTEX *b, float t)
+{
+   out->x = a->x + (b->x - a->x) * t;
+   out->y = a->y + (b->y - a->y) * t;
+   out->z = a->z + (b->z - a->z) * t;
+   out->w = a->w + (b->w - a->w) * t;
+   out->u = a->u + (b->u - a->u) * t;
+   out->v = a->v + (b->v - a->v) * t;
+   out->color.r = a->color.r + (b->color.r - a->color.r) * t;
+   out->color.g = a->color.g + (b->color.g - a->color.g) * t;
+   out->color.b = a->color.b + (b->color.b - a->color.b) * t;
+   out->color.a = a->color.a + (b->color.a - a->color.a) * t;
+}
+
+/* Like clip_polygon, for a plane in homogeneous coordinates. */
+static int clip_polygon_3d(const _AL_CLIP_VERTEX *in, int n,
+   _AL_CLIP_VERTEX *out, const float plane[4])
+{
+   int i, m = 0;
+
+   for (i = 0; i < n; i++) {
+      const _AL_CLIP_VERTEX *a = &in[i];
+      const _AL_CLIP_VERTEX *b = &in[(i + 1) % n];
+      const float da = plane_distance(plane, a);
+      const float db = plane_distance(plane, b);
+
+      if (da >= 0)
+         out[m++] = *a;
+      if ((da >= 0) != (db >= 0))
+         lerp_clip_vertex(&out[m++], a, b, da / (da - db));
+   }
+
+   return m;
+}
+
+/* Divides by w and maps the result to the pixels of the target. Returns
+ * false if the vertex is not in front of the viewer.
+ */
+static bool project_vertex(ALLEGRO_BITMAP *target, const _AL_CLIP_VERTEX *c,
+   persp_vertex *p)
+{
+   if (!(c->w > 0))
+      return false;
+
+   p->q = 1.0f / c->w;
+   p->v.x = (c->x * p->q + 1.0f) * 0.5f * target->w;
+   p->v.y = (1.0f - c->y * p->q) * 0.5f * target->h;
+   p->v.z = _ALLEGRO_CLAMP(0.0f, (c->z * p->q + 1.0f) * 0.5f, 1.0f);
+   p->v.u = c->u;
+   p->v.v = c->v;
+   p->v.color = c->color;
+   return true;
+}
+
+/* Internal function: _al_use_soft_3d
+ *  Returns whether primitives drawn to the memory bitmap target have to be
+ *  projected with _al_triangle_3d and friends, because it has a projection
+ *  transform other than the default one or the depth test is enabled for
+ *  its depth buffer. Otherwise the 2D routines draw the same.
+ */
+bool _al_use_soft_3d(ALLEGRO_BITMAP *target)
+{
+   ALLEGRO_BITMAP *parent = target->parent ? target->parent : target;
+
+   if (!(al_get_bitmap_flags(target) & ALLEGRO_MEMORY_BITMAP))
+      return false;
+   if (target->custom_proj_transform)
+      return true;
+   return parent->depth_buffer && _al_get_render_state()->depth_test;
+}
+
+/* Internal function: _al_get_clip_transform
+ *  Combines the transform and the projection transform of target, which
+ *  _al_clip_vertex applies.
+ */
+void _al_get_clip_transform(ALLEGRO_BITMAP *target, ALLEGRO_TRANSFORM *trans)
+{
+   al_copy_transform(trans, &target->transform);
+   al_compose_transform(trans, &target->proj_transform);
+}
+
+/* Internal function: _al_clip_vertex
+ */
+void _al_clip_vertex(const ALLEGRO_TRANSFORM *trans, const ALLEGRO_VERTEX *in,
+   _AL_CLIP_VERTEX *out)
+{
+   const float x = in->x, y = in->y, z = in->z;
+
+   out->x = trans->m[0][0] * x + trans->m[1][0] * y + trans->m[2][0] * z + trans->m[3][0];
+   out->y = trans->m[0][1] * x + trans->m[1][1] * y + trans->m[2][1] * z + trans->m[3][1];
+   out->z = trans->m[0][2] * x + trans->m[1][2] * y + trans->m[2][2] * z + trans->m[3][2];
+   out->w = trans->m[0][3] * x + trans->m[1][3] * y + trans->m[2][3] * z + trans->m[3][3];
+   out->u = in->u;
+   out->v = in->v;
+   out->color = in->color;
+}
+
+/* Internal function: _al_triangle_3d
+ *  Draws a triangle given by vertices from _al_clip_vertex to the target
+ *  bitmap, testing it against the depth buffer of the target as the render
+ *  state says. Attributes are interpolated perspective correctly. Like with
+ *  _al_triangle_2d, the texture must be locked by the caller.
+ */
+void _al_triangle_3d(ALLEGRO_BITMAP *texture, const _AL_CLIP_VERTEX *v1,
+   const _AL_CLIP_VERTEX *v2, const _AL_CLIP_VERTEX *v3)
+{
+   ALLEGRO_BITMAP *target = al_get_target_bitmap();
+   ALLEGRO_BITMAP *parent = target->parent ? target->parent : target;
+   const _ALLEGRO_RENDER_STATE *render_state = _al_get_render_state();
+   _AL_CLIP_VERTEX a[MAX_CLIPPED_VERTICES_3D], b[MAX_CLIPPED_VERTICES_3D];
+   persp_vertex p[MAX_CLIPPED_VERTICES_3D];
+   float planes[6][4];
+   state_perspective state;
+   float min_x, min_y, max_x, max_y;
+   int x, y, w, h, i, j, n;
+   int need_unlock;
+
+   state.target = target;
+   state.write_mask = render_state->write_mask;
+   state.depth_test = render_state->depth_test && parent->depth_buffer;
+   state.depth_function = render_state->depth_function;
+   state.depth16 = al_get_bitmap_depth(parent) <= 16;
+
+   /* Nothing would be written. */
+   if (!(state.write_mask & ALLEGRO_MASK_RGBA) &&
+         !(state.depth_test && (state.write_mask & ALLEGRO_MASK_DEPTH)))
       return;
-   if (min_x < clip_min_x)
-      min_x = clip_min_x;
-   if (min_y < clip_min_y)
-      min_y = clip_min_y;
 
-   if (al_is_bitmap_locked(target)) {
-      if (!bitmap_region_is_locked(target, min_x, min_y, max_x - min_x, max_y - min_y) ||
-          _al_pixel_format_is_video_only(target->locked_region.format))
-         return;
-   } else {
-      if (!(lr = al_lock_bitmap_region(target, min_x, min_y, max_x - min_x, max_y - min_y, ALLEGRO_PIXEL_FORMAT_ANY, 0)))
+   a[0] = *v1;
+   a[1] = *v2;
+   a[2] = *v3;
+   n = 3;
+   clip_planes(target, planes);
+   for (j = 0; j < 6; j++) {
+      if (plane_distance(planes[j], &a[0]) < 0 ||
+            plane_distance(planes[j], &a[1]) < 0 ||
+            plane_distance(planes[j], &a[2]) < 0)
+         break;
+   }
+   for (; j < 6 && n >= 3; j++) {
+      n = clip_polygon_3d(a, n, b, planes[j]);
+      memcpy(a, b, n * sizeof(*a));
+   }
+   if (n < 3)
+      return;
+
+   for (i = 0; i < n; i++) {
+      if (!project_vertex(target, &a[i], &p[i]))
          return;
-      need_unlock = 1;
    }
 
-   triangle_stepper(state, init, first, step, draw, v1, v2, v3);
+   min_x = max_x = p[0].v.x;
+   min_y = max_y = p[0].v.y;
+   for (i = 1; i < n; i++) {
+      min_x = MIN(min_x, p[i].v.x);
+      max_x = MAX(max_x, p[i].v.x);
+      min_y = MIN(min_y, p[i].v.y);
+      max_y = MAX(max_y, p[i].v.y);
+   }
+   if (!clip_target_rect((int)floorf(min_x) - 1, (int)floorf(min_y) - 1,
+         (int)ceilf(max_x) + 1, (int)ceilf(max_y) + 1, &x, &y, &w, &h))
+      return;
+   if (!lock_triangle_target(target, x, y, w, h, &need_unlock))
+      return;
+
+   state.texture = texture;
+   if (texture) {
+      state.w = al_get_bitmap_width(texture);
+      state.h = al_get_bitmap_height(texture);
+      state.linear = texture_is_linear(texture, &p[0].v, &p[1].v, &p[2].v);
+   }
+   state.shade = !(_al_get_compiled_blender()->flags & _AL_BLEND_COPY);
+   state.color = v1->color;
+   state.grad = false;
+   for (i = 1; i < n; i++) {
+      if (memcmp(&p[i].v.color, &state.color, sizeof(ALLEGRO_COLOR)) != 0)
+         state.grad = true;
+   }
+
+   for (i = 1; i + 1 < n; i++) {
+      triangle_stepper((uintptr_t)&state, shader_perspective_init,
+         shader_solid_any_first, shader_solid_any_step, shader_perspective_draw,
+         &p[0].v, &p[i].v, &p[i + 1].v, target_end_row(target));
+   }
+
+   if (need_unlock)
+      al_unlock_bitmap(target);
+}
+
+/* Clips the segment from t0 to t1 of the line from a to b to the planes of
+ * _al_triangle_3d. Returns false if nothing is left.
+ */
+static bool clip_line_3d(const float planes[6][4], const _AL_CLIP_VERTEX *a,
+   const _AL_CLIP_VERTEX *b, float *t0, float *t1)
+{
+   int j;
+
+   *t0 = 0;
+   *t1 = 1;
+   for (j = 0; j < 6; j++) {
+      const float da = plane_distance(planes[j], a);
+      const float db = plane_distance(planes[j], b);
+      if (da < 0 && db < 0)
+         return false;
+      if (da < 0)
+         *t0 = MAX(*t0, da / (da - db));
+      else if (db < 0)
+         *t1 = MIN(*t1, da / (da - db));
+   }
+   return *t0 <= *t1;
+}
+
+/* Internal function: _al_project_line_3d
+ *  Clips a line given by vertices from _al_clip_vertex like _al_triangle_3d
+ *  does and maps it to the pixels of the target bitmap, which it can then be
+ *  drawn to as a 2D line. Returns false if nothing of it is left.
+ */
+bool _al_project_line_3d(const _AL_CLIP_VERTEX *v1, const _AL_CLIP_VERTEX *v2,
+   ALLEGRO_VERTEX *out1, ALLEGRO_VERTEX *out2)
+{
+   ALLEGRO_BITMAP *target = al_get_target_bitmap();
+   float planes[6][4];
+   _AL_CLIP_VERTEX a, b;
+   persp_vertex p1, p2;
+   float t0, t1;
+
+   clip_planes(target, planes);
+   if (!clip_line_3d(planes, v1, v2, &t0, &t1))
+      return false;
+   lerp_clip_vertex(&a, v1, v2, t0);
+   lerp_clip_vertex(&b, v1, v2, t1);
+   if (!project_vertex(target, &a, &p1) || !project_vertex(target, &b, &p2))
+      return false;
+   *out1 = p1.v;
+   *out2 = p2.v;
+   return true;
+}
+
+/* Internal function: _al_project_point_3d
+ *  Like _al_project_line_3d, for a point.
+ */
+bool _al_project_point_3d(const _AL_CLIP_VERTEX *v, ALLEGRO_VERTEX *out)
+{
+   ALLEGRO_BITMAP *target = al_get_target_bitmap();
+   float planes[6][4];
+   persp_vertex p;
+   int j;
+
+   clip_planes(target, planes);
+   for (j = 0; j < 6; j++) {
+      if (plane_distance(planes[j], v) < 0)
+         return false;
+   }
+   if (!project_vertex(target, v, &p))
+      return false;
+   *out = p.v;
+   return true;
+}
+
+void _al_draw_soft_triangle(
+   ALLEGRO_VERTEX* v1, ALLEGRO_VERTEX* v2, ALLEGRO_VERTEX* v3, uintptr_t state,
+   void (*init)(uintptr_t, ALLEGRO_VERTEX*, ALLEGRO_VERTEX*, ALLEGRO_VERTEX*),
+   void (*first)(uintptr_t, int, int, int, int),
+   void (*step)(uintptr_t, int),
+   void (*draw)(uintptr_t, int, int, int))
+{
+   ALLEGRO_BITMAP *target = al_get_target_bitmap();
+   int x, y, w, h;
+   int need_unlock;
+
+   if (!triangle_target_rect(v1, v2, v3, &x, &y, &w, &h))
+      return;
+
+   if (!lock_triangle_target(target, x, y, w, h, &need_unlock))
+      return;
+
+   draw_triangle(target, state, init, first, step, draw, v1, v2, v3);
 
    if (need_unlock)
       al_unlock_bitmap(target);
@@ -0,0 +1,450 @@
+/*         ______   ___    ___
+ *        /\  _  \ /\_ \  /\_ \
+ *        \ \ \L\ \\//\ \ \//\ \      __     __   _ __   ___
+ *         \ \  __ \ \ \ \  \ \ \   /'__`\ /'_ `\/\`'__\/ __`\
+ *          \ \ \/\ \ \_\ \_ \_\ \_/\  __//\ \L\ \ \ \//\ \L\ \
+ *           \ \_\ \_\/\____\/\____\ \____\ \____ \ \_\\ \____/
+ *            \/_/\/_/\/____/\/____/\/____/\/___L\ \/_/ \/___/
+ *                                           /\____/
+ *                                           \_/__/
+ *
+ *      Tiled software rasterizer for triangles drawn to memory bitmaps.
+ *
+ *      Triangles are queued up instead of being drawn right away, then
+ *      binned into bands of rows which the worker pool draws in parallel.
+ *      Each band is drawn by one thread, with the triangles in the order
+ *      they were queued, so the results are the same as drawing them one
+ *      after another.
+ *
+ *      See LICENSE.txt for copyright information.
+ */
+
+
+#include <string.h>
+
+#include "allegro5/allegro.h"
+#include "allegro5/internal/aintern.h"
+#include "allegro5/internal/aintern_bitmap.h"
+#include "allegro5/internal/aintern_blend.h"
+#include "allegro5/internal/aintern_exitfunc.h"
+#include "allegro5/internal/aintern_memblit.h"
+#include "allegro5/internal/aintern_parallel.h"
+#include "allegro5/internal/aintern_pixels.h"
+#include "allegro5/internal/aintern_thread.h"
+#include "allegro5/internal/aintern_tri_soft.h"
+#include "allegro5/internal/aintern_vector.h"
+
+ALLEGRO_DEBUG_CHANNEL("tri_soft")
+
+
+/* The queue is flushed once this many triangles are pending. */
+#define MAX_QUEUED_TRIANGLES  16384
+
+/* The minimum number of rows in a band. */
+#define MIN_BAND_ROWS         16
+
+
+typedef struct TILED_TRIANGLE
+{
+   ALLEGRO_VERTEX v[3];
+   ALLEGRO_BITMAP *texture;
+   /* Index into queue_blenders. */
+   int blender;
+   /* The part of the target the triangle may touch, relative to the
+    * parent of a sub-bitmap.
+    */
+   int x, y, w, h;
+} TILED_TRIANGLE;
+
+
+static int num_threads = 0;
+
+/* Protects the queue. It is held during a flush, so that nobody gets to
+ * touch the queued bitmaps while the workers draw to them.
+ */
+static _AL_MUTEX queue_mutex = _AL_MUTEX_UNINITED;
+static ALLEGRO_BITMAP *queue_target = NULL;
+static _AL_VECTOR queue = _AL_VECTOR_INITIALIZER(TILED_TRIANGLE);
+static _AL_VECTOR queue_textures = _AL_VECTOR_INITIALIZER(ALLEGRO_BITMAP *);
+static _AL_VECTOR queue_blenders = _AL_VECTOR_INITIALIZER(_AL_COMPILED_BLENDER);
+
+/* The number of rows in each band of the flush in progress. */
+static int job_band_rows = 0;
+
+/* The triangles touching band i are bin_tris[bin_start[i]] up to
+ * bin_tris[bin_start[i + 1]], in the order they were queued.
+ */
+static int *bin_start = NULL;
+static int bin_start_size = 0;
+static int *bin_tris = NULL;
+static int bin_tris_size = 0;
+
+
+static ALLEGRO_BITMAP *root_bitmap(ALLEGRO_BITMAP *bitmap)
+{
+   return bitmap->parent ? bitmap->parent : bitmap;
+}
+
+
+/* Makes a copy of a memory bitmap which looks like it is locked, without
+ * actually locking the bitmap. The workers draw to and from these.
+ */
+static void init_view(ALLEGRO_BITMAP *view, ALLEGRO_BITMAP *bitmap)
+{
+   int format = al_get_bitmap_format(bitmap);
+
+   *view = *bitmap;
+   view->parent = NULL;
+   view->locked = true;
+   view->lock_flags = 0;
+   view->locked_region.format = format;
+   view->locked_region.pitch = bitmap->pitch;
+   view->locked_region.pixel_size = al_get_pixel_size(format);
+}
+
+
+static void set_view_rect(ALLEGRO_BITMAP *view, int x, int y, int w, int h)
+{
+   view->lock_x = x;
+   view->lock_y = y;
+   view->lock_w = w;
+   view->lock_h = h;
+   view->lock_data = view->memory + y * view->pitch
+      + x * view->locked_region.pixel_size;
+   view->locked_region.data = view->lock_data;
+}
+
+
+static void draw_band(int band, void *arg)
+{
+   ALLEGRO_BITMAP *parent = root_bitmap(queue_target);
+   ALLEGRO_BITMAP dst_view, dst_sub;
+   ALLEGRO_BITMAP src_view, src_sub;
+   ALLEGRO_BITMAP *dst = &dst_view;
+   ALLEGRO_BITMAP *src = NULL;
+   ALLEGRO_BITMAP *texture = NULL;
+   int blender = -1;
+   int y1 = band * job_band_rows;
+   int y2 = _ALLEGRO_MIN(y1 + job_band_rows, parent->h);
+   int i;
+
+   init_view(&dst_view, parent);
+   if (queue_target->parent) {
+      dst_sub = *queue_target;
+      dst_sub.parent = &dst_view;
+      dst = &dst_sub;
+   }
+
+   for (i = bin_start[band]; i < bin_start[band + 1]; i++) {
+      TILED_TRIANGLE *t = _al_vector_ref(&queue, bin_tris[i]);
+      int ty1 = _ALLEGRO_MAX(t->y, y1);
+      int ty2 = _ALLEGRO_MIN(t->y + t->h, y2);
+
+      if (t->texture != texture) {
+         texture = t->texture;
+         src = NULL;
+         if (texture) {
+            ALLEGRO_BITMAP *tex_parent = root_bitmap(texture);
+            init_view(&src_view, tex_parent);
+            set_view_rect(&src_view, 0, 0, tex_parent->w, tex_parent->h);
+            src = &src_view;
+            if (texture->parent) {
+               src_sub = *texture;
+               src_sub.parent = &src_view;
+               src = &src_sub;
+            }
+         }
+      }
+
+      set_view_rect(&dst_view, t->x, ty1, t->w, ty2 - ty1);
+      if (t->blender != blender) {
+         blender = t->blender;
+         _al_set_compiled_blender(_al_vector_ref(&queue_blenders, blender));
+      }
+
+      _al_triangle_2d_locked(dst, src, &t->v[0], &t->v[1], &t->v[2]);
+   }
+
+   (void)arg;
+}
+
+
+/* Sorts the queued triangles into the bands they touch. */
+static void bin_triangles(int num_bands)
+{
+   int n = _al_vector_size(&queue);
+   int total = 0;
+   int i, band;
+
+   if (bin_start_size < num_bands + 1) {
+      bin_start_size = num_bands + 1;
+      bin_start = al_realloc(bin_start, bin_start_size * sizeof(int));
+   }
+   memset(bin_start, 0, (num_bands + 1) * sizeof(int));
+
+   for (i = 0; i < n; i++) {
+      TILED_TRIANGLE *t = _al_vector_ref(&queue, i);
+      int b1 = t->y / job_band_rows;
+      int b2 = (t->y + t->h - 1) / job_band_rows;
+      for (band = b1; band <= b2; band++)
+         bin_start[band + 1]++;
+      total += b2 - b1 + 1;
+   }
+   for (band = 0; band < num_bands; band++)
+      bin_start[band + 1] += bin_start[band];
+
+   if (bin_tris_size < total) {
+      bin_tris_size = total;
+      bin_tris = al_realloc(bin_tris, bin_tris_size * sizeof(int));
+   }
+
+   /* Fill the bins using their starts as the write positions, which leaves
+    * each one at the start of the next bin.
+    */
+   for (i = 0; i < n; i++) {
+      TILED_TRIANGLE *t = _al_vector_ref(&queue, i);
+      int b1 = t->y / job_band_rows;
+      int b2 = (t->y + t->h - 1) / job_band_rows;
+      for (band = b1; band <= b2; band++)
+         bin_tris[bin_start[band]++] = i;
+   }
+   for (band = num_bands; band > 0; band--)
+      bin_start[band] = bin_start[band - 1];
+   bin_start[0] = 0;
+}
+
+
+/* Draws the queued triangles. Must be called with queue_mutex held. */
+static void flush_queue(void)
+{
+   ALLEGRO_BITMAP *parent;
+   _AL_COMPILED_BLENDER saved;
+   int h, num_bands;
+
+   if (_al_vector_is_empty(&queue)) {
+      queue_target = NULL;
+      return;
+   }
+
+   parent = root_bitmap(queue_target);
+   h = parent->h;
+   job_band_rows = _ALLEGRO_MAX(MIN_BAND_ROWS,
+      (h + 4 * num_threads - 1) / (4 * num_threads));
+   num_bands = (h + job_band_rows - 1) / job_band_rows;
+   bin_triangles(num_bands);
+
+   /* The blender of each triangle is set by the thread drawing it, and this
+    * thread draws bands as well.
+    */
+   saved = *_al_get_compiled_blender();
+
+   _al_parallel_for(num_bands, num_threads, draw_band, NULL);
+
+   _al_set_compiled_blender(&saved);
+
+   _al_vector_free(&queue);
+   _al_vector_free(&queue_textures);
+   _al_vector_free(&queue_blenders);
+   queue_target = NULL;
+}
+
+
+static bool can_queue_bitmap(ALLEGRO_BITMAP *bitmap)
+{
+   ALLEGRO_BITMAP *parent = root_bitmap(bitmap);
+
+   return (al_get_bitmap_flags(parent) & ALLEGRO_MEMORY_BITMAP) &&
+      !_al_pixel_format_is_compressed(al_get_bitmap_format(parent));
+}
+
+
+/* Returns the index of the current blender in queue_blenders, adding it if
+ * it differs from the last one.
+ */
+static int queue_blender(void)
+{
+   const _AL_COMPILED_BLENDER *blender = _al_get_compiled_blender();
+   const unsigned int n = _al_vector_size(&queue_blenders);
+   _AL_COMPILED_BLENDER *queued;
+
+   if (n > 0 && _al_is_same_blender(_al_vector_ref_back(&queue_blenders),
+         blender))
+      return n - 1;
+
+   queued = _al_vector_alloc_back(&queue_blenders);
+   *queued = *blender;
+   return n;
+}
+
+
+/* Internal function: _al_queue_tiled_triangle
+ *  Queues a triangle for the tiled rasterizer, if it is enabled and the
+ *  target is an unlocked memory bitmap. The given rectangle is the part of
+ *  the target the triangle may touch. Returns false if the triangle should
+ *  be drawn right away instead.
+ */
+bool _al_queue_tiled_triangle(ALLEGRO_BITMAP *target, ALLEGRO_BITMAP *texture,
+   ALLEGRO_VERTEX *v1, ALLEGRO_VERTEX *v2, ALLEGRO_VERTEX *v3,
+   int x, int y, int w, int h)
+{
+   TILED_TRIANGLE *t;
+   unsigned int i;
+
+   if (num_threads == 0 || !target || !can_queue_bitmap(target) ||
+         root_bitmap(target)->locked)
+      return false;
+
+   /* The texture may be locked for reading while it is drawn, but it must
+    * be the backing memory which holds its pixels.
+    */
+   if (texture) {
+      ALLEGRO_BITMAP *tex_parent = root_bitmap(texture);
+      if (!can_queue_bitmap(texture) || tex_parent == root_bitmap(target) ||
+            (tex_parent->locked &&
+            !(tex_parent->lock_flags & ALLEGRO_LOCK_READONLY)))
+         return false;
+   }
+
+   if (w <= 0 || h <= 0)
+      return true;
+
+   /* Held drawing to the target comes first. */
+   _al_flush_held_memory_blits_for(target);
+   _al_mark_bitmap_written(target, x, y, w, h);
+
+   _al_mutex_lock(&queue_mutex);
+
+   if (queue_target != target ||
+         _al_vector_size(&queue) >= MAX_QUEUED_TRIANGLES) {
+      flush_queue();
+      queue_target = target;
+   }
+
+   t = _al_vector_alloc_back(&queue);
+   t->v[0] = *v1;
+   t->v[1] = *v2;
+   t->v[2] = *v3;
+   t->texture = texture;
+   t->blender = queue_blender();
+   t->x = x;
+   t->y = y;
+   t->w = w;
+   t->h = h;
+   if (target->parent) {
+      t->x += target->xofs;
+      t->y += target->yofs;
+   }
+
+   if (texture) {
+      ALLEGRO_BITMAP *tex_parent = root_bitmap(texture);
+      ALLEGRO_BITMAP **ref;
+      for (i = 0; i < _al_vector_size(&queue_textures); i++) {
+         ref = _al_vector_ref(&queue_textures, i);
+         if (*ref == tex_parent)
+            break;
+      }
+      if (i == _al_vector_size(&queue_textures)) {
+         ref = _al_vector_alloc_back(&queue_textures);
+         *ref = tex_parent;
+      }
+   }
+
+   _al_mutex_unlock(&queue_mutex);
+
+   return true;
+}
+
+
+/* Internal function: _al_flush_tiled_triangles
+ *  Draws all queued triangles.
+ */
+void _al_flush_tiled_triangles(void)
+{
+   if (num_threads == 0)
+      return;
+
+   _al_mutex_lock(&queue_mutex);
+   flush_queue();
+   _al_mutex_unlock(&queue_mutex);
+}
+
+
+/* Internal function: _al_flush_tiled_triangles_for
+ *  Draws the queued triangles if they are drawn to the bitmap, or if write
+ *  is true and they are drawn from it. Call this before the pixels of the
+ *  bitmap are accessed in some other way.
+ */
+void _al_flush_tiled_triangles_for(ALLEGRO_BITMAP *bitmap, bool write)
+{
+   ALLEGRO_BITMAP *parent;
+   unsigned int i;
+
+   if (num_threads == 0)
+      return;
+
+   parent = root_bitmap(bitmap);
+
+   _al_mutex_lock(&queue_mutex);
+   if (queue_target) {
+      if (root_bitmap(queue_target) == parent) {
+         flush_queue();
+      }
+      else if (write) {
+         for (i = 0; i < _al_vector_size(&queue_textures); i++) {
+            ALLEGRO_BITMAP **ref = _al_vector_ref(&queue_textures, i);
+            if (*ref == parent) {
+               flush_queue();
+               break;
+            }
+         }
+      }
+   }
+   _al_mutex_unlock(&queue_mutex);
+}
+
+
+static void shutdown_tiled_triangles(void)
+{
+   num_threads = 0;
+
+   _al_vector_free(&queue);
+   _al_vector_free(&queue_textures);
+   _al_vector_free(&queue_blenders);
+   queue_target = NULL;
+   al_free(bin_start);
+   bin_start = NULL;
+   bin_start_size = 0;
+   al_free(bin_tris);
+   bin_tris = NULL;
+   bin_tris_size = 0;
+
+   _al_mutex_destroy(&queue_mutex);
+}
+
+
+/* Internal function: _al_init_tiled_triangles
+ *  Enables the tiled rasterizer if the [graphics] soft_raster_threads config
+ *  key asks for more than one thread.
+ */
+void _al_init_tiled_triangles(void)
+{
+   num_threads = _al_parse_thread_count(al_get_config_value(
+      al_get_system_config(), "graphics", "soft_raster_threads"));
+
+   /* The thread doing the flush draws too, so a single thread would only
+    * add the overhead of queuing.
+    */
+   if (num_threads < 2) {
+      num_threads = 0;
+      return;
+   }
+
+   ALLEGRO_INFO("Rasterizing triangles to memory bitmaps with %d threads\n",
+      num_threads);
+
+   _al_mutex_init(&queue_mutex);
+
+   _al_add_exit_func(shutdown_tiled_triangles, "shutdown_tiled_triangles");
+}
+
+/* vim: set sts=3 sw=3 et: */
@@ -4,6 +4,8 @@
  *    By Peter Wang.
  */
 
+#define ALLEGRO_UNSTABLE
+
 #include <ctype.h>
 #include <math.h>
 #include <stdarg.h>
@@ -18,7 +20,8 @@
 #define MAX_BITMAPS  128
 #define MAX_TRANS    8
 #define MAX_FONTS    16
-#define MAX_VERTICES 100
+#define MAX_VERTICES 256
+#define MAX_POINTS   1024
 #define MAX_POLYGONS 8
 
 typedef struct {
@@ -58,10 +61,12 @@ LockRegion        lock_region;
 Transform         transforms[MAX_TRANS];
 NamedFont         fonts[MAX_FONTS];
 ALLEGRO_VERTEX    vertices[MAX_VERTICES];
+int               vertex_indices[MAX_VERTICES];
 float             simple_vertices[2 * MAX_VERTICES];
 int               num_simple_vertices;
 int               vertex_counts[MAX_POLYGONS];
 int               num_global_bitmaps;
+ALLEGRO_PATH_GEOMETRY *path_geometry;
 float             delay = 0.0;
 bool              save_outputs = false;
 bool              quiet = false;
@@ -244,6 +249,9 @@ static void set_target_reset(ALLEGRO_BITMAP *target)
    al_use_transform(&ident);
    al_orthographic_transform(&ident, 0, 0, -1, al_get_bitmap_width(target), al_get_bitmap_height(target), 1);
    al_use_projection_transform(&ident);
+   al_set_render_state(ALLEGRO_DEPTH_TEST, 0);
+   al_set_render_state(ALLEGRO_DEPTH_FUNCTION, ALLEGRO_RENDER_LESS);
+   al_set_render_state(ALLEGRO_WRITE_MASK, ALLEGRO_MASK_RGBA | ALLEGRO_MASK_DEPTH);
 }
 
 static char const *resolve_var(ALLEGRO_CONFIG const *cfg, char const *section,
@@ -336,6 +344,29 @@ static int get_blend_factor(char const *value)
       : atoi(value);
 }
 
+static int get_render_state(char const *value)
+{
+   return streq(value, "ALLEGRO_WRITE_MASK") ? ALLEGRO_WRITE_MASK
+      : streq(value, "ALLEGRO_DEPTH_TEST") ? ALLEGRO_DEPTH_TEST
+      : streq(value, "ALLEGRO_DEPTH_FUNCTION") ? ALLEGRO_DEPTH_FUNCTION
+      : atoi(value);
+}
+
+static int get_render_value(char const *value)
+{
+   return streq(value, "ALLEGRO_RENDER_NEVER") ? ALLEGRO_RENDER_NEVER
+      : streq(value, "ALLEGRO_RENDER_ALWAYS") ? ALLEGRO_RENDER_ALWAYS
+      : streq(value, "ALLEGRO_RENDER_LESS") ? ALLEGRO_RENDER_LESS
+      : streq(value, "ALLEGRO_RENDER_EQUAL") ? ALLEGRO_RENDER_EQUAL
+      : streq(value, "ALLEGRO_RENDER_LESS_EQUAL") ? ALLEGRO_RENDER_LESS_EQUAL
+      : streq(value, "ALLEGRO_RENDER_GREATER") ? ALLEGRO_RENDER_GREATER
+      : streq(value, "ALLEGRO_RENDER_NOT_EQUAL") ? ALLEGRO_RENDER_NOT_EQUAL
+      : streq(value, "ALLEGRO_RENDER_GREATER_EQUAL") ? ALLEGRO_RENDER_GREATER_EQUAL
+      : streq(value, "ALLEGRO_MASK_RGBA") ? ALLEGRO_MASK_RGBA
+      : streq(value, "ALLEGRO_MASK_DEPTH") ? ALLEGRO_MASK_DEPTH
+      : atoi(value);
+}
+
 static ALLEGRO_TRANSFORM *get_transform(const char *name)
 {
    int i;
@@ -405,6 +436,11 @@ static int get_bitmap_flags(char const *v)
 {
    return streq(v, "ALLEGRO_MEMORY_BITMAP") ? ALLEGRO_MEMORY_BITMAP
       : streq(v, "ALLEGRO_VIDEO_BITMAP") ? ALLEGRO_VIDEO_BITMAP
+      : streq(v, "ALLEGRO_MIN_LINEAR|ALLEGRO_MAG_LINEAR")
+         ? ALLEGRO_MIN_LINEAR|ALLEGRO_MAG_LINEAR
+      : streq(v, "ALLEGRO_MIPMAP") ? ALLEGRO_MIPMAP
+      : streq(v, "ALLEGRO_MEMORY_BITMAP|ALLEGRO_RLE_BITMAP")
+         ? ALLEGRO_MEMORY_BITMAP|ALLEGRO_RLE_BITMAP
       : atoi(v);
 }
 
@@ -433,6 +469,196 @@ static void fill_lock_region(LockRegion *lr, float alphafactor, bool blended)
    }
 }
 
+static void fill_lock_region_spans(LockRegion *lr, float alphafactor,
+   bool blended)
+{
+   ALLEGRO_COLOR *row = al_malloc(lr->w * sizeof(*row));
+   int x, y;
+   float r, g, b, a;
+
+   for (y = 0; y < lr->h; y++) {
+      for (x = 0; x < lr->w; x++) {
+         r = (float)x / (lr->w - 1);
+         b = (float)y / (lr->h - 1);
+         g = r*b;
+         a = r * alphafactor;
+         row[x] = al_map_rgba_f(r, g, b, a);
+      }
+      if (blended)
+         al_put_blended_pixel_span(lr->x, lr->y + y, lr->w, row);
+      else
+         al_put_pixel_span(lr->x, lr->y + y, lr->w, row);
+   }
+
+   al_free(row);
+}
+
+/* Draws the dirty rectangles of a bitmap onto the target. */
+static void fill_dirty_rectangles(ALLEGRO_BITMAP *bmp, ALLEGRO_COLOR color)
+{
+   int n = al_get_bitmap_dirty_rectangles(bmp, NULL, 0);
+   int *rects = al_malloc(n * 4 * sizeof(*rects));
+   int i;
+
+   al_get_bitmap_dirty_rectangles(bmp, rects, n);
+   for (i = 0; i < n; i++) {
+      const int *r = rects + i * 4;
+      al_draw_filled_rectangle(r[0], r[1], r[0] + r[2], r[1] + r[3], color);
+      al_draw_rectangle(r[0] + 0.5, r[1] + 0.5, r[0] + r[2] - 0.5,
+         r[1] + r[3] - 0.5, al_map_rgb(0, 0, 0), 1);
+   }
+
+   al_free(rects);
+}
+
+/* Marks in white the pixels of the target where any channel of the two
+ * bitmaps differs by more than tolerance, and the rest in black.
+ */
+static void fill_difference(ALLEGRO_BITMAP *bmp1, ALLEGRO_BITMAP *bmp2,
+   int tolerance)
+{
+   ALLEGRO_BITMAP *target = al_get_target_bitmap();
+   ALLEGRO_LOCKED_REGION *lr1;
+   ALLEGRO_LOCKED_REGION *lr2;
+   int x, y, w, h, c;
+
+   w = al_get_bitmap_width(bmp1);
+   h = al_get_bitmap_height(bmp1);
+   if (w > al_get_bitmap_width(bmp2))
+      w = al_get_bitmap_width(bmp2);
+   if (h > al_get_bitmap_height(bmp2))
+      h = al_get_bitmap_height(bmp2);
+
+   al_clear_to_color(al_map_rgb(0, 0, 0));
+
+   lr1 = al_lock_bitmap(bmp1, ALLEGRO_PIXEL_FORMAT_RGBA_8888,
+      ALLEGRO_LOCK_READONLY);
+   lr2 = al_lock_bitmap(bmp2, ALLEGRO_PIXEL_FORMAT_RGBA_8888,
+      ALLEGRO_LOCK_READONLY);
+   al_lock_bitmap(target, ALLEGRO_PIXEL_FORMAT_ANY, ALLEGRO_LOCK_READWRITE);
+
+   for (y = 0; y < h; y++) {
+      unsigned char const *data1 =
+         ((unsigned char const *)lr1->data) + y*lr1->pitch;
+      unsigned char const *data2 =
+         ((unsigned char const *)lr2->data) + y*lr2->pitch;
+
+      for (x = 0; x < w; x++) {
+         for (c = 0; c < 4; c++) {
+            if (abs(data1[4*x + c] - data2[4*x + c]) > tolerance) {
+               al_put_pixel(x, y, al_map_rgb(255, 255, 255));
+               break;
+            }
+         }
+      }
+   }
+
+   al_unlock_bitmap(target);
+   al_unlock_bitmap(bmp1);
+   al_unlock_bitmap(bmp2);
+}
+
+/* Sets up num points for fill_transformed_points in the given layout:
+ * "packed" stores the coordinates of each point next to each other,
+ * "vertices" uses the fields of an ALLEGRO_VERTEX array, "arrays" uses a
+ * packed array per coordinate and "strided" puts gaps between them.
+ */
+static void layout_points(char const *layout, float *buf, int dims, int num,
+   float **x, float **y, float **z, int *stride)
+{
+   int i;
+
+   if (streq(layout, "packed")) {
+      *x = buf;
+      *y = buf + 1;
+      *z = buf + 2;
+      *stride = dims * sizeof(float);
+   }
+   else if (streq(layout, "vertices")) {
+      ALLEGRO_VERTEX *v = (ALLEGRO_VERTEX *)buf;
+      *x = &v[0].x;
+      *y = &v[0].y;
+      *z = &v[0].z;
+      *stride = sizeof(ALLEGRO_VERTEX);
+   }
+   else if (streq(layout, "arrays")) {
+      *x = buf;
+      *y = buf + num;
+      *z = buf + 2 * num;
+      *stride = sizeof(float);
+   }
+   else if (streq(layout, "strided")) {
+      *x = buf;
+      *y = buf + 2;
+      *z = buf + 4;
+      *stride = 5 * sizeof(float);
+   }
+   else {
+      fatal_error("unknown layout: %s", layout);
+   }
+
+   for (i = 0; i < num; i++) {
+      float *px = (float *)((char *)*x + i * *stride);
+      float *py = (float *)((char *)*y + i * *stride);
+      float *pz = (float *)((char *)*z + i * *stride);
+      *px = fmodf(i * 12.345f, 600.0f) - 300.0f;
+      *py = fmodf(i * 7.777f, 440.0f) - 220.0f;
+      if (dims == 3)
+         *pz = fmodf(i * 3.21f, 200.0f) - 100.0f;
+   }
+}
+
+/* Transforms num points with al_transform_coordinates_array, or with
+ * al_transform_coordinates_3d_array if dims is 3, with the points in the
+ * given layout. Each result is plotted in green if it is identical to the
+ * one of al_transform_coordinates{,_3d}, or in red otherwise.
+ */
+static void fill_transformed_points(ALLEGRO_TRANSFORM const *trans,
+   char const *layout, int dims, int num)
+{
+   ALLEGRO_VERTEX *buf;
+   float *x, *y, *z;
+   int stride;
+   int i;
+
+   if (num > MAX_POINTS)
+      fatal_error("too many points");
+
+   buf = al_calloc(MAX_POINTS, sizeof(ALLEGRO_VERTEX));
+   layout_points(layout, (float *)buf, dims, num, &x, &y, &z, &stride);
+   if (dims == 3)
+      al_transform_coordinates_3d_array(trans, x, y, z, stride, num);
+   else
+      al_transform_coordinates_array(trans, x, y, stride, num);
+
+   for (i = 0; i < num; i++) {
+      float const *px = (float *)((char *)x + i * stride);
+      float const *py = (float *)((char *)y + i * stride);
+      float const *pz = (float *)((char *)z + i * stride);
+      float ex = fmodf(i * 12.345f, 600.0f) - 300.0f;
+      float ey = fmodf(i * 7.777f, 440.0f) - 220.0f;
+      float ez = fmodf(i * 3.21f, 200.0f) - 100.0f;
+      bool same;
+
+      if (dims == 3) {
+         al_transform_coordinates_3d(trans, &ex, &ey, &ez);
+         same = !memcmp(px, &ex, sizeof(float)) &&
+            !memcmp(py, &ey, sizeof(float)) &&
+            !memcmp(pz, &ez, sizeof(float));
+      }
+      else {
+         al_transform_coordinates(trans, &ex, &ey);
+         same = !memcmp(px, &ex, sizeof(float)) &&
+            !memcmp(py, &ey, sizeof(float));
+      }
+
+      al_draw_filled_rectangle(ex - 1, ey - 1, ex + 1, ey + 1,
+         same ? al_map_rgb(0, 255, 0) : al_map_rgb(255, 0, 0));
+   }
+
+   al_free(buf);
+}
+
 static int get_load_font_flags(char const *v)
 {
    return streq(v, "ALLEGRO_NO_PREMULTIPLIED_ALPHA") ? ALLEGRO_NO_PREMULTIPLIED_ALPHA
@@ -599,6 +825,31 @@ static void fill_simple_vertices(ALLEGRO_CONFIG const *cfg, char const *name)
 #undef MAXBUF
 }
 
+static void fill_vertex_indices(ALLEGRO_CONFIG const *cfg, char const *name)
+{
+#define MAXBUF    80
+
+   char const *value;
+   char buf[MAXBUF];
+   int index;
+   int i;
+
+   memset(vertex_indices, 0, sizeof(vertex_indices));
+
+   for (i = 0; i < MAX_VERTICES; i++) {
+      sprintf(buf, "i%d", i);
+      value = al_get_config_value(cfg, name, buf);
+      if (!value)
+         break;
+
+      if (sscanf(value, " %d ", &index) == 1) {
+         vertex_indices[i] = index;
+      }
+   }
+
+#undef MAXBUF
+}
+
 static void fill_vertex_counts(ALLEGRO_CONFIG const *cfg, char const *name)
 {
 #define MAXBUF    80
@@ -1224,6 +1475,32 @@ static void do_test(ALLEGRO_CONFIG *cfg, char const *testname,
          fill_lock_region(&lock_region, F(0), get_bool(V(1)));
          continue;
       }
+      if (SCAN("fill_lock_region_spans", 2)) {
+         fill_lock_region_spans(&lock_region, F(0), get_bool(V(1)));
+         continue;
+      }
+
+      if (SCAN("al_reset_bitmap_dirty_rectangles", 1)) {
+         al_reset_bitmap_dirty_rectangles(B(0));
+         continue;
+      }
+      if (SCAN("fill_transformed_points", 3)) {
+         fill_transformed_points(get_transform(V(0)), V(1), 2, I(2));
+         continue;
+      }
+      if (SCAN("fill_transformed_points_3d", 3)) {
+         fill_transformed_points(get_transform(V(0)), V(1), 3, I(2));
+         continue;
+      }
+      if (SCAN("fill_difference", 3)) {
+         fill_difference(B(0), B(1), I(2));
+         continue;
+      }
+
+      if (SCAN("fill_dirty_rectangles", 2)) {
+         fill_dirty_rectangles(B(0), C(1));
+         continue;
+      }
 
       /* Fonts */
       if (SCAN("al_draw_text", 6)) {
@@ -1348,6 +1625,14 @@ static void do_test(ALLEGRO_CONFIG *cfg, char const *testname,
          al_draw_prim(vertices, NULL, B(2), I(3), I(4), get_prim_type(V(5)));
          continue;
       }
+      if (SCAN("al_draw_indexed_prim", 6)) {
+         fill_vertices(cfg, V(0));
+         fill_vertex_indices(cfg, V(3));
+         /* decl arg is ignored */
+         al_draw_indexed_prim(vertices, NULL, B(2), vertex_indices, I(4),
+            get_prim_type(V(5)));
+         continue;
+      }
 
       /* Keep 5.0 and 5.1 functions separate for easier merging. */
 
@@ -1376,6 +1661,32 @@ static void do_test(ALLEGRO_CONFIG *cfg, char const *testname,
          al_draw_filled_polygon_with_holes(simple_vertices, vertex_counts, C(2));
          continue;
       }
+      if (SCAN("al_set_path_geometry_polyline", 5)) {
+         if (!path_geometry)
+            path_geometry = al_create_path_geometry(ALLEGRO_PRIM_BUFFER_STATIC);
+         fill_simple_vertices(cfg, V(0));
+         al_set_path_geometry_polyline(path_geometry, simple_vertices,
+            2 * sizeof(float), num_simple_vertices, get_line_join(V(1)),
+            get_line_cap(V(2)), F(3), F(4));
+         continue;
+      }
+      if (SCAN("al_set_path_geometry_filled_polygon_with_holes", 2)) {
+         if (!path_geometry)
+            path_geometry = al_create_path_geometry(ALLEGRO_PRIM_BUFFER_STATIC);
+         fill_simple_vertices(cfg, V(0));
+         fill_vertex_counts(cfg, V(1));
+         al_set_path_geometry_filled_polygon_with_holes(path_geometry,
+            simple_vertices, vertex_counts);
+         continue;
+      }
+      if (SCAN("al_draw_path_geometry", 1)) {
+         al_draw_path_geometry(path_geometry, C(0));
+         continue;
+      }
+      if (SCAN("al_hold_primitive_drawing", 1)) {
+         al_hold_primitive_drawing(get_bool(V(0)));
+         continue;
+      }
 
       /* Transformations (5.1) */
       if (SCAN("al_horizontal_shear_transform", 2)) {
@@ -1394,6 +1705,32 @@ static void do_test(ALLEGRO_CONFIG *cfg, char const *testname,
          al_use_projection_transform(get_transform(V(0)));
          continue;
       }
+      if (SCAN("al_perspective_transform", 7)) {
+         al_perspective_transform(get_transform(V(0)), F(1), F(2), F(3), F(4), F(5), F(6));
+         continue;
+      }
+      if (SCAN("al_translate_transform_3d", 4)) {
+         al_translate_transform_3d(get_transform(V(0)), F(1), F(2), F(3));
+         continue;
+      }
+      if (SCAN("al_rotate_transform_3d", 5)) {
+         al_rotate_transform_3d(get_transform(V(0)), F(1), F(2), F(3), F(4));
+         continue;
+      }
+
+      /* Depth buffers */
+      if (SCAN("al_set_new_bitmap_depth", 1)) {
+         al_set_new_bitmap_depth(I(0));
+         continue;
+      }
+      if (SCAN("al_set_render_state", 2)) {
+         al_set_render_state(get_render_state(V(0)), get_render_value(V(1)));
+         continue;
+      }
+      if (SCAN("al_clear_depth_buffer", 1)) {
+         al_clear_depth_buffer(F(0));
+         continue;
+      }
       if (SCAN("al_set_blend_color", 1)) {
          al_set_blend_color(C(0));
          continue;
@@ -1484,6 +1821,7 @@ static void do_test(ALLEGRO_CONFIG *cfg, char const *testname,
    }
 
    al_set_new_bitmap_format(ALLEGRO_PIXEL_FORMAT_ANY_WITH_ALPHA);
+   al_set_new_bitmap_depth(0);
 
    if (do_check_hash) {
       check_hash(cfg, testname, target, bmp_type);
@@ -1524,6 +1862,9 @@ static void do_test(ALLEGRO_CONFIG *cfg, char const *testname,
       }
    }
 
+   al_destroy_path_geometry(path_geometry);
+   path_geometry = NULL;
+
    /* Free transform names. */
    for (i = 0; i < MAX_TRANS; i++) {
       al_ustr_free(transforms[i].name);